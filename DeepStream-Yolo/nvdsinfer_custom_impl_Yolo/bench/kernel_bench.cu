@@ -0,0 +1,451 @@
+// kernel_bench.cu  (standalone benchmark + correctness check of the YoloLayer decode kernels)
+// Drives cudaYoloLayer (yoloForward.cu), cudaYoloLayer_nc (yoloForward_nc.cu), cudaRegionLayer
+// (yoloForward_v2.cu) and cudaYoloLayerFused (yoloForward_fused.cu, FP32 / FP16 / INT8 heads, one head or all
+// --grids at once) on random head tensors, and for every case prints the time per launch, the achieved
+// bandwidth (head bytes read + box bytes written) and the largest deviation from a CPU decoder.
+// Build with `make bench`.
+//
+//   bench/kernel_bench [--kernel all|yolo|nc|region|fused|fused_half|fused_int8|fused_multi|half]
+//                      [--grids 80,40,20] [--classes 1,80] [--anchors 3] [--batches 1,8] [--reps 200]
+//                      [--class-lanes 0,1,4]
+//
+// --kernel half converts every one of the 2^32 float bit patterns with the device's __float2half_rn and with
+// float_to_half() (half_float.h), the host converter the pose cache, the weights blob and the INT8 tensor cache
+// share, and fails on any difference (NaN only has to stay NaN). It only runs when asked for, not under all.
+//
+// --class-lanes sets YoloLayerParams::classLanes for the fused kernels (0 = the plugin's choice by class count,
+// 1 = one lane per row, 4 = kYoloClassLanes lanes per row); the fused rows are labelled fused/<lanes>.
+//
+// A case fails (exit 1) when a box coordinate or score is off by more than 1e-3 relative (1e-3 absolute near
+// zero), or when more than 0.1% of the rows pick another class (ties under the fast-math intrinsics).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cuda_fp16.h>
+#include <cuda_runtime_api.h>
+
+#include "../half_float.h"
+#include "../yoloForward_fused.h"
+
+cudaError_t cudaYoloLayer(const void* input, void* output, const uint& batchSize, const uint64_t& inputSize,
+    const uint64_t& outputSize, const uint64_t& lastInputSize, const uint& netWidth, const uint& netHeight,
+    const uint& gridSizeX, const uint& gridSizeY, const uint& numOutputClasses, const uint& numBBoxes,
+    const float& scaleXY, const void* anchors, const void* mask, cudaStream_t stream);
+
+cudaError_t cudaYoloLayer_nc(const void* input, void* output, const uint& batchSize, const uint64_t& inputSize,
+    const uint64_t& outputSize, const uint64_t& lastInputSize, const uint& netWidth, const uint& netHeight,
+    const uint& gridSizeX, const uint& gridSizeY, const uint& numOutputClasses, const uint& numBBoxes,
+    const float& scaleXY, const void* anchors, const void* mask, cudaStream_t stream);
+
+cudaError_t cudaRegionLayer(const void* input, void* output, const uint& batchSize,
+    const uint64_t& inputSize, const uint64_t& outputSize, const uint64_t& lastInputSize, const uint& netWidth,
+    const uint& netHeight, const uint& gridSizeX, const uint& gridSizeY, const uint& numOutputClasses,
+    const uint& numBBoxes, const void* anchors, cudaStream_t stream);
+
+namespace {
+
+constexpr uint kNetW = 640;
+constexpr uint kNetH = 640;
+constexpr float kScaleXY = 2.0f;
+
+#define BENCH_CHECK(call) do {                                                                        \
+  const cudaError_t err_ = (call);                                                                      \
+  if (err_ != cudaSuccess) {                                                                            \
+    std::fprintf(stderr, "CUDA failure: %s at %s:%d\n", cudaGetErrorString(err_), __FILE__, __LINE__);  \
+    std::exit(2);                                                                                      \
+  }                                                                                                    \
+} while (0)
+
+struct Options {
+  std::string kernel{"all"};
+  std::vector<int> grids{80, 40, 20};
+  std::vector<int> classes{1, 80};
+  std::vector<int> anchors{3};
+  std::vector<int> batches{1, 8};
+  std::vector<int> classLanes{0};
+  int reps{200};
+};
+
+// One YOLO head as the plugin sees it; `input` holds every batch element back to back, channel-major.
+struct Head {
+  int grid{0};
+  int numBBoxes{0};
+  uint kind{kYoloHead};
+  std::vector<float> anchors;
+  std::vector<int> mask;
+  std::vector<float> input;
+
+  uint64_t inputSize(int nc) const { return (uint64_t) numBBoxes * (5 + nc) * grid * grid; }
+  uint64_t rows() const { return (uint64_t) numBBoxes * grid * grid; }
+};
+
+std::vector<int> parse_list(const char* s) {
+  std::vector<int> out;
+  std::stringstream list(s);
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    if (!item.empty()) out.push_back(std::atoi(item.c_str()));
+  }
+  return out;
+}
+
+float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+// The per-head kernels' math, one batch element of one head, rows written at out + row * 6.
+void reference_decode(const Head& head, const float* in, int nc, float* out) {
+  const int cells = head.grid * head.grid;
+  for (int z = 0; z < head.numBBoxes; ++z) {
+    for (int cell = 0; cell < cells; ++cell) {
+      const int x = cell % head.grid, y = cell / head.grid;
+      const float* p = in + (size_t) z * (5 + nc) * cells + cell;
+      auto at = [&](int c) { return p[(size_t) c * cells]; };
+      float xc, yc, w, h, obj, maxProb = 0.0f;
+      int maxIndex = -1;
+      if (head.kind == kRegionHead) {
+        xc = (sigmoid(at(0)) + x) * kNetW / head.grid;
+        yc = (sigmoid(at(1)) + y) * kNetH / head.grid;
+        w = std::exp(at(2)) * head.anchors[z * 2] * kNetW / head.grid;
+        h = std::exp(at(3)) * head.anchors[z * 2 + 1] * kNetH / head.grid;
+        obj = sigmoid(at(4));
+        float largest = -INFINITY, sum = 0.0f;
+        for (int c = 0; c < nc; ++c) largest = std::max(largest, at(5 + c));
+        for (int c = 0; c < nc; ++c) sum += std::exp(at(5 + c) - largest);
+        for (int c = 0; c < nc; ++c) {
+          const float prob = std::exp(at(5 + c) - largest) / sum;
+          if (prob > maxProb) { maxProb = prob; maxIndex = c; }
+        }
+      } else {
+        const bool activated = head.kind == kYoloHeadNewCoords;
+        const float alpha = kScaleXY, beta = -0.5f * (kScaleXY - 1);
+        const int anchor = head.mask[z] * 2;
+        const float bx = activated ? at(0) : sigmoid(at(0));
+        const float by = activated ? at(1) : sigmoid(at(1));
+        xc = (bx * alpha + beta + x) * kNetW / head.grid;
+        yc = (by * alpha + beta + y) * kNetH / head.grid;
+        w = (activated ? std::pow(at(2) * 2, 2.0f) : std::exp(at(2))) * head.anchors[anchor];
+        h = (activated ? std::pow(at(3) * 2, 2.0f) : std::exp(at(3))) * head.anchors[anchor + 1];
+        obj = activated ? at(4) : sigmoid(at(4));
+        for (int c = 0; c < nc; ++c) {
+          const float prob = activated ? at(5 + c) : sigmoid(at(5 + c));
+          if (prob > maxProb) { maxProb = prob; maxIndex = c; }
+        }
+      }
+      float* o = out + ((size_t) z * cells + cell) * 6;
+      o[0] = xc - w * 0.5f; o[1] = yc - h * 0.5f; o[2] = xc + w * 0.5f; o[3] = yc + h * 0.5f;
+      o[4] = maxProb * obj; o[5] = (float) maxIndex;
+    }
+  }
+}
+
+// Logits for the sigmoid/softmax heads; probabilities and small offsets for new_coords, which the network
+// already activated.
+Head make_head(int grid, int numBBoxes, int nc, int batch, uint kind, std::mt19937& rng) {
+  Head head;
+  head.grid = grid;
+  head.numBBoxes = numBBoxes;
+  head.kind = kind;
+  std::uniform_real_distribution<float> anchor(8.f, 200.f);
+  for (int b = 0; b < numBBoxes; ++b) {
+    head.anchors.push_back(anchor(rng));
+    head.anchors.push_back(anchor(rng));
+    head.mask.push_back(b);
+  }
+  head.input.resize(head.inputSize(nc) * batch);
+  std::normal_distribution<float> logit(0.f, 2.f);
+  std::uniform_real_distribution<float> prob(0.f, 1.f);
+  for (float& v : head.input) {
+    v = kind == kYoloHeadNewCoords ? prob(rng) : std::max(-4.f, std::min(4.f, logit(rng)));
+  }
+  return head;
+}
+
+// Rounds the head to what the device will read, so the reference decodes exactly the same values.
+float quantize(std::vector<float>& values, YoloInputType type, std::vector<char>& bytes) {
+  float scale = 1.0f;
+  if (type == kYoloInputInt8) {
+    float amax = 0.f;
+    for (float v : values) amax = std::max(amax, std::fabs(v));
+    scale = amax > 0.f ? amax / 127.f : 1.f;
+    bytes.resize(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      const int q = std::max(-127, std::min(127, (int) std::lround(values[i] / scale)));
+      bytes[i] = (char) q;
+      values[i] = q * scale;
+    }
+  } else if (type == kYoloInputHalf) {
+    bytes.resize(values.size() * sizeof(__half));
+    __half* h = reinterpret_cast<__half*>(bytes.data());
+    for (size_t i = 0; i < values.size(); ++i) {
+      h[i] = __float2half(values[i]);
+      values[i] = __half2float(h[i]);
+    }
+  } else {
+    bytes.resize(values.size() * sizeof(float));
+    std::copy(values.begin(), values.end(), reinterpret_cast<float*>(bytes.data()));
+  }
+  return scale;
+}
+
+size_t element_size(YoloInputType type) {
+  return type == kYoloInputInt8 ? 1 : type == kYoloInputHalf ? sizeof(__half) : sizeof(float);
+}
+
+struct Check {
+  double maxRelErr{0};
+  double classMismatch{0};
+  bool ok{true};
+};
+
+Check compare(const std::vector<float>& got, const std::vector<float>& ref) {
+  Check c;
+  size_t mismatches = 0;
+  const size_t rows = ref.size() / 6;
+  for (size_t r = 0; r < rows; ++r) {
+    if (got[r * 6 + 5] != ref[r * 6 + 5]) {
+      ++mismatches;
+      continue;
+    }
+    for (int k = 0; k < 5; ++k) {
+      const double e = std::fabs(got[r * 6 + k] - ref[r * 6 + k]) / std::max(1.0, (double) std::fabs(ref[r * 6 + k]));
+      c.maxRelErr = std::max(c.maxRelErr, e);
+    }
+  }
+  c.classMismatch = rows ? (double) mismatches / rows : 0.0;
+  c.ok = c.maxRelErr <= 1e-3 && c.classMismatch <= 1e-3;
+  return c;
+}
+
+// Runs `launch` once for the correctness check and `reps` times under events; returns ms per launch.
+template <typename Launch>
+float time_launches(int reps, cudaStream_t stream, Launch launch) {
+  cudaEvent_t start, stop;
+  BENCH_CHECK(cudaEventCreate(&start));
+  BENCH_CHECK(cudaEventCreate(&stop));
+  BENCH_CHECK(cudaEventRecord(start, stream));
+  for (int i = 0; i < reps; ++i) BENCH_CHECK(launch());
+  BENCH_CHECK(cudaEventRecord(stop, stream));
+  BENCH_CHECK(cudaEventSynchronize(stop));
+  float ms = 0.f;
+  BENCH_CHECK(cudaEventElapsedTime(&ms, start, stop));
+  cudaEventDestroy(start);
+  cudaEventDestroy(stop);
+  return ms / reps;
+}
+
+// One benchmark case: every head of `heads` decoded for `batch` elements by `kernel`.
+bool run_case(const std::string& kernel, std::vector<Head>& heads, int nc, int batch, int classLanes, int reps,
+              cudaStream_t stream) {
+  YoloInputType type = kYoloInputFloat;
+  if (kernel == "fused_half") type = kYoloInputHalf;
+  if (kernel == "fused_int8") type = kYoloInputInt8;
+
+  uint64_t rowsPerBatch = 0;
+  for (const Head& h : heads) rowsPerBatch += h.rows();
+
+  std::vector<void*> inputs, anchors, masks;
+  std::vector<float> scales;
+  size_t bytesRead = 0;
+  for (Head& h : heads) {
+    std::vector<char> bytes;
+    scales.push_back(quantize(h.input, type, bytes));
+    void *in, *an, *ma;
+    BENCH_CHECK(cudaMalloc(&in, bytes.size()));
+    BENCH_CHECK(cudaMemcpy(in, bytes.data(), bytes.size(), cudaMemcpyHostToDevice));
+    BENCH_CHECK(cudaMalloc(&an, h.anchors.size() * sizeof(float)));
+    BENCH_CHECK(cudaMemcpy(an, h.anchors.data(), h.anchors.size() * sizeof(float), cudaMemcpyHostToDevice));
+    BENCH_CHECK(cudaMalloc(&ma, h.mask.size() * sizeof(int)));
+    BENCH_CHECK(cudaMemcpy(ma, h.mask.data(), h.mask.size() * sizeof(int), cudaMemcpyHostToDevice));
+    inputs.push_back(in); anchors.push_back(an); masks.push_back(ma);
+    bytesRead += h.input.size() * element_size(type);
+  }
+  const size_t outFloats = (size_t) batch * rowsPerBatch * 6;
+  float* output;
+  BENCH_CHECK(cudaMalloc(reinterpret_cast<void**>(&output), outFloats * sizeof(float)));
+
+  YoloLayerParams params {};
+  if (kernel.compare(0, 5, "fused") == 0) {
+    params.numHeads = heads.size();
+    params.netWidth = kNetW;
+    params.netHeight = kNetH;
+    params.numClasses = nc;
+    params.objectnessGate = -INFINITY;
+    params.objectnessLogit = -INFINITY;
+    params.classLanes = classLanes;
+    for (size_t i = 0; i < heads.size(); ++i) {
+      YoloHeadParams& p = params.heads[i];
+      p.input = inputs[i];
+      p.scale = scales[i];
+      p.anchors = static_cast<const float*>(anchors[i]);
+      p.mask = static_cast<const int*>(masks[i]);
+      p.inputSize = heads[i].inputSize(nc);
+      p.threadStart = params.threadsPerBatch;
+      p.gridSizeX = p.gridSizeY = heads[i].grid;
+      p.numBBoxes = heads[i].numBBoxes;
+      p.scaleXY = kScaleXY;
+      p.kind = heads[i].kind;
+      params.threadsPerBatch += heads[i].rows();
+    }
+  }
+
+  auto launch = [&]() -> cudaError_t {
+    if (kernel.compare(0, 5, "fused") == 0) {
+      return cudaYoloLayerFused(params, type, output, false, batch, stream);
+    }
+    const Head& h = heads[0];
+    const uint grid = h.grid, numBBoxes = h.numBBoxes, numClasses = nc, batchSize = batch;
+    if (kernel == "region") {
+      return cudaRegionLayer(inputs[0], output, batchSize, h.inputSize(nc), rowsPerBatch, 0, kNetW, kNetH, grid,
+          grid, numClasses, numBBoxes, anchors[0], stream);
+    }
+    if (kernel == "nc") {
+      return cudaYoloLayer_nc(inputs[0], output, batchSize, h.inputSize(nc), rowsPerBatch, 0, kNetW, kNetH, grid,
+          grid, numClasses, numBBoxes, kScaleXY, anchors[0], masks[0], stream);
+    }
+    return cudaYoloLayer(inputs[0], output, batchSize, h.inputSize(nc), rowsPerBatch, 0, kNetW, kNetH, grid, grid,
+        numClasses, numBBoxes, kScaleXY, anchors[0], masks[0], stream);
+  };
+
+  BENCH_CHECK(launch());
+  BENCH_CHECK(cudaStreamSynchronize(stream));
+  std::vector<float> got(outFloats), ref(outFloats);
+  BENCH_CHECK(cudaMemcpy(got.data(), output, outFloats * sizeof(float), cudaMemcpyDeviceToHost));
+  for (int b = 0; b < batch; ++b) {
+    uint64_t row = 0;
+    for (const Head& h : heads) {
+      reference_decode(h, h.input.data() + b * h.inputSize(nc), nc, ref.data() + (b * rowsPerBatch + row) * 6);
+      row += h.rows();
+    }
+  }
+  const Check check = compare(got, ref);
+
+  const float ms = time_launches(reps, stream, launch);
+  const double gbps = (bytesRead + outFloats * sizeof(float)) / (ms * 1e6);
+
+  std::string grids;
+  for (const Head& h : heads) grids += (grids.empty() ? "" : "+") + std::to_string(h.grid);
+  const std::string label = kernel.compare(0, 5, "fused") == 0 ? kernel + "/" + std::to_string(classLanes) : kernel;
+  std::printf("%-14s %-10s %4d %4d %5d %10.2f %9.1f %10.2e %8.4f%%  %s\n", label.c_str(), grids.c_str(),
+              heads[0].numBBoxes, nc, batch, ms * 1000.f, gbps, check.maxRelErr, check.classMismatch * 100.0,
+              check.ok ? "ok" : "FAIL");
+
+  for (size_t i = 0; i < heads.size(); ++i) {
+    cudaFree(inputs[i]); cudaFree(anchors[i]); cudaFree(masks[i]);
+  }
+  cudaFree(output);
+  return check.ok;
+}
+
+__global__ void float2HalfCuda(uint32_t first, uint32_t n, uint16_t* out)
+{
+  const uint32_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < n) {
+    out[i] = __half_as_ushort(__float2half_rn(__uint_as_float(first + i)));
+  }
+}
+
+// float_to_half() against __float2half_rn over every float, in chunks of 2^24.
+bool check_half(cudaStream_t stream) {
+  constexpr uint32_t kChunk = 1u << 24;
+  uint16_t* device = nullptr;
+  BENCH_CHECK(cudaMalloc(&device, kChunk * sizeof(uint16_t)));
+  std::vector<uint16_t> expected(kChunk);
+  uint64_t mismatches = 0;
+  for (uint64_t first = 0; first < (1ull << 32); first += kChunk) {
+    float2HalfCuda<<<kChunk / 256, 256, 0, stream>>>((uint32_t) first, kChunk, device);
+    BENCH_CHECK(cudaMemcpyAsync(expected.data(), device, kChunk * sizeof(uint16_t), cudaMemcpyDeviceToHost, stream));
+    BENCH_CHECK(cudaStreamSynchronize(stream));
+    for (uint32_t i = 0; i < kChunk; ++i) {
+      const uint32_t x = (uint32_t) first + i;
+      float f;
+      std::memcpy(&f, &x, sizeof(f));
+      const uint16_t got = float_to_half(f);
+      const bool nan = (x & 0x7fffffffu) > 0x7f800000u;
+      const bool same = nan ? (got & 0x7fffu) > 0x7c00u && (expected[i] & 0x7fffu) > 0x7c00u : got == expected[i];
+      if (!same && mismatches++ < 8) {
+        std::fprintf(stderr, "float_to_half(0x%08x) = 0x%04x, __float2half_rn = 0x%04x\n", x, got, expected[i]);
+      }
+    }
+  }
+  cudaFree(device);
+  std::printf("%-14s %llu of 2^32 floats differ\n", "half", (unsigned long long) mismatches);
+  return mismatches == 0;
+}
+
+void usage() {
+  std::fprintf(stderr, "usage: kernel_bench [--kernel all|yolo|nc|region|fused|fused_half|fused_int8|fused_multi|half] "
+                       "[--grids a,b] [--classes a,b] [--anchors a,b] [--batches a,b] [--reps N] "
+                       "[--class-lanes a,b]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!v) { usage(); return 2; }
+    if (a == "--kernel") o.kernel = v;
+    else if (a == "--grids") o.grids = parse_list(v);
+    else if (a == "--classes") o.classes = parse_list(v);
+    else if (a == "--anchors") o.anchors = parse_list(v);
+    else if (a == "--batches") o.batches = parse_list(v);
+    else if (a == "--reps") o.reps = std::max(1, std::atoi(v));
+    else if (a == "--class-lanes") o.classLanes = parse_list(v);
+    else { usage(); return 2; }
+    ++i;
+  }
+
+  cudaStream_t stream;
+  BENCH_CHECK(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+
+  if (o.kernel == "half") {
+    const bool ok = check_half(stream);
+    cudaStreamDestroy(stream);
+    return ok ? 0 : 1;
+  }
+
+  static const char* kKernels[] = {"yolo", "nc", "region", "fused", "fused_half", "fused_int8", "fused_multi"};
+  std::mt19937 rng(1234);
+  int failures = 0;
+  std::printf("%-14s %-10s %4s %4s %5s %10s %9s %10s %9s\n", "kernel", "grid", "bbox", "nc", "batch", "us/launch",
+              "GB/s", "max_rel", "cls_diff");
+  for (const char* name : kKernels) {
+    const std::string kernel = name;
+    if (o.kernel != "all" && o.kernel != kernel) continue;
+    const uint kind = kernel == "nc" ? kYoloHeadNewCoords : kernel == "region" ? kRegionHead : kYoloHead;
+    for (int nb : o.anchors) {
+      for (int nc : o.classes) {
+        for (int batch : o.batches) {
+          // The per-head kernels have no class lanes: one pass
+          const std::vector<int> lanes = kernel.compare(0, 5, "fused") == 0 ? o.classLanes : std::vector<int>{0};
+          for (int cl : lanes) {
+            if (kernel == "fused_multi") {
+              if ((int) o.grids.size() > kYoloMaxHeads) continue;
+              std::vector<Head> heads;
+              for (int g : o.grids) heads.push_back(make_head(g, nb, nc, batch, kind, rng));
+              failures += !run_case(kernel, heads, nc, batch, cl, o.reps, stream);
+              continue;
+            }
+            for (int g : o.grids) {
+              std::vector<Head> heads{make_head(g, nb, nc, batch, kind, rng)};
+              failures += !run_case(kernel, heads, nc, batch, cl, o.reps, stream);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  cudaStreamDestroy(stream);
+  return failures > 0 ? 1 : 0;
+}
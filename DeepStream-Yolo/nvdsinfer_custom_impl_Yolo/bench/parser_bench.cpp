@@ -0,0 +1,491 @@
+// parser_bench.cpp  (standalone latency / allocation benchmark for the parser entry points)
+// Feeds synthetic (or recorded, --input) output tensors through the exported parse functions of
+// libnvdsinfer_custom_impl_Yolo.so and prints one row per (parser, threshold, candidate count):
+// p50 / p99 latency, calls per second and operator new calls per parse. Build with `make bench`.
+//
+//   bench/parser_bench [--parser all|yolo|cuda|v8pose|yolo26pose|obb|obb_nms] [--iters N] [--preds N]
+//                      [--thresholds 0.25,0.5] [--candidates 10,100,1000]
+//                      [--input tensor.f32 --dims 56x8400] [--csv out.csv]
+//                      [--baseline base.csv [--tolerance 1.10]]
+//
+// --input replays a raw float32 dump of one output tensor (e.g. written from a probe) instead of the
+// synthetic tensors; --dims gives its shape, outermost first. With --baseline the run fails (exit 1) when
+// any row's p99 exceeds the baseline row with the same key by more than --tolerance.
+//
+// obb_nms times the rotated NMS on its own, obb_nms() against obb_nms_cuda() on the same --candidates random boxes
+// at IoU 0.10 (every pair tested) and 0.45 (the grid pass), the crossover kObbNmsCudaMin* in obb_nms.h comes from.
+// It fails when the two keep different boxes for more than 1% of the candidates, and is skipped without a GPU.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "nvdsinfer_custom_impl.h"
+
+#include "../obb_nms.h"
+
+extern "C" bool NvDsInferParseYolo(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+extern "C" bool NvDsInferParseYoloCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+extern "C" bool NvDsInferParseYoloV8Pose(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferObjectDetectionInfo>& objects);
+extern "C" bool NvDsInferParseYolo26Pose(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferInstanceMaskInfo>& objects);
+extern "C" bool NvDsInferParseYoloOBB(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferObjectDetectionInfo>& objects);
+
+// Every operator new in the process, the library's included: the executable's definitions interpose the ones
+// in libstdc++ for the whole link map.
+static std::atomic<unsigned long long> g_allocs{0};
+
+void* operator new(std::size_t size) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr unsigned int kNetW = 640;
+constexpr unsigned int kNetH = 640;
+constexpr int kPoseKpts = 17;
+constexpr int kNumClasses = 80;
+constexpr size_t kParseFailed = static_cast<size_t>(-1);
+
+struct Options {
+  std::string parser{"all"};
+  int iters{2000};
+  int warmup{50};
+  int preds{8400};
+  std::vector<float> thresholds{0.25f, 0.5f};
+  std::vector<int> candidates{10, 100, 1000};
+  std::string input;
+  std::vector<unsigned int> dims;
+  std::string csv;
+  std::string baseline;
+  double tolerance{1.10};
+};
+
+struct Row {
+  std::string key;  // parser/threshold/candidates, the baseline join key
+  double p50_us{0}, p99_us{0}, calls_per_s{0}, allocs_per_call{0};
+  size_t objects{0};
+};
+
+// One bench case: the tensor handed to the parser, host-resident unless `device` is set.
+struct Tensor {
+  std::vector<float> host;
+  std::vector<unsigned int> dims;
+  float* device{nullptr};
+};
+
+template <typename T>
+std::vector<T> parse_list(const char* s) {
+  std::vector<T> out;
+  std::stringstream list(s);
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    if (!item.empty()) out.push_back(static_cast<T>(std::atof(item.c_str())));
+  }
+  return out;
+}
+
+std::vector<unsigned int> parse_dims(const char* s) {
+  std::vector<unsigned int> out;
+  std::stringstream list(s);
+  std::string item;
+  while (std::getline(list, item, 'x')) {
+    if (!item.empty()) out.push_back(static_cast<unsigned int>(std::atoi(item.c_str())));
+  }
+  return out;
+}
+
+NvDsInferLayerInfo layer_info(const Tensor& t) {
+  NvDsInferLayerInfo L;
+  std::memset(&L, 0, sizeof(L));
+  L.dataType = NvDsInferDataType::FLOAT;
+  L.inferDims.numDims = static_cast<unsigned int>(t.dims.size());
+  L.inferDims.numElements = 1;
+  for (size_t i = 0; i < t.dims.size(); ++i) {
+    L.inferDims.d[i] = t.dims[i];
+    L.inferDims.numElements *= t.dims[i];
+  }
+  L.layerName = "output";
+  L.buffer = t.device ? static_cast<void*>(t.device) : const_cast<float*>(t.host.data());
+  return L;
+}
+
+// A box inside the network with a plausible size; cx,cy,w,h.
+void random_box(std::mt19937& rng, float* b) {
+  std::uniform_real_distribution<float> pos(32.f, 608.f), size(8.f, 160.f);
+  b[0] = pos(rng); b[1] = pos(rng); b[2] = size(rng); b[3] = size(rng);
+}
+
+// Scores of the `candidates` anchors land in [thr + 0.05, 1), everything else below 0.05.
+float candidate_score(std::mt19937& rng, float thr) {
+  return std::uniform_real_distribution<float>(std::min(thr + 0.05f, 0.99f), 1.f)(rng);
+}
+float background_score(std::mt19937& rng) {
+  return std::uniform_real_distribution<float>(0.f, 0.05f)(rng);
+}
+
+// [N, 6] x1,y1,x2,y2,score,class: what the YoloLayer plugin writes.
+Tensor make_boxes(int n, int candidates, float thr, std::mt19937& rng) {
+  Tensor t;
+  t.dims = {static_cast<unsigned int>(n), 6};
+  t.host.resize(static_cast<size_t>(n) * 6);
+  for (int i = 0; i < n; ++i) {
+    float* p = &t.host[static_cast<size_t>(i) * 6];
+    random_box(rng, p);
+    const float cx = p[0], cy = p[1], w = p[2], h = p[3];
+    p[0] = cx - 0.5f * w; p[1] = cy - 0.5f * h; p[2] = cx + 0.5f * w; p[3] = cy + 0.5f * h;
+    p[4] = i < candidates ? candidate_score(rng, thr) : background_score(rng);
+    p[5] = static_cast<float>(rng() % kNumClasses);
+  }
+  return t;
+}
+
+// V8/YOLO11 pose head, channel-major [5 + 3 * 17, N] = [56, 8400]: cx,cy,w,h,obj, then x,y,conf per keypoint.
+Tensor make_v8_pose(int n, int candidates, float thr, std::mt19937& rng) {
+  const int dim = 5 + 3 * kPoseKpts;
+  Tensor t;
+  t.dims = {static_cast<unsigned int>(dim), static_cast<unsigned int>(n)};
+  t.host.resize(static_cast<size_t>(n) * dim);
+  for (int i = 0; i < n; ++i) {
+    float b[4];
+    random_box(rng, b);
+    for (int c = 0; c < 4; ++c) t.host[static_cast<size_t>(c) * n + i] = b[c];
+    t.host[static_cast<size_t>(4) * n + i] = i < candidates ? candidate_score(rng, thr) : background_score(rng);
+    for (int k = 0; k < kPoseKpts; ++k) {
+      t.host[static_cast<size_t>(5 + 3 * k) * n + i] = b[0] + (rng() % 32) - 16.f;
+      t.host[static_cast<size_t>(6 + 3 * k) * n + i] = b[1] + (rng() % 32) - 16.f;
+      t.host[static_cast<size_t>(7 + 3 * k) * n + i] = std::uniform_real_distribution<float>(0.f, 1.f)(rng);
+    }
+  }
+  return t;
+}
+
+// YOLO26 end-to-end pose head, [N, 6 + 3 * 17]: x1,y1,x2,y2,score,cls, keypoints.
+Tensor make_yolo26_pose(int n, int candidates, float thr, std::mt19937& rng) {
+  const int dim = 6 + 3 * kPoseKpts;
+  Tensor t;
+  t.dims = {static_cast<unsigned int>(n), static_cast<unsigned int>(dim)};
+  t.host.resize(static_cast<size_t>(n) * dim);
+  for (int i = 0; i < n; ++i) {
+    float* p = &t.host[static_cast<size_t>(i) * dim];
+    random_box(rng, p);
+    const float cx = p[0], cy = p[1], w = p[2], h = p[3];
+    p[0] = cx - 0.5f * w; p[1] = cy - 0.5f * h; p[2] = cx + 0.5f * w; p[3] = cy + 0.5f * h;
+    p[4] = i < candidates ? candidate_score(rng, thr) : background_score(rng);
+    p[5] = 0.f;
+    for (int k = 0; k < kPoseKpts; ++k) {
+      p[6 + 3 * k] = cx; p[7 + 3 * k] = cy;
+      p[8 + 3 * k] = std::uniform_real_distribution<float>(0.f, 1.f)(rng);
+    }
+  }
+  return t;
+}
+
+// OBB head, [N, 6 + 1]: cx,cy,w,h,theta,obj, one class score.
+Tensor make_obb(int n, int candidates, float thr, std::mt19937& rng) {
+  const int dim = 7;
+  Tensor t;
+  t.dims = {static_cast<unsigned int>(n), static_cast<unsigned int>(dim)};
+  t.host.resize(static_cast<size_t>(n) * dim);
+  for (int i = 0; i < n; ++i) {
+    float* p = &t.host[static_cast<size_t>(i) * dim];
+    random_box(rng, p);
+    p[4] = std::uniform_real_distribution<float>(-1.57f, 1.57f)(rng);
+    p[5] = i < candidates ? candidate_score(rng, thr) : background_score(rng);
+    p[6] = 1.f;
+  }
+  return t;
+}
+
+// Candidates are the first rows of the tensor; shuffle them among the background so the scan sees them spread
+// out the way a real frame does.
+void shuffle_rows(Tensor& t, bool channel_major, std::mt19937& rng) {
+  const size_t rows = channel_major ? t.dims[1] : t.dims[0];
+  const size_t dim = channel_major ? t.dims[0] : t.dims[1];
+  for (size_t i = rows - 1; i > 0; --i) {
+    const size_t j = rng() % (i + 1);
+    for (size_t c = 0; c < dim; ++c) {
+      float& a = channel_major ? t.host[c * rows + i] : t.host[i * dim + c];
+      float& b = channel_major ? t.host[c * rows + j] : t.host[j * dim + c];
+      std::swap(a, b);
+    }
+  }
+}
+
+bool load_tensor(const Options& o, Tensor& t) {
+  std::ifstream f(o.input, std::ios::binary | std::ios::ate);
+  size_t elems = 1;
+  for (unsigned int d : o.dims) elems *= d;
+  if (!f.good() || o.dims.empty() || static_cast<size_t>(f.tellg()) != elems * sizeof(float)) {
+    std::fprintf(stderr, "ERROR: %s is not a float32 tensor of the --dims shape\n", o.input.c_str());
+    return false;
+  }
+  t.dims = o.dims;
+  t.host.resize(elems);
+  f.seekg(0);
+  f.read(reinterpret_cast<char*>(t.host.data()), elems * sizeof(float));
+  return true;
+}
+
+template <typename Parse>
+Row run_case(const std::string& key, const Options& o, Parse parse) {
+  for (int i = 0; i < o.warmup; ++i) {
+    if (parse() == kParseFailed) {
+      std::fprintf(stderr, "ERROR: %s: the parser returned false\n", key.c_str());
+      return Row();
+    }
+  }
+
+  std::vector<double> us(o.iters);
+  size_t objects = 0;
+  const unsigned long long allocs0 = g_allocs.load();
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < o.iters; ++i) {
+    const auto a = std::chrono::steady_clock::now();
+    objects = parse();
+    us[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - a).count();
+  }
+  const double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const unsigned long long allocs = g_allocs.load() - allocs0;
+
+  Row r;
+  r.key = key;
+  std::sort(us.begin(), us.end());
+  r.p50_us = us[us.size() / 2];
+  r.p99_us = us[std::min(us.size() - 1, us.size() * 99 / 100)];
+  r.calls_per_s = o.iters / total_s;
+  r.allocs_per_call = static_cast<double>(allocs) / o.iters;
+  r.objects = objects;
+  return r;
+}
+
+NvDsInferParseDetectionParams detection_params(float thr) {
+  NvDsInferParseDetectionParams p;
+  p.numClassesConfigured = kNumClasses;
+  p.perClassPreclusterThreshold.assign(kNumClasses, thr);
+  p.perClassPostclusterThreshold.assign(kNumClasses, 0.f);
+  return p;
+}
+
+bool wants(const Options& o, const char* name) {
+  return o.parser == "all" || o.parser == name;
+}
+
+// One case of one parser: builds (or reuses the recorded) tensor and times the entry point on it.
+bool bench_parser(const std::string& name, const Options& o, float thr, int candidates, std::mt19937& rng,
+                  std::vector<Row>& rows) {
+  Tensor t;
+  bool channel_major = false;
+  if (!o.input.empty()) {
+    if (!load_tensor(o, t)) return false;
+  } else if (name == "yolo" || name == "cuda") {
+    t = make_boxes(o.preds, candidates, thr, rng);
+  } else if (name == "v8pose") {
+    t = make_v8_pose(o.preds, candidates, thr, rng);
+    channel_major = true;
+  } else if (name == "yolo26pose") {
+    t = make_yolo26_pose(o.preds, candidates, thr, rng);
+  } else {
+    t = make_obb(o.preds, candidates, thr, rng);
+  }
+  if (o.input.empty()) shuffle_rows(t, channel_major, rng);
+
+  if (name == "cuda") {
+    const size_t bytes = t.host.size() * sizeof(float);
+    if (cudaMalloc(reinterpret_cast<void**>(&t.device), bytes) != cudaSuccess ||
+        cudaMemcpy(t.device, t.host.data(), bytes, cudaMemcpyHostToDevice) != cudaSuccess) {
+      std::fprintf(stderr, "WARNING: No CUDA device, skipping the cuda parser\n");
+      if (t.device) cudaFree(t.device);
+      return true;
+    }
+  }
+
+  const std::vector<NvDsInferLayerInfo> layers{layer_info(t)};
+  NvDsInferNetworkInfo net{kNetW, kNetH, 3};
+  const NvDsInferParseDetectionParams params = detection_params(thr);
+  char key[128];
+  std::snprintf(key, sizeof(key), "%s/%.2f/%d", name.c_str(), thr, o.input.empty() ? candidates : -1);
+
+  std::vector<NvDsInferParseObjectInfo> boxes;
+  std::vector<NvDsInferInstanceMaskInfo> masks;
+  Row r;
+  if (name == "yolo26pose") {
+    r = run_case(key, o, [&] {
+      return NvDsInferParseYolo26Pose(layers, net, params, masks) ? masks.size() : kParseFailed;
+    });
+  } else {
+    NvDsInferParseCustomFunc fn = NvDsInferParseYoloOBB;
+    if (name == "yolo") fn = NvDsInferParseYolo;
+    else if (name == "cuda") fn = NvDsInferParseYoloCuda;
+    else if (name == "v8pose") fn = NvDsInferParseYoloV8Pose;
+    r = run_case(key, o, [&] { return fn(layers, net, params, boxes) ? boxes.size() : kParseFailed; });
+  }
+  if (r.key.empty()) return false;
+  rows.push_back(r);
+
+  std::printf("%-28s %10.1f %10.1f %12.0f %10.2f %8zu\n", r.key.c_str(), r.p50_us, r.p99_us, r.calls_per_s,
+              r.allocs_per_call, r.objects);
+  if (t.device) cudaFree(t.device);
+  return true;
+}
+
+// obb_nms() and obb_nms_cuda() on the same boxes, one row each per (IoU, candidate count).
+bool bench_obb_nms(const Options& o, std::mt19937& rng, std::vector<Row>& rows) {
+  std::uniform_real_distribution<float> u(0.f, 1.f);
+  for (float iou : {0.10f, 0.45f}) {
+    for (int n : o.candidates) {
+      std::vector<ObbGauss> g(n);
+      for (ObbGauss& b : g) {
+        b = obb_gauss(kNetW * u(rng), kNetH * u(rng), 20.f + 40.f * u(rng), 8.f + 16.f * u(rng), 3.1416f * u(rng));
+      }
+      std::vector<int> cpu(n), gpu(n);
+      const int keptCpu = obb_nms(g.data(), nullptr, n, iou, cpu.data());
+      const int keptGpu = obb_nms_cuda(g.data(), n, iou, 0, gpu.data());
+      if (keptGpu < 0) {
+        std::fprintf(stderr, "WARNING: No CUDA device, skipping obb_nms\n");
+        return true;
+      }
+      // Pairs right at the threshold may round the other way under the device's exp / log.
+      std::vector<char> inCpu(n, 0), inGpu(n, 0);
+      for (int k = 0; k < keptCpu; ++k) inCpu[cpu[k]] = 1;
+      for (int k = 0; k < keptGpu; ++k) inGpu[gpu[k]] = 1;
+      int differ = 0;
+      for (int i = 0; i < n; ++i) differ += inCpu[i] != inGpu[i];
+      if (differ * 100 > n) {
+        std::fprintf(stderr, "ERROR: obb_nms/%.2f/%d: CPU and GPU disagree on %d boxes\n", iou, n, differ);
+        return false;
+      }
+
+      for (int device = 0; device < 2; ++device) {
+        char key[128];
+        std::snprintf(key, sizeof(key), "obb_nms_%s/%.2f/%d", device ? "cuda" : "cpu", iou, n);
+        std::vector<int>& keep = device ? gpu : cpu;
+        const Row r = run_case(key, o, [&] {
+          const int kept = device ? obb_nms_cuda(g.data(), n, iou, 0, keep.data())
+                                  : obb_nms(g.data(), nullptr, n, iou, keep.data());
+          return kept < 0 ? kParseFailed : static_cast<size_t>(kept);
+        });
+        if (r.key.empty()) return false;
+        rows.push_back(r);
+        std::printf("%-28s %10.1f %10.1f %12.0f %10.2f %8zu\n", r.key.c_str(), r.p50_us, r.p99_us, r.calls_per_s,
+                    r.allocs_per_call, r.objects);
+      }
+    }
+  }
+  return true;
+}
+
+std::map<std::string, double> load_baseline(const std::string& path) {
+  std::map<std::string, double> p99;
+  std::ifstream f(path);
+  std::string line;
+  while (std::getline(f, line)) {
+    std::stringstream s(line);
+    std::string key, p50, v;
+    if (std::getline(s, key, ',') && std::getline(s, p50, ',') && std::getline(s, v, ',') && key != "key") {
+      p99[key] = std::atof(v.c_str());
+    }
+  }
+  return p99;
+}
+
+void usage() {
+  std::fprintf(stderr, "usage: parser_bench [--parser all|yolo|cuda|v8pose|yolo26pose|obb|obb_nms] [--iters N] "
+                       "[--preds N] [--thresholds a,b] [--candidates a,b] [--input file --dims AxB] "
+                       "[--csv file] [--baseline file [--tolerance r]]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!v) { usage(); return 2; }
+    if (a == "--parser") o.parser = v;
+    else if (a == "--iters") o.iters = std::max(1, std::atoi(v));
+    else if (a == "--preds") o.preds = std::max(1, std::atoi(v));
+    else if (a == "--thresholds") o.thresholds = parse_list<float>(v);
+    else if (a == "--candidates") o.candidates = parse_list<int>(v);
+    else if (a == "--input") o.input = v;
+    else if (a == "--dims") o.dims = parse_dims(v);
+    else if (a == "--csv") o.csv = v;
+    else if (a == "--baseline") o.baseline = v;
+    else if (a == "--tolerance") o.tolerance = std::atof(v);
+    else { usage(); return 2; }
+    ++i;
+  }
+  if (!o.input.empty()) {
+    if (o.parser == "all") {
+      std::fprintf(stderr, "ERROR: --input needs a single --parser\n");
+      return 2;
+    }
+    o.candidates = {0};
+  }
+
+  static const char* kParsers[] = {"yolo", "cuda", "v8pose", "yolo26pose", "obb"};
+  std::mt19937 rng(1234);
+  std::vector<Row> rows;
+  std::printf("%-28s %10s %10s %12s %10s %8s\n", "parser/thr/candidates", "p50_us", "p99_us", "calls/s",
+              "allocs", "objects");
+  for (const char* name : kParsers) {
+    if (!wants(o, name)) continue;
+    for (float thr : o.thresholds) {
+      for (int c : o.candidates) {
+        if (!bench_parser(name, o, thr, std::min(c, o.preds), rng, rows)) return 1;
+      }
+    }
+  }
+  if (o.input.empty() && wants(o, "obb_nms") && !bench_obb_nms(o, rng, rows)) return 1;
+
+  if (!o.csv.empty()) {
+    std::ofstream f(o.csv);
+    f << "key,p50_us,p99_us,calls_per_s,allocs_per_call,objects\n";
+    for (const Row& r : rows) {
+      f << r.key << "," << r.p50_us << "," << r.p99_us << "," << r.calls_per_s << "," << r.allocs_per_call << ","
+        << r.objects << "\n";
+    }
+  }
+
+  int regressions = 0;
+  if (!o.baseline.empty()) {
+    const std::map<std::string, double> base = load_baseline(o.baseline);
+    for (const Row& r : rows) {
+      std::map<std::string, double>::const_iterator it = base.find(r.key);
+      if (it != base.end() && r.p99_us > it->second * o.tolerance) {
+        std::printf("REGRESSION: %s p99 %.1f us, baseline %.1f us\n", r.key.c_str(), r.p99_us, it->second);
+        ++regressions;
+      }
+    }
+  }
+  return regressions > 0 ? 1 : 0;
+}
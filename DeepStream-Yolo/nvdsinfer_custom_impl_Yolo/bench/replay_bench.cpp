@@ -0,0 +1,575 @@
+// replay_bench.cpp  (replay recorded parser inputs through the current build and diff the results)
+// Reads a recording written with SQUEAKVIEW_RECORD (see tensor_record.h), feeds every recorded call to the
+// parser it was recorded from (or --parser) and prints one summary row: frames, p50 / p99 latency per call,
+// operator new calls per call and detections. Build with `make bench`; `make replay` runs it over every
+// recording under runs/.
+//
+//   bench/replay_bench --input runs/<run>/tensors.sqvrec [--parser yolo|cuda|...] [--passes N]
+//                      [--results out.csv] [--baseline base.csv [--max-unmatched 0.01]
+//                      [--max-box-delta 1.0] [--max-kpt-delta 1.0]] [--csv dashboard.csv [--label rev]
+//                      [--tolerance 1.10]]
+//
+// --results writes every detection of the last pass (frame, class, confidence, box and, for the pose parsers,
+// the keypoints from the pose cache). --baseline diffs them against an earlier --results file: detections of a
+// frame are matched greedily by confidence at IoU >= 0.5 within a class, and the run fails (exit 1) when more
+// than --max-unmatched of them are unmatched on either side, or the mean box or keypoint delta of the matched
+// ones exceeds its limit in pixels. --csv appends the summary row to a dashboard file; with --tolerance the run
+// also fails when p99 exceeds the newest earlier row of the same recording and parser by more than that ratio.
+// Replays are only comparable with SQUEAKVIEW_POSE_TRACK off, as tracking state carries over between passes.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "nvdsinfer_custom_impl.h"
+
+#include "../pose_cache.h"
+#include "../tensor_record.h"
+
+extern "C" bool NvDsInferParseYolo(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+extern "C" bool NvDsInferParseYoloCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+extern "C" bool NvDsInferParseYoloCudaNms(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+extern "C" bool NvDsInferParseYoloV8Pose(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferObjectDetectionInfo>& objects);
+extern "C" bool NvDsInferParseYoloV8PoseBoxes(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferObjectDetectionInfo>& objects);
+extern "C" bool NvDsInferParseYoloV8PoseCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+extern "C" bool NvDsInferParseYolo26Pose(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferInstanceMaskInfo>& objects);
+extern "C" bool NvDsInferParseYoloOBB(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferObjectDetectionInfo>& objects);
+extern "C" bool NvDsInferParseYoloV8OBB(const std::vector<NvDsInferLayerInfo>& layers,
+    const NvDsInferNetworkInfo& net, const NvDsInferParseDetectionParams& params,
+    std::vector<NvDsInferObjectDetectionInfo>& objects);
+
+// Every operator new in the process, the library's included (see parser_bench.cpp).
+static std::atomic<unsigned long long> g_allocs{0};
+
+void* operator new(std::size_t size) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Options {
+  std::string input;
+  std::string parser;  // empty: the one each call was recorded from
+  int passes{2};
+  std::string results;
+  std::string baseline;
+  double max_unmatched{0.01};
+  double max_box_delta{1.0};
+  double max_kpt_delta{1.0};
+  std::string csv;
+  std::string label{"-"};
+  double tolerance{0};
+};
+
+struct RecordedLayer {
+  std::string name;
+  NvDsInferDataType type;
+  NvDsInferDims dims;
+  size_t offset;  // of the data in the recording
+  size_t bytes;
+};
+
+struct RecordedCall {
+  std::string parser;
+  uint32_t slot;
+  NvDsInferNetworkInfo net;
+  NvDsInferParseDetectionParams params;
+  std::vector<RecordedLayer> layers;
+};
+
+// Consecutive calls from slot 0 up to the next slot 0, laid out again the way nvinfer hands them over: layer l
+// of call k at buffers[l] + k * frame bytes.
+struct Batch {
+  size_t first, count;
+  std::vector<std::vector<uint64_t>> host;  // uint64_t keeps every frame 8-byte aligned
+  std::vector<void*> device;
+};
+
+struct Detection {
+  int cls;
+  float conf;
+  float box[4];  // left, top, width, height
+  std::vector<float> kpts;  // x, y, score per keypoint
+};
+
+struct Summary {
+  std::string key;  // recording/parser, the dashboard join key
+  size_t frames{0};
+  double p50_us{0}, p99_us{0}, allocs_per_call{0};
+  size_t detections{0};
+  size_t unmatched{0};
+  double box_delta{0}, kpt_delta{0};
+};
+
+bool read_recording(const std::string& path, std::vector<char>& data, std::vector<RecordedCall>& calls) {
+  std::ifstream f(path, std::ios::binary | std::ios::ate);
+  if (!f.good()) {
+    std::fprintf(stderr, "ERROR: could not open %s\n", path.c_str());
+    return false;
+  }
+  data.resize(static_cast<size_t>(f.tellg()));
+  f.seekg(0);
+  f.read(data.data(), data.size());
+
+  NvDsRecordFileHeader fh{};
+  if (data.size() >= sizeof(fh)) std::memcpy(&fh, data.data(), sizeof(fh));
+  if (std::memcmp(fh.magic, kRecordFileMagic, sizeof(fh.magic)) != 0 || fh.version != kRecordVersion) {
+    std::fprintf(stderr, "ERROR: %s is not a version %u recording\n", path.c_str(), kRecordVersion);
+    return false;
+  }
+
+  size_t pos = sizeof(fh);
+  while (pos + sizeof(NvDsRecordHeader) <= data.size()) {
+    NvDsRecordHeader h;
+    std::memcpy(&h, data.data() + pos, sizeof(h));
+    if (h.magic != kRecordMagic || h.bytes < sizeof(h) || pos + h.bytes > data.size()) {
+      std::fprintf(stderr, "WARNING: %s: recording ends in a partial record after %zu calls\n", path.c_str(),
+                   calls.size());
+      break;
+    }
+    const size_t end = pos + h.bytes;
+    RecordedCall c;
+    c.parser.assign(h.parser, strnlen(h.parser, sizeof(h.parser)));
+    if (c.parser == "result") {  // live results of SQUEAKVIEW_RECORD_RESULTS, not a call
+      pos = end;
+      continue;
+    }
+    c.slot = h.batch_slot;
+    c.net = NvDsInferNetworkInfo{h.net_width, h.net_height, h.net_channels};
+    c.params.numClassesConfigured = h.num_classes;
+    const float* thr = reinterpret_cast<const float*>(data.data() + pos + sizeof(h));
+    c.params.perClassPreclusterThreshold.assign(thr, thr + h.num_classes);
+    c.params.perClassPostclusterThreshold.assign(h.num_classes, 0.f);
+    size_t p = pos + sizeof(h) + ((h.num_classes * sizeof(float) + 7) & ~static_cast<size_t>(7));
+    for (uint32_t l = 0; l < h.num_layers && p + sizeof(NvDsRecordLayer) <= end; ++l) {
+      NvDsRecordLayer d;
+      std::memcpy(&d, data.data() + p, sizeof(d));
+      RecordedLayer L;
+      L.name.assign(d.name, strnlen(d.name, sizeof(d.name)));
+      L.type = static_cast<NvDsInferDataType>(d.data_type);
+      std::memset(&L.dims, 0, sizeof(L.dims));
+      L.dims.numDims = std::min<uint32_t>(d.num_dims, kRecordMaxDims);
+      L.dims.numElements = 1;
+      for (uint32_t k = 0; k < L.dims.numDims; ++k) {
+        L.dims.d[k] = d.dims[k];
+        L.dims.numElements *= d.dims[k];
+      }
+      L.offset = p + sizeof(d);
+      L.bytes = static_cast<size_t>(d.bytes);
+      c.layers.push_back(L);
+      p = L.offset + ((L.bytes + 7) & ~static_cast<size_t>(7));
+    }
+    calls.push_back(c);
+    pos = end;
+  }
+  return true;
+}
+
+bool cuda_parser(const std::string& name) {
+  return name == "cuda" || name == "cuda_nms" || name == "v8pose_cuda";
+}
+
+bool pose_parser(const std::string& name) {
+  return name == "v8pose" || name == "v8pose_boxes" || name == "v8pose_cuda" || name == "yolo26pose";
+}
+
+// Groups the calls into batches and copies their tensors into place. Calls of one batch must agree on the layer
+// count and sizes; a call that doesn't starts a new batch.
+bool build_batches(const std::vector<char>& data, const std::vector<RecordedCall>& calls, bool device,
+                   std::vector<Batch>& batches) {
+  auto same_shape = [&](const RecordedCall& a, const RecordedCall& b) {
+    if (a.layers.size() != b.layers.size()) return false;
+    for (size_t l = 0; l < a.layers.size(); ++l) {
+      if (a.layers[l].bytes != b.layers[l].bytes) return false;
+    }
+    return true;
+  };
+  for (size_t i = 0; i < calls.size(); ++i) {
+    if (batches.empty() || calls[i].slot == 0 || !same_shape(calls[i], calls[batches.back().first])) {
+      batches.push_back(Batch{i, 0, {}, {}});
+    }
+    ++batches.back().count;
+  }
+
+  for (Batch& b : batches) {
+    const RecordedCall& c0 = calls[b.first];
+    b.host.resize(c0.layers.size());
+    b.device.assign(c0.layers.size(), nullptr);
+    for (size_t l = 0; l < c0.layers.size(); ++l) {
+      const size_t frame = c0.layers[l].bytes;
+      b.host[l].resize((frame * b.count + 7) / 8);
+      char* dst = reinterpret_cast<char*>(b.host[l].data());
+      for (size_t k = 0; k < b.count; ++k) {
+        std::memcpy(dst + k * frame, data.data() + calls[b.first + k].layers[l].offset, frame);
+      }
+      if (device && frame > 0) {
+        if (cudaMalloc(&b.device[l], frame * b.count) != cudaSuccess ||
+            cudaMemcpy(b.device[l], dst, frame * b.count, cudaMemcpyHostToDevice) != cudaSuccess) {
+          std::fprintf(stderr, "ERROR: No CUDA device for the CUDA parsers\n");
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// The newest pose frame, i.e. the one the call just published, as detections with keypoints.
+void pose_detections(std::vector<Detection>& out) {
+  out.clear();
+  NvDsPoseFrame f;
+  if (!NvDsInferPoseAcquireLatest(-1, &f)) return;
+  for (int i = 0; i < f.count; ++i) {
+    const float* r = f.data + static_cast<size_t>(i) * f.stride;
+    Detection d;
+    d.cls = 0;
+    d.conf = r[4];
+    d.box[0] = r[0]; d.box[1] = r[1]; d.box[2] = r[2] - r[0]; d.box[3] = r[3] - r[1];
+    d.kpts.assign(r + 5, r + 5 + 3 * f.kpts);
+    out.push_back(d);
+  }
+  NvDsInferPoseRelease(&f);
+}
+
+template <typename Object>
+void object_detections(const std::vector<Object>& objects, std::vector<Detection>& out) {
+  out.clear();
+  for (const Object& o : objects) {
+    Detection d;
+    d.cls = static_cast<int>(o.classId);
+    d.conf = o.detectionConfidence;
+    d.box[0] = o.left; d.box[1] = o.top; d.box[2] = o.width; d.box[3] = o.height;
+    out.push_back(d);
+  }
+}
+
+// One call through the named parser; false when it is unknown or returns false.
+bool parse(const std::string& name, const std::vector<NvDsInferLayerInfo>& layers, const RecordedCall& c,
+           std::vector<NvDsInferParseObjectInfo>& boxes, std::vector<NvDsInferInstanceMaskInfo>& masks) {
+  NvDsInferParseCustomFunc fn = nullptr;
+  if (name == "yolo") fn = NvDsInferParseYolo;
+  else if (name == "cuda") fn = NvDsInferParseYoloCuda;
+  else if (name == "cuda_nms") fn = NvDsInferParseYoloCudaNms;
+  else if (name == "v8pose") fn = NvDsInferParseYoloV8Pose;
+  else if (name == "v8pose_boxes") fn = NvDsInferParseYoloV8PoseBoxes;
+  else if (name == "v8pose_cuda") fn = NvDsInferParseYoloV8PoseCuda;
+  else if (name == "obb") fn = NvDsInferParseYoloOBB;
+  else if (name == "v8obb") fn = NvDsInferParseYoloV8OBB;
+  else if (name == "yolo26pose") return NvDsInferParseYolo26Pose(layers, c.net, c.params, masks);
+  return fn && fn(layers, c.net, c.params, boxes);
+}
+
+// Replays every call o.passes times; latency and allocations are taken from all but the first pass (unless
+// there is only one), the detections from the last.
+bool replay(const Options& o, const std::vector<char>& data, const std::vector<RecordedCall>& calls,
+            Summary& s, std::vector<std::vector<Detection>>& results) {
+  const std::string forced = o.parser;
+  bool device = false;
+  for (const RecordedCall& c : calls) device = device || cuda_parser(forced.empty() ? c.parser : forced);
+  std::vector<Batch> batches;
+  if (!build_batches(data, calls, device, batches)) return false;
+
+  std::vector<NvDsInferLayerInfo> layers;
+  std::vector<NvDsInferParseObjectInfo> boxes;
+  std::vector<NvDsInferInstanceMaskInfo> masks;
+  std::vector<double> us;
+  us.reserve(calls.size() * o.passes);
+  results.assign(calls.size(), std::vector<Detection>());
+  unsigned long long allocs = 0;
+
+  for (int pass = 0; pass < o.passes; ++pass) {
+    const bool timed = pass > 0 || o.passes == 1;
+    const bool last = pass + 1 == o.passes;
+    for (const Batch& b : batches) {
+      for (size_t k = 0; k < b.count; ++k) {
+        const RecordedCall& c = calls[b.first + k];
+        const std::string& name = forced.empty() ? c.parser : forced;
+        layers.resize(c.layers.size());
+        for (size_t l = 0; l < c.layers.size(); ++l) {
+          NvDsInferLayerInfo& L = layers[l];
+          std::memset(&L, 0, sizeof(L));
+          L.dataType = c.layers[l].type;
+          L.inferDims = c.layers[l].dims;
+          L.layerName = c.layers[l].name.c_str();
+          char* base = cuda_parser(name) ? static_cast<char*>(b.device[l])
+                                         : reinterpret_cast<char*>(const_cast<uint64_t*>(b.host[l].data()));
+          L.buffer = base ? base + k * c.layers[l].bytes : nullptr;
+        }
+
+        const unsigned long long allocs0 = g_allocs.load();
+        const auto a = std::chrono::steady_clock::now();
+        const bool ok = parse(name, layers, c, boxes, masks);
+        const double t = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - a).count();
+        if (!ok) {
+          std::fprintf(stderr, "ERROR: call %zu: parser %s failed or is unknown\n", b.first + k, name.c_str());
+          return false;
+        }
+        if (timed) {
+          us.push_back(t);
+          allocs += g_allocs.load() - allocs0;
+        }
+        if (!last) continue;
+
+        std::vector<Detection>& r = results[b.first + k];
+        if (pose_parser(name)) pose_detections(r);
+        else object_detections(boxes, r);
+        s.detections += r.size();
+      }
+    }
+  }
+
+  for (Batch& b : batches) {
+    for (void* p : b.device) {
+      if (p) cudaFree(p);
+    }
+  }
+
+  s.frames = calls.size();
+  if (!us.empty()) {
+    std::sort(us.begin(), us.end());
+    s.p50_us = us[us.size() / 2];
+    s.p99_us = us[std::min(us.size() - 1, us.size() * 99 / 100)];
+    s.allocs_per_call = static_cast<double>(allocs) / us.size();
+  }
+  return true;
+}
+
+void write_results(const std::string& path, const std::vector<std::vector<Detection>>& results) {
+  std::ofstream f(path);
+  f << "frame,cls,conf,left,top,width,height,kpts\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    for (const Detection& d : results[i]) {
+      f << i << "," << d.cls << "," << d.conf << "," << d.box[0] << "," << d.box[1] << "," << d.box[2] << ","
+        << d.box[3] << ",";
+      for (size_t k = 0; k < d.kpts.size(); ++k) f << (k ? " " : "") << d.kpts[k];
+      f << "\n";
+    }
+  }
+}
+
+bool load_results(const std::string& path, std::vector<std::vector<Detection>>& results) {
+  std::ifstream f(path);
+  if (!f.good()) {
+    std::fprintf(stderr, "ERROR: could not open the baseline %s\n", path.c_str());
+    return false;
+  }
+  std::string line;
+  while (std::getline(f, line)) {
+    std::stringstream s(line);
+    std::string field;
+    std::vector<std::string> v;
+    while (std::getline(s, field, ',')) v.push_back(field);
+    if (v.size() < 7 || v[0] == "frame") continue;
+    const size_t frame = static_cast<size_t>(std::atol(v[0].c_str()));
+    if (frame >= results.size()) results.resize(frame + 1);
+    Detection d;
+    d.cls = std::atoi(v[1].c_str());
+    d.conf = static_cast<float>(std::atof(v[2].c_str()));
+    for (int k = 0; k < 4; ++k) d.box[k] = static_cast<float>(std::atof(v[3 + k].c_str()));
+    if (v.size() > 7) {
+      std::stringstream kp(v[7]);
+      float x;
+      while (kp >> x) d.kpts.push_back(x);
+    }
+    results[frame].push_back(d);
+  }
+  return true;
+}
+
+float iou(const Detection& a, const Detection& b) {
+  const float x1 = std::max(a.box[0], b.box[0]), y1 = std::max(a.box[1], b.box[1]);
+  const float x2 = std::min(a.box[0] + a.box[2], b.box[0] + b.box[2]);
+  const float y2 = std::min(a.box[1] + a.box[3], b.box[1] + b.box[3]);
+  const float inter = std::max(0.f, x2 - x1) * std::max(0.f, y2 - y1);
+  const float uni = a.box[2] * a.box[3] + b.box[2] * b.box[3] - inter;
+  return uni > 0.f ? inter / uni : 0.f;
+}
+
+// Matches every frame of cur against base and fills the accuracy columns of s. Returns the baseline's
+// detection count.
+size_t diff_results(const std::vector<std::vector<Detection>>& cur, const std::vector<std::vector<Detection>>& base,
+                    Summary& s) {
+  size_t base_total = 0, matched = 0, kpts = 0;
+  double box_sum = 0, kpt_sum = 0;
+  const size_t frames = std::max(cur.size(), base.size());
+  for (size_t i = 0; i < frames; ++i) {
+    static const std::vector<Detection> kNone;
+    const std::vector<Detection>& c = i < cur.size() ? cur[i] : kNone;
+    const std::vector<Detection>& b = i < base.size() ? base[i] : kNone;
+    base_total += b.size();
+
+    std::vector<size_t> order(c.size());
+    for (size_t k = 0; k < order.size(); ++k) order[k] = k;
+    std::sort(order.begin(), order.end(), [&](size_t x, size_t y) { return c[x].conf > c[y].conf; });
+    std::vector<bool> taken(b.size(), false);
+    size_t frame_matched = 0;
+    for (size_t k : order) {
+      int best = -1;
+      float best_iou = 0.5f;
+      for (size_t j = 0; j < b.size(); ++j) {
+        if (taken[j] || b[j].cls != c[k].cls) continue;
+        const float v = iou(c[k], b[j]);
+        if (v >= best_iou) { best_iou = v; best = static_cast<int>(j); }
+      }
+      if (best < 0) continue;
+      taken[best] = true;
+      ++frame_matched;
+      const Detection& m = b[best];
+      for (int e = 0; e < 4; ++e) box_sum += std::fabs(c[k].box[e] - m.box[e]) / 4.0;
+      const size_t n = std::min(c[k].kpts.size(), m.kpts.size()) / 3;
+      for (size_t p = 0; p < n; ++p) {
+        kpt_sum += std::hypot(c[k].kpts[3 * p] - m.kpts[3 * p], c[k].kpts[3 * p + 1] - m.kpts[3 * p + 1]);
+      }
+      kpts += n;
+    }
+    matched += frame_matched;
+    s.unmatched += (c.size() - frame_matched) + (b.size() - frame_matched);
+  }
+  s.box_delta = matched ? box_sum / matched : 0;
+  s.kpt_delta = kpts ? kpt_sum / kpts : 0;
+  return base_total;
+}
+
+// p99 of the newest dashboard row with this key, or a negative value when there is none.
+double previous_p99(const std::string& path, const std::string& key) {
+  std::ifstream f(path);
+  std::string line;
+  double p99 = -1;
+  while (std::getline(f, line)) {
+    std::stringstream s(line);
+    std::vector<std::string> v;
+    std::string field;
+    while (std::getline(s, field, ',')) v.push_back(field);
+    if (v.size() > 5 && v[1] == key) p99 = std::atof(v[4].c_str());
+  }
+  return p99;
+}
+
+void append_dashboard(const std::string& path, const std::string& label, const Summary& s) {
+  const bool fresh = !std::ifstream(path).good();
+  std::ofstream f(path, std::ios::app);
+  if (fresh) {
+    f << "label,key,frames,p50_us,p99_us,allocs_per_call,detections,unmatched,box_delta_px,kpt_delta_px\n";
+  }
+  f << label << "," << s.key << "," << s.frames << "," << s.p50_us << "," << s.p99_us << "," << s.allocs_per_call
+    << "," << s.detections << "," << s.unmatched << "," << s.box_delta << "," << s.kpt_delta << "\n";
+}
+
+void usage() {
+  std::fprintf(stderr, "usage: replay_bench --input file.sqvrec [--parser name] [--passes N] [--results file] "
+                       "[--baseline file [--max-unmatched r] [--max-box-delta px] [--max-kpt-delta px]] "
+                       "[--csv file [--label name] [--tolerance r]]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!v) { usage(); return 2; }
+    if (a == "--input") o.input = v;
+    else if (a == "--parser") o.parser = v;
+    else if (a == "--passes") o.passes = std::max(1, std::atoi(v));
+    else if (a == "--results") o.results = v;
+    else if (a == "--baseline") o.baseline = v;
+    else if (a == "--max-unmatched") o.max_unmatched = std::atof(v);
+    else if (a == "--max-box-delta") o.max_box_delta = std::atof(v);
+    else if (a == "--max-kpt-delta") o.max_kpt_delta = std::atof(v);
+    else if (a == "--csv") o.csv = v;
+    else if (a == "--label") o.label = v;
+    else if (a == "--tolerance") o.tolerance = std::atof(v);
+    else { usage(); return 2; }
+    ++i;
+  }
+  if (o.input.empty()) { usage(); return 2; }
+  // Replaying must not append to a recording.
+  unsetenv("SQUEAKVIEW_RECORD");
+
+  std::vector<char> data;
+  std::vector<RecordedCall> calls;
+  if (!read_recording(o.input, data, calls)) return 1;
+  if (calls.empty()) {
+    std::fprintf(stderr, "ERROR: %s holds no calls\n", o.input.c_str());
+    return 1;
+  }
+
+  Summary s;
+  s.key = o.input + "/" + (o.parser.empty() ? calls[0].parser : o.parser);
+  std::vector<std::vector<Detection>> results;
+  if (!replay(o, data, calls, s, results)) return 1;
+  if (!o.results.empty()) write_results(o.results, results);
+
+  int failures = 0;
+  size_t base_total = 0;
+  if (!o.baseline.empty()) {
+    std::vector<std::vector<Detection>> base;
+    if (!load_results(o.baseline, base)) return 1;
+    base_total = diff_results(results, base, s);
+  }
+
+  std::printf("%-48s %8s %10s %10s %8s %10s %9s %9s %9s\n", "recording/parser", "frames", "p50_us", "p99_us",
+              "allocs", "objects", "unmatched", "box_px", "kpt_px");
+  std::printf("%-48s %8zu %10.1f %10.1f %8.2f %10zu %9zu %9.3f %9.3f\n", s.key.c_str(), s.frames, s.p50_us,
+              s.p99_us, s.allocs_per_call, s.detections, s.unmatched, s.box_delta, s.kpt_delta);
+
+  if (!o.baseline.empty()) {
+    const double allowed = o.max_unmatched * std::max<size_t>(base_total, 1);
+    if (static_cast<double>(s.unmatched) > allowed) {
+      std::printf("REGRESSION: %zu unmatched detections, %zu in the baseline\n", s.unmatched, base_total);
+      ++failures;
+    }
+    if (s.box_delta > o.max_box_delta) {
+      std::printf("REGRESSION: mean box delta %.3f px, limit %.3f px\n", s.box_delta, o.max_box_delta);
+      ++failures;
+    }
+    if (s.kpt_delta > o.max_kpt_delta) {
+      std::printf("REGRESSION: mean keypoint delta %.3f px, limit %.3f px\n", s.kpt_delta, o.max_kpt_delta);
+      ++failures;
+    }
+  }
+  if (!o.csv.empty()) {
+    const double prev = o.tolerance > 0 ? previous_p99(o.csv, s.key) : -1;
+    if (prev > 0 && s.p99_us > prev * o.tolerance) {
+      std::printf("REGRESSION: p99 %.1f us, previous run %.1f us\n", s.p99_us, prev);
+      ++failures;
+    }
+    append_dashboard(o.csv, o.label, s);
+  }
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,284 @@
+// build_report.cpp  (IProfiler + IEngineInspector report behind writeBuildReport)
+
+#include "build_report.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "mem_budget.h"
+#include "utils.h"
+
+int
+buildReportIterations()
+{
+  static const int iterations = [] {
+    const char* env = getenv("YOLO_BUILD_REPORT");
+    const int n = env ? std::atoi(env) : 0;
+    return n > 0 ? n : 0;
+  }();
+  return iterations;
+}
+
+std::string
+buildReportPath(const std::string& engineFilePath)
+{
+  if (engineFilePath == "") {
+    return "build_report.json";
+  }
+  const size_t ext = engineFilePath.rfind(".engine");
+  return engineFilePath.substr(0, ext) + "_report.json";
+}
+
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 5)
+
+namespace {
+
+// Sums reportLayerTime() per layer, keeping the order in which TensorRT first reports each layer.
+class LayerProfiler : public nvinfer1::IProfiler {
+  public:
+    void reportLayerTime(const char* layerName, float ms) noexcept override {
+      std::map<std::string, size_t>::iterator it = m_Index.find(layerName);
+      if (it == m_Index.end()) {
+        it = m_Index.emplace(layerName, m_Names.size()).first;
+        m_Names.push_back(layerName);
+        m_TotalMs.push_back(0.0);
+      }
+      m_TotalMs[it->second] += ms;
+    }
+
+    const std::vector<std::string>& names() const { return m_Names; }
+    const std::vector<double>& totalMs() const { return m_TotalMs; }
+
+  private:
+    std::map<std::string, size_t> m_Index;
+    std::vector<std::string> m_Names;
+    std::vector<double> m_TotalMs;
+};
+
+struct LayerInfo {
+  std::string type;
+  std::string precision;
+  std::string tactic;
+};
+
+size_t
+dataTypeSize(const nvinfer1::DataType& type)
+{
+  switch (type) {
+    case nvinfer1::DataType::kHALF:
+      return 2;
+    case nvinfer1::DataType::kINT8:
+    case nvinfer1::DataType::kBOOL:
+    case nvinfer1::DataType::kUINT8:
+      return 1;
+#if NV_TENSORRT_MAJOR >= 10
+    case nvinfer1::DataType::kINT64:
+      return 8;
+    case nvinfer1::DataType::kBF16:
+      return 2;
+#endif
+    default:
+      return 4;
+  }
+}
+
+// Value of the first "key": "string" pair at or after `from`; empty when absent or not a string.
+std::string
+jsonStringField(const std::string& json, const std::string& key, const size_t& from = 0)
+{
+  size_t pos = json.find("\"" + key + "\"", from);
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos = json.find(':', pos + key.size() + 2);
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos = json.find_first_not_of(" \t\n", pos + 1);
+  if (pos == std::string::npos || json[pos] != '"') {
+    return "";
+  }
+  std::string value;
+  for (++pos; pos < json.size() && json[pos] != '"'; ++pos) {
+    if (json[pos] == '\\' && pos + 1 < json.size()) {
+      ++pos;
+    }
+    value += json[pos];
+  }
+  return value;
+}
+
+std::string
+jsonEscape(const std::string& value)
+{
+  std::string out;
+  for (const char& c : value) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    }
+    else if ((unsigned char) c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    }
+    else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+std::map<std::string, LayerInfo>
+inspectLayers(nvinfer1::ICudaEngine* engine, nvinfer1::IExecutionContext* context)
+{
+  std::map<std::string, LayerInfo> layers;
+  nvinfer1::IEngineInspector* inspector = engine->createEngineInspector();
+  if (inspector == nullptr) {
+    return layers;
+  }
+  inspector->setExecutionContext(context);
+  for (int i = 0; i < engine->getNbLayers(); ++i) {
+    const char* raw = inspector->getLayerInformation(i, nvinfer1::LayerInformationFormat::kJSON);
+    if (raw == nullptr) {
+      continue;
+    }
+    const std::string info = raw;
+    std::string name = jsonStringField(info, "Name");
+    if (name == "") {
+      // Without kDETAILED verbosity the layer information is only its quoted name
+      name = info.size() >= 2 && info.front() == '"' ? info.substr(1, info.rfind('"') - 1) : info;
+    }
+    LayerInfo layer;
+    layer.type = jsonStringField(info, "LayerType");
+    const size_t outputs = info.find("\"Outputs\"");
+    if (outputs != std::string::npos) {
+      layer.precision = jsonStringField(info, "Format/Datatype", outputs);
+    }
+    layer.tactic = jsonStringField(info, "TacticName");
+    if (layer.tactic == "") {
+      layer.tactic = jsonStringField(info, "TacticValue");
+    }
+    layers[name] = layer;
+  }
+  delete inspector;
+  return layers;
+}
+
+} // namespace
+
+bool
+writeBuildReport(nvinfer1::ICudaEngine* engine, const std::string& reportPath, const int& iterations,
+    const std::string& networkMode)
+{
+  nvinfer1::IExecutionContext* context = engine->createExecutionContext();
+  if (context == nullptr) {
+    std::cerr << "WARNING: Could not create an execution context for the build report\n" << std::endl;
+    return false;
+  }
+
+  // Zero-filled buffers for every I/O tensor, inputs at the OPT shape of profile 0
+  std::vector<void*> buffers;
+  bool ready = true;
+  for (int i = 0; i < engine->getNbIOTensors() && ready; ++i) {
+    const char* name = engine->getIOTensorName(i);
+    if (engine->getTensorIOMode(name) == nvinfer1::TensorIOMode::kINPUT) {
+      nvinfer1::Dims dims = engine->getTensorShape(name);
+      for (int d = 0; d < dims.nbDims; ++d) {
+        if (dims.d[d] < 0) {
+          dims = engine->getProfileShape(name, 0, nvinfer1::OptProfileSelector::kOPT);
+          break;
+        }
+      }
+      ready = context->setInputShape(name, dims);
+    }
+  }
+  for (int i = 0; i < engine->getNbIOTensors() && ready; ++i) {
+    const char* name = engine->getIOTensorName(i);
+    const nvinfer1::Dims dims = context->getTensorShape(name);
+    size_t bytes = dataTypeSize(engine->getTensorDataType(name));
+    for (int d = 0; d < dims.nbDims; ++d) {
+      bytes *= dims.d[d] > 0 ? dims.d[d] : 1;
+    }
+    void* buffer = nullptr;
+    ready = mem_device_alloc(&buffer, bytes, kMemBuild) == cudaSuccess && cudaMemset(buffer, 0, bytes) == cudaSuccess;
+    if (buffer != nullptr) {
+      buffers.push_back(buffer);
+    }
+    ready = ready && context->setTensorAddress(name, buffer);
+  }
+
+  cudaStream_t stream = nullptr;
+  ready = ready && cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) == cudaSuccess;
+
+  // One untimed run pays for the lazy initialization, then the profiler sees only warm iterations
+  ready = ready && context->enqueueV3(stream) && cudaStreamSynchronize(stream) == cudaSuccess;
+  LayerProfiler profiler;
+  context->setProfiler(&profiler);
+  for (int i = 0; i < iterations && ready; ++i) {
+    ready = context->enqueueV3(stream) && cudaStreamSynchronize(stream) == cudaSuccess;
+  }
+
+  bool written = false;
+  if (ready) {
+    const std::map<std::string, LayerInfo> layers = inspectLayers(engine, context);
+    const std::vector<std::string>& names = profiler.names();
+    const std::vector<double>& totalMs = profiler.totalMs();
+
+    double engineMs = 0.0;
+    for (const double& ms : totalMs) {
+      engineMs += ms / iterations;
+    }
+
+    std::ostringstream report;
+    report << "{\n  \"precision\": \"" << networkMode << "\",\n  \"iterations\": " << iterations <<
+        ",\n  \"total_ms\": " << engineMs << ",\n  \"layers\": [";
+    for (size_t i = 0; i < names.size(); ++i) {
+      const double ms = totalMs[i] / iterations;
+      std::map<std::string, LayerInfo>::const_iterator it = layers.find(names[i]);
+      const LayerInfo info = it != layers.end() ? it->second : LayerInfo();
+      report << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << jsonEscape(names[i]) << "\", \"time_ms\": " << ms <<
+          ", \"percent\": " << (engineMs > 0.0 ? 100.0 * ms / engineMs : 0.0) << ", \"type\": \"" <<
+          jsonEscape(info.type) << "\", \"precision\": \"" << jsonEscape(info.precision) << "\", \"tactic\": \"" <<
+          jsonEscape(info.tactic) << "\", \"plugin\": " << (info.type.compare(0, 6, "Plugin") == 0 ? "true" :
+          "false") << "}";
+    }
+    report << "\n  ]\n}\n";
+
+    const std::string text = report.str();
+    written = writeBinaryFile(reportPath, text.data(), text.size());
+    if (written) {
+      std::cout << "Build report (" << names.size() << " layers, " << engineMs << " ms) saved to " << reportPath <<
+          "\n" << std::endl;
+    }
+  }
+  if (!written) {
+    std::cerr << "WARNING: Could not write the build report to " << reportPath << "\n" << std::endl;
+  }
+
+  if (stream != nullptr) {
+    cudaStreamDestroy(stream);
+  }
+  for (void* buffer : buffers) {
+    mem_device_free(buffer);
+  }
+  delete context;
+  return written;
+}
+
+#else
+
+bool
+writeBuildReport(nvinfer1::ICudaEngine*, const std::string&, const int&, const std::string&)
+{
+  std::cerr << "WARNING: The build report needs TensorRT >= 8.5\n" << std::endl;
+  return false;
+}
+
+#endif
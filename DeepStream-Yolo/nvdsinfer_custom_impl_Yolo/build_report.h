@@ -0,0 +1,23 @@
+// build_report.h  (per-layer build and latency report for a freshly built engine)
+// Runs the engine on a throwaway execution context with an IProfiler attached and writes one JSON document:
+// the mean time of every layer over the timed iterations, next to what IEngineInspector knows about it
+// (layer type, output precision, tactic). Needs TensorRT >= 8.5 and an engine built with kDETAILED profiling
+// verbosity for the inspector fields; the timings work at any verbosity.
+
+#ifndef __BUILD_REPORT_H__
+#define __BUILD_REPORT_H__
+
+#include <string>
+
+#include "NvInfer.h"
+
+// YOLO_BUILD_REPORT=<iterations>: 0 (unset) disables the report.
+int buildReportIterations();
+
+// <engine path without .engine>_report.json, or build_report.json when the engine path is unknown.
+std::string buildReportPath(const std::string& engineFilePath);
+
+bool writeBuildReport(nvinfer1::ICudaEngine* engine, const std::string& reportPath, const int& iterations,
+    const std::string& networkMode);
+
+#endif
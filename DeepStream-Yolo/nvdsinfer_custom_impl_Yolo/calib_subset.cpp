@@ -0,0 +1,134 @@
+// calib_subset.cpp  (difference hashes, near-duplicate pruning and farthest-point sampling behind calib_subset.h)
+
+#include "calib_subset.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "opencv2/opencv.hpp"
+
+#include "parser_pool.h"
+#include "parser_trace.h"
+
+namespace {
+
+inline int
+hashDistance(const uint64_t& a, const uint64_t& b)
+{
+  return __builtin_popcountll(a ^ b);
+}
+
+} // namespace
+
+bool
+calibImageHash(const std::string& path, uint64_t& hash)
+{
+  // The reduced decode lets the JPEG decoder skip most of its work
+  cv::Mat img = cv::imread(path, cv::IMREAD_REDUCED_GRAYSCALE_8);
+  if (img.empty()) {
+    return false;
+  }
+  cv::Mat thumb;
+  cv::resize(img, thumb, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+  hash = 0;
+  for (int y = 0; y < 8; ++y) {
+    const uint8_t* row = thumb.ptr<uint8_t>(y);
+    for (int x = 0; x < 8; ++x) {
+      hash = hash << 1 | (row[x] < row[x + 1] ? 1 : 0);
+    }
+  }
+  return true;
+}
+
+std::vector<std::string>
+calibSubset(const std::vector<std::string>& paths)
+{
+  const char* dedupEnv = getenv("INT8_CALIB_DEDUP");
+  const int dedup = dedupEnv && *dedupEnv ? std::atoi(dedupEnv) : -1;
+  const char* maxEnv = getenv("INT8_CALIB_MAX_IMAGES");
+  const size_t maxImages = maxEnv && std::atol(maxEnv) > 0 ? static_cast<size_t>(std::atol(maxEnv)) : 0;
+  if (dedup < 0 && (maxImages == 0 || paths.size() <= maxImages)) {
+    return paths;
+  }
+
+  TraceScope trace("calib_subset");
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<uint64_t> hashes(paths.size(), 0);
+  std::vector<char> readable(paths.size(), 0);
+  parallel_for(static_cast<int>(paths.size()), [&](int i) {
+    readable[i] = calibImageHash(paths[i], hashes[i]);
+  });
+
+  // Greedy in list order: an image is kept unless it is within `dedup` bits of one kept before it. The kept
+  // hashes are scanned newest first, since a duplicate is most often a neighbouring frame.
+  std::vector<size_t> kept;
+  std::vector<uint64_t> keptHashes;
+  size_t unreadable = 0;
+  size_t duplicates = 0;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    if (!readable[i]) {
+      ++unreadable;
+      continue;
+    }
+    bool duplicate = false;
+    for (size_t k = keptHashes.size(); k-- > 0 && dedup >= 0;) {
+      if (hashDistance(hashes[i], keptHashes[k]) <= dedup) {
+        duplicate = true;
+        break;
+      }
+    }
+    if (duplicate) {
+      ++duplicates;
+      continue;
+    }
+    kept.push_back(i);
+    keptHashes.push_back(hashes[i]);
+  }
+
+  // Farthest-point sampling: start from the first image, then repeatedly add the one farthest from everything
+  // picked so far (the earliest on ties), so every scene gets a share before any of them gets a second frame
+  if (maxImages > 0 && kept.size() > maxImages) {
+    std::vector<int> nearest(kept.size(), 65);
+    std::vector<char> picked(kept.size(), 0);
+    size_t next = 0;
+    for (size_t n = 0; n < maxImages; ++n) {
+      picked[next] = 1;
+      size_t farthest = 0;
+      int farthestDistance = -1;
+      for (size_t k = 0; k < kept.size(); ++k) {
+        if (picked[k]) {
+          continue;
+        }
+        const int d = hashDistance(keptHashes[k], keptHashes[next]);
+        if (d < nearest[k]) {
+          nearest[k] = d;
+        }
+        if (nearest[k] > farthestDistance) {
+          farthestDistance = nearest[k];
+          farthest = k;
+        }
+      }
+      next = farthest;
+    }
+    std::vector<size_t> sampled;
+    for (size_t k = 0; k < kept.size(); ++k) {
+      if (picked[k]) {
+        sampled.push_back(kept[k]);
+      }
+    }
+    kept.swap(sampled);
+  }
+
+  std::vector<std::string> subset;
+  subset.reserve(kept.size());
+  for (const size_t& i : kept) {
+    subset.push_back(paths[i]);
+  }
+
+  const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Calibration subset: " << subset.size() << " of " << paths.size() << " images (" << duplicates <<
+      " near-duplicates, " << unreadable << " unreadable) in " << s << " s" << std::endl;
+  return subset;
+}
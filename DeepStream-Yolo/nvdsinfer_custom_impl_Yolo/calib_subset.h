@@ -0,0 +1,26 @@
+// calib_subset.h  (prunes an INT8 calibration image list down to a diverse subset before calibration)
+// Calibration lists dumped from long sessions are mostly near-identical frames of a static scene, and every one of
+// them costs a decode, a preprocess and a calibration pass. Before the batches are generated, each image gets a
+// 64-bit difference hash (decoded at 1/8 scale in grayscale, 9x8 thumbnail, one bit per horizontal gradient),
+// computed in parallel on the parser pool.
+//
+// INT8_CALIB_DEDUP=<bits> drops every image whose hash is within <bits> (Hamming distance) of an image kept
+// earlier in the list; 0 drops exact duplicates only, 4-8 also drops frames that differ by noise or compression.
+// INT8_CALIB_MAX_IMAGES=<n> then keeps at most n images, picked by farthest-point sampling on the hashes so the
+// subset spreads over the scenes rather than over time. The subset keeps list order and is deterministic, so
+// INT8_CALIB_TENSOR_CACHE still matches on the next run. Unreadable images are left out of the subset.
+
+#ifndef __CALIB_SUBSET_H__
+#define __CALIB_SUBSET_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Difference hash of the image at `path`; false when it cannot be read.
+bool calibImageHash(const std::string& path, uint64_t& hash);
+
+// The subset of `paths` INT8_CALIB_DEDUP and INT8_CALIB_MAX_IMAGES select; `paths` itself when neither is set.
+std::vector<std::string> calibSubset(const std::vector<std::string>& paths);
+
+#endif
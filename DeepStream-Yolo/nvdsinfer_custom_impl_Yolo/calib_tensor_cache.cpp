@@ -0,0 +1,199 @@
+// calib_tensor_cache.cpp  (CalibTensorCache: mmap reader and streaming writer)
+
+#include "calib_tensor_cache.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "half_float.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'Q', 'V', 'C', 'A', 'L', 'I', 'B'};
+constexpr uint32_t kVersion = 1;
+
+struct CacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  CalibTensorKey key;
+  uint64_t images;
+};
+
+} // namespace
+
+uint64_t
+calibListHash(const std::vector<std::string>& paths)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (const std::string& path : paths) {
+    for (const char& c : path) {
+      hash = (hash ^ (uint8_t) c) * 1099511628211ull;
+    }
+    hash = (hash ^ '\n') * 1099511628211ull;
+  }
+  return hash;
+}
+
+CalibTensorCache::~CalibTensorCache()
+{
+  close();
+}
+
+void
+CalibTensorCache::close()
+{
+  if (m_Map != nullptr) {
+    munmap(m_Map, m_MapSize);
+    m_Map = nullptr;
+  }
+  m_Data = nullptr;
+  m_Images = 0;
+  if (m_File != nullptr) {
+    fclose(m_File);
+    m_File = nullptr;
+    std::remove(m_TmpPath.c_str());
+  }
+}
+
+size_t
+CalibTensorCache::open(const std::string& path, const CalibTensorKey& key)
+{
+  close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(CacheHeader)) {
+    ::close(fd);
+    return 0;
+  }
+  void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return 0;
+  }
+
+  CacheHeader header;
+  std::memcpy(&header, map, sizeof(header));
+  const size_t elementSize = key.halfPrecision ? sizeof(uint16_t) : sizeof(float);
+  const size_t imageElements = (size_t) key.inputC * key.inputH * key.inputW;
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+      std::memcmp(&header.key, &key, sizeof(key)) != 0 ||
+      (size_t) st.st_size != sizeof(CacheHeader) + header.images * imageElements * elementSize) {
+    std::cout << "Calibration tensor cache " << path << " does not match this calibration, rebuilding it" <<
+        std::endl;
+    munmap(map, st.st_size);
+    return 0;
+  }
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+  m_Key = key;
+  m_ElementSize = elementSize;
+  m_ImageElements = imageElements;
+  m_Map = map;
+  m_MapSize = st.st_size;
+  m_Data = static_cast<const char*>(map) + sizeof(CacheHeader);
+  m_Images = header.images;
+  return m_Images;
+}
+
+bool
+CalibTensorCache::read(const size_t& first, const size_t& count, float* dst) const
+{
+  if (m_Data == nullptr || first + count > m_Images) {
+    return false;
+  }
+  const size_t elements = count * m_ImageElements;
+  const char* src = m_Data + first * m_ImageElements * m_ElementSize;
+  if (!m_Key.halfPrecision) {
+    std::memcpy(dst, src, elements * sizeof(float));
+    return true;
+  }
+  const uint16_t* half = reinterpret_cast<const uint16_t*>(src);
+  for (size_t i = 0; i < elements; ++i) {
+    dst[i] = half_to_float(half[i]);
+  }
+  return true;
+}
+
+bool
+CalibTensorCache::beginWrite(const std::string& path, const CalibTensorKey& key)
+{
+  close();
+  m_Key = key;
+  m_ElementSize = key.halfPrecision ? sizeof(uint16_t) : sizeof(float);
+  m_ImageElements = (size_t) key.inputC * key.inputH * key.inputW;
+  m_Path = path;
+  m_TmpPath = path + ".tmp";
+  m_File = fopen(m_TmpPath.c_str(), "wb");
+  if (m_File == nullptr) {
+    std::cerr << "WARNING: Could not create the calibration tensor cache " << m_TmpPath << std::endl;
+    return false;
+  }
+
+  // The image count is patched in by finishWrite
+  CacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.key = key;
+  if (fwrite(&header, sizeof(header), 1, m_File) != 1) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool
+CalibTensorCache::append(const float* src, const size_t& count)
+{
+  if (m_File == nullptr) {
+    return false;
+  }
+  const size_t elements = count * m_ImageElements;
+  bool ok;
+  if (!m_Key.halfPrecision) {
+    ok = fwrite(src, sizeof(float), elements, m_File) == elements;
+  }
+  else {
+    m_HalfBuffer.resize(elements);
+    for (size_t i = 0; i < elements; ++i) {
+      m_HalfBuffer[i] = float_to_half(src[i]);
+    }
+    ok = fwrite(m_HalfBuffer.data(), sizeof(uint16_t), elements, m_File) == elements;
+  }
+  if (!ok) {
+    std::cerr << "WARNING: Writing the calibration tensor cache failed, dropping it" << std::endl;
+    close();
+    return false;
+  }
+  m_Images += count;
+  return true;
+}
+
+bool
+CalibTensorCache::finishWrite()
+{
+  if (m_File == nullptr) {
+    return false;
+  }
+  const uint64_t images = m_Images;
+  const bool ok = fseek(m_File, offsetof(CacheHeader, images), SEEK_SET) == 0 &&
+      fwrite(&images, sizeof(images), 1, m_File) == 1 && fclose(m_File) == 0;
+  m_File = nullptr;
+  if (!ok || std::rename(m_TmpPath.c_str(), m_Path.c_str()) != 0) {
+    std::remove(m_TmpPath.c_str());
+    std::cerr << "WARNING: Could not save the calibration tensor cache " << m_Path << std::endl;
+    return false;
+  }
+  std::cout << "Calibration tensor cache (" << images << " images) saved to " << m_Path << std::endl;
+  m_Images = 0;
+  return true;
+}
@@ -0,0 +1,71 @@
+// calib_tensor_cache.h  (preprocessed INT8 calibration inputs kept on disk between calibration runs)
+// File: a fixed header (magic, version, the preprocessing key, image count) followed by the CHW tensor of
+// every calibration image in list order, as float or fp16. Images are stored one by one, so a later run may use
+// a different INT8_CALIB_BATCH_SIZE. The file is written under a temporary name and renamed once complete; a
+// later run maps it read-only and copies batches straight out of the page cache.
+
+#ifndef __CALIB_TENSOR_CACHE_H__
+#define __CALIB_TENSOR_CACHE_H__
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Everything that changes the preprocessed values. Two runs with equal keys produce equal tensors.
+struct CalibTensorKey {
+  int32_t inputC;
+  int32_t inputH;
+  int32_t inputW;
+  int32_t inputFormat;
+  float scaleFactor;
+  float offsets[3];
+  int32_t maintainAspectRatio;
+  int32_t symmetricPadding;
+  int32_t gpuPreprocess;
+  int32_t halfPrecision;
+  uint64_t listHash;         // FNV-1a over the image paths, in order
+};
+
+uint64_t calibListHash(const std::vector<std::string>& paths);
+
+class CalibTensorCache {
+  public:
+    CalibTensorCache() = default;
+    ~CalibTensorCache();
+    CalibTensorCache(const CalibTensorCache&) = delete;
+    CalibTensorCache& operator=(const CalibTensorCache&) = delete;
+
+    // Maps `path` when it was written for `key`; returns the number of images it holds, 0 if absent or stale.
+    size_t open(const std::string& path, const CalibTensorKey& key);
+
+    // Images [first, first + count) as float, into dst (count * image elements).
+    bool read(const size_t& first, const size_t& count, float* dst) const;
+
+    bool beginWrite(const std::string& path, const CalibTensorKey& key);
+
+    bool append(const float* src, const size_t& count);
+
+    // Completes the file under its final name. Without it the temporary file is removed on destruction.
+    bool finishWrite();
+
+    bool writing() const { return m_File != nullptr; }
+
+  private:
+    void close();
+
+    CalibTensorKey m_Key;
+    size_t m_ImageElements {0};
+    size_t m_ElementSize {0};
+    void* m_Map {nullptr};
+    size_t m_MapSize {0};
+    size_t m_Images {0};
+    const char* m_Data {nullptr};
+    FILE* m_File {nullptr};
+    std::string m_Path;
+    std::string m_TmpPath;
+    std::vector<uint16_t> m_HalfBuffer;
+};
+
+#endif
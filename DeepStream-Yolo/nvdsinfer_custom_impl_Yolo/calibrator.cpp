@@ -8,11 +8,17 @@
 #include <fstream>
 #include <iterator>
 
+#include "calib_subset.h"
+#include "mem_budget.h"
+#include "parser_pool.h"
+#include "parser_trace.h"
+
 Int8EntropyCalibrator2::Int8EntropyCalibrator2(const int& batchSize, const int& channels, const int& height,
     const int& width, const float& scaleFactor, const float* offsets, const int& inputFormat,
-    const std::string& imgPath, const std::string& calibTablePath) : batchSize(batchSize), inputC(channels),
+    const std::string& imgPath, const std::string& calibTablePath, const int& maintainAspectRatio,
+    const int& symmetricPadding) : batchSize(batchSize), inputC(channels),
     inputH(height), inputW(width), scaleFactor(scaleFactor), offsets(offsets), inputFormat(inputFormat),
-    calibTablePath(calibTablePath), imageIndex(0)
+    calibTablePath(calibTablePath)
 {
   inputCount = batchSize * channels * height * width;
   std::fstream f(imgPath);
@@ -22,17 +28,75 @@ Int8EntropyCalibrator2::Int8EntropyCalibrator2(const int& batchSize, const int&
         imgPaths.push_back(temp);
       }
   }
-  batchData = new float[inputCount];
+  imgPaths = calibSubset(imgPaths);
+  numBatches = imgPaths.size() / batchSize;
+
+  gpuPreprocess = getenv("INT8_CALIB_GPU_PREPROCESS") && std::string(getenv("INT8_CALIB_GPU_PREPROCESS")) == "1";
+  preprocessParams.inputC = inputC;
+  preprocessParams.inputH = inputH;
+  preprocessParams.inputW = inputW;
+  preprocessParams.scaleFactor = scaleFactor;
+  for (int c = 0; c < 3; ++c) {
+    preprocessParams.offsets[c] = offsets[c];
+  }
+  preprocessParams.inputFormat = inputFormat;
+  preprocessParams.maintainAspectRatio = maintainAspectRatio;
+  preprocessParams.symmetricPadding = symmetricPadding;
+  if (gpuPreprocess) {
+    std::cout << "Calibration preprocessing: GPU (maintain-aspect-ratio=" << maintainAspectRatio <<
+        ", symmetric-padding=" << symmetricPadding << ")" << std::endl;
+  }
+
+  if (getenv("INT8_CALIB_TENSOR_CACHE")) {
+    const std::string cachePath = getenv("INT8_CALIB_TENSOR_CACHE");
+    CalibTensorKey key;
+    memset(&key, 0, sizeof(key));
+    key.inputC = inputC;
+    key.inputH = inputH;
+    key.inputW = inputW;
+    key.inputFormat = inputFormat;
+    key.scaleFactor = scaleFactor;
+    for (int c = 0; c < 3; ++c) {
+      key.offsets[c] = offsets[c];
+    }
+    key.maintainAspectRatio = gpuPreprocess ? maintainAspectRatio : 0;
+    key.symmetricPadding = gpuPreprocess ? symmetricPadding : 0;
+    key.gpuPreprocess = gpuPreprocess;
+    key.halfPrecision = getenv("INT8_CALIB_TENSOR_CACHE_FP16") &&
+        std::string(getenv("INT8_CALIB_TENSOR_CACHE_FP16")) == "1";
+    key.listHash = calibListHash(imgPaths);
+
+    if (tensorCache.open(cachePath, key) >= numBatches * batchSize) {
+      readTensorCache = true;
+      std::cout << "Calibration inputs read from " << cachePath << std::endl;
+    }
+    else {
+      tensorCache.beginWrite(cachePath, key);
+    }
+  }
   std::cout << "Calibration images: " << imgPaths.size() << std::endl;
   std::cout << "Calibration batch size: " << batchSize << std::endl;
-  CUDA_CHECK(cudaMalloc(&deviceInput, inputCount * sizeof(float)));
+  for (int i = 0; i < 2 && (!gpuPreprocess || readTensorCache); ++i) {
+    CUDA_CHECK(mem_pinned_alloc((void**) &hostSlots[i], inputCount * sizeof(float), kMemCalibrator));
+  }
+  CUDA_CHECK(mem_device_alloc(&deviceInput, inputCount * sizeof(float), kMemCalibrator));
+  CUDA_CHECK(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
 }
 
 Int8EntropyCalibrator2::~Int8EntropyCalibrator2()
 {
-  CUDA_CHECK(cudaFree(deviceInput));
-  if (batchData) {
-    delete[] batchData;
+  {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    stopLoader = true;
+  }
+  slotCond.notify_all();
+  if (loader.joinable()) {
+    loader.join();
+  }
+  CUDA_CHECK(cudaStreamDestroy(stream));
+  mem_device_free(deviceInput);
+  for (int i = 0; i < 2; ++i) {
+    mem_pinned_free(hostSlots[i]);
   }
 }
 
@@ -42,34 +106,150 @@ Int8EntropyCalibrator2::getBatchSize() const noexcept
   return batchSize;
 }
 
+bool
+Int8EntropyCalibrator2::loadBatch(const size_t& first, const int& slot)
+{
+  if (readTensorCache) {
+    return tensorCache.read(first, batchSize, hostSlots[slot]);
+  }
+
+  const size_t imageCount = inputCount / batchSize;
+  std::vector<cv::Mat>& images = slotImages[slot];
+  images.resize(batchSize);
+  std::vector<char> ok(batchSize, 0);
+  parallel_for(batchSize, [&](int i) {
+    cv::Mat img = cv::imread(imgPaths[first + i]);
+    if (img.empty()) {
+      return;
+    }
+    if (gpuPreprocess) {
+      images[i] = img.isContinuous() ? img : img.clone();
+    }
+    else {
+      std::vector<float> inputData = prepareImage(img, inputC, inputH, inputW, scaleFactor, offsets, inputFormat);
+      memcpy(hostSlots[slot] + i * imageCount, inputData.data(), imageCount * sizeof(float));
+    }
+    ok[i] = 1;
+  });
+
+  for (int i = 0; i < batchSize; ++i) {
+    if (!ok[i]) {
+      std::cerr << "Failed to read image for calibration: " << imgPaths[first + i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+Int8EntropyCalibrator2::uploadBatch(const int& slot)
+{
+  if (!gpuPreprocess || readTensorCache) {
+    CUDA_CHECK(cudaMemcpyAsync(deviceInput, hostSlots[slot], inputCount * sizeof(float), cudaMemcpyHostToDevice,
+        stream));
+    CUDA_CHECK(cudaStreamSynchronize(stream));
+    if (tensorCache.writing()) {
+      tensorCache.append(hostSlots[slot], batchSize);
+    }
+    return true;
+  }
+
+  const size_t imageCount = inputCount / batchSize;
+  const std::vector<cv::Mat>& images = slotImages[slot];
+  for (int i = 0; i < batchSize; ++i) {
+    const cv::Mat& img = images[i];
+    const size_t bytes = img.total() * img.elemSize();
+    // The staging buffer is reused image after image; stream order keeps each copy behind the previous kernel
+    if (!deviceImage.reserve(bytes)) {
+      std::cerr << "Failed to allocate the calibration image buffer" << std::endl;
+      return false;
+    }
+    CUDA_CHECK(cudaMemcpyAsync(deviceImage.get(), img.data, bytes, cudaMemcpyHostToDevice, stream));
+    CUDA_CHECK(calibPreprocess(deviceImage.get(), img.cols, img.rows, img.step, preprocessParams,
+        static_cast<float*>(deviceInput) + i * imageCount, stream));
+  }
+  if (tensorCache.writing()) {
+    cacheStaging.resize(inputCount);
+    CUDA_CHECK(cudaMemcpyAsync(cacheStaging.data(), deviceInput, inputCount * sizeof(float), cudaMemcpyDeviceToHost,
+        stream));
+  }
+  CUDA_CHECK(cudaStreamSynchronize(stream));
+  if (tensorCache.writing()) {
+    tensorCache.append(cacheStaging.data(), batchSize);
+  }
+  return true;
+}
+
+void
+Int8EntropyCalibrator2::loaderLoop()
+{
+  for (size_t batch = 0; batch < numBatches; ++batch) {
+    const int slot = batch % 2;
+    {
+      std::unique_lock<std::mutex> lock(slotMutex);
+      slotCond.wait(lock, [&] { return stopLoader || slotState[slot] == kSlotFree; });
+      if (stopLoader) {
+        return;
+      }
+    }
+
+    bool loaded = false;
+    {
+      TraceScope loadTrace("calib_load_batch");
+      loaded = loadBatch(batch * batchSize, slot);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(slotMutex);
+      slotState[slot] = loaded ? kSlotReady : kSlotFailed;
+    }
+    slotCond.notify_all();
+    if (!loaded) {
+      return;
+    }
+  }
+}
+
 bool
 Int8EntropyCalibrator2::getBatch(void** bindings, const char** names, int nbBindings) noexcept
 {
-  if (imageIndex + batchSize > uint(imgPaths.size())) {
+  if (batchIndex >= numBatches) {
     return false;
   }
 
-  float* ptr = batchData;
-  for (size_t i = imageIndex; i < imageIndex + batchSize; ++i) {
-    cv::Mat img = cv::imread(imgPaths[i]);
-    if (img.empty()){
-      std::cerr << "Failed to read image for calibration" << std::endl;
+  // Time TensorRT waits on the calibrator for each batch: the loader's lead plus the upload
+  TraceScope trace("calib_get_batch", kTraceCalibBatch);
+  if (!loader.joinable()) {
+    loader = std::thread(&Int8EntropyCalibrator2::loaderLoop, this);
+  }
+
+  const int slot = batchIndex % 2;
+  {
+    std::unique_lock<std::mutex> lock(slotMutex);
+    slotCond.wait(lock, [&] { return slotState[slot] != kSlotFree; });
+    if (slotState[slot] == kSlotFailed) {
       return false;
     }
-  
-    std::vector<float> inputData = prepareImage(img, inputC, inputH, inputW, scaleFactor, offsets, inputFormat);
+  }
 
-    size_t len = inputData.size();
-    memcpy(ptr, inputData.data(), len * sizeof(float));
-    ptr += inputData.size();
+  const bool uploaded = uploadBatch(slot);
 
-    std::cout << "Load image: " << imgPaths[i] << std::endl;
-    std::cout << "Progress: " << (i + 1) * 100. / imgPaths.size() << "%" << std::endl;
+  {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    slotState[slot] = kSlotFree;
+  }
+  slotCond.notify_all();
+  if (!uploaded) {
+    return false;
   }
 
-  imageIndex += batchSize;
+  ++batchIndex;
+  if (batchIndex == numBatches && tensorCache.writing()) {
+    tensorCache.finishWrite();
+  }
+  std::cout << "Load batch: " << batchIndex << "/" << numBatches << std::endl;
+  std::cout << "Progress: " << batchIndex * batchSize * 100. / imgPaths.size() << "%" << std::endl;
 
-  CUDA_CHECK(cudaMemcpy(deviceInput, batchData, inputCount * sizeof(float), cudaMemcpyHostToDevice));
   bindings[0] = deviceInput;
 
   return true;
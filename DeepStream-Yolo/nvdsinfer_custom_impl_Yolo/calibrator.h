@@ -6,12 +6,19 @@
 #ifndef CALIBRATOR_H
 #define CALIBRATOR_H
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <cuda_runtime_api.h>
 
 #include "NvInfer.h"
 #include "opencv2/opencv.hpp"
 
+#include "calib_tensor_cache.h"
+#include "calibrator_preprocess.h"
+#include "cuda_workspace.h"
+
 #define CUDA_CHECK(status) {                                                                                           \
   if (status != 0) {                                                                                                   \
     std::cout << "CUDA failure: " << cudaGetErrorString(status) << " in file " << __FILE__  << " at line "  <<         \
@@ -24,7 +31,7 @@ class Int8EntropyCalibrator2 : public nvinfer1::IInt8EntropyCalibrator2 {
   public:
     Int8EntropyCalibrator2(const int& batchSize, const int& channels, const int& height, const int& width,
         const float& scaleFactor, const float* offsets, const int& inputFormat, const std::string& imgPath,
-        const std::string& calibTablePath);
+        const std::string& calibTablePath, const int& maintainAspectRatio = 0, const int& symmetricPadding = 0);
 
     virtual ~Int8EntropyCalibrator2();
 
@@ -37,6 +44,16 @@ class Int8EntropyCalibrator2 : public nvinfer1::IInt8EntropyCalibrator2 {
     void writeCalibrationCache(const void* cache, size_t length) noexcept override;
 
   private:
+    // Batches are decoded ahead of getBatch into two pinned slots: the loader thread prepares the images of one
+    // batch in parallel (parser_pool) while TensorRT calibrates on the previous one.
+    enum SlotState { kSlotFree, kSlotReady, kSlotFailed };
+
+    void loaderLoop();
+
+    bool loadBatch(const size_t& first, const int& slot);
+
+    bool uploadBatch(const int& slot);
+
     int batchSize;
     int inputC;
     int inputH;
@@ -46,10 +63,28 @@ class Int8EntropyCalibrator2 : public nvinfer1::IInt8EntropyCalibrator2 {
     const float* offsets;
     int inputFormat;
     std::string calibTablePath;
-    size_t imageIndex;
     size_t inputCount;
     std::vector<std::string> imgPaths;
-    float* batchData {nullptr};
+    // INT8_CALIB_GPU_PREPROCESS=1: the slots hold the decoded 8-bit images and calibPreprocess() does the
+    // resize / letterbox / normalization on the GPU, matching nvinfer's scaling instead of prepareImage's crop
+    bool gpuPreprocess {false};
+    CalibPreprocessParams preprocessParams;
+    std::vector<cv::Mat> slotImages[2];
+    DeviceBuffer<uint8_t> deviceImage;
+    // INT8_CALIB_TENSOR_CACHE=<file>: preprocessed inputs are saved there on the first run and read back on the
+    // next ones while the preprocessing key and the image list are unchanged
+    CalibTensorCache tensorCache;
+    bool readTensorCache {false};
+    std::vector<float> cacheStaging;
+    float* hostSlots[2] {nullptr, nullptr};
+    SlotState slotState[2] {kSlotFree, kSlotFree};
+    size_t numBatches {0};
+    size_t batchIndex {0};
+    std::thread loader;
+    std::mutex slotMutex;
+    std::condition_variable slotCond;
+    bool stopLoader {false};
+    cudaStream_t stream {nullptr};
     void* deviceInput {nullptr};
     bool readCache;
     std::vector<char> calibrationCache;
@@ -0,0 +1,95 @@
+// calibrator_preprocess.cu  (fused resize / letterbox / normalize / CHW kernel behind calibPreprocess)
+
+#include "calibrator_preprocess.h"
+
+#include <algorithm>
+
+namespace {
+
+__device__ inline float
+sampleBilinear(const uint8_t* image, const size_t pitch, const int imageW, const int imageH, const float sx,
+    const float sy, const int c)
+{
+  const float x = fminf(fmaxf(sx, 0.0f), imageW - 1.0f);
+  const float y = fminf(fmaxf(sy, 0.0f), imageH - 1.0f);
+  const int x0 = (int) x;
+  const int y0 = (int) y;
+  const int x1 = min(x0 + 1, imageW - 1);
+  const int y1 = min(y0 + 1, imageH - 1);
+  const float fx = x - x0;
+  const float fy = y - y0;
+  const uint8_t* r0 = image + y0 * pitch;
+  const uint8_t* r1 = image + y1 * pitch;
+  const float top = r0[x0 * 3 + c] + (r0[x1 * 3 + c] - (float) r0[x0 * 3 + c]) * fx;
+  const float bottom = r1[x0 * 3 + c] + (r1[x1 * 3 + c] - (float) r1[x0 * 3 + c]) * fx;
+  return top + (bottom - top) * fy;
+}
+
+__global__ void
+calibPreprocessKernel(const uint8_t* image, const int imageW, const int imageH, const size_t pitch,
+    const CalibPreprocessParams params, const float scaleX, const float scaleY, const int padX, const int padY,
+    const int scaledW, const int scaledH, float* output)
+{
+  const int x = blockIdx.x * blockDim.x + threadIdx.x;
+  const int y = blockIdx.y * blockDim.y + threadIdx.y;
+  if (x >= params.inputW || y >= params.inputH) {
+    return;
+  }
+
+  float bgr[3] = {0.0f, 0.0f, 0.0f};
+  const int dx = x - padX;
+  const int dy = y - padY;
+  if (dx >= 0 && dx < scaledW && dy >= 0 && dy < scaledH) {
+    const float sx = (dx + 0.5f) / scaleX - 0.5f;
+    const float sy = (dy + 0.5f) / scaleY - 0.5f;
+    for (int c = 0; c < 3; ++c) {
+      bgr[c] = sampleBilinear(image, pitch, imageW, imageH, sx, sy, c);
+    }
+  }
+
+  const size_t plane = (size_t) params.inputH * params.inputW;
+  float* out = output + (size_t) y * params.inputW + x;
+  if (params.inputFormat == 2) {
+    const float gray = 0.299f * bgr[2] + 0.587f * bgr[1] + 0.114f * bgr[0];
+    out[0] = params.scaleFactor * (gray - params.offsets[0]);
+    return;
+  }
+  for (int c = 0; c < params.inputC && c < 3; ++c) {
+    const float value = params.inputFormat == 0 ? bgr[2 - c] : bgr[c];
+    out[c * plane] = params.scaleFactor * (value - params.offsets[c]);
+  }
+}
+
+} // namespace
+
+cudaError_t
+calibPreprocess(const uint8_t* image, const int& imageW, const int& imageH, const size_t& pitch,
+    const CalibPreprocessParams& params, float* output, cudaStream_t stream)
+{
+  if (imageW <= 0 || imageH <= 0) {
+    return cudaErrorInvalidValue;
+  }
+
+  float scaleX = params.inputW / (float) imageW;
+  float scaleY = params.inputH / (float) imageH;
+  int scaledW = params.inputW;
+  int scaledH = params.inputH;
+  int padX = 0;
+  int padY = 0;
+  if (params.maintainAspectRatio) {
+    const float scale = std::min(scaleX, scaleY);
+    scaleX = scaleY = scale;
+    scaledW = std::min(params.inputW, (int) (imageW * scale + 0.5f));
+    scaledH = std::min(params.inputH, (int) (imageH * scale + 0.5f));
+    if (params.symmetricPadding) {
+      padX = (params.inputW - scaledW) / 2;
+      padY = (params.inputH - scaledH) / 2;
+    }
+  }
+
+  const dim3 block(32, 8);
+  const dim3 grid((params.inputW + block.x - 1) / block.x, (params.inputH + block.y - 1) / block.y);
+  calibPreprocessKernel<<<grid, block, 0, stream>>>(image, imageW, imageH, pitch, params, scaleX, scaleY, padX,
+      padY, scaledW, scaledH, output);
+  return cudaGetLastError();
+}
@@ -0,0 +1,29 @@
+// calibrator_preprocess.h  (GPU image preprocessing for the INT8 calibrator)
+// One kernel turns a packed 8-bit BGR image into a network input plane set: resize (bilinear), optional
+// letterbox with DeepStream's maintain-aspect-ratio / symmetric-padding placement, channel order, then
+// net-scale-factor * (pixel - offset) per channel, written CHW straight into the calibration binding. Padding
+// is black before normalization, as nvinfer's scaled buffer is.
+
+#ifndef __CALIBRATOR_PREPROCESS_H__
+#define __CALIBRATOR_PREPROCESS_H__
+
+#include <stdint.h>
+
+#include <cuda_runtime_api.h>
+
+struct CalibPreprocessParams {
+  int inputC;
+  int inputH;
+  int inputW;
+  float scaleFactor;
+  float offsets[3];
+  int inputFormat;          // 0 RGB, 1 BGR, 2 GRAY (nvinfer model-color-format)
+  int maintainAspectRatio;
+  int symmetricPadding;
+};
+
+// image: device, imageH x imageW x 3 BGR with rows `pitch` bytes apart; output: device, inputC x inputH x inputW.
+cudaError_t calibPreprocess(const uint8_t* image, const int& imageW, const int& imageH, const size_t& pitch,
+    const CalibPreprocessParams& params, float* output, cudaStream_t stream);
+
+#endif
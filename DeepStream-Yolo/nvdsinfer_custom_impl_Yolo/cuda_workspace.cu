@@ -0,0 +1,183 @@
+// cuda_workspace.cu
+
+#include "cuda_workspace.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "parser_log.h"
+
+namespace {
+
+constexpr size_t kScratchMinBytes = 64 << 10;
+
+struct ParserStream {
+  cudaStream_t stream{nullptr};
+  bool created{false};
+  ~ParserStream() {
+    if (created) cudaStreamDestroy(stream);
+  }
+};
+
+thread_local ParserStream t_stream;
+thread_local ParserStream t_priority_stream;
+
+// Bit s set: batch slot s parses on the priority stream.
+uint64_t priority_sources()
+{
+  static const uint64_t mask = [] {
+    uint64_t m = 0;
+    const char* v = std::getenv("SQUEAKVIEW_PRIORITY_SOURCES");
+    while (v && *v) {
+      char* end = nullptr;
+      const long s = std::strtol(v, &end, 10);
+      if (end == v) break;
+      if (s >= 0 && s < kMaxBatchSlots) m |= 1ull << s;
+      v = *end == ',' ? end + 1 : end;
+    }
+    if (m) {
+      PARSER_LOG(kLogInfo, "[parser] priority streams for sources 0x%llx", (unsigned long long) m);
+    }
+    return m;
+  }();
+  return mask;
+}
+
+struct ScratchBlock {
+  void* ptr;
+  size_t bytes;
+  cudaEvent_t released;  // recorded on `stream` when the block went back to the pool
+  cudaStream_t stream;
+  bool busy;
+};
+
+struct ScratchPool {
+  std::mutex mutex;
+  std::vector<ScratchBlock> blocks;
+  ~ScratchPool() {
+    for (ScratchBlock& b : blocks) {
+      cudaEventDestroy(b.released);
+      mem_device_free(b.ptr);
+    }
+  }
+};
+
+ScratchPool g_scratch;
+
+} // namespace
+
+cudaStream_t parser_stream(int batch_slot)
+{
+  const bool priority = batch_slot >= 0 && batch_slot < kMaxBatchSlots && (priority_sources() >> batch_slot & 1);
+  ParserStream& s = priority ? t_priority_stream : t_stream;
+  if (!s.created) {
+    int least = 0, greatest = 0;
+    cudaError_t err;
+    if (priority && cudaDeviceGetStreamPriorityRange(&least, &greatest) == cudaSuccess) {
+      err = cudaStreamCreateWithPriority(&s.stream, cudaStreamNonBlocking, greatest);
+    } else {
+      err = cudaStreamCreateWithFlags(&s.stream, cudaStreamNonBlocking);
+    }
+    if (err != cudaSuccess) {
+      return nullptr;
+    }
+    s.created = true;
+  }
+  return s.stream;
+}
+
+void* scratch_acquire(size_t bytes, cudaStream_t stream)
+{
+  std::lock_guard<std::mutex> lock(g_scratch.mutex);
+  ScratchBlock* best = nullptr;
+  for (ScratchBlock& b : g_scratch.blocks) {
+    if (!b.busy && b.bytes >= bytes && (!best || b.bytes < best->bytes)) best = &b;
+  }
+  if (best) {
+    if (best->stream != stream) cudaStreamWaitEvent(stream, best->released, 0);
+    best->busy = true;
+    return best->ptr;
+  }
+
+  size_t size = kScratchMinBytes;
+  while (size < bytes) size <<= 1;
+  ScratchBlock b{nullptr, size, nullptr, stream, true};
+  if (mem_device_alloc(&b.ptr, size, kMemParsers) != cudaSuccess) {
+    cudaGetLastError();
+    PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: Failed to allocate %zu bytes of parser scratch", size);
+    return nullptr;
+  }
+  if (cudaEventCreateWithFlags(&b.released, cudaEventDisableTiming) != cudaSuccess) {
+    mem_device_free(b.ptr);
+    return nullptr;
+  }
+  g_scratch.blocks.push_back(b);
+  parser_stats_add(kStatAllocations, 1);
+  return b.ptr;
+}
+
+void scratch_release(void* ptr, cudaStream_t stream)
+{
+  std::lock_guard<std::mutex> lock(g_scratch.mutex);
+  for (ScratchBlock& b : g_scratch.blocks) {
+    if (b.ptr != ptr) continue;
+    cudaEventRecord(b.released, stream);
+    b.stream = stream;
+    b.busy = false;
+    return;
+  }
+}
+
+bool parser_cuda_graphs()
+{
+  static const bool enabled = [] {
+    const char* v = std::getenv("SQUEAKVIEW_CUDA_GRAPH");
+    const bool on = v && std::strcmp(v, "1") == 0;
+    if (on) {
+      PARSER_LOG(kLogInfo, "[parser] replaying GPU parser work from CUDA graphs");
+    }
+    return on;
+  }();
+  return enabled;
+}
+
+StreamGraphCache::~StreamGraphCache()
+{
+  for (Entry& e : entries_) {
+    if (e.exec != nullptr) cudaGraphExecDestroy(e.exec);
+  }
+}
+
+cudaGraphExec_t StreamGraphCache::find(const GraphKey& key)
+{
+  for (Entry& e : entries_) {
+    if (e.exec != nullptr && e.key == key) {
+      e.used = ++tick_;
+      return e.exec;
+    }
+  }
+  return nullptr;
+}
+
+cudaGraphExec_t StreamGraphCache::insert(const GraphKey& key, cudaGraph_t graph)
+{
+  cudaGraphExec_t exec = nullptr;
+#if CUDART_VERSION >= 11040
+  if (cudaGraphInstantiateWithFlags(&exec, graph, 0) != cudaSuccess) return nullptr;
+#else
+  if (cudaGraphInstantiate(&exec, graph, nullptr, nullptr, 0) != cudaSuccess) return nullptr;
+#endif
+
+  Entry* slot = &entries_[0];
+  for (Entry& e : entries_) {
+    if (e.exec == nullptr) { slot = &e; break; }
+    if (e.used < slot->used) slot = &e;
+  }
+  if (slot->exec != nullptr) cudaGraphExecDestroy(slot->exec);
+  slot->key = key;
+  slot->exec = exec;
+  slot->used = ++tick_;
+  return exec;
+}
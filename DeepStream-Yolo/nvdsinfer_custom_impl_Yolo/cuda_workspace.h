@@ -0,0 +1,233 @@
+// cuda_workspace.h  (per-thread CUDA scratch for the GPU parse functions)
+// nvinfer runs every parse callback of a GIE on that GIE's output thread, so thread_local workspaces are
+// per-context. Each gets its own non-blocking stream and grow-only device / pinned host buffers: after the
+// first frame a parse call does no cudaMalloc/cudaFree and never serializes on the legacy default stream.
+// What the GIEs share is scheduled here too: thrust temporaries come from one process-wide scratch pool, and
+// priority sources get their own high-priority stream so their post-processing overtakes the other GIEs' work.
+
+#ifndef __CUDA_WORKSPACE_H__
+#define __CUDA_WORKSPACE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+
+#include <cuda_runtime_api.h>
+
+#include "mem_budget.h"
+#include "parser_context.h"
+#include "parser_stats.h"
+#include "pinned_pool.h"
+
+// Grow-only device allocation; growing discards the old contents.
+template <typename T>
+class DeviceBuffer {
+ public:
+  DeviceBuffer() = default;
+  DeviceBuffer(const DeviceBuffer&) = delete;
+  DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+  ~DeviceBuffer() {
+    mem_device_free(ptr_);
+  }
+
+  bool reserve(size_t n) {
+    if (n <= cap_) return true;
+    mem_device_free(ptr_);
+    ptr_ = nullptr;
+    cap_ = 0;
+    if (mem_device_alloc(reinterpret_cast<void**>(&ptr_), n * sizeof(T), kMemParsers) != cudaSuccess) return false;
+    cap_ = n;
+    parser_stats_add(kStatAllocations, 1);
+    return true;
+  }
+
+  T* get() const { return ptr_; }
+  size_t capacity() const { return cap_; }
+
+ private:
+  T* ptr_{nullptr};
+  size_t cap_{0};
+};
+
+// Grow-only page-locked host allocation from the pinned pool (pinned_pool.h), so device-to-host copies can run
+// asynchronously on the stream.
+template <typename T>
+class PinnedBuffer {
+ public:
+  PinnedBuffer() = default;
+  PinnedBuffer(const PinnedBuffer&) = delete;
+  PinnedBuffer& operator=(const PinnedBuffer&) = delete;
+  ~PinnedBuffer() { pinned_free(ptr_); }
+
+  bool reserve(size_t n) {
+    if (n <= cap_) return true;
+    pinned_free(ptr_);
+    ptr_ = nullptr;
+    cap_ = 0;
+    try {
+      ptr_ = static_cast<T*>(pinned_alloc(n * sizeof(T)));
+    } catch (const std::bad_alloc&) {
+      return false;
+    }
+    cap_ = n;
+    parser_stats_add(kStatAllocations, 1);
+    return true;
+  }
+
+  T* get() const { return ptr_; }
+  size_t capacity() const { return cap_; }
+
+ private:
+  T* ptr_{nullptr};
+  size_t cap_{0};
+};
+
+// The calling thread's stream for a parse of batch slot batch_slot, created non-blocking on first use (0, the
+// default stream, if that fails). Sources listed in SQUEAKVIEW_PRIORITY_SOURCES="0[,2...]" (read once) get a
+// second stream at the device's greatest priority, so the scheduler runs their kernels ahead of work already
+// queued by other slots and other GIEs; every other slot, and -1, uses the default priority.
+cudaStream_t parser_stream(int batch_slot = -1);
+
+// Device scratch shared by the parse threads of every GIE, grow-only. A released block goes back to the pool
+// with an event recorded on its stream; handing it to another stream makes that stream wait on the event, so
+// two GIEs reuse the same memory without a cudaFree (which synchronizes the whole device) in between.
+void* scratch_acquire(size_t bytes, cudaStream_t stream);
+void scratch_release(void* ptr, cudaStream_t stream);
+
+// thrust allocator over the scratch pool, for thrust::cuda::par(alloc).on(stream).
+class ScratchAllocator {
+ public:
+  typedef char value_type;
+
+  explicit ScratchAllocator(cudaStream_t stream) : stream_(stream) {}
+
+  char* allocate(std::ptrdiff_t n) {
+    void* p = scratch_acquire(static_cast<size_t>(n), stream_);
+    if (p == nullptr) throw std::bad_alloc();
+    return static_cast<char*>(p);
+  }
+
+  void deallocate(char* p, size_t) { scratch_release(p, stream_); }
+
+ private:
+  cudaStream_t stream_;
+};
+
+// SQUEAKVIEW_CUDA_GRAPH=1 (read once): replay the fixed-shape parts of the GPU parsers from CUDA graphs.
+bool parser_cuda_graphs();
+
+// Everything a captured sequence was recorded with (buffer pointers, sizes, scalar kernel arguments).
+struct GraphKey {
+  static constexpr int kWords = 10;
+  uintptr_t words[kWords];
+
+  GraphKey(std::initializer_list<uintptr_t> values) {
+    std::memset(words, 0, sizeof(words));
+    int i = 0;
+    for (uintptr_t v : values) {
+      if (i == kWords) break;
+      words[i++] = v;
+    }
+  }
+
+  bool operator==(const GraphKey& o) const { return std::memcmp(words, o.words, sizeof(words)) == 0; }
+};
+
+// A few instantiated graphs of one stream sequence, one per key, least recently used evicted. nvinfer cycles
+// through a small pool of output buffers, so a handful of entries covers every input pointer it hands out.
+class StreamGraphCache {
+ public:
+  StreamGraphCache() = default;
+  StreamGraphCache(const StreamGraphCache&) = delete;
+  StreamGraphCache& operator=(const StreamGraphCache&) = delete;
+  ~StreamGraphCache();
+
+  // Runs the work record(stream) enqueues. With parser_cuda_graphs() the first call per key captures it and
+  // every later call is a single cudaGraphLaunch; without it, or when capture fails, the work is enqueued
+  // directly. record must enqueue the same operations every time for a given key.
+  template <typename Record>
+  cudaError_t run(const GraphKey& key, cudaStream_t stream, Record record) {
+    if (!parser_cuda_graphs() || stream == nullptr || disabled_) {
+      record(stream);
+      return cudaGetLastError();
+    }
+
+    cudaGraphExec_t exec = find(key);
+    if (exec == nullptr) {
+      if (cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal) != cudaSuccess) {
+        return fallback(stream, record);
+      }
+      record(stream);
+      cudaGraph_t graph = nullptr;
+      if (cudaStreamEndCapture(stream, &graph) != cudaSuccess || graph == nullptr) {
+        return fallback(stream, record);
+      }
+      exec = insert(key, graph);
+      cudaGraphDestroy(graph);
+      if (exec == nullptr) {
+        return fallback(stream, record);
+      }
+    }
+    return cudaGraphLaunch(exec, stream);
+  }
+
+ private:
+  static constexpr int kEntries = 8;
+
+  struct Entry {
+    GraphKey key{};
+    cudaGraphExec_t exec{nullptr};
+    uint64_t used{0};
+  };
+
+  cudaGraphExec_t find(const GraphKey& key);
+  cudaGraphExec_t insert(const GraphKey& key, cudaGraph_t graph);
+
+  // Capture is not possible on this stream or device: stop trying and enqueue directly from now on.
+  template <typename Record>
+  cudaError_t fallback(cudaStream_t stream, Record record) {
+    cudaGetLastError();
+    disabled_ = true;
+    record(stream);
+    return cudaGetLastError();
+  }
+
+  Entry entries_[kEntries];
+  uint64_t tick_{0};
+  bool disabled_{false};
+};
+
+// Device copies of small per-batch-slot host tables (ROI masks), uploaded again only when their id changes.
+class SlotUploadCache {
+ public:
+  SlotUploadCache() = default;
+  SlotUploadCache(const SlotUploadCache&) = delete;
+  SlotUploadCache& operator=(const SlotUploadCache&) = delete;
+
+  // Device copy of host[0..bytes) for slot, nullptr if it cannot be allocated. The upload is enqueued on
+  // stream, so it must not be recorded into a graph capture.
+  const uint8_t* get(int slot, uint64_t id, const uint8_t* host, size_t bytes, cudaStream_t stream) {
+    Entry& e = entries_[slot < 0 ? 0 : (slot < kMaxBatchSlots ? slot : kMaxBatchSlots - 1)];
+    if (e.id != id) {
+      e.id = 0;
+      if (!e.buf.reserve(bytes) ||
+          cudaMemcpyAsync(e.buf.get(), host, bytes, cudaMemcpyHostToDevice, stream) != cudaSuccess) {
+        return nullptr;
+      }
+      e.id = id;
+    }
+    return e.buf.get();
+  }
+
+ private:
+  struct Entry {
+    DeviceBuffer<uint8_t> buf;
+    uint64_t id{0};
+  };
+
+  Entry entries_[kMaxBatchSlots];
+};
+
+#endif
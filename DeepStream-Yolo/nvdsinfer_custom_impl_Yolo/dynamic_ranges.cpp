@@ -0,0 +1,259 @@
+// dynamic_ranges.cpp  (JSON / CSV / calibration cache readers behind loadDynamicRanges)
+
+#include "dynamic_ranges.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+std::string
+trimmed(const std::string& s)
+{
+  const size_t begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  const size_t end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+void
+skipSpace(const std::string& text, size_t& pos)
+{
+  while (pos < text.size() && std::isspace((unsigned char) text[pos])) {
+    ++pos;
+  }
+}
+
+bool
+parseString(const std::string& text, size_t& pos, std::string& out)
+{
+  skipSpace(text, pos);
+  if (pos >= text.size() || text[pos] != '"') {
+    return false;
+  }
+  out.clear();
+  for (++pos; pos < text.size() && text[pos] != '"'; ++pos) {
+    if (text[pos] == '\\' && pos + 1 < text.size()) {
+      ++pos;
+    }
+    out += text[pos];
+  }
+  if (pos >= text.size()) {
+    return false;
+  }
+  ++pos;
+  return true;
+}
+
+bool
+parseNumber(const std::string& text, size_t& pos, float& out)
+{
+  skipSpace(text, pos);
+  const char* begin = text.c_str() + pos;
+  char* end = nullptr;
+  out = std::strtof(begin, &end);
+  if (end == begin) {
+    return false;
+  }
+  pos += end - begin;
+  return true;
+}
+
+bool
+expect(const std::string& text, size_t& pos, const char c)
+{
+  skipSpace(text, pos);
+  if (pos >= text.size() || text[pos] != c) {
+    return false;
+  }
+  ++pos;
+  return true;
+}
+
+// Flat object of tensor -> number | {"min": x, "max": y} (also "amax")
+bool
+parseJson(const std::string& text, DynamicRanges& ranges)
+{
+  size_t pos = 0;
+  if (!expect(text, pos, '{')) {
+    return false;
+  }
+  skipSpace(text, pos);
+  if (pos < text.size() && text[pos] == '}') {
+    return true;
+  }
+  while (true) {
+    std::string name;
+    if (!parseString(text, pos, name) || !expect(text, pos, ':')) {
+      return false;
+    }
+    skipSpace(text, pos);
+    if (pos < text.size() && text[pos] == '{') {
+      ++pos;
+      float minValue = 0.0f;
+      float maxValue = 0.0f;
+      bool hasMin = false;
+      bool hasMax = false;
+      while (true) {
+        std::string key;
+        float value;
+        if (!parseString(text, pos, key) || !expect(text, pos, ':') || !parseNumber(text, pos, value)) {
+          return false;
+        }
+        if (key == "min") {
+          minValue = value;
+          hasMin = true;
+        }
+        else if (key == "max") {
+          maxValue = value;
+          hasMax = true;
+        }
+        else if (key == "amax") {
+          minValue = -value;
+          maxValue = value;
+          hasMin = hasMax = true;
+        }
+        skipSpace(text, pos);
+        if (pos < text.size() && text[pos] == ',') {
+          ++pos;
+          continue;
+        }
+        if (!expect(text, pos, '}')) {
+          return false;
+        }
+        break;
+      }
+      if (!hasMin || !hasMax) {
+        std::cerr << "WARNING: Dynamic range of " << name << " needs min and max (or amax), skipped" << std::endl;
+      }
+      else {
+        ranges[name] = std::make_pair(minValue, maxValue);
+      }
+    }
+    else {
+      float amax;
+      if (!parseNumber(text, pos, amax)) {
+        return false;
+      }
+      ranges[name] = std::make_pair(-amax, amax);
+    }
+    skipSpace(text, pos);
+    if (pos < text.size() && text[pos] == ',') {
+      ++pos;
+      continue;
+    }
+    return expect(text, pos, '}');
+  }
+}
+
+bool
+parseCalibrationCache(std::istream& input, DynamicRanges& ranges)
+{
+  std::string line;
+  std::getline(input, line);
+  while (std::getline(input, line)) {
+    const size_t colon = line.rfind(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    const std::string name = trimmed(line.substr(0, colon));
+    const std::string hex = trimmed(line.substr(colon + 1));
+    char* end = nullptr;
+    const uint32_t bits = std::strtoul(hex.c_str(), &end, 16);
+    if (name.empty() || end == hex.c_str()) {
+      continue;
+    }
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    const float amax = scale * 127.0f;
+    ranges[name] = std::make_pair(-amax, amax);
+  }
+  return true;
+}
+
+bool
+parseCsv(std::istream& input, DynamicRanges& ranges)
+{
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(input, line)) {
+    ++lineNumber;
+    const size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    line = trimmed(line);
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::stringstream row(line);
+    std::string field;
+    while (std::getline(row, field, ',')) {
+      fields.push_back(trimmed(field));
+    }
+    char* end = nullptr;
+    if (fields.size() == 2) {
+      const float amax = std::strtof(fields[1].c_str(), &end);
+      if (end != fields[1].c_str()) {
+        ranges[fields[0]] = std::make_pair(-amax, amax);
+        continue;
+      }
+    }
+    else if (fields.size() == 3) {
+      char* end2 = nullptr;
+      const float minValue = std::strtof(fields[1].c_str(), &end);
+      const float maxValue = std::strtof(fields[2].c_str(), &end2);
+      if (end != fields[1].c_str() && end2 != fields[2].c_str()) {
+        ranges[fields[0]] = std::make_pair(minValue, maxValue);
+        continue;
+      }
+    }
+    // A header row is expected; anything else is reported
+    if (lineNumber > 1) {
+      std::cerr << "WARNING: Skipping dynamic range line " << lineNumber << ": " << line << std::endl;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+bool
+loadDynamicRanges(const std::string& path, DynamicRanges& ranges)
+{
+  std::ifstream input(path);
+  if (!input.good()) {
+    std::cerr << "Could not open the dynamic range file " << path << std::endl;
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << input.rdbuf();
+  const std::string text = buffer.str();
+  const std::string head = trimmed(text.substr(0, 64));
+
+  bool ok;
+  if (!head.empty() && head[0] == '{') {
+    ok = parseJson(text, ranges);
+  }
+  else if (head.compare(0, 4, "TRT-") == 0) {
+    std::stringstream lines(text);
+    ok = parseCalibrationCache(lines, ranges);
+  }
+  else {
+    std::stringstream lines(text);
+    ok = parseCsv(lines, ranges);
+  }
+  if (!ok) {
+    std::cerr << "Could not parse the dynamic range file " << path << std::endl;
+  }
+  return ok;
+}
@@ -0,0 +1,19 @@
+// dynamic_ranges.h  (per-tensor INT8 dynamic ranges imported from a file instead of an on-device calibration)
+// Accepted formats, picked from the content:
+//   JSON  {"tensor": 4.2, "other": {"min": -1.5, "max": 3.0}, ...}   (a bare number is a symmetric amax)
+//   CSV   tensor,amax  or  tensor,min,max   one per line, '#' starts a comment
+//   TensorRT calibration cache  "TRT-...Calibration..." header, then "tensor: <hex float32 scale>";
+//         the range is scale * 127
+
+#ifndef __DYNAMIC_RANGES_H__
+#define __DYNAMIC_RANGES_H__
+
+#include <map>
+#include <string>
+#include <utility>
+
+typedef std::map<std::string, std::pair<float, float>> DynamicRanges;
+
+bool loadDynamicRanges(const std::string& path, DynamicRanges& ranges);
+
+#endif
@@ -0,0 +1,319 @@
+// engine_cache.cpp  (key, lookup and store behind engine_cache.h)
+
+#include "engine_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "parser_trace.h"
+#include "utils.h"
+#include "yolo.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+// Build variables read by Yolo::createEngine and the YoloLayer plugin; a change in any of them is a new plan.
+const char* const kBuildVariables[] = {
+  "YOLO_OPT_PROFILES", "YOLO_FP32_LAYERS", "YOLO_SPARSITY", "YOLO_BUILDER_OPT_LEVEL", "YOLO_OBJECTNESS_GATE",
+  "YOLO_OUTPUT_FP16", "YOLO_OUTPUT_COMPACT", "YOLO_COMPACT_THRESHOLD", "YOLO_REFIT", "YOLO_FOLD_BN",
+  "YOLO_WEIGHTS_BLOB_FP16", "INT8_DYNAMIC_RANGES", "INT8_FP16_LAYERS", "INT8_CALIB_IMG_PATH", "INT8_CALIB_BATCH_SIZE",
+  "INT8_CALIB_DEDUP", "INT8_CALIB_MAX_IMAGES", "INT8_CALIB_GPU_PREPROCESS",
+};
+
+uint64_t
+fnv1a(const void* data, size_t size, uint64_t hash = kFnvOffset)
+{
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ p[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+std::string
+hex(uint64_t value)
+{
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016llx", (unsigned long long) value);
+  return buf;
+}
+
+// Content hash of a file, streamed in 1 MiB pieces; empty when it cannot be read.
+std::string
+fileHash(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file.good()) {
+    return "";
+  }
+  std::vector<char> buf(1 << 20);
+  uint64_t hash = kFnvOffset;
+  while (file) {
+    file.read(buf.data(), buf.size());
+    hash = fnv1a(buf.data(), file.gcount(), hash);
+  }
+  return hex(hash);
+}
+
+std::string
+cacheDir(const std::string& modelPath)
+{
+  const char* env = getenv("YOLO_ENGINE_CACHE");
+  if (env && std::string(env) == "0") {
+    return "";
+  }
+  if (env && *env) {
+    return env;
+  }
+  return modelPath.substr(0, modelPath.rfind("/") + 1) + "engine_cache";
+}
+
+std::string
+sidecarPath(const std::string& planPath)
+{
+  return planPath.substr(0, planPath.rfind(".engine")) + ".key";
+}
+
+void
+removeEntry(const std::string& planPath)
+{
+  std::remove(planPath.c_str());
+  std::remove(sidecarPath(planPath).c_str());
+}
+
+// dst becomes a hard link to src (a copy across file systems), replaced atomically.
+bool
+linkFile(const std::string& src, const std::string& dst)
+{
+  const std::string tmp = dst + ".tmp";
+  std::remove(tmp.c_str());
+  if (link(src.c_str(), tmp.c_str()) != 0) {
+    std::ifstream in(src, std::ios::binary);
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!in.good() || !out.good() || !(out << in.rdbuf())) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp.c_str(), dst.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+// The line of a key description starting with prefix, empty when there is none.
+std::string
+descriptionLine(const std::string& description, const std::string& prefix)
+{
+  std::istringstream in(description);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, prefix.size(), prefix) == 0) {
+      return line;
+    }
+  }
+  return "";
+}
+
+} // namespace
+
+bool
+engineCacheKey(const NetworkInfo& networkInfo, EngineCacheKey& key)
+{
+  const bool onnx = networkInfo.networkType == "onnx";
+  const std::string dir = cacheDir(onnx ? networkInfo.onnxFilePath : networkInfo.cfgFilePath);
+  if (dir == "") {
+    return false;
+  }
+
+  std::ostringstream d;
+  if (onnx) {
+    d << "onnx=" << fileHash(networkInfo.onnxFilePath) << "\n";
+  }
+  else {
+    d << "cfg=" << fileHash(networkInfo.cfgFilePath) << "\n" << "weights=" << fileHash(networkInfo.wtsFilePath) << "\n";
+  }
+  if (d.str().find("=\n") != std::string::npos) {
+    return false;
+  }
+
+  d << "precision=" << networkInfo.networkMode << "\n";
+  d << "batch=" << networkInfo.batchSize << " implicit=" << networkInfo.implicitBatch << "\n";
+  d << "device=" << networkInfo.deviceType << " dla=" << networkInfo.dlaCore << "\n";
+  d << "workspace=" << networkInfo.workspaceSize << "\n";
+  d << "classes=" << networkInfo.numDetectedClasses << "\n";
+  if (networkInfo.networkMode == "INT8") {
+    d << "calib=" << (networkInfo.int8CalibPath != "" ? fileHash(networkInfo.int8CalibPath) : "") << "\n";
+    d << "input=" << networkInfo.inputFormat << " scale=" << networkInfo.scaleFactor << " letterbox="
+        << networkInfo.maintainAspectRatio << networkInfo.symmetricPadding << "\n";
+    if (networkInfo.offsets) {
+      d << "offsets=" << networkInfo.offsets[0] << "," << networkInfo.offsets[1] << "," << networkInfo.offsets[2]
+          << "\n";
+    }
+    if (getenv("INT8_DYNAMIC_RANGES")) {
+      d << "ranges=" << fileHash(getenv("INT8_DYNAMIC_RANGES")) << "\n";
+    }
+  }
+
+  int deviceId = 0;
+  cudaDeviceProp prop;
+  if (cudaGetDevice(&deviceId) != cudaSuccess || cudaGetDeviceProperties(&prop, deviceId) != cudaSuccess) {
+    return false;
+  }
+  d << "gpu=" << prop.name << " sm=" << prop.major << "." << prop.minor << "\n";
+  d << "tensorrt=" << NV_TENSORRT_MAJOR << "." << NV_TENSORRT_MINOR << "." << NV_TENSORRT_PATCH << " runtime="
+      << getInferLibVersion() << "\n";
+  for (const char* name : kBuildVariables) {
+    if (getenv(name)) {
+      d << name << "=" << getenv(name) << "\n";
+    }
+  }
+
+  key.description = d.str();
+  key.hash = fnv1a(key.description.data(), key.description.size());
+  key.planPath = dir + "/" + networkInfo.modelName + "_" + hex(key.hash) + ".engine";
+  return true;
+}
+
+nvinfer1::ICudaEngine*
+engineCacheLoad(const EngineCacheKey& key, nvinfer1::ILogger& logger, const std::string& engineFilePath)
+{
+  std::vector<char> sidecar;
+  if (!readBinaryFile(sidecarPath(key.planPath), sidecar)) {
+    return nullptr;
+  }
+
+  // The sidecar is the key description followed by the plan size; both must match before TensorRT sees the plan
+  const std::string text(sidecar.begin(), sidecar.end());
+  const std::string sizeTag = "plan_bytes=";
+  std::error_code ec;
+  const uintmax_t planBytes = fs::file_size(key.planPath, ec);
+  if (text.compare(0, key.description.size(), key.description) != 0 || ec ||
+      text.compare(key.description.size(), std::string::npos, sizeTag + std::to_string(planBytes) + "\n") != 0) {
+    std::cerr << "WARNING: Engine cache entry " << key.planPath << " does not match its key, rebuilding\n"
+        << std::endl;
+    removeEntry(key.planPath);
+    return nullptr;
+  }
+
+  TraceScope trace("engine_cache_load", kTraceBuild);
+  nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(logger);
+  nvinfer1::ICudaEngine* engine = nullptr;
+  if (runtime) {
+#if NV_TENSORRT_MAJOR >= 10
+    PlanFileReader reader(key.planPath);
+    engine = runtime->deserializeCudaEngine(reader);
+#else
+    std::vector<char> plan;
+    if (readBinaryFile(key.planPath, plan)) {
+      engine = runtime->deserializeCudaEngine(plan.data(), plan.size());
+    }
+#endif
+  }
+  if (engine == nullptr) {
+    std::cerr << "WARNING: Cached engine " << key.planPath << " failed to deserialize, rebuilding\n" << std::endl;
+    removeEntry(key.planPath);
+    return nullptr;
+  }
+
+  std::cout << "Engine loaded from cache " << key.planPath << "\n" << std::endl;
+  // A hit counts as use, so the eviction in engineCacheStore keeps entries that are still loaded
+  fs::last_write_time(key.planPath, fs::file_time_type::clock::now(), ec);
+  if (engineFilePath != "" && engineFilePath != key.planPath && linkFile(key.planPath, engineFilePath)) {
+    std::cout << "Engine plan saved to " << engineFilePath << "\n" << std::endl;
+  }
+  return engine;
+}
+
+void
+engineCacheStore(const EngineCacheKey& key, const std::string& engineFilePath, const std::string& modelName)
+{
+  std::error_code ec;
+  const std::string dir = key.planPath.substr(0, key.planPath.rfind("/"));
+  fs::create_directories(dir, ec);
+  const uintmax_t planBytes = fs::file_size(engineFilePath, ec);
+  if (ec || !linkFile(engineFilePath, key.planPath)) {
+    std::cerr << "WARNING: Could not add " << engineFilePath << " to the engine cache in " << dir << "\n"
+        << std::endl;
+    return;
+  }
+  const std::string sidecar = key.description + "plan_bytes=" + std::to_string(planBytes) + "\n";
+  if (!writeBinaryFile(sidecarPath(key.planPath), sidecar.data(), sidecar.size())) {
+    removeEntry(key.planPath);
+    return;
+  }
+  std::cout << "Engine cached as " << key.planPath << "\n" << std::endl;
+
+  // Newest first; everything past kEngineCacheKeep for this model goes
+  std::vector<std::pair<fs::file_time_type, std::string>> entries;
+  for (const fs::directory_entry& e : fs::directory_iterator(dir, ec)) {
+    const std::string name = e.path().filename().string();
+    if (name.compare(0, modelName.size() + 1, modelName + "_") == 0 && e.path().extension() == ".engine") {
+      entries.emplace_back(fs::last_write_time(e.path(), ec), e.path().string());
+    }
+  }
+  std::sort(entries.begin(), entries.end(), [] (const std::pair<fs::file_time_type, std::string>& a,
+      const std::pair<fs::file_time_type, std::string>& b) { return a.first > b.first; });
+  for (size_t i = kEngineCacheKeep; i < entries.size(); ++i) {
+    removeEntry(entries[i].second);
+  }
+}
+
+std::vector<std::string>
+engineCacheFallbacks(const EngineCacheKey& key, const std::string& modelName)
+{
+  const char* const compatible[] = {"batch=", "device=", "classes=", "gpu=", "tensorrt="};
+  const char* const model[] = {"onnx=", "cfg=", "weights="};
+
+  std::error_code ec;
+  const std::string dir = key.planPath.substr(0, key.planPath.rfind("/"));
+  // ((same model, mtime), plan path)
+  typedef std::pair<std::pair<bool, fs::file_time_type>, std::string> Candidate;
+  std::vector<Candidate> entries;
+  for (const fs::directory_entry& e : fs::directory_iterator(dir, ec)) {
+    const std::string path = e.path().string();
+    const std::string name = e.path().filename().string();
+    if (path == key.planPath || e.path().extension() != ".engine" ||
+        name.compare(0, modelName.size() + 1, modelName + "_") != 0) {
+      continue;
+    }
+    std::vector<char> sidecar;
+    if (!readBinaryFile(sidecarPath(path), sidecar)) {
+      continue;
+    }
+    const std::string text(sidecar.begin(), sidecar.end());
+    bool usable = true;
+    for (const char* prefix : compatible) {
+      usable = usable && descriptionLine(text, prefix) == descriptionLine(key.description, prefix);
+    }
+    if (!usable) {
+      continue;
+    }
+    bool sameModel = true;
+    for (const char* prefix : model) {
+      sameModel = sameModel && descriptionLine(text, prefix) == descriptionLine(key.description, prefix);
+    }
+    entries.emplace_back(std::make_pair(sameModel, fs::last_write_time(e.path(), ec)), path);
+  }
+  std::sort(entries.begin(), entries.end(), [] (const Candidate& a, const Candidate& b) { return a.first > b.first; });
+
+  std::vector<std::string> plans;
+  for (const Candidate& e : entries) {
+    plans.push_back(e.second);
+  }
+  return plans;
+}
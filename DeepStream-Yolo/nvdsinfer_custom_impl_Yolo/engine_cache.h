@@ -0,0 +1,48 @@
+// engine_cache.h  (content-addressed cache of built engine plans behind NvDsInferYoloCudaEngineGet)
+// nvinfer asks the library for an engine whenever model-engine-file is missing or fails to deserialize (an
+// upgraded TensorRT, another GPU). Every plan the library builds is also stored as
+// <cache dir>/<model>_<key>.engine, where the key hashes everything the plan depends on: the ONNX file (or the
+// cfg and weights), the INT8 calibration inputs, precision, batch size and optimization profiles, DLA core,
+// workspace, the GPU name and SM version, the TensorRT build and runtime versions, and the YOLO_* / INT8_*
+// build variables. A matching entry is validated against its .key sidecar and deserialized instead of rebuilt,
+// then linked to the engine path nvinfer loads on the next start. YOLO_ENGINE_CACHE=<dir> moves the cache
+// (default <model dir>/engine_cache); YOLO_ENGINE_CACHE=0 turns it off. The newest kEngineCacheKeep entries
+// per model are kept.
+
+#ifndef __ENGINE_CACHE_H__
+#define __ENGINE_CACHE_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NvInfer.h"
+
+struct NetworkInfo;
+
+constexpr int kEngineCacheKeep = 4;
+
+struct EngineCacheKey
+{
+  std::string description;  // one "name=value" line per input, stored in the sidecar
+  uint64_t hash {0};
+  std::string planPath;
+};
+
+// False when the cache is off or a model input cannot be read.
+bool engineCacheKey(const NetworkInfo& networkInfo, EngineCacheKey& key);
+
+// The cached engine for key, or nullptr on a miss. A stale or unreadable entry is removed.
+nvinfer1::ICudaEngine* engineCacheLoad(const EngineCacheKey& key, nvinfer1::ILogger& logger,
+    const std::string& engineFilePath);
+
+// Adds the plan just written to engineFilePath to the cache and drops the oldest entries of the model. key is to be
+// taken after the build, since an INT8 build can write the calibration table it hashes.
+void engineCacheStore(const EngineCacheKey& key, const std::string& engineFilePath, const std::string& modelName);
+
+// Plans of other cache entries that can serve in place of key's while it is built (engine_swap.h): same batch
+// size, device, class count, GPU and TensorRT. Entries of the same model (another precision) come first, then
+// earlier versions of the model, newest first within each.
+std::vector<std::string> engineCacheFallbacks(const EngineCacheKey& key, const std::string& modelName);
+
+#endif
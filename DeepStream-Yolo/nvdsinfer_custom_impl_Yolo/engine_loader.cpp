@@ -0,0 +1,130 @@
+// engine_loader.cpp  (NvDsInferYoloCudaEngineGet for libnvdsinfer_custom_impl_Yolo_parsers.so)
+// The parser library carries the bbox, pose and OBB parsers without TensorRT's builder, the ONNX parser, the
+// Darknet layers or the YoloLayer plugin, so dlopen from nvinfer maps and relocates a fraction of the full
+// library. nvinfer only calls the engine-create function when model-engine-file is missing or stale; this one
+// then loads libnvdsinfer_custom_impl_Yolo.so (YOLO_BUILDER_LIB, default: next to this library) and forwards,
+// as does NvDsInferYoloRefitEngine. NvDsInferYoloEngineSwapPoll only forwards once the builder library is loaded,
+// so polling it never maps the builder into a pipeline that did not build.
+// Plans that use the YoloLayer plugin (Darknet models) need the plugin registered before nvinfer deserializes
+// them and therefore the full library in custom-lib-path; ONNX exports with the decode baked in do not.
+
+#include <cstdlib>
+#include <dlfcn.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include "nvdsinfer_custom_impl.h"
+
+namespace {
+
+#if NV_TENSORRT_MAJOR >= 8
+typedef bool (*EngineGetFn)(nvinfer1::IBuilder* const, nvinfer1::IBuilderConfig* const,
+    const NvDsInferContextInitParams* const, nvinfer1::DataType, nvinfer1::ICudaEngine*&);
+#else
+typedef bool (*EngineGetFn)(nvinfer1::IBuilder* const, const NvDsInferContextInitParams* const, nvinfer1::DataType,
+    nvinfer1::ICudaEngine*&);
+#endif
+
+const char* const kBuilderLib = "libnvdsinfer_custom_impl_Yolo.so";
+
+std::string
+builderLibPath()
+{
+  const char* env = getenv("YOLO_BUILDER_LIB");
+  if (env && *env) {
+    return env;
+  }
+
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(&builderLibPath), &info) && info.dli_fname) {
+    const std::string self = info.dli_fname;
+    const size_t slash = self.rfind('/');
+    if (slash != std::string::npos) {
+      return self.substr(0, slash + 1) + kBuilderLib;
+    }
+  }
+  return kBuilderLib;
+}
+
+// The builder library stays loaded for the life of the process: the engine it returns and the plugins it
+// registered refer to its code.
+void*
+builderLib()
+{
+  static std::once_flag once;
+  static void* handle = nullptr;
+  std::call_once(once, [] {
+    const std::string path = builderLibPath();
+    handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+      std::cerr << "ERROR: Could not load the engine builder library " << path << ": " << dlerror() << "\n"
+                << std::endl;
+    }
+  });
+  return handle;
+}
+
+void*
+builderSymbol(const char* name)
+{
+  void* handle = builderLib();
+  void* symbol = handle ? dlsym(handle, name) : nullptr;
+  if (handle && !symbol) {
+    std::cerr << "ERROR: The engine builder library does not export " << name << "\n" << std::endl;
+  }
+  return symbol;
+}
+
+} // namespace
+
+#if NV_TENSORRT_MAJOR >= 8
+extern "C" bool
+NvDsInferYoloCudaEngineGet(nvinfer1::IBuilder* const builder, nvinfer1::IBuilderConfig* const builderConfig,
+    const NvDsInferContextInitParams* const initParams, nvinfer1::DataType dataType,
+    nvinfer1::ICudaEngine*& cudaEngine);
+
+extern "C" bool
+NvDsInferYoloCudaEngineGet(nvinfer1::IBuilder* const builder, nvinfer1::IBuilderConfig* const builderConfig,
+    const NvDsInferContextInitParams* const initParams, nvinfer1::DataType dataType, nvinfer1::ICudaEngine*& cudaEngine)
+{
+  const EngineGetFn fn = reinterpret_cast<EngineGetFn>(builderSymbol("NvDsInferYoloCudaEngineGet"));
+  return fn && fn(builder, builderConfig, initParams, dataType, cudaEngine);
+}
+#else
+extern "C" bool
+NvDsInferYoloCudaEngineGet(nvinfer1::IBuilder* const builder, const NvDsInferContextInitParams* const initParams,
+    nvinfer1::DataType dataType, nvinfer1::ICudaEngine*& cudaEngine);
+
+extern "C" bool
+NvDsInferYoloCudaEngineGet(nvinfer1::IBuilder* const builder, const NvDsInferContextInitParams* const initParams,
+    nvinfer1::DataType dataType, nvinfer1::ICudaEngine*& cudaEngine)
+{
+  const EngineGetFn fn = reinterpret_cast<EngineGetFn>(builderSymbol("NvDsInferYoloCudaEngineGet"));
+  return fn && fn(builder, initParams, dataType, cudaEngine);
+}
+#endif
+
+// Engines are registered by the builder library that created them (engine_refit.h)
+extern "C" int
+NvDsInferYoloRefitEngine(const char* engineFilePath, const char* onnxFilePath)
+{
+  typedef int (*RefitFn)(const char*, const char*);
+  const RefitFn fn = reinterpret_cast<RefitFn>(builderSymbol("NvDsInferYoloRefitEngine"));
+  return fn ? fn(engineFilePath, onnxFilePath) : 0;
+}
+
+// Background builds run in the builder library (engine_swap.h); nothing to report while it is not loaded
+extern "C" int
+NvDsInferYoloEngineSwapPoll(char* path, int size)
+{
+  void* handle = dlopen(builderLibPath().c_str(), RTLD_NOW | RTLD_NOLOAD);
+  if (!handle) {
+    return 0;
+  }
+  typedef int (*PollFn)(char*, int);
+  const PollFn fn = reinterpret_cast<PollFn>(dlsym(handle, "NvDsInferYoloEngineSwapPoll"));
+  const int result = fn ? fn(path, size) : 0;
+  dlclose(handle);
+  return result;
+}
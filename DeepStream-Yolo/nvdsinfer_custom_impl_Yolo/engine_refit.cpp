@@ -0,0 +1,160 @@
+// engine_refit.cpp  (registry and IRefitter path behind engine_refit.h)
+
+#include "engine_refit.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "NvOnnxParser.h"
+
+#include "parser_trace.h"
+
+namespace {
+
+// Set as the error recorder of every registered engine, which is how the registry learns that nvinfer destroyed
+// it (pipeline teardown, re-init, a hot swap): TensorRT holds a reference to the recorder for the engine and for
+// each of its execution contexts and drops it when they are destroyed. Errors go on to the logger, as they would
+// without a recorder.
+class EngineLifetime : public nvinfer1::IErrorRecorder
+{
+  public:
+    explicit EngineLifetime(nvinfer1::ILogger& logger) : m_Logger(logger) {}
+
+    bool alive() const { return m_Refs.load() > 0; }
+
+    int32_t getNbErrors() const noexcept override { return 0; }
+    nvinfer1::ErrorCode getErrorCode(int32_t) const noexcept override { return nvinfer1::ErrorCode::kSUCCESS; }
+    ErrorDesc getErrorDesc(int32_t) const noexcept override { return ""; }
+    bool hasOverflowed() const noexcept override { return false; }
+    void clear() noexcept override {}
+    bool reportError(nvinfer1::ErrorCode, ErrorDesc desc) noexcept override {
+      m_Logger.log(nvinfer1::ILogger::Severity::kERROR, desc);
+      return false;
+    }
+    RefCount incRefCount() noexcept override { return ++m_Refs; }
+    RefCount decRefCount() noexcept override { return --m_Refs; }
+
+  private:
+    nvinfer1::ILogger& m_Logger;
+    std::atomic<int32_t> m_Refs {0};
+};
+
+struct RefitEngine
+{
+  nvinfer1::ICudaEngine* engine;
+  nvinfer1::ILogger* logger;
+  const EngineLifetime* lifetime;
+};
+
+std::mutex g_refitMutex;
+std::map<std::string, RefitEngine> g_refitEngines;
+// Every recorder handed to TensorRT; one is only freed once no engine or context holds it any more.
+std::vector<std::unique_ptr<EngineLifetime>> g_lifetimes;
+
+// Forgets the engines that have been destroyed. Called with g_refitMutex held.
+void
+dropDestroyedEngines()
+{
+  for (auto it = g_refitEngines.begin(); it != g_refitEngines.end();) {
+    it = it->second.lifetime->alive() ? std::next(it) : g_refitEngines.erase(it);
+  }
+  for (size_t i = 0; i < g_lifetimes.size();) {
+    if (g_lifetimes[i]->alive()) {
+      ++i;
+      continue;
+    }
+    g_lifetimes[i] = std::move(g_lifetimes.back());
+    g_lifetimes.pop_back();
+  }
+}
+
+} // namespace
+
+void
+engineRefitRegister(const std::string& engineFilePath, nvinfer1::ICudaEngine* engine, nvinfer1::ILogger& logger)
+{
+  if (engine == nullptr || !engine->isRefittable()) {
+    return;
+  }
+  if (engine->getErrorRecorder() != nullptr) {
+    std::cerr << "WARNING: Engine " << engineFilePath << " already has an error recorder, so its lifetime cannot be "
+        "followed; not registering it for refits\n" << std::endl;
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_refitMutex);
+  dropDestroyedEngines();
+  g_lifetimes.emplace_back(new EngineLifetime(logger));
+  engine->setErrorRecorder(g_lifetimes.back().get());
+  g_refitEngines[engineFilePath] = RefitEngine{engine, &logger, g_lifetimes.back().get()};
+  std::cout << "Engine " << engineFilePath << " is refittable (NvDsInferYoloRefitEngine)\n" << std::endl;
+}
+
+extern "C" int
+NvDsInferYoloRefitEngine(const char* engineFilePath, const char* onnxFilePath)
+{
+  if (onnxFilePath == nullptr || *onnxFilePath == '\0') {
+    return 0;
+  }
+
+  // One refit at a time: IRefitter must not run concurrently on the same engine
+  std::lock_guard<std::mutex> lock(g_refitMutex);
+  dropDestroyedEngines();
+  auto it = g_refitEngines.end();
+  if (engineFilePath != nullptr && *engineFilePath != '\0') {
+    it = g_refitEngines.find(engineFilePath);
+  }
+  else if (g_refitEngines.size() == 1) {
+    it = g_refitEngines.begin();
+  }
+  if (it == g_refitEngines.end()) {
+    std::cerr << "ERROR: No refittable engine registered for " << (engineFilePath ? engineFilePath : "<any>") <<
+        " (build with YOLO_REFIT=1 and let the library create the engine)\n" << std::endl;
+    return 0;
+  }
+
+#if NV_TENSORRT_MAJOR >= 10
+  TraceScope trace("NvDsInferYoloRefitEngine", kTraceBuild);
+  const auto start = std::chrono::steady_clock::now();
+  nvinfer1::ILogger& logger = *it->second.logger;
+
+  std::unique_ptr<nvinfer1::IRefitter> refitter(nvinfer1::createInferRefitter(*it->second.engine, logger));
+  if (!refitter) {
+    std::cerr << "ERROR: Could not create a refitter for " << it->first << "\n" << std::endl;
+    return 0;
+  }
+  std::unique_ptr<nvonnxparser::IParserRefitter> parserRefitter(
+      nvonnxparser::createParserRefitter(*refitter, logger));
+  if (!parserRefitter || !parserRefitter->refitFromFile(onnxFilePath)) {
+    std::cerr << "ERROR: " << onnxFilePath << " does not match the architecture of " << it->first << "\n" <<
+        std::endl;
+    return 0;
+  }
+  const int32_t missing = refitter->getMissingWeights(0, nullptr);
+  if (missing > 0) {
+    std::cerr << "ERROR: " << onnxFilePath << " leaves " << missing << " weights of " << it->first << " unset\n" <<
+        std::endl;
+    return 0;
+  }
+
+  // Inference already queued on nvinfer's stream still reads the old weights
+  cudaDeviceSynchronize();
+  if (!refitter->refitCudaEngine()) {
+    std::cerr << "ERROR: Refitting " << it->first << " failed\n" << std::endl;
+    return 0;
+  }
+
+  const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Refitted " << it->first << " from " << onnxFilePath << " in " << ms << " ms\n" << std::endl;
+  return 1;
+#else
+  std::cerr << "ERROR: Refitting from ONNX requires TensorRT >= 10\n" << std::endl;
+  return 0;
+#endif
+}
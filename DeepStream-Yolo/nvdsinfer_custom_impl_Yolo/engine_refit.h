@@ -0,0 +1,30 @@
+// engine_refit.h  (swap the weights of a running engine through nvinfer1::IRefitter)
+// With YOLO_REFIT=1 engines are built with BuilderFlag::kREFIT. Every refittable engine the library hands to
+// nvinfer (built, or loaded from the engine cache) is registered under its model-engine-file path, and
+// NvDsInferYoloRefitEngine() replaces its weights in place from an ONNX file of the same architecture, e.g. a
+// fine-tuned export, without a rebuild or a pipeline restart. nvinfer deserializes an existing
+// model-engine-file itself, so the engine has to come through NvDsInferYoloCudaEngineGet: leave
+// model-engine-file unset (or pointing at a missing file) and let the engine cache supply the plan. An engine
+// leaves the registry once nvinfer destroys it and its execution contexts (the library follows this through an
+// error recorder it sets on the engine), so a refit after a teardown or a hot swap finds no engine.
+// The refit must not overlap inference on the engine: the caller stops buffers from reaching nvinfer first,
+// and the refit waits for the GPU to finish the work already queued. The plan files are not rewritten, so a
+// restart comes back with the weights the engine was built from. Requires TensorRT >= 10 (ONNX parser refitter).
+
+#ifndef __ENGINE_REFIT_H__
+#define __ENGINE_REFIT_H__
+
+#include <string>
+
+#include "NvInfer.h"
+
+// Remembers a refittable engine under engineFilePath, replacing an earlier one there. Not refittable: ignored.
+void engineRefitRegister(const std::string& engineFilePath, nvinfer1::ICudaEngine* engine, nvinfer1::ILogger& logger);
+
+extern "C" {
+// Refits the engine registered under engineFilePath (nullptr or "": the only registered engine) with the weights
+// of onnxFilePath. Returns 1 on success, 0 when there is no such engine or the weights do not fit it.
+int NvDsInferYoloRefitEngine(const char* engineFilePath, const char* onnxFilePath);
+}
+
+#endif
@@ -0,0 +1,291 @@
+// engine_swap.cpp  (fallback lookup and background build behind engine_swap.h)
+
+#include "engine_swap.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cuda_runtime_api.h>
+
+#include "engine_cache.h"
+#include "parser_trace.h"
+#include "utils.h"
+#include "yolo.h"
+
+namespace {
+
+#if NV_TENSORRT_MAJOR >= 10
+
+enum SwapState { kSwapBuilding, kSwapReady, kSwapFailed, kSwapReported };
+
+std::atomic<bool> g_swapCancel {false};
+
+// Lets the builder give up at its next step once the process exits
+class CancelMonitor : public nvinfer1::IProgressMonitor
+{
+  public:
+    void phaseStart(const char*, const char*, int32_t) noexcept override {}
+    bool stepComplete(const char*, int32_t) noexcept override { return !g_swapCancel.load(); }
+    void phaseFinish(const char*) noexcept override {}
+};
+
+struct SwapJob
+{
+  NetworkInfo info;         // engineFilePath is the temporary plan
+  float offsets[4];         // NvDsInferContextInitParams::offsets outlives nvinfer's call, not the build
+  std::string plan;         // where the validated plan goes
+  bool cached {false};
+  EngineCacheKey key;
+  std::string signature;    // input and output tensors of the fallback
+  nvinfer1::ILogger* logger {nullptr};  // nvinfer's, alive for the process
+  int device {0};
+  SwapState state {kSwapBuilding};
+  std::thread thread;
+};
+
+struct SwapRegistry
+{
+  ~SwapRegistry() {
+    g_swapCancel.store(true);
+    for (auto& job : jobs) {
+      if (job.second->thread.joinable()) {
+        job.second->thread.join();
+      }
+    }
+  }
+
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<SwapJob>> jobs;  // by engine path
+};
+
+SwapRegistry&
+registry()
+{
+  static SwapRegistry r;
+  return r;
+}
+
+// One line per input and output: name, direction, data type and shape (-1 for the dynamic batch)
+std::string
+ioSignature(const nvinfer1::ICudaEngine& engine)
+{
+  std::ostringstream s;
+  for (int i = 0; i < engine.getNbIOTensors(); ++i) {
+    const char* name = engine.getIOTensorName(i);
+    const nvinfer1::Dims dims = engine.getTensorShape(name);
+    s << name << (engine.getTensorIOMode(name) == nvinfer1::TensorIOMode::kINPUT ? " in " : " out ") <<
+        static_cast<int>(engine.getTensorDataType(name));
+    for (int d = 0; d < dims.nbDims; ++d) {
+      s << " " << dims.d[d];
+    }
+    s << "\n";
+  }
+  return s.str();
+}
+
+nvinfer1::ICudaEngine*
+loadPlan(const std::string& planPath, nvinfer1::ILogger& logger)
+{
+  if (!fileExists(planPath)) {
+    return nullptr;
+  }
+  nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(logger);
+  if (runtime == nullptr) {
+    return nullptr;
+  }
+  PlanFileReader reader(planPath);
+  nvinfer1::ICudaEngine* engine = runtime->deserializeCudaEngine(reader);
+  if (engine == nullptr) {
+    delete runtime;
+  }
+  return engine;
+}
+
+void
+buildInBackground(SwapJob* job)
+{
+  cudaSetDevice(job->device);
+  const char* nice = getenv("YOLO_HOT_SWAP_NICE");
+  setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice && *nice ? std::atoi(nice) : 10);
+
+  TraceScope trace("engine_swap_build", kTraceBuild);
+  const auto start = std::chrono::steady_clock::now();
+  const std::string& tmpPath = job->info.engineFilePath;
+
+  CancelMonitor monitor;
+  std::string failure;
+  std::unique_ptr<nvinfer1::IBuilder> builder(nvinfer1::createInferBuilder(*job->logger));
+  std::unique_ptr<nvinfer1::IBuilderConfig> config(builder ? builder->createBuilderConfig() : nullptr);
+  if (!config) {
+    failure = "could not create a builder";
+  }
+  else {
+    config->setProgressMonitor(&monitor);
+    if (job->info.workspaceSize > 0) {
+      config->setMemoryPoolLimit(nvinfer1::MemoryPoolType::kWORKSPACE, (size_t) job->info.workspaceSize * 1024 * 1024);
+    }
+    std::unique_ptr<nvinfer1::ICudaEngine> engine;
+    {
+      Yolo yolo(job->info);
+      engine.reset(yolo.createEngine(builder.get(), config.get()));
+    }
+    // createEngine read the plan back from tmpPath, so a non-null engine is a plan that deserializes
+    if (!engine) {
+      failure = g_swapCancel.load() ? "cancelled" : "the build failed";
+    }
+    else if (ioSignature(*engine) != job->signature) {
+      failure = "its inputs and outputs differ from the fallback engine's";
+    }
+    else if (std::rename(tmpPath.c_str(), job->plan.c_str()) != 0) {
+      failure = "could not move the plan to " + job->plan;
+    }
+  }
+
+  const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (failure.empty()) {
+    // Keyed after the build, which may have written the INT8 calibration table the key hashes
+    if (job->cached && engineCacheKey(job->info, job->key)) {
+      engineCacheStore(job->key, job->plan, job->info.modelName);
+    }
+    std::cout << "Background build of " << job->plan << " done in " << s << " s, ready to swap in\n" << std::endl;
+  }
+  else {
+    std::remove(tmpPath.c_str());
+    std::cerr << "WARNING: Background build of " << job->plan << " failed after " << s << " s (" << failure <<
+        "), serving from the fallback engine\n" << std::endl;
+  }
+
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  job->state = failure.empty() ? kSwapReady : kSwapFailed;
+}
+
+#endif
+
+} // namespace
+
+bool
+engineSwapEnabled()
+{
+  static const bool enabled = getenv("YOLO_HOT_SWAP") && std::atoi(getenv("YOLO_HOT_SWAP")) == 1;
+  return enabled;
+}
+
+bool
+engineSwapStart(const NetworkInfo& networkInfo, const EngineCacheKey* cacheKey, nvinfer1::ILogger& logger,
+    nvinfer1::ICudaEngine*& fallback)
+{
+#if NV_TENSORRT_MAJOR >= 10
+  std::vector<std::string> candidates;
+  if (getenv("YOLO_FALLBACK_ENGINE") && *getenv("YOLO_FALLBACK_ENGINE")) {
+    candidates.push_back(getenv("YOLO_FALLBACK_ENGINE"));
+  }
+  if (cacheKey != nullptr) {
+    const std::vector<std::string> cached = engineCacheFallbacks(*cacheKey, networkInfo.modelName);
+    candidates.insert(candidates.end(), cached.begin(), cached.end());
+  }
+
+  nvinfer1::ICudaEngine* engine = nullptr;
+  std::string fallbackPath;
+  for (const std::string& path : candidates) {
+    // The engine path itself is the plan nvinfer just failed to load
+    if (path == networkInfo.engineFilePath) {
+      continue;
+    }
+    TraceScope trace("engine_swap_fallback", kTraceBuild);
+    engine = loadPlan(path, logger);
+    if (engine != nullptr) {
+      fallbackPath = path;
+      break;
+    }
+    std::cerr << "WARNING: Fallback engine " << path << " does not load\n" << std::endl;
+  }
+  if (engine == nullptr) {
+    std::cout << "No fallback engine for " << networkInfo.engineFilePath << ", building in the foreground\n" <<
+        std::endl;
+    return false;
+  }
+
+  SwapRegistry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  std::unique_ptr<SwapJob>& slot = r.jobs[networkInfo.engineFilePath];
+  if (slot && slot->state == kSwapBuilding) {
+    // nvinfer asked again (a restarted pipeline): the running build is reported when it is done
+    std::cout << "Serving from fallback engine " << fallbackPath << ", " << networkInfo.engineFilePath <<
+        " is still building\n" << std::endl;
+    fallback = engine;
+    return true;
+  }
+  if (slot && slot->thread.joinable()) {
+    slot->thread.join();
+  }
+
+  std::unique_ptr<SwapJob> job(new SwapJob());
+  job->info = networkInfo;
+  if (networkInfo.offsets != nullptr) {
+    std::memcpy(job->offsets, networkInfo.offsets, sizeof(job->offsets));
+    job->info.offsets = job->offsets;
+  }
+  job->plan = networkInfo.engineFilePath;
+  job->info.engineFilePath = networkInfo.engineFilePath + ".swap";
+  job->cached = cacheKey != nullptr;
+  if (cacheKey != nullptr) {
+    job->key = *cacheKey;
+  }
+  job->signature = ioSignature(*engine);
+  job->logger = &logger;
+  cudaGetDevice(&job->device);
+  job->thread = std::thread(buildInBackground, job.get());
+  slot = std::move(job);
+
+  std::cout << "Serving from fallback engine " << fallbackPath << " while " << networkInfo.engineFilePath <<
+      " builds in the background\n" << std::endl;
+  fallback = engine;
+  return true;
+#else
+  static_cast<void>(networkInfo);
+  static_cast<void>(cacheKey);
+  static_cast<void>(logger);
+  static_cast<void>(fallback);
+  std::cerr << "WARNING: YOLO_HOT_SWAP requires TensorRT >= 10, building in the foreground\n" << std::endl;
+  return false;
+#endif
+}
+
+extern "C" int
+NvDsInferYoloEngineSwapPoll(char* path, int size)
+{
+#if NV_TENSORRT_MAJOR >= 10
+  SwapRegistry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (auto& it : r.jobs) {
+    SwapJob& job = *it.second;
+    if (job.state != kSwapReady && job.state != kSwapFailed) {
+      continue;
+    }
+    const int result = job.state == kSwapReady ? 1 : -1;
+    job.state = kSwapReported;
+    if (path != nullptr && size > 0) {
+      std::snprintf(path, size, "%s", it.first.c_str());
+    }
+    return result;
+  }
+#else
+  static_cast<void>(path);
+  static_cast<void>(size);
+#endif
+  return 0;
+}
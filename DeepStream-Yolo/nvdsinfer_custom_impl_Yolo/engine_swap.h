@@ -0,0 +1,38 @@
+// engine_swap.h  (serve from a fallback engine while the requested one builds in the background)
+// With YOLO_HOT_SWAP=1, NvDsInferYoloCudaEngineGet does not block pipeline startup on a build when the engine
+// cache misses. It hands nvinfer a fallback engine at once and builds the requested engine on a background thread
+// at a lower CPU priority (YOLO_HOT_SWAP_NICE, default 10). The fallback is YOLO_FALLBACK_ENGINE=<plan> when it
+// loads; otherwise the newest engine cache entry with the same batch size, device, class count, GPU and TensorRT:
+// the same model in another precision first, then an earlier version of the model. Without a fallback the build
+// runs in the foreground as before.
+// The background build writes a temporary plan, checks that it deserializes and that its input and output
+// tensors match the fallback's, then renames it to the engine path and adds it to the engine cache.
+// NvDsInferYoloEngineSwapPoll() reports the validated plan once; the application then sets nvinfer's
+// model-engine-file property to it, and nvinfer switches to the new engine between two batches without stopping
+// the pipeline. Process exit cancels a build still running. Requires TensorRT >= 10.
+
+#ifndef __ENGINE_SWAP_H__
+#define __ENGINE_SWAP_H__
+
+#include <string>
+
+#include "NvInfer.h"
+
+struct NetworkInfo;
+struct EngineCacheKey;
+
+// YOLO_HOT_SWAP=1, read once.
+bool engineSwapEnabled();
+
+// Loads a fallback for networkInfo's engine and starts building the engine in the background. cacheKey is null
+// when the engine cache is off. False (and fallback untouched) when no fallback loads or a build cannot start.
+bool engineSwapStart(const NetworkInfo& networkInfo, const EngineCacheKey* cacheKey, nvinfer1::ILogger& logger,
+    nvinfer1::ICudaEngine*& fallback);
+
+extern "C" {
+// 1: a background build finished and its validated plan is at path (each plan is reported once); -1: a build
+// failed and the fallback stays; 0: nothing new. path gets size bytes at most, NUL-terminated.
+int NvDsInferYoloEngineSwapPoll(char* path, int size);
+}
+
+#endif
@@ -0,0 +1,214 @@
+// frame_ring.h  (lock-free MPSC ring of finished result frames, shared by the pose and OBB caches)
+// Slot life cycle: FREE/READY -> WRITING (producer) -> READY -> READING (consumer) -> READY.
+// Producers never touch a READING slot, so an acquired frame cannot tear; they skip to the next slot.
+// A slot is allocated for MaxRows rows of up to MaxWidth floats the first time a producer claims it, so a ring
+// nothing publishes to (the OBB ring in a pose pipeline) costs no memory and publishing only allocates while the
+// ring fills up for the first time.
+
+#ifndef __FRAME_RING_H__
+#define __FRAME_RING_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "parser_context.h"
+#include "parser_stats.h"
+
+// What a reader sees of one pinned slot; data stays valid until release(slot).
+struct FrameView {
+  uint64_t seq{0};
+  uint64_t frame_num{0};
+  int32_t source_id{0};
+  int32_t slot{-1};
+  int32_t count{0};
+  int32_t width{0};  // floats per row
+  int32_t flags{0};
+  const float* data{nullptr};
+};
+
+template <int Slots, int MaxRows, int MaxWidth>
+class FrameRing {
+ public:
+  FrameRing() = default;
+
+  // Copies up to MaxRows rows into the next free slot, keeping the first `width` of every `in_width` floats,
+  // and publishes it under tag. Returns the frame seq, or 0 when every slot was held by a reader.
+  uint64_t publish(const float* rows, int count, int in_width, int width, const FrameTag& tag, int32_t flags) {
+    int index = -1;
+    Slot* s = claim(index);
+    if (!s) return 0;
+    // Only the WRITING owner touches flat, and readers only see it after the release store below.
+    if (s->flat.empty()) {
+      s->flat.resize(static_cast<size_t>(MaxRows) * MaxWidth);
+      parser_stats_add(kStatAllocations, 1);
+    }
+
+    width = std::min(std::max(0, width), MaxWidth);
+    count = rows ? std::min(std::max(0, count), MaxRows) : 0;
+    if (width == in_width) {
+      std::memcpy(s->flat.data(), rows, static_cast<size_t>(count) * width * sizeof(float));
+    } else {
+      for (int i = 0; i < count; ++i) {
+        std::memcpy(s->flat.data() + static_cast<size_t>(i) * width, rows + static_cast<size_t>(i) * in_width,
+                    width * sizeof(float));
+      }
+    }
+    s->frame_num.store(tag.frame_num, std::memory_order_relaxed);
+    s->source_id.store(tag.batch_slot, std::memory_order_relaxed);
+    s->count = count;
+    s->width = width;
+    s->flags = flags;
+    s->unread.store(1, std::memory_order_relaxed);
+
+    const uint64_t seq = next_seq_.fetch_add(1, std::memory_order_relaxed) + 1;
+    s->seq.store(seq, std::memory_order_relaxed);
+    s->state.store(kReady, std::memory_order_release);
+    latest_.store(index, std::memory_order_release);
+    return seq;
+  }
+
+  // Oldest finished frame newer than after_seq (source_id < 0 matches any source).
+  bool acquire(int source_id, uint64_t after_seq, FrameView* view) {
+    // Retry a few times: a candidate can be reclaimed by a producer between the scan and the pin.
+    for (int attempt = 0; attempt < 4; ++attempt) {
+      int best = -1;
+      uint64_t best_seq = 0;
+      for (int i = 0; i < Slots; ++i) {
+        if (!matches(slots_[i], source_id)) continue;
+        const uint64_t seq = slots_[i].seq.load(std::memory_order_relaxed);
+        if (seq > after_seq && (best < 0 || seq < best_seq)) { best = i; best_seq = seq; }
+      }
+      if (best < 0) return false;
+      if (pin(best, view)) {
+        if (view->seq > after_seq && (source_id < 0 || view->source_id == source_id)) return true;
+        release(view->slot);
+      }
+    }
+    return false;
+  }
+
+  // Newest finished frame (source_id < 0 matches any source).
+  bool acquire_latest(int source_id, FrameView* view) {
+    for (int attempt = 0; attempt < 4; ++attempt) {
+      int best = -1;
+      uint64_t best_seq = 0;
+      for (int i = 0; i < Slots; ++i) {
+        if (!matches(slots_[i], source_id)) continue;
+        const uint64_t seq = slots_[i].seq.load(std::memory_order_relaxed);
+        if (seq > best_seq) { best = i; best_seq = seq; }
+      }
+      if (best < 0) return false;
+      if (pin(best, view)) {
+        if (source_id < 0 || view->source_id == source_id) return true;
+        release(view->slot);
+      }
+    }
+    return false;
+  }
+
+  // The frame with exactly this (source_id, frame_num), if it is still in the ring.
+  bool acquire_frame(int source_id, uint64_t frame_num, FrameView* view) {
+    for (int i = 0; i < Slots; ++i) {
+      const Slot& s = slots_[i];
+      if (!matches(s, source_id) || s.frame_num.load(std::memory_order_relaxed) != frame_num) continue;
+      if (pin(i, view)) {
+        if (view->frame_num == frame_num && (source_id < 0 || view->source_id == source_id)) return true;
+        release(view->slot);
+      }
+    }
+    return false;
+  }
+
+  void release(int slot) {
+    if (slot < 0 || slot >= Slots) return;
+    uint32_t expected = kReading;
+    slots_[slot].state.compare_exchange_strong(expected, kReady, std::memory_order_release);
+  }
+
+  // Unpinned view of the newest frame (legacy readers); false before the first publish.
+  bool peek_latest(FrameView* view) const {
+    const int i = latest_.load(std::memory_order_acquire);
+    if (i < 0) return false;
+    const Slot& s = slots_[i];
+    view->seq = s.seq.load(std::memory_order_relaxed);
+    view->frame_num = s.frame_num.load(std::memory_order_relaxed);
+    view->source_id = s.source_id.load(std::memory_order_relaxed);
+    view->slot = i;
+    view->count = s.count;
+    view->width = s.width;
+    view->flags = s.flags;
+    view->data = s.flat.data();
+    s.unread.store(0, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  enum : uint32_t { kFree = 0, kWriting = 1, kReady = 2, kReading = 3 };
+
+  struct Slot {
+    std::atomic<uint32_t> state{kFree};
+    std::atomic<uint64_t> seq{0};
+    // Keys are atomic because readers filter on them before pinning the slot.
+    std::atomic<uint64_t> frame_num{0};
+    std::atomic<int32_t> source_id{0};
+    // Plain fields below are only written in WRITING and published by the release store of READY.
+    int32_t count{0};
+    int32_t width{0};
+    int32_t flags{0};
+    // Set by publish, cleared by any read; a READY slot reclaimed while still set is a dropped frame.
+    mutable std::atomic<uint8_t> unread{0};
+    std::vector<float> flat;
+  };
+
+  Slot* claim(int& index) {
+    for (int attempt = 0; attempt < Slots; ++attempt) {
+      const int i = static_cast<int>(head_.fetch_add(1, std::memory_order_relaxed) % Slots);
+      Slot& s = slots_[i];
+      uint32_t expected = kReady;
+      if (s.state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) {
+        if (s.unread.exchange(0, std::memory_order_relaxed)) parser_stats_add(kStatCacheOverwrites, 1);
+        index = i;
+        return &s;
+      }
+      expected = kFree;
+      if (s.state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) {
+        index = i;
+        return &s;
+      }
+    }
+    return nullptr;
+  }
+
+  bool pin(int i, FrameView* view) {
+    Slot& s = slots_[i];
+    uint32_t expected = kReady;
+    if (!s.state.compare_exchange_strong(expected, kReading, std::memory_order_acquire)) {
+      return false;
+    }
+    view->seq = s.seq.load(std::memory_order_relaxed);
+    view->frame_num = s.frame_num.load(std::memory_order_relaxed);
+    view->source_id = s.source_id.load(std::memory_order_relaxed);
+    view->slot = i;
+    view->count = s.count;
+    view->width = s.width;
+    view->flags = s.flags;
+    view->data = s.flat.data();
+    s.unread.store(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  static bool matches(const Slot& s, int source_id) {
+    return s.state.load(std::memory_order_acquire) == kReady &&
+           (source_id < 0 || s.source_id.load(std::memory_order_relaxed) == source_id);
+  }
+
+  std::atomic<uint64_t> next_seq_{0};
+  std::atomic<uint64_t> head_{0};
+  std::atomic<int> latest_{-1};
+  Slot slots_[Slots];
+};
+
+#endif
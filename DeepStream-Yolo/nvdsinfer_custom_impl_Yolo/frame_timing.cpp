@@ -0,0 +1,94 @@
+// frame_timing.cpp
+
+#include "frame_timing.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "parser_trace.h"
+
+namespace {
+
+// Newest parsed frame of one batch slot. The parse thread writes the frame fields, then publishes parsed_ns with
+// a release store; the tag takes it with an exchange, so each mark is tagged at most once.
+struct alignas(64) SlotMark {
+  std::atomic<uint64_t> frame_num{0};
+  std::atomic<int64_t> parse_start_ns{0};
+  std::atomic<int64_t> parsed_ns{0};  // 0 = nothing to tag
+};
+
+SlotMark g_marks[kMaxBatchSlots];
+
+struct OpenFrame {
+  bool open{false};
+  int slot{0};
+  uint64_t frame_num{0};
+  int64_t start_ns{0};
+};
+
+thread_local OpenFrame t_open;
+
+// Tagged frames, oldest overwritten first. Written once per frame by the tagging probe and read by the
+// application, never by the parsers, so a mutex is fine.
+std::mutex g_ring_mutex;
+NvDsFrameTiming g_ring[kFrameTimingRing];
+uint64_t g_ring_next = 0;
+
+} // namespace
+
+void frame_timing_open(const FrameTag& tag, int64_t now_ns) {
+  t_open.open = true;
+  t_open.slot = tag.batch_slot;
+  t_open.frame_num = tag.frame_num;
+  t_open.start_ns = now_ns;
+}
+
+void frame_timing_close(int64_t now_ns) {
+  if (!t_open.open) return;
+  t_open.open = false;
+  SlotMark& m = g_marks[t_open.slot];
+  m.frame_num.store(t_open.frame_num, std::memory_order_relaxed);
+  m.parse_start_ns.store(t_open.start_ns, std::memory_order_relaxed);
+  m.parsed_ns.store(now_ns > 0 ? now_ns : 1, std::memory_order_release);
+}
+
+extern "C" int NvDsInferTagFrameTiming(int source_id, uint64_t pts_ns, int64_t capture_ns) {
+  if (source_id < 0 || source_id >= kMaxBatchSlots) return 0;
+  SlotMark& m = g_marks[source_id];
+  const int64_t parsed_ns = m.parsed_ns.exchange(0, std::memory_order_acquire);
+  if (parsed_ns == 0) return 0;
+
+  NvDsFrameTiming t{};
+  t.frame_num = m.frame_num.load(std::memory_order_relaxed);
+  t.pts_ns = pts_ns;
+  t.capture_ns = capture_ns > 0 ? capture_ns : 0;
+  t.parse_start_ns = m.parse_start_ns.load(std::memory_order_relaxed);
+  t.parsed_ns = parsed_ns;
+  t.source_id = source_id;
+
+  if (t.capture_ns > 0 && t.capture_ns <= parsed_ns) {
+    trace_record(kTraceCapture, parsed_ns - t.capture_ns);
+  }
+
+  std::lock_guard<std::mutex> lock(g_ring_mutex);
+  g_ring[g_ring_next++ % kFrameTimingRing] = t;
+  return 1;
+}
+
+extern "C" int NvDsInferGetFrameTiming(int source_id, uint64_t frame_num, NvDsFrameTiming* out) {
+  if (!out) return 0;
+  std::lock_guard<std::mutex> lock(g_ring_mutex);
+  const uint64_t held = g_ring_next < kFrameTimingRing ? g_ring_next : kFrameTimingRing;
+  for (uint64_t k = 1; k <= held; ++k) {
+    const NvDsFrameTiming& t = g_ring[(g_ring_next - k) % kFrameTimingRing];
+    if (t.source_id == source_id && t.frame_num == frame_num) {
+      *out = t;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+extern "C" int64_t NvDsInferMonotonicNs() {
+  return trace_now_ns();
+}
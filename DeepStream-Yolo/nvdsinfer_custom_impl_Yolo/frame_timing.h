@@ -0,0 +1,50 @@
+// frame_timing.h  (capture-to-parse latency of every parsed frame)
+// nvinfer passes the parsers neither PTS nor capture times, so the two ends are joined per batch slot. Every
+// parse callback marks its frame (batch slot, frame_num as in parser_context.h) with monotonic parse-start and
+// parse-complete times. The application then tags it with the buffer's PTS and capture time through
+// NvDsInferTagFrameTiming from a probe on nvinfer's src pad. nvinfer parses a batch and pushes it downstream on the
+// same output thread, so at that probe the newest untagged mark of a slot belongs to that buffer; slots of
+// batches nvinfer skipped (interval) have none and are ignored.
+// Tagged frames are kept in a ring for lookup by (source, frame_num), and their capture-to-parse latency goes to
+// the "capture" stage of parser_trace.h, so NvDsInferGetStageLatency reports its percentiles. All times are
+// CLOCK_MONOTONIC nanoseconds, the clock GStreamer's system clock runs on.
+
+#ifndef __FRAME_TIMING_H__
+#define __FRAME_TIMING_H__
+
+#include <cstdint>
+
+#include "parser_context.h"
+
+constexpr int kFrameTimingRing = 256;
+
+// Layout mirrored by ctypes in apps/inference/runner.py; keep field order and sizes stable.
+extern "C" {
+struct NvDsFrameTiming {
+  uint64_t frame_num;   // per-source frame counter (see parser_context.h)
+  uint64_t pts_ns;      // buffer PTS as tagged by the application
+  int64_t capture_ns;   // capture time as tagged by the application, 0 = unknown
+  int64_t parse_start_ns;
+  int64_t parsed_ns;    // parse callback finished
+  int32_t source_id;    // batch slot
+  int32_t reserved;
+};
+
+// Tags the newest parsed, untagged frame of batch slot source_id. Returns 1 when there was one (the latency was
+// recorded when capture_ns > 0), 0 when nvinfer did not parse this slot since the last tag.
+int NvDsInferTagFrameTiming(int source_id, uint64_t pts_ns, int64_t capture_ns);
+
+// Timing of a tagged frame still in the ring. Returns 1 and fills *out, or 0 when it is unknown.
+int NvDsInferGetFrameTiming(int source_id, uint64_t frame_num, NvDsFrameTiming* out);
+
+// The clock the timings use, for applications that can't read CLOCK_MONOTONIC themselves.
+int64_t NvDsInferMonotonicNs();
+}
+
+// Called by tag_frame: the calling thread is now parsing this frame.
+void frame_timing_open(const FrameTag& tag, int64_t now_ns);
+
+// Called when the calling thread's parse callback returns; marks the frame it opened as parsed.
+void frame_timing_close(int64_t now_ns);
+
+#endif
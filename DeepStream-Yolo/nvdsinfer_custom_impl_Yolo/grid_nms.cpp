@@ -0,0 +1,107 @@
+// grid_nms.cpp
+
+#include "grid_nms.h"
+
+#include <cmath>
+
+#include "parser_stats.h"
+
+namespace {
+
+template <typename T>
+inline void grow(std::vector<T>& v, size_t n) {
+  if (v.size() < n) {
+    v.resize(n);
+    parser_stats_add(kStatAllocations, 1);
+  }
+}
+
+thread_local GridNms t_grid;
+
+// Cell index of coordinate v, clamped to [0, cells). The float clamp runs first so NaN maps to cell 0.
+inline uint16_t cell_of(float v, float origin, float scale, int cells) {
+  const float f = std::min(std::max(0.f, (v - origin) * scale), static_cast<float>(cells - 1));
+  return static_cast<uint16_t>(f);
+}
+
+} // namespace
+
+void GridNms::begin(int n) {
+  count = std::max(0, n);
+  const size_t un = static_cast<size_t>(count);
+  grow(x1, un); grow(y1, un); grow(x2, un); grow(y2, un);
+  grow(cls, un); grow(keep, un);
+  grow(gx0_, un); grow(gy0_, un); grow(gx1_, un); grow(gy1_, un);
+  grow(removed_, un); grow(seen_, un); grow(sides_, un);
+}
+
+void GridNms::build() {
+  const int n = count;
+  std::fill(removed_.begin(), removed_.begin() + n, 0);
+  std::fill(seen_.begin(), seen_.begin() + n, 0);
+  stamp_ = 0;
+  gw_ = gh_ = 1;
+
+  float min_x = 0.f, min_y = 0.f, sx = 0.f, sy = 0.f;
+  if (n > kGridNmsMinBoxes) {
+    min_x = x1[0]; min_y = y1[0];
+    float max_x = x2[0], max_y = y2[0];
+    for (int r = 0; r < n; ++r) {
+      min_x = std::min(min_x, x1[r]); max_x = std::max(max_x, x2[r]);
+      min_y = std::min(min_y, y1[r]); max_y = std::max(max_y, y2[r]);
+      sides_[r] = std::max(x2[r] - x1[r], y2[r] - y1[r]);
+    }
+    std::nth_element(sides_.begin(), sides_.begin() + n / 2, sides_.begin() + n);
+    const float side = sides_[n / 2];
+    const float span_x = max_x - min_x, span_y = max_y - min_y;
+    if (side > 0.f && std::isfinite(span_x) && std::isfinite(span_y)) {
+      gw_ = std::min(kGridNmsMaxCells, std::max(1, static_cast<int>(std::ceil(span_x / side))));
+      gh_ = std::min(kGridNmsMaxCells, std::max(1, static_cast<int>(std::ceil(span_y / side))));
+      sx = span_x > 0.f ? gw_ / span_x : 0.f;
+      sy = span_y > 0.f ? gh_ / span_y : 0.f;
+    }
+  }
+
+  // Counting sort of the (box, cell) pairs; filling in rank order keeps every cell's ranks ascending.
+  const int cells = gw_ * gh_;
+  grow(cell_start_, static_cast<size_t>(cells) + 1);
+  std::fill(cell_start_.begin(), cell_start_.begin() + cells + 1, 0);
+  size_t pairs = 0;
+  for (int r = 0; r < n; ++r) {
+    gx0_[r] = cell_of(x1[r], min_x, sx, gw_); gx1_[r] = cell_of(x2[r], min_x, sx, gw_);
+    gy0_[r] = cell_of(y1[r], min_y, sy, gh_); gy1_[r] = cell_of(y2[r], min_y, sy, gh_);
+    gx1_[r] = std::max(gx0_[r], gx1_[r]); gy1_[r] = std::max(gy0_[r], gy1_[r]);
+    for (int gy = gy0_[r]; gy <= gy1_[r]; ++gy) {
+      for (int gx = gx0_[r]; gx <= gx1_[r]; ++gx) ++cell_start_[gy * gw_ + gx + 1];
+    }
+    pairs += static_cast<size_t>(gx1_[r] - gx0_[r] + 1) * (gy1_[r] - gy0_[r] + 1);
+  }
+  for (int c = 0; c < cells; ++c) cell_start_[c + 1] += cell_start_[c];
+  grow(items_, pairs);
+
+  // cell_start_[c] is used as the fill cursor of cell c, which leaves it at the start of cell c + 1; shift back.
+  for (int r = 0; r < n; ++r) {
+    for (int gy = gy0_[r]; gy <= gy1_[r]; ++gy) {
+      for (int gx = gx0_[r]; gx <= gx1_[r]; ++gx) items_[cell_start_[gy * gw_ + gx]++] = r;
+    }
+  }
+  for (int c = cells; c > 0; --c) cell_start_[c] = cell_start_[c - 1];
+  cell_start_[0] = 0;
+}
+
+GridNms& grid_nms() {
+  return t_grid;
+}
+
+int grid_nms_iou(GridNms& g, float iou_thr, int max_keep) {
+  const float* x1 = g.x1.data(); const float* y1 = g.y1.data();
+  const float* x2 = g.x2.data(); const float* y2 = g.y2.data();
+  return g.run(max_keep, [=](int i, int j) {
+    const float w = std::max(0.f, std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]));
+    const float h = std::max(0.f, std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]));
+    const float inter = w * h;
+    const float area_i = std::max(0.f, x2[i] - x1[i]) * std::max(0.f, y2[i] - y1[i]);
+    const float area_j = std::max(0.f, x2[j] - x1[j]) * std::max(0.f, y2[j] - y1[j]);
+    return inter / (area_i + area_j - inter + 1e-6f) > iou_thr;
+  });
+}
@@ -0,0 +1,92 @@
+// grid_nms.h  (greedy NMS over a uniform spatial grid, shared by the detection, pose and OBB parsers)
+// Boxes are ranked best first and binned into every cell of a uniform grid that their axis-aligned box covers.
+// The cell side is the median box side, so a typical box lands in one to four cells. A kept box then tests
+// only the boxes that share one of its cells. Two boxes of positive overlap always share a cell, so for any
+// overlap test that needs intersecting boxes (IoU > thr > 0, probiou above kObbDisjointIouMax) the result is
+// exactly that of the all-pairs greedy pass, while crowded frames stay near-linear instead of quadratic.
+// Boxes of different classes never suppress each other unless both are given class -1.
+
+#ifndef __GRID_NMS_H__
+#define __GRID_NMS_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Up to this many boxes the grid is a single cell: the all-pairs pass is cheaper than building it.
+constexpr int kGridNmsMinBoxes = 64;
+// Cells per axis at most, which bounds what a box much larger than the median costs.
+constexpr int kGridNmsMaxCells = 32;
+
+struct GridNms {
+  // Boxes by rank (0 = best) and their class, -1 for every box when class-agnostic.
+  std::vector<float> x1, y1, x2, y2;
+  std::vector<int> cls;
+  // Ranks kept by the last run(), best first.
+  std::vector<int> keep;
+  int count{0};
+
+  // Resets for n boxes. Fill ranks 0..n-1 with set(), then call build() before run().
+  void begin(int n);
+
+  void set(int r, float bx1, float by1, float bx2, float by2, int c) {
+    x1[r] = bx1; y1[r] = by1; x2[r] = bx2; y2[r] = by2; cls[r] = c;
+  }
+
+  void build();
+
+  // Greedy pass in rank order: suppress(i, j) for ranks i < j says whether kept box i removes box j. It is only
+  // asked for pairs of the same class whose boxes share a cell, at most once per pair. Stops once max_keep
+  // boxes are kept (max_keep <= 0: no limit). Leaves the kept ranks in keep and returns their count.
+  template <typename Suppress>
+  int run(int max_keep, Suppress suppress);
+
+ private:
+  std::vector<int> cell_start_;  // gw_ * gh_ + 1 offsets into items_
+  std::vector<int> items_;       // ranks binned per cell, ascending within a cell
+  std::vector<uint16_t> gx0_, gy0_, gx1_, gy1_;  // cells covered by each box
+  std::vector<uint8_t> removed_;
+  std::vector<uint32_t> seen_;   // last kept box that tested this one, so shared cells test a pair once
+  std::vector<float> sides_;
+  uint32_t stamp_{0};
+  int gw_{1}, gh_{1};
+};
+
+// The calling thread's grid (one per nvinfer output thread).
+GridNms& grid_nms();
+
+// Axis-aligned IoU NMS over the boxes of g: fills g.keep and returns the kept count.
+int grid_nms_iou(GridNms& g, float iou_thr, int max_keep);
+
+template <typename Suppress>
+int GridNms::run(int max_keep, Suppress suppress) {
+  const int limit = max_keep > 0 ? std::min(max_keep, count) : count;
+  int kept = 0;
+  for (int i = 0; i < count && kept < limit; ++i) {
+    if (removed_[i]) continue;
+    keep[kept++] = i;
+    if (kept == limit) break;
+    if (++stamp_ == 0) {
+      std::fill(seen_.begin(), seen_.begin() + count, 0);
+      stamp_ = 1;
+    }
+    const int c = cls[i];
+    for (int gy = gy0_[i]; gy <= gy1_[i]; ++gy) {
+      for (int gx = gx0_[i]; gx <= gx1_[i]; ++gx) {
+        const int cell = gy * gw_ + gx;
+        const int* first = items_.data() + cell_start_[cell];
+        const int* last = items_.data() + cell_start_[cell + 1];
+        // Ranks are ascending within a cell, so every better box is skipped in one step.
+        for (const int* it = std::upper_bound(first, last, i); it != last; ++it) {
+          const int j = *it;
+          if (removed_[j] || seen_[j] == stamp_ || cls[j] != c) continue;
+          seen_[j] = stamp_;
+          if (suppress(i, j)) removed_[j] = 1;
+        }
+      }
+    }
+  }
+  return kept;
+}
+
+#endif
@@ -0,0 +1,53 @@
+// half_float.h  (float <-> IEEE fp16 on the host, for the compact pose records, the weights blob, the INT8 tensor
+// cache and the FP16 detection outputs)
+// float_to_half gives the same results as CUDA's __float2half_rn: round to nearest even, subnormal halves kept,
+// values from 65520 up going to infinity and NaN to the quiet NaN 0x7e00 with its sign. bench/kernel_bench
+// --kernel half checks every float against the device conversion.
+
+#ifndef __HALF_FLOAT_H__
+#define __HALF_FLOAT_H__
+
+#include <cstdint>
+#include <cstring>
+
+inline uint16_t float_to_half(float f) {
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  const uint32_t sign = (x >> 16) & 0x8000u;
+  const uint32_t absx = x & 0x7fffffffu;
+  if (absx > 0x7f800000u) return sign | 0x7e00u;
+  if (absx >= 0x477ff000u) return sign | 0x7c00u;
+  if (absx < 0x38800000u) {
+    // Subnormal half: the mantissa with its implicit bit, shifted down by the exponent deficit.
+    if (absx < 0x33000000u) return sign;
+    const uint32_t mant = (absx & 0x7fffffu) | 0x800000u;
+    const uint32_t shift = 126 - (absx >> 23);
+    const uint32_t half = mant >> shift;
+    const uint32_t rest = mant & ((1u << shift) - 1);
+    const uint32_t mid = 1u << (shift - 1);
+    return sign | (half + (rest > mid || (rest == mid && (half & 1u)) ? 1u : 0u));
+  }
+  // Rebias the exponent; a carry out of the mantissa correctly bumps the exponent, up to infinity.
+  const uint32_t half = (absx - 0x38000000u) >> 13;
+  const uint32_t rest = absx & 0x1fffu;
+  return sign | (half + (rest > 0x1000u || (rest == 0x1000u && (half & 1u)) ? 1u : 0u));
+}
+
+// Exact, like every half -> float conversion. The exponent is rebased by a multiply by 2^112, which also scales
+// subnormal halves right and lets loops over it auto-vectorize; infinities and NaNs, payload kept, are the one
+// exponent the multiply cannot reach.
+inline float half_to_float(uint16_t h) {
+  const uint32_t magnitude = static_cast<uint32_t>(h & 0x7fffu) << 13;
+  float f;
+  std::memcpy(&f, &magnitude, sizeof(f));
+  f *= 5.192296858534828e+33f;  // 2^112
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  // Selected with a mask rather than a branch, which would keep the loops from vectorizing.
+  const uint32_t special = 0u - static_cast<uint32_t>((h & 0x7c00u) == 0x7c00u);
+  x = (x & ~special) | ((magnitude | 0x7f800000u) & special) | static_cast<uint32_t>(h & 0x8000u) << 16;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+#endif
@@ -6,11 +6,32 @@
 #include "batchnorm_layer.h"
 
 #include <cassert>
+#include <cstdlib>
 #include <math.h>
 
+#include "weights_blob.h"
+
+void
+batchnormTerms(const float* bnBiases, const float* bnWeights, const float* bnRunningMean, const float* bnRunningVar,
+    float eps, int filters, float* shift, float* scale)
+{
+  for (int i = 0; i < filters; ++i) {
+    const float runningVar = sqrt(bnRunningVar[i] + eps);
+    shift[i] = bnBiases[i] - ((bnRunningMean[i] * bnWeights[i]) / runningVar);
+    scale[i] = bnWeights[i] / runningVar;
+  }
+}
+
+bool
+foldBatchnorm()
+{
+  static const bool fold = !(getenv("YOLO_FOLD_BN") && std::atoi(getenv("YOLO_FOLD_BN")) == 0);
+  return fold;
+}
+
 nvinfer1::ITensor*
-batchnormLayer(int layerIdx, std::map<std::string, std::string>& block, std::vector<float>& weights,
-    std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr, nvinfer1::ITensor* input,
+batchnormLayer(int layerIdx, std::map<std::string, std::string>& block, const WeightsSpan& weights,
+    WeightsArena& arena, int& weightPtr, nvinfer1::ITensor* input,
     nvinfer1::INetworkDefinition* network)
 {
   nvinfer1::ITensor* output;
@@ -26,54 +47,37 @@ batchnormLayer(int layerIdx, std::map<std::string, std::string>& block, std::vec
     eps = std::stof(block.at("eps"));
   }
 
-  std::vector<float> bnBiases;
-  std::vector<float> bnWeights;
-  std::vector<float> bnRunningMean;
-  std::vector<float> bnRunningVar;
-
-  for (int i = 0; i < filters; ++i) {
-    bnBiases.push_back(weights[weightPtr]);
-    ++weightPtr;
-  }
-  for (int i = 0; i < filters; ++i) {
-    bnWeights.push_back(weights[weightPtr]);
-    ++weightPtr;
-  }
-  for (int i = 0; i < filters; ++i) {
-    bnRunningMean.push_back(weights[weightPtr]);
-    ++weightPtr;
-  }
-  for (int i = 0; i < filters; ++i) {
-    bnRunningVar.push_back(sqrt(weights[weightPtr] + eps));
-    ++weightPtr;
-  }
-
   int size = filters;
   nvinfer1::Weights shift {nvinfer1::DataType::kFLOAT, nullptr, size};
   nvinfer1::Weights scale {nvinfer1::DataType::kFLOAT, nullptr, size};
-  nvinfer1::Weights power {nvinfer1::DataType::kFLOAT, nullptr, size};
-
-  float* shiftWt = new float[size];
-  for (int i = 0; i < size; ++i) {
-    shiftWt[i] = bnBiases.at(i) - ((bnRunningMean.at(i) * bnWeights.at(i)) / bnRunningVar.at(i));
+  // Empty power weights mean power 1
+  nvinfer1::Weights power {nvinfer1::DataType::kFLOAT, nullptr, 0};
+
+  WeightsBlob* blob = weights.blob;
+  if (blob != nullptr && blob->mapped()) {
+    shift = blob->tensor(layerIdx, kBlobShift);
+    scale = blob->tensor(layerIdx, kBlobScale);
+    assert(shift.count == size && scale.count == size);
+    weightPtr += blob->consumed(layerIdx);
   }
-  shift.values = shiftWt;
-
-  float* scaleWt = new float[size];
-  for (int i = 0; i < size; ++i) {
-    scaleWt[i] = bnWeights.at(i) / bnRunningVar[i];
+  else {
+    const float* bnBiases = &weights[weightPtr];
+    const float* bnWeights = bnBiases + filters;
+    const float* bnRunningMean = bnWeights + filters;
+    const float* bnRunningVar = bnRunningMean + filters;
+    weightPtr += 4 * filters;
+
+    float* shiftWt = arena.allocate(2 * size);
+    float* scaleWt = shiftWt + size;
+    batchnormTerms(bnBiases, bnWeights, bnRunningMean, bnRunningVar, eps, size, shiftWt, scaleWt);
+    shift.values = shiftWt;
+    scale.values = scaleWt;
   }
-  scale.values = scaleWt;
-
-  float* powerWt = new float[size];
-  for (int i = 0; i < size; ++i) {
-    powerWt[i] = 1.0;
+  if (blob != nullptr) {
+    blob->record(layerIdx, kBlobShift, shift);
+    blob->record(layerIdx, kBlobScale, scale);
+    blob->recordConsumed(layerIdx, 4 * filters);
   }
-  power.values = powerWt;
-
-  trtWeights.push_back(shift);
-  trtWeights.push_back(scale);
-  trtWeights.push_back(power);
 
   nvinfer1::IScaleLayer* batchnorm = network->addScale(*input, nvinfer1::ScaleMode::kCHANNEL, shift, scale, power);
   assert(batchnorm != nullptr);
@@ -12,9 +12,19 @@
 #include "NvInfer.h"
 
 #include "activation_layer.h"
+#include "weights_span.h"
 
-nvinfer1::ITensor* batchnormLayer(int layerIdx, std::map<std::string, std::string>& block, std::vector<float>& weights,
-    std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr, nvinfer1::ITensor* input,
+// Inference-time batchnorm of `filters` channels as y = scale * x + shift, from the Darknet terms (biases,
+// scales, running means, running variances, in file order).
+void batchnormTerms(const float* bnBiases, const float* bnWeights, const float* bnRunningMean,
+    const float* bnRunningVar, float eps, int filters, float* shift, float* scale);
+
+// Whether conv / deconv blocks with batch_normalize=1 fold the batchnorm into their kernel and bias instead of
+// adding an IScaleLayer after them (YOLO_FOLD_BN, default on; read once).
+bool foldBatchnorm();
+
+nvinfer1::ITensor* batchnormLayer(int layerIdx, std::map<std::string, std::string>& block, const WeightsSpan& weights,
+    WeightsArena& arena, int& weightPtr, nvinfer1::ITensor* input,
     nvinfer1::INetworkDefinition* network);
 
 #endif
@@ -6,11 +6,13 @@
 #include "convolutional_layer.h"
 
 #include <cassert>
-#include <math.h>
+
+#include "batchnorm_layer.h"
+#include "weights_blob.h"
 
 nvinfer1::ITensor*
-convolutionalLayer(int layerIdx, std::map<std::string, std::string>& block, std::vector<float>& weights,
-    std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr, int& inputChannels, nvinfer1::ITensor* input,
+convolutionalLayer(int layerIdx, std::map<std::string, std::string>& block, const WeightsSpan& weights,
+    WeightsArena& arena, int& weightPtr, int& inputChannels, nvinfer1::ITensor* input,
     nvinfer1::INetworkDefinition* network, std::string layerName)
 {
   nvinfer1::ITensor* output;
@@ -59,67 +61,66 @@ convolutionalLayer(int layerIdx, std::map<std::string, std::string>& block, std:
   }
 
   int size = filters * inputChannels * kernelSize * kernelSize / groups;
-  std::vector<float> bnBiases;
-  std::vector<float> bnWeights;
-  std::vector<float> bnRunningMean;
-  std::vector<float> bnRunningVar;
   nvinfer1::Weights convWt {nvinfer1::DataType::kFLOAT, nullptr, size};
   nvinfer1::Weights convBias {nvinfer1::DataType::kFLOAT, nullptr, bias};
 
-  if (batchNormalize == 0) {
-    float* val;
-    if (bias != 0) {
-      val = new float[filters];
-      for (int i = 0; i < filters; ++i) {
-          val[i] = weights[weightPtr];
-          ++weightPtr;
-      }
-      convBias.values = val;
-      trtWeights.push_back(convBias);
-    }
-    val = new float[size];
-    for (int i = 0; i < size; ++i) {
-        val[i] = weights[weightPtr];
-        ++weightPtr;
-    }
-    convWt.values = val;
-    trtWeights.push_back(convWt);
+  // File order: [bias], weights without batchnorm; bn biases, scales, means, variances, [bias], weights with it.
+  // Bias and kernel weights are used in place unless the batchnorm is folded into them.
+  WeightsBlob* blob = weights.blob;
+  const int firstWeight = weightPtr;
+  const bool fold = batchNormalize == 1 && foldBatchnorm();
+  const float* bnBiases = nullptr;
+  const float* bnWeights = nullptr;
+  const float* bnRunningMean = nullptr;
+  const float* bnRunningVar = nullptr;
+  if (blob != nullptr && blob->mapped()) {
+    // As the recording build handed them to TensorRT: batchnorm folded, scale terms computed
+    convWt = blob->tensor(layerIdx, kBlobKernel);
+    convBias = blob->tensor(layerIdx, kBlobBias);
+    assert(convWt.count == size);
+    weightPtr += blob->consumed(layerIdx);
   }
   else {
-    for (int i = 0; i < filters; ++i) {
-      bnBiases.push_back(weights[weightPtr]);
-      ++weightPtr;
+    if (batchNormalize != 0) {
+      bnBiases = &weights[weightPtr];
+      bnWeights = bnBiases + filters;
+      bnRunningMean = bnWeights + filters;
+      bnRunningVar = bnRunningMean + filters;
+      weightPtr += 4 * filters;
     }
-    for (int i = 0; i < filters; ++i) {
-      bnWeights.push_back(weights[weightPtr]);
-      ++weightPtr;
-    }
-    for (int i = 0; i < filters; ++i) {
-      bnRunningMean.push_back(weights[weightPtr]);
-      ++weightPtr;
-    }
-    for (int i = 0; i < filters; ++i) {
-      bnRunningVar.push_back(sqrt(weights[weightPtr] + eps));
-      ++weightPtr;
-    }
-    float* val;
     if (bias != 0) {
-      val = new float[filters];
-      for (int i = 0; i < filters; ++i) {
-        val[i] = weights[weightPtr];
-        ++weightPtr;
-      }
-      convBias.values = val;
-    }
-    val = new float[size];
-    for (int i = 0; i < size; ++i) {
-      val[i] = weights[weightPtr];
-      ++weightPtr;
+      convBias.values = &weights[weightPtr];
+      weightPtr += filters;
     }
-    convWt.values = val;
-    trtWeights.push_back(convWt);
-    if (bias != 0) {
-      trtWeights.push_back(convBias);
+    const float* kernel = &weights[weightPtr];
+    convWt.values = kernel;
+    weightPtr += size;
+
+    // Batchnorm folded into the layer (YOLO_FOLD_BN): w' = w * scale and b' = b * scale + shift per filter. Costs a
+    // copy of the kernel in the arena and saves the IScaleLayer, which TensorRT does not always fuse (INT8,
+    // precision constraints) and which keeps the activation from fusing into the convolution.
+    if (fold) {
+      float* shiftWt = arena.allocate(3 * filters);
+      float* scaleWt = shiftWt + filters;
+      float* foldedBias = scaleWt + filters;
+      batchnormTerms(bnBiases, bnWeights, bnRunningMean, bnRunningVar, eps, filters, shiftWt, scaleWt);
+      const float* convBiasWt = static_cast<const float*>(convBias.values);
+      for (int f = 0; f < filters; ++f) {
+        foldedBias[f] = shiftWt[f] + (convBiasWt ? convBiasWt[f] * scaleWt[f] : 0.f);
+      }
+      float* foldedWt = arena.allocate(size);
+      // Kernel is [filters][input channels / groups][size][size]; scaled in runs of filters by arena.prepare()
+      const int perFilter = size / filters;
+      arena.defer(filters, perFilter, [=](int first, int last) {
+        for (int f = first; f < last; ++f) {
+          for (int j = 0; j < perFilter; ++j) {
+            foldedWt[f * perFilter + j] = kernel[f * perFilter + j] * scaleWt[f];
+          }
+        }
+      });
+      convWt.values = foldedWt;
+      convBias.values = foldedBias;
+      convBias.count = filters;
     }
   }
 
@@ -137,33 +138,34 @@ convolutionalLayer(int layerIdx, std::map<std::string, std::string>& block, std:
 
   output = conv->getOutput(0);
 
-  if (batchNormalize == 1) {
+  if (blob != nullptr) {
+    blob->record(layerIdx, kBlobKernel, convWt);
+    blob->record(layerIdx, kBlobBias, convBias);
+  }
+
+  if (batchNormalize == 1 && !fold) {
     size = filters;
     nvinfer1::Weights shift {nvinfer1::DataType::kFLOAT, nullptr, size};
     nvinfer1::Weights scale {nvinfer1::DataType::kFLOAT, nullptr, size};
-    nvinfer1::Weights power {nvinfer1::DataType::kFLOAT, nullptr, size};
+    // Empty power weights mean power 1
+    nvinfer1::Weights power {nvinfer1::DataType::kFLOAT, nullptr, 0};
 
-    float* shiftWt = new float[size];
-    for (int i = 0; i < size; ++i) {
-      shiftWt[i] = bnBiases.at(i) - ((bnRunningMean.at(i) * bnWeights.at(i)) / bnRunningVar.at(i));
+    if (blob != nullptr && blob->mapped()) {
+      shift = blob->tensor(layerIdx, kBlobShift);
+      scale = blob->tensor(layerIdx, kBlobScale);
+      assert(shift.count == size && scale.count == size);
     }
-    shift.values = shiftWt;
-
-    float* scaleWt = new float[size];
-    for (int i = 0; i < size; ++i) {
-      scaleWt[i] = bnWeights.at(i) / bnRunningVar[i];
+    else {
+      float* shiftWt = arena.allocate(2 * size);
+      float* scaleWt = shiftWt + size;
+      batchnormTerms(bnBiases, bnWeights, bnRunningMean, bnRunningVar, eps, size, shiftWt, scaleWt);
+      shift.values = shiftWt;
+      scale.values = scaleWt;
     }
-    scale.values = scaleWt;
-
-    float* powerWt = new float[size];
-    for (int i = 0; i < size; ++i) {
-      powerWt[i] = 1.0;
+    if (blob != nullptr) {
+      blob->record(layerIdx, kBlobShift, shift);
+      blob->record(layerIdx, kBlobScale, scale);
     }
-    power.values = powerWt;
-
-    trtWeights.push_back(shift);
-    trtWeights.push_back(scale);
-    trtWeights.push_back(power);
 
     nvinfer1::IScaleLayer* batchnorm = network->addScale(*output, nvinfer1::ScaleMode::kCHANNEL, shift, scale, power);
     assert(batchnorm != nullptr);
@@ -172,6 +174,10 @@ convolutionalLayer(int layerIdx, std::map<std::string, std::string>& block, std:
     output = batchnorm->getOutput(0);
   }
 
+  if (blob != nullptr) {
+    blob->recordConsumed(layerIdx, weightPtr - firstWeight);
+  }
+
   output = activationLayer(layerIdx, activation, output, network, layerName);
   assert(output != nullptr);
 
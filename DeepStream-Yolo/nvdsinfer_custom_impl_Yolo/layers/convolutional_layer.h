@@ -12,9 +12,10 @@
 #include "NvInfer.h"
 
 #include "activation_layer.h"
+#include "weights_span.h"
 
 nvinfer1::ITensor* convolutionalLayer(int layerIdx, std::map<std::string, std::string>& block,
-    std::vector<float>& weights, std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr, int& inputChannels,
+    const WeightsSpan& weights, WeightsArena& arena, int& weightPtr, int& inputChannels,
     nvinfer1::ITensor* input, nvinfer1::INetworkDefinition* network, std::string layerName = "");
 
 #endif
@@ -7,9 +7,11 @@
 
 #include <cassert>
 
+#include "weights_blob.h"
+
 nvinfer1::ITensor*
-implicitLayer(int layerIdx, std::map<std::string, std::string>& block, std::vector<float>& weights,
-    std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr, nvinfer1::INetworkDefinition* network)
+implicitLayer(int layerIdx, std::map<std::string, std::string>& block, const WeightsSpan& weights,
+    int& weightPtr, nvinfer1::INetworkDefinition* network)
 {
   nvinfer1::ITensor* output;
 
@@ -20,13 +22,19 @@ implicitLayer(int layerIdx, std::map<std::string, std::string>& block, std::vect
 
   nvinfer1::Weights convWt {nvinfer1::DataType::kFLOAT, nullptr, filters};
 
-  float* val = new float[filters];
-  for (int i = 0; i < filters; ++i) {
-    val[i] = weights[weightPtr];
-    ++weightPtr;
+  WeightsBlob* blob = weights.blob;
+  if (blob != nullptr && blob->mapped()) {
+    convWt = blob->tensor(layerIdx, kBlobConstant);
+    assert(convWt.count == filters);
+  }
+  else {
+    convWt.values = &weights[weightPtr];
+  }
+  weightPtr += filters;
+  if (blob != nullptr) {
+    blob->record(layerIdx, kBlobConstant, convWt);
+    blob->recordConsumed(layerIdx, filters);
   }
-  convWt.values = val;
-  trtWeights.push_back(convWt);
 
   nvinfer1::IConstantLayer* implicit = network->addConstant(nvinfer1::Dims{4, {1, filters, 1, 1}}, convWt);
   assert(implicit != nullptr);
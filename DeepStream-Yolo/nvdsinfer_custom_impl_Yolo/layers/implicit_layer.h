@@ -12,7 +12,9 @@
 
 #include "NvInfer.h"
 
-nvinfer1::ITensor* implicitLayer(int layerIdx, std::map<std::string, std::string>& block, std::vector<float>& weights,
-    std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr, nvinfer1::INetworkDefinition* network);
+#include "weights_span.h"
+
+nvinfer1::ITensor* implicitLayer(int layerIdx, std::map<std::string, std::string>& block, const WeightsSpan& weights,
+    int& weightPtr, nvinfer1::INetworkDefinition* network);
 
 #endif
@@ -0,0 +1,334 @@
+/*
+ * Created by Marcos Luciano
+ * https://www.github.com/marcoslucianops
+ */
+
+#include "weights_blob.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../half_float.h"
+#include "batchnorm_layer.h"
+
+namespace {
+
+constexpr char kBlobMagic[4] = {'S', 'Q', 'W', 'B'};
+constexpr uint32_t kBlobVersion = 1;
+constexpr uint32_t kBlobFlagFold = 1;
+constexpr uint32_t kBlobFlagFp16 = 2;
+constexpr size_t kBlobAlign = 64;
+
+constexpr uint32_t kBlobFloat = 0;
+constexpr uint32_t kBlobHalf = 1;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t flags;
+  uint32_t tensors;
+  uint64_t weightsSize;
+  int64_t weightsMtime;
+  uint64_t cfgHash;
+  uint64_t consumed;
+  uint8_t reserved[16];
+};
+static_assert(sizeof(Header) == 64, "blob header must be 64 bytes");
+
+bool
+fp16Blob()
+{
+  static const bool fp16 = getenv("YOLO_WEIGHTS_BLOB_FP16") && std::atoi(getenv("YOLO_WEIGHTS_BLOB_FP16")) == 1;
+  return fp16;
+}
+
+// FNV-1a of the cfg file, so an edited cfg (other filters, layers) never picks up a stale blob
+uint64_t
+cfgHash(const std::string& cfgPath)
+{
+  std::ifstream file(cfgPath, std::ios::binary);
+  uint64_t h = 1469598103934665603ull;
+  for (std::istreambuf_iterator<char> it(file), end; it != end; ++it) {
+    h = (h ^ static_cast<uint8_t>(*it)) * 1099511628211ull;
+  }
+  return h;
+}
+
+bool
+weightsStat(const std::string& weightsPath, uint64_t& size, int64_t& mtime)
+{
+  struct stat st;
+  if (stat(weightsPath.c_str(), &st) != 0) {
+    return false;
+  }
+  size = st.st_size;
+  mtime = static_cast<int64_t>(st.st_mtime);
+  return true;
+}
+
+
+size_t
+alignUp(size_t n)
+{
+  return (n + kBlobAlign - 1) / kBlobAlign * kBlobAlign;
+}
+
+} // namespace
+
+WeightsBlob::~WeightsBlob()
+{
+  close();
+}
+
+void
+WeightsBlob::close()
+{
+  if (m_Map != nullptr) {
+    munmap(m_Map, m_MapSize);
+  }
+  m_Map = nullptr;
+  m_MapSize = 0;
+  m_Entries = nullptr;
+  m_Index.clear();
+  m_TotalConsumed = 0;
+  m_Recording = false;
+  m_Recorded.clear();
+}
+
+bool
+WeightsBlob::open(const std::string& blobPath, const std::string& weightsPath, const std::string& cfgPath)
+{
+  close();
+
+  uint64_t weightsSize = 0;
+  int64_t weightsMtime = 0;
+  if (!weightsStat(weightsPath, weightsSize, weightsMtime)) {
+    return false;
+  }
+
+  const int fd = ::open(blobPath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  m_Map = map;
+  m_MapSize = st.st_size;
+
+  const Header* header = static_cast<const Header*>(m_Map);
+  const uint32_t flags = (foldBatchnorm() ? kBlobFlagFold : 0) | (fp16Blob() ? kBlobFlagFp16 : 0);
+  std::string stale;
+  if (std::memcmp(header->magic, kBlobMagic, sizeof(kBlobMagic)) != 0 || header->version != kBlobVersion) {
+    stale = "not a version " + std::to_string(kBlobVersion) + " weights blob";
+  }
+  else if (header->weightsSize != weightsSize || header->weightsMtime != weightsMtime) {
+    stale = "the weights file changed";
+  }
+  else if (header->cfgHash != cfgHash(cfgPath)) {
+    stale = "the cfg file changed";
+  }
+  else if (header->flags != flags) {
+    stale = "YOLO_FOLD_BN or YOLO_WEIGHTS_BLOB_FP16 changed";
+  }
+  else if (m_MapSize < sizeof(Header) + (size_t) header->tensors * sizeof(Entry)) {
+    stale = "the entry table is truncated";
+  }
+  if (!stale.empty()) {
+    std::cout << "Weights blob " << blobPath << " is stale (" << stale << "), rebuilding it" << std::endl;
+    close();
+    return false;
+  }
+
+  m_Entries = reinterpret_cast<const Entry*>(static_cast<const char*>(m_Map) + sizeof(Header));
+  int layers = 0;
+  for (uint32_t i = 0; i < header->tensors; ++i) {
+    const Entry& e = m_Entries[i];
+    const size_t bytes = e.kind == kBlobConsumed ? 0 :
+        (size_t) e.count * (e.type == kBlobHalf ? sizeof(uint16_t) : sizeof(float));
+    if (e.layer < 0 || e.kind >= kBlobKinds || e.offset % kBlobAlign != 0 || e.offset > m_MapSize ||
+        bytes > m_MapSize - e.offset) {
+      std::cerr << "WARNING: Weights blob " << blobPath << " has an invalid entry, rebuilding it" << std::endl;
+      close();
+      return false;
+    }
+    layers = std::max(layers, e.layer + 1);
+  }
+  m_Index.assign((size_t) layers * kBlobKinds, -1);
+  for (uint32_t i = 0; i < header->tensors; ++i) {
+    m_Index[(size_t) m_Entries[i].layer * kBlobKinds + m_Entries[i].kind] = i;
+  }
+  m_TotalConsumed = header->consumed;
+
+  // Each layer reads its tensors once, front to back
+  madvise(m_Map, m_MapSize, MADV_SEQUENTIAL | MADV_WILLNEED);
+  std::cout << "\nLoading pre-trained weights from blob " << blobPath << " (" << header->tensors << " tensors, " <<
+      m_MapSize / (1024 * 1024) << " MB)" << std::endl;
+  return true;
+}
+
+void
+WeightsBlob::beginRecord()
+{
+  close();
+  m_Recording = true;
+}
+
+int
+WeightsBlob::find(int layerIdx, BlobTensorKind kind) const
+{
+  const size_t slot = (size_t) layerIdx * kBlobKinds + kind;
+  return layerIdx >= 0 && slot < m_Index.size() ? m_Index[slot] : -1;
+}
+
+nvinfer1::Weights
+WeightsBlob::tensor(int layerIdx, BlobTensorKind kind) const
+{
+  nvinfer1::Weights w {nvinfer1::DataType::kFLOAT, nullptr, 0};
+  const int i = find(layerIdx, kind);
+  if (i < 0) {
+    return w;
+  }
+  const Entry& e = m_Entries[i];
+  w.type = e.type == kBlobHalf ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kFLOAT;
+  w.values = e.count > 0 ? static_cast<const char*>(m_Map) + e.offset : nullptr;
+  w.count = e.count;
+  return w;
+}
+
+int
+WeightsBlob::consumed(int layerIdx) const
+{
+  const int i = find(layerIdx, kBlobConsumed);
+  return i < 0 ? 0 : (int) m_Entries[i].count;
+}
+
+void
+WeightsBlob::record(int layerIdx, BlobTensorKind kind, const nvinfer1::Weights& weights)
+{
+  if (!m_Recording || weights.count <= 0) {
+    return;
+  }
+  const bool half = fp16Blob() && (kind == kBlobKernel || kind == kBlobBias);
+  Recorded r;
+  r.entry = Entry {layerIdx, kind, half ? kBlobHalf : kBlobFloat, (uint32_t) weights.count, 0};
+  r.values = weights.values;
+  m_Recorded.push_back(r);
+}
+
+void
+WeightsBlob::recordConsumed(int layerIdx, int count)
+{
+  if (!m_Recording) {
+    return;
+  }
+  Recorded r;
+  r.entry = Entry {layerIdx, kBlobConsumed, kBlobFloat, (uint32_t) count, 0};
+  r.values = nullptr;
+  m_Recorded.push_back(r);
+}
+
+bool
+WeightsBlob::write(const std::string& blobPath, const std::string& weightsPath, const std::string& cfgPath) const
+{
+  if (!m_Recording) {
+    return false;
+  }
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kBlobMagic, sizeof(kBlobMagic));
+  header.version = kBlobVersion;
+  header.flags = (foldBatchnorm() ? kBlobFlagFold : 0) | (fp16Blob() ? kBlobFlagFp16 : 0);
+  header.tensors = m_Recorded.size();
+  if (!weightsStat(weightsPath, header.weightsSize, header.weightsMtime)) {
+    return false;
+  }
+  header.cfgHash = cfgHash(cfgPath);
+
+  std::vector<Entry> entries;
+  entries.reserve(m_Recorded.size());
+  size_t offset = alignUp(sizeof(Header) + m_Recorded.size() * sizeof(Entry));
+  for (const Recorded& r : m_Recorded) {
+    Entry e = r.entry;
+    if (e.kind == kBlobConsumed) {
+      header.consumed += e.count;
+    }
+    else {
+      e.offset = offset;
+      offset = alignUp(offset + (size_t) e.count * (e.type == kBlobHalf ? sizeof(uint16_t) : sizeof(float)));
+    }
+    entries.push_back(e);
+  }
+
+  const std::string tmpPath = blobPath + ".tmp";
+  FILE* file = fopen(tmpPath.c_str(), "wb");
+  if (file == nullptr) {
+    std::cerr << "WARNING: Could not write the weights blob " << tmpPath << std::endl;
+    return false;
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+      fwrite(entries.data(), sizeof(Entry), entries.size(), file) == entries.size();
+  std::vector<uint16_t> half;
+  static const char zeros[kBlobAlign] = {};
+  size_t pos = sizeof(Header) + entries.size() * sizeof(Entry);
+  for (size_t i = 0; ok && i < entries.size(); ++i) {
+    const Entry& e = entries[i];
+    if (e.kind == kBlobConsumed || e.count == 0) {
+      continue;
+    }
+    ok = fwrite(zeros, 1, e.offset - pos, file) == e.offset - pos;
+    const float* values = static_cast<const float*>(m_Recorded[i].values);
+    if (e.type == kBlobHalf) {
+      half.resize(e.count);
+      for (uint32_t j = 0; j < e.count; ++j) {
+        half[j] = float_to_half(values[j]);
+      }
+      ok = ok && fwrite(half.data(), sizeof(uint16_t), e.count, file) == e.count;
+      pos = e.offset + e.count * sizeof(uint16_t);
+    }
+    else {
+      ok = ok && fwrite(values, sizeof(float), e.count, file) == e.count;
+      pos = e.offset + e.count * sizeof(float);
+    }
+  }
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(tmpPath.c_str(), blobPath.c_str()) != 0) {
+    std::cerr << "WARNING: Could not write the weights blob " << blobPath << std::endl;
+    remove(tmpPath.c_str());
+    return false;
+  }
+  std::cout << "Weights blob written to " << blobPath << " (" << header.tensors << " tensors, " <<
+      offset / (1024 * 1024) << " MB)\n" << std::endl;
+  return true;
+}
+
+bool
+weightsBlobEnabled()
+{
+  static const bool enabled = getenv("YOLO_WEIGHTS_BLOB") && std::atoi(getenv("YOLO_WEIGHTS_BLOB")) == 1;
+  return enabled;
+}
+
+std::string
+weightsBlobPath(const std::string& weightsPath)
+{
+  return weightsPath + ".blob";
+}
@@ -0,0 +1,101 @@
+/*
+ * Created by Marcos Luciano
+ * https://www.github.com/marcoslucianops
+ */
+
+#ifndef __WEIGHTS_BLOB_H__
+#define __WEIGHTS_BLOB_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NvInfer.h"
+
+// Packed, indexed copy of the weights a Darknet network hands to TensorRT (YOLO_WEIGHTS_BLOB=1). The first build
+// of a cfg records, per layer, the exact tensors the builders pass on (kernels and biases with the batchnorm
+// already folded, scale layer terms, implicit constants) and the number of .weights floats the layer consumed,
+// and writes them to `<weights>.blob` next to the .weights file. Later builds map the blob and take every
+// layer's tensors straight from it, so the .weights file is neither read nor re-sliced and nothing is folded
+// again.
+//
+// Layout: a 64 byte header (magic "SQWB", version, flags, tensor count, the .weights size and mtime, a hash of the
+// cfg, total floats consumed), a table of 24 byte entries (layer, kind, data type, count, offset), then the
+// tensors, each starting on a 64 byte boundary. A blob is only used when the header matches the .weights file,
+// the cfg and the YOLO_FOLD_BN setting; otherwise it is rewritten by the build. YOLO_WEIGHTS_BLOB_FP16=1 stores
+// convolution and deconvolution kernels and biases as FP16, which halves the blob; scale and implicit terms stay
+// FP32.
+
+enum BlobTensorKind : uint32_t {
+  kBlobKernel = 0,
+  kBlobBias = 1,
+  kBlobShift = 2,
+  kBlobScale = 3,
+  kBlobConstant = 4,
+  kBlobConsumed = 5,  // no data: count = .weights floats the layer consumed
+  kBlobKinds = 6
+};
+
+class WeightsBlob {
+  public:
+    WeightsBlob() = default;
+    ~WeightsBlob();
+    WeightsBlob(const WeightsBlob&) = delete;
+    WeightsBlob& operator=(const WeightsBlob&) = delete;
+
+    // Maps blobPath when it was written from weightsPath and cfgPath with the current YOLO_FOLD_BN setting.
+    bool open(const std::string& blobPath, const std::string& weightsPath, const std::string& cfgPath);
+    // Starts recording the tensors of a build from the .weights file.
+    void beginRecord();
+    // Unmaps the blob and drops what was recorded. The tensors handed out must no longer be needed.
+    void close();
+
+    bool mapped() const { return m_Map != nullptr; }
+    bool recording() const { return m_Recording; }
+
+    // Tensor `kind` of layer `layerIdx` in the mapped blob; count 0 and no values when the layer has none.
+    nvinfer1::Weights tensor(int layerIdx, BlobTensorKind kind) const;
+    // .weights floats layer `layerIdx` consumed when the blob was recorded.
+    int consumed(int layerIdx) const;
+    // .weights floats the whole network consumed.
+    size_t totalConsumed() const { return m_TotalConsumed; }
+
+    // While recording: the tensor as it goes to TensorRT; it must stay valid until write().
+    void record(int layerIdx, BlobTensorKind kind, const nvinfer1::Weights& weights);
+    void recordConsumed(int layerIdx, int count);
+    // Writes what was recorded to blobPath (through a temporary file renamed into place).
+    bool write(const std::string& blobPath, const std::string& weightsPath, const std::string& cfgPath) const;
+
+  private:
+    struct Entry {
+      int32_t layer;
+      uint32_t kind;
+      uint32_t type;
+      uint32_t count;
+      uint64_t offset;
+    };
+
+    struct Recorded {
+      Entry entry;
+      const void* values;
+    };
+
+    int find(int layerIdx, BlobTensorKind kind) const;
+
+    void* m_Map = nullptr;
+    size_t m_MapSize = 0;
+    const Entry* m_Entries = nullptr;
+    std::vector<int> m_Index;  // kBlobKinds slots per layer, entry index or -1
+    size_t m_TotalConsumed = 0;
+
+    bool m_Recording = false;
+    std::vector<Recorded> m_Recorded;
+};
+
+// YOLO_WEIGHTS_BLOB=1, read once.
+bool weightsBlobEnabled();
+
+// `<weights>.blob`, next to the .weights file.
+std::string weightsBlobPath(const std::string& weightsPath);
+
+#endif
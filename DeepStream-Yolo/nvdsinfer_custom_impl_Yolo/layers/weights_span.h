@@ -0,0 +1,92 @@
+/*
+ * Created by Marcos Luciano
+ * https://www.github.com/marcoslucianops
+ */
+
+#ifndef __WEIGHTS_SPAN_H__
+#define __WEIGHTS_SPAN_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../mem_budget.h"
+#include "../parser_pool.h"
+
+class WeightsBlob;
+
+// Read-only view of the Darknet weights the layer builders consume in order; the storage is owned elsewhere
+// (DarknetWeights in utils.h maps it straight from the .weights file). Builders hand slices of it to TensorRT
+// as they are, so the mapping must outlive the engine build. With a weights blob (weights_blob.h) the builders
+// take their tensors from the mapped blob instead and data is null, or record them into it while recording.
+struct WeightsSpan {
+  const float* data = nullptr;
+  size_t count = 0;
+  WeightsBlob* blob = nullptr;
+
+  size_t size() const { return count; }
+
+  const float& operator[](const size_t& i) const { return data[i]; }
+};
+
+// Bump allocator for the weights the builders compute (folded batchnorm shift / scale). Memory is taken in
+// large chunks and released all at once by clear(), so a network needs a handful of allocations, not one per
+// layer and tensor. The chunks are tracked as host memory of the build (mem_budget.h).
+// The bulk of the work (scaling every kernel weight) is deferred: TensorRT only reads nvinfer1::Weights values when
+// it builds the engine, so the builders define their layers on arena memory, queue the fill with defer(), and
+// prepare() runs the queue on the parser pool once the whole network is defined.
+class WeightsArena {
+  public:
+    ~WeightsArena() { clear(); }
+
+    float* allocate(const size_t& count) {
+      if (m_Chunks.empty() || m_Used + count > m_ChunkSize) {
+        m_ChunkSize = count > kChunkFloats ? count : kChunkFloats;
+        m_Chunks.emplace_back(new float[m_ChunkSize]);
+        m_Used = 0;
+        m_Allocated += m_ChunkSize * sizeof(float);
+        mem_track(kMemBuild, kMemHost, m_ChunkSize * sizeof(float));
+      }
+      float* p = m_Chunks.back().get() + m_Used;
+      m_Used += count;
+      return p;
+    }
+
+    // Queues fn(first, last) over [0, rows) in runs of about kJobFloats floats, rows of rowFloats floats each.
+    void defer(const int& rows, const int& rowFloats, const std::function<void(int, int)>& fn) {
+      const int step = std::max(1, static_cast<int>(kJobFloats / std::max(rowFloats, 1)));
+      for (int first = 0; first < rows; first += step) {
+        const int last = std::min(rows, first + step);
+        m_Jobs.push_back([fn, first, last] { fn(first, last); });
+      }
+    }
+
+    // Runs the deferred work in parallel and returns when all of it is done.
+    void prepare() {
+      parallel_for(static_cast<int>(m_Jobs.size()), [this](int i) { m_Jobs[i](); });
+      m_Jobs.clear();
+    }
+
+    void clear() {
+      m_Jobs.clear();
+      mem_release(kMemBuild, kMemHost, m_Allocated);
+      m_Allocated = 0;
+      m_Chunks.clear();
+      m_ChunkSize = 0;
+      m_Used = 0;
+    }
+
+  private:
+    static constexpr size_t kChunkFloats = 1 << 20;
+    static constexpr size_t kJobFloats = 1 << 18;
+
+    std::vector<std::unique_ptr<float[]>> m_Chunks;
+    size_t m_ChunkSize = 0;
+    size_t m_Used = 0;
+    size_t m_Allocated = 0;
+    std::vector<std::function<void()>> m_Jobs;
+};
+
+#endif
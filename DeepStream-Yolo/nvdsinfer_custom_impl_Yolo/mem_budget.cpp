@@ -0,0 +1,183 @@
+// mem_budget.cpp
+
+#include "mem_budget.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#include "parser_log.h"
+
+namespace {
+
+const char* const kComponentNames[kMemComponents] = {"parsers", "plugin", "calibrator", "build"};
+const char* const kKindNames[kMemKinds] = {"device", "pinned", "host"};
+
+struct Block {
+  MemComponent component;
+  size_t bytes;
+};
+
+struct Accounts {
+  std::mutex mutex;
+  uint64_t current[kMemComponents][kMemKinds] = {};
+  uint64_t peak[kMemComponents][kMemKinds] = {};
+  uint64_t total[kMemKinds] = {};
+  uint64_t total_peak[kMemKinds] = {};
+  uint64_t refused = 0;
+  std::unordered_map<void*, Block> blocks[kMemKinds];  // device and pinned blocks, for the frees
+};
+
+// Never destroyed: thread_local buffers still free their blocks while the process exits.
+Accounts& accounts() {
+  static Accounts* a = new Accounts();
+  return *a;
+}
+
+// SQUEAKVIEW_MEM_BUDGET, in bytes per kind.
+const uint64_t* budgets() {
+  static uint64_t b[kMemKinds] = {};
+  static std::once_flag once;
+  std::call_once(once, [] {
+    const char* v = std::getenv("SQUEAKVIEW_MEM_BUDGET");
+    while (v && *v) {
+      const char* eq = std::strchr(v, '=');
+      if (!eq) break;
+      char* end = nullptr;
+      const double mib = std::strtod(eq + 1, &end);
+      if (end == eq + 1) break;
+      for (int k = 0; k < kMemKinds; ++k) {
+        if (std::strncmp(v, kKindNames[k], eq - v) == 0 && std::strlen(kKindNames[k]) == size_t(eq - v)) {
+          b[k] = mib > 0 ? static_cast<uint64_t>(mib * 1024 * 1024) : 0;
+        }
+      }
+      v = *end == ',' ? end + 1 : end;
+    }
+    if (b[kMemDevice] || b[kMemPinned] || b[kMemHost]) {
+      PARSER_LOG(kLogInfo, "[mem] budgets: device %llu MiB, pinned %llu MiB, host %llu MiB (0 = none)",
+                 (unsigned long long) (b[kMemDevice] >> 20), (unsigned long long) (b[kMemPinned] >> 20),
+                 (unsigned long long) (b[kMemHost] >> 20));
+    }
+  });
+  return b;
+}
+
+// Caller holds the mutex.
+bool charge_locked(Accounts& a, MemComponent c, MemKind k, size_t bytes, bool check) {
+  const uint64_t budget = budgets()[k];
+  if (check && budget && a.total[k] + bytes > budget) {
+    ++a.refused;
+    PARSER_LOG_EVERY_MS(kLogWarn, 1000, "[mem] %s budget refused %zu bytes for %s (%llu of %llu MiB in use)",
+                        kKindNames[k], bytes, kComponentNames[c], (unsigned long long) (a.total[k] >> 20),
+                        (unsigned long long) (budget >> 20));
+    return false;
+  }
+  a.current[c][k] += bytes;
+  a.total[k] += bytes;
+  if (a.current[c][k] > a.peak[c][k]) a.peak[c][k] = a.current[c][k];
+  if (a.total[k] > a.total_peak[k]) a.total_peak[k] = a.total[k];
+  return true;
+}
+
+void release_locked(Accounts& a, MemComponent c, MemKind k, size_t bytes) {
+  a.current[c][k] -= bytes < a.current[c][k] ? bytes : a.current[c][k];
+  a.total[k] -= bytes < a.total[k] ? bytes : a.total[k];
+}
+
+template <typename Alloc>
+cudaError_t alloc_block(void** ptr, size_t bytes, MemComponent c, MemKind k, Alloc alloc) {
+  *ptr = nullptr;
+  Accounts& a = accounts();
+  {
+    std::lock_guard<std::mutex> lock(a.mutex);
+    if (!charge_locked(a, c, k, bytes, true)) return cudaErrorMemoryAllocation;
+  }
+  const cudaError_t err = alloc(ptr, bytes);
+  std::lock_guard<std::mutex> lock(a.mutex);
+  if (err != cudaSuccess) {
+    *ptr = nullptr;
+    release_locked(a, c, k, bytes);
+    return err;
+  }
+  a.blocks[k][*ptr] = Block{c, bytes};
+  return cudaSuccess;
+}
+
+// Removes ptr from the accounts; false when it is not a block of kind k.
+bool forget_block(void* ptr, MemKind k) {
+  Accounts& a = accounts();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  auto it = a.blocks[k].find(ptr);
+  if (it == a.blocks[k].end()) return false;
+  release_locked(a, it->second.component, k, it->second.bytes);
+  a.blocks[k].erase(it);
+  return true;
+}
+
+} // namespace
+
+cudaError_t mem_device_alloc(void** ptr, size_t bytes, MemComponent component) {
+  return alloc_block(ptr, bytes, component, kMemDevice,
+                     [](void** p, size_t n) { return cudaMalloc(p, n); });
+}
+
+cudaError_t mem_pinned_alloc(void** ptr, size_t bytes, MemComponent component) {
+  return alloc_block(ptr, bytes, component, kMemPinned,
+                     [](void** p, size_t n) { return cudaHostAlloc(p, n, cudaHostAllocDefault); });
+}
+
+void mem_device_free(void* ptr) {
+  if (!ptr) return;
+  forget_block(ptr, kMemDevice);
+  cudaFree(ptr);
+}
+
+void mem_pinned_free(void* ptr) {
+  if (!ptr) return;
+  forget_block(ptr, kMemPinned);
+  cudaFreeHost(ptr);
+}
+
+bool mem_charge(MemComponent component, MemKind kind, size_t bytes) {
+  Accounts& a = accounts();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  return charge_locked(a, component, kind, bytes, true);
+}
+
+void mem_track(MemComponent component, MemKind kind, size_t bytes) {
+  Accounts& a = accounts();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  charge_locked(a, component, kind, bytes, false);
+}
+
+void mem_release(MemComponent component, MemKind kind, size_t bytes) {
+  Accounts& a = accounts();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  release_locked(a, component, kind, bytes);
+}
+
+size_t mem_budget(MemKind kind) {
+  return static_cast<size_t>(budgets()[kind]);
+}
+
+size_t mem_budget_left(MemKind kind) {
+  const uint64_t budget = budgets()[kind];
+  if (!budget) return SIZE_MAX;
+  Accounts& a = accounts();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  return static_cast<size_t>(a.total[kind] < budget ? budget - a.total[kind] : 0);
+}
+
+extern "C" void NvDsInferGetMemoryStats(NvDsMemoryStats* out) {
+  if (!out) return;
+  const uint64_t* b = budgets();
+  Accounts& a = accounts();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  std::memcpy(out->current, a.current, sizeof(out->current));
+  std::memcpy(out->peak, a.peak, sizeof(out->peak));
+  std::memcpy(out->total_peak, a.total_peak, sizeof(out->total_peak));
+  std::memcpy(out->budget, b, sizeof(out->budget));
+  out->refused = a.refused;
+}
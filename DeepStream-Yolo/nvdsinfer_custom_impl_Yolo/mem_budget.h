@@ -0,0 +1,72 @@
+// mem_budget.h  (accounts of the library's own device, pinned and host memory, with optional budgets)
+// The library's allocations go through here: the parsers' CUDA workspaces, scratch pool and pinned pool, the
+// YoloLayer plugin's tables, the INT8 calibrator's input buffers, the build report's bindings and the Darknet
+// weights arena. Current and peak bytes are kept per component and kind and exported through
+// NvDsInferGetMemoryStats. Allocations are rare (the buffers are grow-only), so one mutex guards the accounts.
+//
+// SQUEAKVIEW_MEM_BUDGET="device=<MiB>,pinned=<MiB>,host=<MiB>" (any subset, read once) caps each kind. A device or
+// pinned allocation that would go over is refused like a failed cudaMalloc, which the callers already handle,
+// and counted in `refused`. Host memory the callers cannot do without (the weights arena) is tracked, not
+// refused. The engine build applies the device budget before TensorRT allocates: the INT8 calibration batch
+// shrinks until its input buffers fit in half of the budget left, and the builder workspace is capped at the rest.
+// The parser and builder libraries each keep their own accounts.
+
+#ifndef __MEM_BUDGET_H__
+#define __MEM_BUDGET_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include <cuda_runtime_api.h>
+
+enum MemComponent : int {
+  kMemParsers = 0,  // CUDA workspaces, scratch pool, pinned pool
+  kMemPlugin,       // YoloLayer anchors, masks and ROI cells
+  kMemCalibrator,   // INT8 calibration input buffers
+  kMemBuild,        // builder workspace, build report bindings, Darknet weights arena
+  kMemComponents,
+};
+
+enum MemKind : int {
+  kMemDevice = 0,
+  kMemPinned,
+  kMemHost,
+  kMemKinds,
+};
+
+// cudaMalloc / cudaHostAlloc on the component's account; cudaErrorMemoryAllocation when the budget refuses it.
+cudaError_t mem_device_alloc(void** ptr, size_t bytes, MemComponent component);
+cudaError_t mem_pinned_alloc(void** ptr, size_t bytes, MemComponent component);
+
+// Frees a block of mem_device_alloc / mem_pinned_alloc (nullptr is ignored).
+void mem_device_free(void* ptr);
+void mem_pinned_free(void* ptr);
+
+// Charges memory allocated elsewhere; false (nothing charged) when it does not fit the budget.
+bool mem_charge(MemComponent component, MemKind kind, size_t bytes);
+
+// Charges without a budget check, for memory the caller cannot do without.
+void mem_track(MemComponent component, MemKind kind, size_t bytes);
+
+void mem_release(MemComponent component, MemKind kind, size_t bytes);
+
+// Budget of a kind in bytes, 0 without one.
+size_t mem_budget(MemKind kind);
+
+// Bytes left under the budget of a kind; SIZE_MAX without one.
+size_t mem_budget_left(MemKind kind);
+
+// Layout mirrored by ctypes in apps/inference/runner.py; keep field order and sizes stable.
+extern "C" {
+struct NvDsMemoryStats {
+  uint64_t current[kMemComponents][kMemKinds];
+  uint64_t peak[kMemComponents][kMemKinds];
+  uint64_t total_peak[kMemKinds];
+  uint64_t budget[kMemKinds];  // 0 = none
+  uint64_t refused;            // allocations a budget turned down
+};
+
+void NvDsInferGetMemoryStats(NvDsMemoryStats* out);
+}
+
+#endif
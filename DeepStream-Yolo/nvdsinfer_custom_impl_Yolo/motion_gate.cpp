@@ -0,0 +1,202 @@
+// motion_gate.cpp
+
+#include "motion_gate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "parser_log.h"
+#include "parser_trace.h"
+#include "pose_cache.h"
+
+namespace {
+
+constexpr int kMotionMaxRows = 32;       // best rows compared per frame
+constexpr float kMotionMinConf = 0.4f;   // detections below this flicker too much to count as motion
+constexpr float kMotionMatchIou = 0.1f;  // below this a detection has no counterpart in the other frame
+constexpr float kMotionKptVisible = 0.3f;
+constexpr float kMotionEmaAlpha = 0.2f;
+
+struct GateParams {
+  int interval{0};  // 0 = gate off
+  float idle_s{30.f};
+  float threshold{0.05f};
+};
+
+const GateParams& gate_params() {
+  static const GateParams params = [] {
+    GateParams p;
+    if (const char* v = std::getenv("SQUEAKVIEW_MOTION_GATE")) {
+      float idle = p.idle_s, thr = p.threshold;
+      const int n = std::sscanf(v, "%d,%f,%f", &p.interval, &idle, &thr);
+      p.interval = n >= 1 ? std::max(0, p.interval) : 0;
+      if (n >= 2 && idle >= 0.f) p.idle_s = idle;
+      if (n >= 3 && thr > 0.f) p.threshold = thr;
+      if (p.interval > 0) {
+        PARSER_LOG(kLogInfo, "[MOTION] gate on: interval=%d after %.0fs below %.3f diag/s", p.interval, p.idle_s,
+                   p.threshold);
+      }
+    }
+    return p;
+  }();
+  return params;
+}
+
+// One detection of a frame, reduced to what the comparison needs.
+struct MotionObject {
+  float x1, y1, x2, y2;
+  int kpts;
+  float kp[3 * kPoseMaxKpts];
+};
+
+struct SlotMotion {
+  std::vector<MotionObject> prev;
+  bool has_prev{false};
+  int64_t prev_ns{0};
+  int64_t moved_ns{0};
+  float ema{0.f};
+  uint64_t frames{0};
+  int detections{0};
+};
+
+struct SlotState {
+  std::mutex mutex;
+  std::unique_ptr<SlotMotion> motion;
+  std::atomic<int64_t> seen_ns{0};
+  std::atomic<int> idle{0};
+};
+
+SlotState g_slots[kMaxBatchSlots];
+
+float box_iou(const MotionObject& a, const MotionObject& b) {
+  const float iw = std::max(0.f, std::min(a.x2, b.x2) - std::max(a.x1, b.x1));
+  const float ih = std::max(0.f, std::min(a.y2, b.y2) - std::max(a.y1, b.y1));
+  const float inter = iw * ih;
+  const float uni = (a.x2 - a.x1) * (a.y2 - a.y1) + (b.x2 - b.x1) * (b.y2 - b.y1) - inter;
+  return uni > 0.f ? inter / uni : 0.f;
+}
+
+// Displacement from a to b in a's box diagonals: mean over keypoints visible in both, else the box center.
+float displacement(const MotionObject& a, const MotionObject& b) {
+  const float diag = std::max(1.f, std::hypot(a.x2 - a.x1, a.y2 - a.y1));
+  float sum = 0.f;
+  int n = 0;
+  for (int j = 0; j < std::min(a.kpts, b.kpts); ++j) {
+    if (a.kp[3 * j + 2] < kMotionKptVisible || b.kp[3 * j + 2] < kMotionKptVisible) continue;
+    sum += std::hypot(b.kp[3 * j] - a.kp[3 * j], b.kp[3 * j + 1] - a.kp[3 * j + 1]);
+    ++n;
+  }
+  if (n == 0) {
+    sum = 0.5f * std::hypot(b.x1 + b.x2 - a.x1 - a.x2, b.y1 + b.y2 - a.y1 - a.y2);
+    n = 1;
+  }
+  return sum / n / diag;
+}
+
+// Largest displacement of a detection in `from` to its best match in `to`; infinity when one has none.
+float max_displacement(const std::vector<MotionObject>& from, const std::vector<MotionObject>& to) {
+  float worst = 0.f;
+  for (const MotionObject& a : from) {
+    int best = -1;
+    float best_iou = kMotionMatchIou;
+    for (size_t j = 0; j < to.size(); ++j) {
+      const float iou = box_iou(a, to[j]);
+      if (iou >= best_iou) { best = static_cast<int>(j); best_iou = iou; }
+    }
+    if (best < 0) return INFINITY;
+    worst = std::max(worst, displacement(a, to[best]));
+  }
+  return worst;
+}
+
+} // namespace
+
+bool motion_gate_enabled() {
+  return gate_params().interval > 0;
+}
+
+void motion_observe(const FrameTag& tag, const float* rows, int count, int stride, int box, int conf_col,
+                    int kpts) {
+  if (!motion_gate_enabled() || tag.batch_slot < 0 || tag.batch_slot >= kMaxBatchSlots) return;
+  TraceScope trace("motion_observe");
+  const GateParams& p = gate_params();
+  kpts = std::min(std::max(0, kpts), kPoseMaxKpts);
+
+  SlotState& s = g_slots[tag.batch_slot];
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.motion) s.motion.reset(new SlotMotion());
+  SlotMotion& m = *s.motion;
+
+  thread_local std::vector<MotionObject> cur;
+  cur.clear();
+  for (int i = 0; i < count && static_cast<int>(cur.size()) < kMotionMaxRows; ++i) {
+    const float* r = rows + static_cast<size_t>(i) * stride;
+    if (r[conf_col] < kMotionMinConf) continue;
+    MotionObject o;
+    if (box == kMotionCxcywh) {
+      o.x1 = r[0] - 0.5f * r[2]; o.y1 = r[1] - 0.5f * r[3]; o.x2 = r[0] + 0.5f * r[2]; o.y2 = r[1] + 0.5f * r[3];
+    } else {
+      o.x1 = r[0]; o.y1 = r[1]; o.x2 = r[2]; o.y2 = r[3];
+    }
+    o.kpts = kpts;
+    std::copy(r + kPoseBaseValuesPerDet, r + kPoseBaseValuesPerDet + 3 * kpts, o.kp);
+    cur.push_back(o);
+  }
+
+  const int64_t now = trace_now_ns();
+  float rate = INFINITY;
+  if (m.has_prev) {
+    const float dt = std::max(1e-3f, (now - m.prev_ns) * 1e-9f);
+    rate = std::max(max_displacement(cur, m.prev), max_displacement(m.prev, cur)) / dt;
+  }
+  if (!(rate <= p.threshold)) m.moved_ns = now;
+  // A new or vanished detection enters the average as 1 diagonal per second.
+  m.ema += kMotionEmaAlpha * ((std::isfinite(rate) ? rate : 1.f) - m.ema);
+  m.prev.swap(cur);
+  m.has_prev = true;
+  m.prev_ns = now;
+  ++m.frames;
+  m.detections = static_cast<int>(m.prev.size());
+
+  const int idle = (now - m.moved_ns) * 1e-9 >= p.idle_s ? 1 : 0;
+  if (idle != s.idle.load(std::memory_order_relaxed)) {
+    PARSER_LOG(kLogInfo, "[MOTION] slot %d %s", tag.batch_slot, idle ? "idle" : "active");
+  }
+  s.idle.store(idle, std::memory_order_relaxed);
+  s.seen_ns.store(now, std::memory_order_relaxed);
+}
+
+extern "C" int NvDsInferGetMotionState(int source_id, NvDsMotionState* state) {
+  if (!state || !motion_gate_enabled() || source_id < 0 || source_id >= kMaxBatchSlots) return 0;
+  SlotState& s = g_slots[source_id];
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.motion) return 0;
+  const SlotMotion& m = *s.motion;
+  state->motion = m.ema;
+  state->quiet_s = (trace_now_ns() - m.moved_ns) * 1e-9;
+  state->frames = m.frames;
+  state->idle = s.idle.load(std::memory_order_relaxed);
+  state->detections = m.detections;
+  return 1;
+}
+
+extern "C" int NvDsInferGetInferInterval() {
+  if (!motion_gate_enabled()) return 0;
+  // Sources silent for twice the idle time (a camera that went away) no longer hold the gate open.
+  const int64_t now = trace_now_ns();
+  const int64_t recent_ns = static_cast<int64_t>(std::max(5.f, 2.f * gate_params().idle_s) * 1e9f);
+  bool seen = false;
+  for (SlotState& s : g_slots) {
+    const int64_t at = s.seen_ns.load(std::memory_order_relaxed);
+    if (at == 0 || now - at > recent_ns) continue;
+    if (!s.idle.load(std::memory_order_relaxed)) return 0;
+    seen = true;
+  }
+  return seen ? gate_params().interval : 0;
+}
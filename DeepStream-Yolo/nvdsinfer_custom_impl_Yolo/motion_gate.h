@@ -0,0 +1,44 @@
+// motion_gate.h  (scene motion from consecutive detections, for an adaptive nvinfer interval)
+// With SQUEAKVIEW_MOTION_GATE="<interval>[,<idle_s>[,<threshold>]]" every frame published to the pose or OBB
+// ring is compared with the previous one of its batch slot: confident detections are matched on IoU, and the
+// motion of a frame is the largest keypoint (or box center) displacement in box diagonals per second. A new or
+// vanished detection counts as motion. A slot that shows no motion above `threshold` (default 0.05) for
+// `idle_s` seconds (default 30) is idle. The parsers never see the frames nvinfer skips, so the library only
+// recommends an interval: NvDsInferGetInferInterval() is `interval` once every recently seen slot is idle and
+// 0 otherwise, and the runner applies it to the nvinfer element, reusing the last pose frame in between.
+
+#ifndef __MOTION_GATE_H__
+#define __MOTION_GATE_H__
+
+#include <cstdint>
+
+#include "parser_context.h"
+
+enum MotionBox : int { kMotionXyxy = 0, kMotionCxcywh = 1 };
+
+// Layout mirrored by ctypes in apps/inference/runner.py; keep field order and sizes stable.
+extern "C" {
+struct NvDsMotionState {
+  double motion;       // smoothed motion, box diagonals per second
+  double quiet_s;      // seconds since the last frame above the threshold
+  uint64_t frames;     // frames observed for this source
+  int32_t idle;        // 1 while the source counts as idle
+  int32_t detections;  // confident detections in the latest frame
+};
+
+// Returns 0 for an unknown source or while the gate is off.
+int NvDsInferGetMotionState(int source_id, NvDsMotionState* state);
+
+// nvinfer interval the runner should apply now: 0 while the gate is off or any source is active.
+int NvDsInferGetInferInterval();
+}
+
+// SQUEAKVIEW_MOTION_GATE is set; read once.
+bool motion_gate_enabled();
+
+// Feeds one published frame: count rows of `stride` floats, the box at [0, 4) in `box` format, the
+// confidence at column conf_col and, for pose rows, kpts (x, y, score) triplets from kPoseBaseValuesPerDet.
+void motion_observe(const FrameTag& tag, const float* rows, int count, int stride, int box, int conf_col,
+                    int kpts);
+
+#endif
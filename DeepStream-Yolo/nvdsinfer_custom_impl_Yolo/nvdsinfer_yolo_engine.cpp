@@ -28,8 +28,13 @@
 #include "nvdsinfer_custom_impl.h"
 #include "nvdsinfer_context.h"
 
+#include "engine_cache.h"
+#include "engine_refit.h"
+#include "engine_swap.h"
 #include "yolo.h"
 
+#include <experimental/filesystem>
+
 #define USE_CUDA_ENGINE_GET_API 1
 
 static bool
@@ -58,12 +63,15 @@ getYoloNetworkInfo(NetworkInfo& networkInfo, const NvDsInferContextInitParams* i
   networkInfo.implicitBatch = initParams->forceImplicitBatchDimension;
   networkInfo.int8CalibPath = initParams->int8CalibrationFilePath;
   networkInfo.deviceType = initParams->useDLA ? "kDLA" : "kGPU";
+  networkInfo.dlaCore = initParams->dlaCore;
   networkInfo.numDetectedClasses = initParams->numDetectedClasses;
   networkInfo.clusterMode = initParams->clusterMode;
   networkInfo.scaleFactor = initParams->networkScaleFactor;
   networkInfo.offsets = initParams->offsets;
   networkInfo.workspaceSize = initParams->workspaceSize;
   networkInfo.inputFormat = initParams->networkInputFormat;
+  networkInfo.maintainAspectRatio = initParams->maintainAspectRatio;
+  networkInfo.symmetricPadding = initParams->symmetricPadding;
 
   if (initParams->networkMode == NvDsInferNetworkMode_FP32) {
     networkInfo.networkMode = "FP32";
@@ -75,6 +83,21 @@ getYoloNetworkInfo(NetworkInfo& networkInfo, const NvDsInferContextInitParams* i
     networkInfo.networkMode = "FP16";
   }
 
+  // Where the built plan is saved: model-engine-file when set, otherwise the name nvinfer looks for next to the
+  // model on the next start
+  std::string engineFilePath = initParams->modelEngineFilePath;
+  if (engineFilePath == "") {
+    std::string networkMode = networkInfo.networkMode;
+    std::transform(networkMode.begin(), networkMode.end(), networkMode.begin(), [] (uint8_t c) {
+      return std::tolower(c);
+    });
+    engineFilePath = (yoloType == "onnx" ? onnxFilePath : wtsFilePath) + "_b" +
+        std::to_string(initParams->maxBatchSize) + "_" + (initParams->useDLA ? "dla" +
+        std::to_string(initParams->dlaCore) : "gpu" + std::to_string(initParams->gpuID)) + "_" + networkMode +
+        ".engine";
+  }
+  networkInfo.engineFilePath = engineFilePath;
+
   if (yoloType == "onnx") {
     if (!fileExists(networkInfo.onnxFilePath)) {
       std::cerr << "ONNX file does not exist\n" << std::endl;
@@ -131,6 +154,31 @@ NvDsInferYoloCudaEngineGet(nvinfer1::IBuilder* const builder, const NvDsInferCon
   if (!getYoloNetworkInfo(networkInfo, initParams))
     return false;
 
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR > 0)
+  nvinfer1::ILogger& engineLogger = *builder->getLogger();
+#else
+  nvinfer1::ILogger& engineLogger = logger;
+#endif
+
+  // A plan built earlier from the same inputs comes back without parsing the model (engine_cache.h)
+  EngineCacheKey cacheKey;
+  const bool cached = engineCacheKey(networkInfo, cacheKey);
+  if (cached) {
+    cudaEngine = engineCacheLoad(cacheKey, engineLogger, networkInfo.engineFilePath);
+    if (cudaEngine != nullptr) {
+      engineRefitRegister(networkInfo.engineFilePath, cudaEngine, engineLogger);
+      return true;
+    }
+  }
+
+  // YOLO_HOT_SWAP: serve from a fallback engine at once and build this one in the background (engine_swap.h)
+  if (engineSwapEnabled() && engineSwapStart(networkInfo, cached ? &cacheKey : nullptr, engineLogger, cudaEngine)) {
+    return true;
+  }
+
+  const std::experimental::filesystem::file_time_type buildStart =
+      std::experimental::filesystem::file_time_type::clock::now();
+
   Yolo yolo(networkInfo);
 
 #if NV_TENSORRT_MAJOR >= 8
@@ -144,6 +192,15 @@ NvDsInferYoloCudaEngineGet(nvinfer1::IBuilder* const builder, const NvDsInferCon
     return false;
   }
 
+  // Only a plan this build wrote: when saving failed, the file there is the one nvinfer could not load. The key is
+  // taken again first: a first INT8 build writes the calibration table it hashes, so the next start finds the entry
+  std::error_code ec;
+  if (cached && std::experimental::filesystem::last_write_time(networkInfo.engineFilePath, ec) >= buildStart && !ec &&
+      engineCacheKey(networkInfo, cacheKey)) {
+    engineCacheStore(cacheKey, networkInfo.engineFilePath, networkInfo.modelName);
+  }
+  engineRefitRegister(networkInfo.engineFilePath, cudaEngine, engineLogger);
+
   return true;
 }
 #endif
@@ -23,75 +23,197 @@
  * https://www.github.com/marcoslucianops
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
 #include "nvdsinfer_custom_impl.h"
 
-#include "utils.h"
+#include "grid_nms.h"
+#include "half_float.h"
+#include "parser_context.h"
+#include "parser_stats.h"
+#include "parser_trace.h"
+#include "result_record.h"
+#include "roi_mask.h"
+#include "simd_scan.h"
+#include "tensor_record.h"
 
 extern "C" bool
 NvDsInferParseYolo(std::vector<NvDsInferLayerInfo> const& outputLayersInfo, NvDsInferNetworkInfo const& networkInfo,
     NvDsInferParseDetectionParams const& detectionParams, std::vector<NvDsInferParseObjectInfo>& objectList);
 
-static NvDsInferParseObjectInfo
-convertBBox(const float& bx1, const float& by1, const float& bx2, const float& by2, const uint& netW, const uint& netH)
+// Decodes numFrames consecutive frames of a contiguous dense [numFrames, N, 6] output (FP32 or FP16) in one pass,
+// frame f into objectLists[f] with the ROI of batch slot f. For host code that owns the whole batch (benchmarks,
+// offline tools).
+extern "C" bool
+NvDsInferParseYoloBatch(NvDsInferLayerInfo const& output, NvDsInferNetworkInfo const& networkInfo,
+    NvDsInferParseDetectionParams const& detectionParams, unsigned int numFrames,
+    std::vector<NvDsInferParseObjectInfo>* objectLists);
+
+static inline float
+clampBox(const float val, const float maxVal)
 {
-  NvDsInferParseObjectInfo b;
+  return std::min(maxVal, std::max(0.f, val));
+}
 
-  float x1 = bx1;
-  float y1 = by1;
-  float x2 = bx2;
-  float y2 = by2;
+// Per-class NMS over binfo[first..] when SQUEAKVIEW_DETECT_NMS=1: the topk best boxes go through the grid pass
+// of grid_nms.h and the survivors replace the range, best first.
+static void
+suppressOverlaps(std::vector<NvDsInferParseObjectInfo>& binfo, const size_t first)
+{
+  TraceScope trace("yolo_nms", kTraceNms);
+  static thread_local std::vector<int> order;
+  static thread_local std::vector<NvDsInferParseObjectInfo> kept;
+  int n = (int) (binfo.size() - first);
+  if (order.size() < (size_t) n) {
+    order.resize(n);
+  }
+  for (int i = 0; i < n; ++i) {
+    order[i] = i;
+  }
 
-  x1 = clamp(x1, 0, netW);
-  y1 = clamp(y1, 0, netH);
-  x2 = clamp(x2, 0, netW);
-  y2 = clamp(y2, 0, netH);
+  const NvDsInferParseObjectInfo* objs = binfo.data() + first;
+  auto better = [objs](int l, int r) { return objs[l].detectionConfidence > objs[r].detectionConfidence; };
+  const int topk = parser_topk();
+  if (topk > 0 && n > topk) {
+    std::nth_element(order.begin(), order.begin() + topk, order.begin() + n, better);
+    n = topk;
+  }
+  std::sort(order.begin(), order.begin() + n, better);
 
-  b.left = x1;
-  b.width = clamp(x2 - x1, 0, netW);
-  b.top = y1;
-  b.height = clamp(y2 - y1, 0, netH);
+  GridNms& g = grid_nms();
+  g.begin(n);
+  for (int r = 0; r < n; ++r) {
+    const NvDsInferParseObjectInfo& o = objs[order[r]];
+    g.set(r, o.left, o.top, o.left + o.width, o.top + o.height, (int) o.classId);
+  }
+  g.build();
+  const int numKept = grid_nms_iou(g, parser_nms_iou(), 0);
 
-  return b;
+  kept.clear();
+  for (int k = 0; k < numKept; ++k) {
+    kept.push_back(objs[order[g.keep[k]]]);
+  }
+  binfo.resize(first);
+  binfo.insert(binfo.end(), kept.begin(), kept.end());
 }
 
+// Candidates come from box_candidates() (SIMD threshold + class-range masks over the interleaved rows);
+// the survivors inside the slot's ROI are read in full, clamped branch-free and appended to reserved capacity.
 static void
-addBBoxProposal(const float bx1, const float by1, const float bx2, const float by2, const uint& netW, const uint& netH,
-    const int maxIndex, const float maxProb, std::vector<NvDsInferParseObjectInfo>& binfo)
+decodeTensorYolo(const float* output, const uint& outputSize, const uint& netW, const uint& netH,
+    const std::vector<float>& preclusterThreshold, const RoiView& roi, std::vector<NvDsInferParseObjectInfo>& binfo)
 {
-  NvDsInferParseObjectInfo bbi = convertBBox(bx1, by1, bx2, by2, netW, netH);
+  static thread_local std::vector<int> hits;
+  if (hits.size() < outputSize) {
+    hits.resize(outputSize);
+  }
 
-  if (bbi.width < 1 || bbi.height < 1) {
-    return;
+  const int numHits = box_candidates(output, outputSize, preclusterThreshold.data(),
+      (int) preclusterThreshold.size(), hits.data());
+
+  const float w = (float) netW;
+  const float h = (float) netH;
+  const size_t first = binfo.size();
+  binfo.reserve(first + numHits);
+  int outside = 0;
+
+  for (int k = 0; k < numHits; ++k) {
+    const float* p = output + (size_t) hits[k] * 6;
+    if (roi.anchor_outside(hits[k]) || roi.center_outside(p[0], p[1], p[2], p[3])) {
+      ++outside;
+      continue;
+    }
+
+    const float x1 = clampBox(p[0], w);
+    const float y1 = clampBox(p[1], h);
+    const float x2 = clampBox(p[2], w);
+    const float y2 = clampBox(p[3], h);
+
+    NvDsInferParseObjectInfo bbi;
+    bbi.left = x1;
+    bbi.top = y1;
+    bbi.width = clampBox(x2 - x1, w);
+    bbi.height = clampBox(y2 - y1, h);
+
+    if (bbi.width < 1 || bbi.height < 1) {
+      continue;
+    }
+
+    bbi.detectionConfidence = p[4];
+    bbi.classId = (int) p[5];
+    binfo.push_back(bbi);
   }
 
-  bbi.detectionConfidence = maxProb;
-  bbi.classId = maxIndex;
-  binfo.push_back(bbi);
+  if (parser_detect_nms() && binfo.size() - first > 1) {
+    suppressOverlaps(binfo, first);
+  }
+
+  parser_stats_frame(outputSize, numHits - outside, binfo.size() - first);
 }
 
-static std::vector<NvDsInferParseObjectInfo>
-decodeTensorYolo(const float* output, const uint& outputSize, const uint& netW, const uint& netH,
-    const std::vector<float>& preclusterThreshold)
+// The first `rows` rows of frame f as floats. FP16 outputs (engines built with YOLO_OUTPUT_FP16=1) are widened
+// into a per-thread buffer first, so the SIMD scan and the decode below stay float-only.
+static const float*
+frameRows(NvDsInferLayerInfo const& output, const uint outputSize, const uint f, const uint rows)
 {
-  std::vector<NvDsInferParseObjectInfo> binfo;
+  const size_t frameValues = (size_t) outputSize * 6;
+  if (output.dataType != HALF) {
+    return (const float*) (output.buffer) + f * frameValues;
+  }
 
-  for (uint b = 0; b < outputSize; ++b) {
-    float maxProb = output[b * 6 + 4];
-    int maxIndex = (int) output[b * 6 + 5];
+  const size_t values = (size_t) rows * 6;
+  static thread_local std::vector<float> widened;
+  if (widened.size() < values) {
+    widened.resize(values);
+  }
+  const uint16_t* in = (const uint16_t*) (output.buffer) + f * frameValues;
+  for (size_t i = 0; i < values; ++i) {
+    widened[i] = half_to_float(in[i]);
+  }
+  return widened.data();
+}
 
-    if (maxProb < preclusterThreshold[maxIndex]) {
-      continue;
-    }
+// Boxes per frame: [N, 6] or [B, N, 6].
+static uint
+boxesPerFrame(const NvDsInferDims& dims)
+{
+  return dims.numDims >= 3 ? dims.d[1] : dims.d[0];
+}
+
+// Frame f of output goes to objectLists[f], gated by the ROI of batch slot firstSlot + f. With a count layer
+// (compact output) only the valid prefix of each frame is read; its rows are no longer in anchor order, so the
+// ROI is checked on the box centers.
+static bool
+decodeFrames(NvDsInferLayerInfo const& output, const NvDsInferLayerInfo* count, NvDsInferNetworkInfo const& networkInfo,
+    NvDsInferParseDetectionParams const& detectionParams, int firstSlot, unsigned int numFrames,
+    std::vector<NvDsInferParseObjectInfo>* objectLists)
+{
+  if (!output.buffer || !objectLists) {
+    return false;
+  }
 
-    float bx1 = output[b * 6 + 0];
-    float by1 = output[b * 6 + 1];
-    float bx2 = output[b * 6 + 2];
-    float by2 = output[b * 6 + 3];
+  const uint outputSize = boxesPerFrame(output.inferDims);
 
-    addBBoxProposal(bx1, by1, bx2, by2, netW, netH, maxIndex, maxProb, binfo);
+  for (uint f = 0; f < numFrames; ++f) {
+    objectLists[f].clear();
+    const uint rows = yolo_valid_rows(count, f, outputSize);
+    decodeTensorYolo(frameRows(output, outputSize, f, rows), rows, networkInfo.width, networkInfo.height,
+        detectionParams.perClassPreclusterThreshold, roi_view(firstSlot + f, networkInfo, count ? 0 : outputSize),
+        objectLists[f]);
   }
 
-  return binfo;
+  return true;
+}
+
+extern "C" bool
+NvDsInferParseYoloBatch(NvDsInferLayerInfo const& output, NvDsInferNetworkInfo const& networkInfo,
+    NvDsInferParseDetectionParams const& detectionParams, unsigned int numFrames,
+    std::vector<NvDsInferParseObjectInfo>* objectLists)
+{
+  return decodeFrames(output, nullptr, networkInfo, detectionParams, 0, numFrames, objectLists);
 }
 
 static bool
@@ -104,18 +226,14 @@ NvDsInferParseCustomYolo(std::vector<NvDsInferLayerInfo> const& outputLayersInfo
     return false;
   }
 
-  std::vector<NvDsInferParseObjectInfo> objects;
-
-  const NvDsInferLayerInfo& output = outputLayersInfo[0];
-  const uint outputSize = output.inferDims.d[0];
-
-  std::vector<NvDsInferParseObjectInfo> outObjs = decodeTensorYolo((const float*) (output.buffer), outputSize,
-      networkInfo.width, networkInfo.height, detectionParams.perClassPreclusterThreshold);
-
-  objects.insert(objects.end(), outObjs.begin(), outObjs.end());
-
-  objectList = objects;
-
+  // nvinfer calls once per frame with the buffer already at that frame; a [B, N, 6] tensor can only
+  // return its first entry through objectList.
+  const YoloOutputLayers layers = yolo_output_layers(outputLayersInfo);
+  const FrameTag tag = tag_frame(*layers.boxes);
+  if (!decodeFrames(*layers.boxes, layers.count, networkInfo, detectionParams, tag.batch_slot, 1, &objectList)) {
+    return false;
+  }
+  publish_detect_record(objectList.data(), static_cast<int>(objectList.size()), tag, 0);
   return true;
 }
 
@@ -123,6 +241,8 @@ extern "C" bool
 NvDsInferParseYolo(std::vector<NvDsInferLayerInfo> const& outputLayersInfo, NvDsInferNetworkInfo const& networkInfo,
     NvDsInferParseDetectionParams const& detectionParams, std::vector<NvDsInferParseObjectInfo>& objectList)
 {
+  parser_record("yolo", outputLayersInfo, networkInfo, detectionParams);
+  TraceScope trace("NvDsInferParseYolo", kTraceParse);
   return NvDsInferParseCustomYolo(outputLayersInfo, networkInfo, detectionParams, objectList);
 }
 
@@ -23,48 +23,280 @@
  * https://www.github.com/marcoslucianops
  */
 
-#include <thrust/host_vector.h>
-#include <thrust/device_vector.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <cuda_fp16.h>
+#include <thrust/device_ptr.h>
+#include <thrust/sort.h>
+#include <thrust/system/cuda/execution_policy.h>
 
 #include "nvdsinfer_custom_impl.h"
 
+#include "cuda_workspace.h"
+#include "parser_context.h"
+#include "parser_stats.h"
+#include "parser_trace.h"
+#include "result_record.h"
+#include "roi_mask.h"
+#include "tensor_record.h"
+
 extern "C" bool
 NvDsInferParseYoloCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo, NvDsInferNetworkInfo const& networkInfo,
     NvDsInferParseDetectionParams const& detectionParams, std::vector<NvDsInferParseObjectInfo>& objectList);
 
-__global__ void decodeTensorYoloCuda(NvDsInferParseObjectInfo *binfo, const float* output, const uint outputSize,
-    const uint netW, const uint netH, const float* preclusterThreshold)
+extern "C" bool
+NvDsInferParseYoloCudaNms(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+
+// Only boxes above their class threshold and inside the ROI are written, packed at the front of binfo through
+// one atomic per warp: the lanes that pass agree on a base offset and take consecutive slots after it.
+// roiAnchors / roiCells are the slot's RoiView on the device (both nullptr without an ROI). T is float, or __half
+// for engines built with YOLO_OUTPUT_FP16=1. validRows is the count layer of a compact output (rows past it are
+// stale), nullptr for the dense one.
+__device__ inline float outputValue(const float* p) { return *p; }
+
+__device__ inline float outputValue(const __half* p) { return __half2float(*p); }
+
+template <typename T>
+__global__ void decodeTensorYoloCuda(NvDsInferParseObjectInfo *binfo, int* numObjects, const T* output,
+    const uint outputSize, const int* validRows, const uint netW, const uint netH, const float* preclusterThreshold,
+    const uint8_t* roiAnchors, const uint8_t* roiCells, const int roiW, const int roiH)
 {
   int x_id = blockIdx.x * blockDim.x + threadIdx.x;
+  const int rows = validRows ? min(*validRows, (int) outputSize) : (int) outputSize;
 
-  if (x_id >= outputSize) {
-    return;
+  bool pass = false;
+  float maxProb = 0.0;
+  int maxIndex = 0;
+  if (x_id < rows) {
+    maxProb = outputValue(output + x_id * 6 + 4);
+    maxIndex = (int) outputValue(output + x_id * 6 + 5);
+    // Class -1 marks rows without a class, e.g. anchors dropped by the plugin's objectness gate
+    pass = maxIndex >= 0 && maxProb >= preclusterThreshold[maxIndex];
+    if (pass && roiAnchors) {
+      pass = roiAnchors[x_id] != 0;
+    }
+    else if (pass && roiCells) {
+      const T* p = output + x_id * 6;
+      const int gx = min(max((int) (0.5f * (outputValue(p) + outputValue(p + 2)) / kRoiCellStride), 0), roiW - 1);
+      const int gy = min(max((int) (0.5f * (outputValue(p + 1) + outputValue(p + 3)) / kRoiCellStride), 0),
+          roiH - 1);
+      pass = roiCells[gy * roiW + gx] != 0;
+    }
   }
 
-  float maxProb = output[x_id * 6 + 4];
-  int maxIndex = (int) output[x_id * 6 + 5];
-
-  if (maxProb < preclusterThreshold[maxIndex]) {
-    binfo[x_id].detectionConfidence = 0.0;
+  const unsigned int ballot = __ballot_sync(0xffffffff, pass);
+  if (!pass) {
     return;
   }
 
-  float bx1 = output[x_id * 6 + 0];
-  float by1 = output[x_id * 6 + 1];
-  float bx2 = output[x_id * 6 + 2];
-  float by2 = output[x_id * 6 + 3];
+  const int lane = threadIdx.x & 31;
+  const int leader = __ffs(ballot) - 1;
+  int base = 0;
+  if (lane == leader) {
+    base = atomicAdd(numObjects, __popc(ballot));
+  }
+  base = __shfl_sync(ballot, base, leader);
+  const int slot = base + __popc(ballot & ((1u << lane) - 1));
+
+  float bx1 = outputValue(output + x_id * 6 + 0);
+  float by1 = outputValue(output + x_id * 6 + 1);
+  float bx2 = outputValue(output + x_id * 6 + 2);
+  float by2 = outputValue(output + x_id * 6 + 3);
 
   bx1 = fminf(float(netW), fmaxf(float(0.0), bx1));
   by1 = fminf(float(netH), fmaxf(float(0.0), by1));
   bx2 = fminf(float(netW), fmaxf(float(0.0), bx2));
   by2 = fminf(float(netH), fmaxf(float(0.0), by2));
 
-  binfo[x_id].left = bx1;
-  binfo[x_id].top = by1;
-  binfo[x_id].width = fminf(float(netW), fmaxf(float(0.0), bx2 - bx1));
-  binfo[x_id].height = fminf(float(netH), fmaxf(float(0.0), by2 - by1));
-  binfo[x_id].detectionConfidence = maxProb;
-  binfo[x_id].classId = maxIndex;
+  NvDsInferParseObjectInfo obj;
+  obj.left = bx1;
+  obj.top = by1;
+  obj.width = fminf(float(netW), fmaxf(float(0.0), bx2 - bx1));
+  obj.height = fminf(float(netH), fmaxf(float(0.0), by2 - by1));
+  obj.detectionConfidence = maxProb;
+  obj.classId = maxIndex;
+  binfo[slot] = obj;
+}
+
+static constexpr int kNmsBlock = 64;
+static constexpr int kNmsMaxCandidates = 4096;   // highest-confidence boxes considered by the GPU NMS
+
+struct ObjectConfidenceGreater {
+  __host__ __device__ bool operator()(const NvDsInferParseObjectInfo& a, const NvDsInferParseObjectInfo& b) const {
+    return a.detectionConfidence > b.detectionConfidence;
+  }
+};
+
+// Boxes of different classes never suppress each other.
+__device__ __forceinline__ float classIouCuda(const NvDsInferParseObjectInfo& a, const NvDsInferParseObjectInfo& b)
+{
+  if (a.classId != b.classId) {
+    return 0.f;
+  }
+  const float w = fmaxf(0.f, fminf(a.left + a.width, b.left + b.width) - fmaxf(a.left, b.left));
+  const float h = fmaxf(0.f, fminf(a.top + a.height, b.top + b.height) - fmaxf(a.top, b.top));
+  const float inter = w * h;
+  return inter / (a.width * a.height + b.width * b.height - inter + 1e-6f);
+}
+
+// Bitmask NMS over confidence-sorted boxes: block (row, col) sets bit j of word (i, col) when box i
+// suppresses box col*64 + j.
+__global__ void nmsMaskCuda(const NvDsInferParseObjectInfo* objs, int n, float iouThr, unsigned long long* mask,
+    int colBlocks)
+{
+  const int rowBlock = blockIdx.y;
+  const int colBlock = blockIdx.x;
+  if (colBlock < rowBlock) {
+    return;
+  }
+
+  const int rowSize = min(n - rowBlock * kNmsBlock, kNmsBlock);
+  const int colSize = min(n - colBlock * kNmsBlock, kNmsBlock);
+
+  __shared__ NvDsInferParseObjectInfo cols[kNmsBlock];
+  if (threadIdx.x < colSize) {
+    cols[threadIdx.x] = objs[colBlock * kNmsBlock + threadIdx.x];
+  }
+  __syncthreads();
+
+  if (threadIdx.x >= rowSize) {
+    return;
+  }
+
+  const int i = rowBlock * kNmsBlock + threadIdx.x;
+  const NvDsInferParseObjectInfo a = objs[i];
+  unsigned long long bits = 0;
+  const int start = colBlock == rowBlock ? threadIdx.x + 1 : 0;
+  for (int j = start; j < colSize; ++j) {
+    if (classIouCuda(a, cols[j]) > iouThr) {
+      bits |= 1ull << j;
+    }
+  }
+  mask[(size_t) i * colBlocks + colBlock] = bits;
+}
+
+// Greedy pass over the mask in one block, so the suppression never leaves the device: thread t owns word t
+// of the running removed set. Stops after maxKeep survivors (top-K).
+__global__ void nmsReduceCuda(const unsigned long long* mask, int n, int colBlocks, int maxKeep,
+    const NvDsInferParseObjectInfo* objs, NvDsInferParseObjectInfo* out, int* outCount)
+{
+  extern __shared__ unsigned long long removed[];
+  __shared__ int kept;
+
+  for (int b = threadIdx.x; b < colBlocks; b += blockDim.x) {
+    removed[b] = 0;
+  }
+  if (threadIdx.x == 0) {
+    kept = 0;
+  }
+  __syncthreads();
+
+  for (int i = 0; i < n && kept < maxKeep; ++i) {
+    const bool alive = !((removed[i / kNmsBlock] >> (i % kNmsBlock)) & 1ull);
+    __syncthreads();
+    if (alive) {
+      const unsigned long long* row = mask + (size_t) i * colBlocks;
+      for (int b = i / kNmsBlock + threadIdx.x; b < colBlocks; b += blockDim.x) {
+        removed[b] |= row[b];
+      }
+      if (threadIdx.x == 0) {
+        out[kept++] = objs[i];
+      }
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    *outCount = kept;
+  }
+}
+
+// Per-thread (i.e. per nvinfer context) buffers reused across frames; thresholds are re-uploaded only
+// when the config values change.
+struct YoloCudaWorkspace {
+  DeviceBuffer<NvDsInferParseObjectInfo> objects;
+  DeviceBuffer<int> numObjects;
+  PinnedBuffer<NvDsInferParseObjectInfo> hostObjects;
+  PinnedBuffer<int> hostNumObjects;
+  DeviceBuffer<float> thresholds;
+  std::vector<float> hostThresholds;
+  // NvDsInferParseYoloCudaNms only.
+  DeviceBuffer<unsigned long long> nmsMask;
+  DeviceBuffer<NvDsInferParseObjectInfo> kept;
+  StreamGraphCache decodeGraphs;
+  SlotUploadCache roi;
+};
+
+static thread_local YoloCudaWorkspace yoloCudaWorkspace;
+
+// Decodes the [N, 6] output of batch slot tag.batch_slot into ws.objects, survivors packed at the front; their
+// count lands in *numObjects. With a count layer (compact output) the kernel reads it in place and stops at the
+// valid rows, which are not in anchor order, so the ROI is checked on the box centers. Leaves the stream
+// synchronized.
+static bool decodeYoloCuda(const NvDsInferLayerInfo& output, const NvDsInferLayerInfo* count,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams, const FrameTag& tag,
+    YoloCudaWorkspace& ws, cudaStream_t stream, int* numObjects)
+{
+  const uint outputSize = output.inferDims.d[0];
+
+  if (!ws.objects.reserve(outputSize) || !ws.numObjects.reserve(1) || !ws.hostObjects.reserve(outputSize) ||
+      !ws.hostNumObjects.reserve(1) ||
+      !ws.thresholds.reserve(std::max<size_t>(detectionParams.perClassPreclusterThreshold.size(), 1))) {
+    std::cerr << "ERROR: Failed to allocate the bbox parsing workspace" << std::endl;
+    return false;
+  }
+
+  if (ws.hostThresholds != detectionParams.perClassPreclusterThreshold) {
+    ws.hostThresholds = detectionParams.perClassPreclusterThreshold;
+    cudaMemcpyAsync(ws.thresholds.get(), ws.hostThresholds.data(), ws.hostThresholds.size() * sizeof(float),
+        cudaMemcpyHostToDevice, stream);
+  }
+
+  // Uploaded outside the graph, like the thresholds.
+  const RoiView roi = roi_view(tag.batch_slot, networkInfo, count ? 0 : outputSize);
+  const int* validRows = count ? static_cast<const int*>(count->buffer) : nullptr;
+  const uint8_t* roiCells = roi.active() ? ws.roi.get(tag.batch_slot, roi.id, roi.cells, roi.bytes, stream) : nullptr;
+  const uint8_t* roiAnchors = roiCells && roi.anchors ? roiCells + (roi.anchors - roi.cells) : nullptr;
+
+  // Fixed shape for a given output buffer, so it can be replayed from a CUDA graph (SQUEAKVIEW_CUDA_GRAPH=1).
+  const GraphKey key {reinterpret_cast<uintptr_t>(output.buffer), outputSize, networkInfo.width, networkInfo.height,
+      reinterpret_cast<uintptr_t>(ws.objects.get()), reinterpret_cast<uintptr_t>(ws.thresholds.get()),
+      reinterpret_cast<uintptr_t>(ws.numObjects.get()), reinterpret_cast<uintptr_t>(ws.hostNumObjects.get()),
+      reinterpret_cast<uintptr_t>(roiAnchors ? roiAnchors : roiCells),
+      static_cast<uintptr_t>(output.dataType) ^ reinterpret_cast<uintptr_t>(validRows)};
+  cudaError_t err = ws.decodeGraphs.run(key, stream, [&](cudaStream_t s) {
+    cudaMemsetAsync(ws.numObjects.get(), 0, sizeof(int), s);
+
+    int threads_per_block = 1024;
+    int number_of_blocks = ((outputSize) / threads_per_block) + 1;
+
+    if (output.dataType == HALF) {
+      decodeTensorYoloCuda<<<number_of_blocks, threads_per_block, 0, s>>>(
+          ws.objects.get(), ws.numObjects.get(), (const __half*) (output.buffer), outputSize, validRows,
+          networkInfo.width, networkInfo.height, ws.thresholds.get(), roiAnchors, roiCells, roi.cells_w, roi.cells_h);
+    }
+    else {
+      decodeTensorYoloCuda<<<number_of_blocks, threads_per_block, 0, s>>>(
+          ws.objects.get(), ws.numObjects.get(), (const float*) (output.buffer), outputSize, validRows,
+          networkInfo.width, networkInfo.height, ws.thresholds.get(), roiAnchors, roiCells, roi.cells_w, roi.cells_h);
+    }
+
+    cudaMemcpyAsync(ws.hostNumObjects.get(), ws.numObjects.get(), sizeof(int), cudaMemcpyDeviceToHost, s);
+  });
+  if (err == cudaSuccess) {
+    err = cudaStreamSynchronize(stream);
+  }
+  if (err != cudaSuccess) {
+    std::cerr << "ERROR: bbox parsing failed: " << cudaGetErrorString(err) << std::endl;
+    return false;
+  }
+
+  *numObjects = std::min<int>(*ws.hostNumObjects.get(), outputSize);
+  return true;
 }
 
 static bool NvDsInferParseCustomYoloCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
@@ -76,22 +308,100 @@ static bool NvDsInferParseCustomYoloCuda(std::vector<NvDsInferLayerInfo> const&
     return false;
   }
 
-  const NvDsInferLayerInfo& output = outputLayersInfo[0];
-  const uint outputSize = output.inferDims.d[0];
+  YoloCudaWorkspace& ws = yoloCudaWorkspace;
+  const YoloOutputLayers layers = yolo_output_layers(outputLayersInfo);
+  const FrameTag tag = tag_frame(*layers.boxes);
+  cudaStream_t stream = parser_stream(tag.batch_slot);
 
-  thrust::device_vector<float> perClassPreclusterThreshold = detectionParams.perClassPreclusterThreshold;
+  // Count first, then only the survivors.
+  int numObjects = 0;
+  if (!decodeYoloCuda(*layers.boxes, layers.count, networkInfo, detectionParams, tag, ws, stream, &numObjects)) {
+    return false;
+  }
 
-  thrust::device_vector<NvDsInferParseObjectInfo> objects(outputSize);
+  if (numObjects > 0) {
+    cudaMemcpyAsync(ws.hostObjects.get(), ws.objects.get(), numObjects * sizeof(NvDsInferParseObjectInfo),
+        cudaMemcpyDeviceToHost, stream);
+    const cudaError_t err = cudaStreamSynchronize(stream);
+    if (err != cudaSuccess) {
+      std::cerr << "ERROR: bbox parsing failed: " << cudaGetErrorString(err) << std::endl;
+      return false;
+    }
+  }
 
-  int threads_per_block = 1024;
-  int number_of_blocks = ((outputSize) / threads_per_block) + 1;
+  objectList.assign(ws.hostObjects.get(), ws.hostObjects.get() + numObjects);
+  parser_stats_frame(layers.boxes->inferDims.d[0], numObjects, numObjects);
+  publish_detect_record(objectList.data(), numObjects, tag, 0);
 
-  decodeTensorYoloCuda<<<number_of_blocks, threads_per_block>>>(
-      thrust::raw_pointer_cast(objects.data()), (float*) (output.buffer), outputSize, networkInfo.width,
-          networkInfo.height, thrust::raw_pointer_cast(perClassPreclusterThreshold.data()));
+  return true;
+}
 
-  objectList.resize(outputSize);
-  thrust::copy(objects.begin(), objects.end(), objectList.begin());
+// Decode + class-aware NMS + top-K on the device; the result is final, so use cluster-mode=4 with it.
+// nvinfer does not pass nms-iou-threshold or topk to parsers: they come from SQUEAKVIEW_NMS_IOU and
+// SQUEAKVIEW_TOPK (see parser_context.h).
+static bool NvDsInferParseCustomYoloCudaNms(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList)
+{
+  if (outputLayersInfo.empty()) {
+    std::cerr << "ERROR: Could not find output layer in bbox parsing" << std::endl;
+    return false;
+  }
+
+  YoloCudaWorkspace& ws = yoloCudaWorkspace;
+  const YoloOutputLayers layers = yolo_output_layers(outputLayersInfo);
+  const FrameTag tag = tag_frame(*layers.boxes);
+  cudaStream_t stream = parser_stream(tag.batch_slot);
+
+  int numObjects = 0;
+  if (!decodeYoloCuda(*layers.boxes, layers.count, networkInfo, detectionParams, tag, ws, stream, &numObjects)) {
+    return false;
+  }
+
+  objectList.clear();
+  if (numObjects == 0) {
+    parser_stats_frame(layers.boxes->inferDims.d[0], 0, 0);
+    publish_detect_record(nullptr, 0, tag, 0);
+    return true;
+  }
+
+  // Sort, NMS and the readback of the kept boxes
+  TraceScope nmsTrace("bbox_nms", kTraceNms);
+
+  thrust::device_ptr<NvDsInferParseObjectInfo> objs = thrust::device_pointer_cast(ws.objects.get());
+  ScratchAllocator scratch(stream);
+  thrust::sort(thrust::cuda::par(scratch).on(stream), objs, objs + numObjects, ObjectConfidenceGreater());
+
+  const int n = std::min(numObjects, kNmsMaxCandidates);
+  const int topk = parser_topk();
+  const int maxKeep = topk > 0 ? std::min(topk, n) : n;
+  const int colBlocks = (n + kNmsBlock - 1) / kNmsBlock;
+  const size_t maskWords = (size_t) n * colBlocks;
+  if (!ws.nmsMask.reserve(maskWords) || !ws.kept.reserve(maxKeep)) {
+    std::cerr << "ERROR: Failed to allocate the bbox NMS workspace" << std::endl;
+    return false;
+  }
+
+  // Blocks below the diagonal return without writing; their words must read as "suppresses nothing".
+  cudaMemsetAsync(ws.nmsMask.get(), 0, maskWords * sizeof(unsigned long long), stream);
+  const dim3 grid(colBlocks, colBlocks);
+  nmsMaskCuda<<<grid, kNmsBlock, 0, stream>>>(ws.objects.get(), n, parser_nms_iou(), ws.nmsMask.get(), colBlocks);
+  nmsReduceCuda<<<1, kNmsBlock, colBlocks * sizeof(unsigned long long), stream>>>(
+      ws.nmsMask.get(), n, colBlocks, maxKeep, ws.objects.get(), ws.kept.get(), ws.numObjects.get());
+
+  cudaMemcpyAsync(ws.hostNumObjects.get(), ws.numObjects.get(), sizeof(int), cudaMemcpyDeviceToHost, stream);
+  cudaMemcpyAsync(ws.hostObjects.get(), ws.kept.get(), maxKeep * sizeof(NvDsInferParseObjectInfo),
+      cudaMemcpyDeviceToHost, stream);
+  const cudaError_t err = cudaStreamSynchronize(stream);
+  if (err != cudaSuccess) {
+    std::cerr << "ERROR: bbox NMS failed: " << cudaGetErrorString(err) << std::endl;
+    return false;
+  }
+
+  const int numKept = std::min(*ws.hostNumObjects.get(), maxKeep);
+  objectList.assign(ws.hostObjects.get(), ws.hostObjects.get() + numKept);
+  parser_stats_frame(layers.boxes->inferDims.d[0], numObjects, numKept);
+  publish_detect_record(objectList.data(), numKept, tag, 0);
 
   return true;
 }
@@ -100,7 +410,21 @@ extern "C" bool
 NvDsInferParseYoloCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo, NvDsInferNetworkInfo const& networkInfo,
     NvDsInferParseDetectionParams const& detectionParams, std::vector<NvDsInferParseObjectInfo>& objectList)
 {
+  parser_record("cuda", outputLayersInfo, networkInfo, detectionParams);
+  TraceScope trace("NvDsInferParseYoloCuda", kTraceParse);
   return NvDsInferParseCustomYoloCuda(outputLayersInfo, networkInfo, detectionParams, objectList);
 }
 
 CHECK_CUSTOM_PARSE_FUNC_PROTOTYPE(NvDsInferParseYoloCuda);
+
+extern "C" bool
+NvDsInferParseYoloCudaNms(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList)
+{
+  parser_record("cuda_nms", outputLayersInfo, networkInfo, detectionParams);
+  TraceScope trace("NvDsInferParseYoloCudaNms", kTraceParse);
+  return NvDsInferParseCustomYoloCudaNms(outputLayersInfo, networkInfo, detectionParams, objectList);
+}
+
+CHECK_CUSTOM_PARSE_FUNC_PROTOTYPE(NvDsInferParseYoloCudaNms);
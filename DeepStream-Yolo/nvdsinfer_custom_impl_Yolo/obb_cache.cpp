@@ -0,0 +1,57 @@
+// obb_cache.cpp  (OBB frames on a FrameRing behind NvDsInferObbAcquire)
+
+#include "obb_cache.h"
+
+#include "frame_ring.h"
+#include "motion_gate.h"
+#include "result_record.h"
+#include "result_shm.h"
+
+namespace {
+
+FrameRing<kObbRingSlots, kObbMaxDets, kObbValuesPerDet> g_obb_ring;
+
+int to_obb_frame(bool ok, const FrameView& v, NvDsObbFrame* frame) {
+  if (!ok) return 0;
+  frame->seq = v.seq;
+  frame->frame_num = v.frame_num;
+  frame->source_id = v.source_id;
+  frame->slot = v.slot;
+  frame->count = v.count;
+  frame->stride = v.width;
+  frame->flags = v.flags;
+  frame->reserved = 0;
+  frame->data = v.data;
+  return 1;
+}
+
+} // namespace
+
+uint64_t publish_obb_rows(const float* rows, int count, const FrameTag& tag, int32_t flags) {
+  shm_publish_rows(kShmKindObb, rows, count, kObbValuesPerDet, kObbValuesPerDet, tag, flags);
+  motion_observe(tag, rows, count, kObbValuesPerDet, kMotionCxcywh, 5, 0);
+  publish_obb_record(rows, count, tag, flags & kObbFrameSourceCoords);
+  return g_obb_ring.publish(rows, count, kObbValuesPerDet, kObbValuesPerDet, tag, flags);
+}
+
+extern "C" int NvDsInferObbAcquire(int source_id, uint64_t after_seq, NvDsObbFrame* frame) {
+  if (!frame) return 0;
+  FrameView v;
+  return to_obb_frame(g_obb_ring.acquire(source_id, after_seq, &v), v, frame);
+}
+
+extern "C" int NvDsInferObbAcquireLatest(int source_id, NvDsObbFrame* frame) {
+  if (!frame) return 0;
+  FrameView v;
+  return to_obb_frame(g_obb_ring.acquire_latest(source_id, &v), v, frame);
+}
+
+extern "C" int NvDsInferObbAcquireFrame(int source_id, uint64_t frame_num, NvDsObbFrame* frame) {
+  if (!frame) return 0;
+  FrameView v;
+  return to_obb_frame(g_obb_ring.acquire_frame(source_id, frame_num, &v), v, frame);
+}
+
+extern "C" void NvDsInferObbRelease(const NvDsObbFrame* frame) {
+  if (frame) g_obb_ring.release(frame->slot);
+}
@@ -0,0 +1,50 @@
+// obb_cache.h  (ring of finished OBB frames, keeping the rotation that the AABB objects drop)
+// NvDsInferParseYoloOBB publishes one frame per call; readers acquire a finished slot, read the rows in
+// place and release it, exactly like the pose cache (pose_cache.h).
+
+#ifndef __OBB_CACHE_H__
+#define __OBB_CACHE_H__
+
+#include <cstdint>
+
+#include "parser_context.h"
+
+// Layout is part of the exported ABI (ctypes / analysis tooling); keep field order and sizes stable.
+extern "C" {
+struct NvDsObbFrame {
+  uint64_t seq;        // monotonically increasing, 0 = no frame
+  uint64_t frame_num;  // per-source frame counter (see parser_context.h)
+  int32_t source_id;   // batch slot of the frame, i.e. frame_meta.batch_id
+  int32_t slot;        // ring slot index, needed by NvDsInferObbRelease
+  int32_t count;       // detections in data
+  int32_t stride;      // floats per detection: kObbValuesPerDet
+  int32_t flags;       // kObbFrame* bits
+  int32_t reserved;
+  const float* data;   // count*stride floats: [cx,cy,w,h,theta,conf,cls], theta in radians, cls as float
+};
+
+// Acquire the oldest finished frame newer than after_seq (source_id < 0 matches any source).
+// Returns 1 and fills *frame on success; the data stays valid until NvDsInferObbRelease.
+int NvDsInferObbAcquire(int source_id, uint64_t after_seq, NvDsObbFrame* frame);
+
+// Acquire the newest finished frame (source_id < 0 matches any source).
+int NvDsInferObbAcquireLatest(int source_id, NvDsObbFrame* frame);
+
+// Acquire the frame with exactly this (source_id, frame_num); returns 0 if it is not (or no longer) in the ring.
+int NvDsInferObbAcquireFrame(int source_id, uint64_t frame_num, NvDsObbFrame* frame);
+
+void NvDsInferObbRelease(const NvDsObbFrame* frame);
+}
+
+// Centres and sizes are in source-frame pixels (its size was known to the parser), not network pixels.
+constexpr int32_t kObbFrameSourceCoords = 1;
+
+constexpr int kObbRingSlots = 16;
+constexpr int kObbMaxDets = 256;
+constexpr int kObbValuesPerDet = 7;
+
+// Copies count rows of kObbValuesPerDet floats into the next free slot and publishes it under tag.
+// Returns the frame seq, or 0 when every slot was held by a reader and the frame was dropped.
+uint64_t publish_obb_rows(const float* rows, int count, const FrameTag& tag, int32_t flags);
+
+#endif
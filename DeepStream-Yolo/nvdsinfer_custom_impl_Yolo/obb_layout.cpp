@@ -0,0 +1,86 @@
+// obb_layout.cpp
+
+#include "obb_layout.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include "parser_log.h"
+
+namespace {
+
+thread_local bool t_set = false;
+thread_local NvDsInferDims t_dims{};
+thread_local ObbLayout t_lay;
+
+bool same_dims(const NvDsInferDims& a, const NvDsInferDims& b) {
+  if (a.numDims != b.numDims) return false;
+  for (unsigned int i = 0; i < a.numDims; ++i) {
+    if (a.d[i] != b.d[i]) return false;
+  }
+  return true;
+}
+
+ObbLayout probe(const NvDsInferDims& d) {
+  ObbLayout lay;
+  if (d.numDims == 2) { lay.num_preds = d.d[0]; lay.dim = d.d[1]; }
+  else if (d.numDims == 3) { lay.num_preds = d.d[1]; lay.dim = d.d[2]; }
+  else return lay;
+  if (lay.num_preds <= 0 || lay.dim < 7) return lay;  // box + theta + obj + at least one class
+  lay.nc = lay.dim - 6;
+  lay.valid = true;
+  return lay;
+}
+
+int env_order() {
+  static const int order = [] {
+    const char* v = std::getenv("SQUEAKVIEW_OBB_LAYOUT");
+    if (v && std::strcmp(v, "theta_obj") == 0) return static_cast<int>(kObbThetaObj);
+    if (v && std::strcmp(v, "obj_theta") == 0) return static_cast<int>(kObbObjTheta);
+    return static_cast<int>(kObbOrderUnknown);
+  }();
+  return order;
+}
+
+inline bool is_angle(float v) { return std::fabs(v) <= 3.5f; }
+inline bool is_prob(float v) { return v >= 0.f && v <= 1.0001f; }
+
+} // namespace
+
+ObbLayout& obb_layout(const NvDsInferDims& dims) {
+  if (t_set && same_dims(t_dims, dims)) return t_lay;
+  t_lay = probe(dims);
+  t_dims = dims;
+  t_set = true;
+  if (t_lay.valid) {
+    PARSER_LOG(kLogInfo, "[OBB][parser] layout num_preds=%d dim=%d nc=%d", t_lay.num_preds, t_lay.dim, t_lay.nc);
+  } else {
+    PARSER_LOG(kLogWarn, "[OBB][parser] unsupported output dims (numDims=%u)", dims.numDims);
+  }
+  return t_lay;
+}
+
+int resolve_obb_order(ObbLayout& lay, const float* data) {
+  if (lay.order != kObbOrderUnknown) return lay.order;
+  if (env_order() != kObbOrderUnknown) {
+    lay.order = env_order();
+    return lay.order;
+  }
+
+  int theta_obj = 0, obj_theta = 0;
+  for (int i = 0; i < lay.num_preds; ++i) {
+    const float* p = data + static_cast<size_t>(i) * lay.dim;
+    const bool l0 = is_angle(p[4]) && is_prob(p[5]);
+    const bool l1 = is_angle(p[5]) && is_prob(p[4]);
+    if (l0 && !l1) ++theta_obj;
+    else if (l1 && !l0) ++obj_theta;
+  }
+  if (theta_obj + obj_theta == 0) return kObbThetaObj;
+
+  lay.order = obj_theta > theta_obj ? kObbObjTheta : kObbThetaObj;
+  PARSER_LOG(kLogInfo, "[OBB][parser] channel order %s (%d rows theta_obj, %d rows obj_theta)",
+             lay.order == kObbObjTheta ? "obj_theta" : "theta_obj", theta_obj, obj_theta);
+  return lay.order;
+}
@@ -0,0 +1,33 @@
+// obb_layout.h  (output tensor layout of the OBB head, probed once per engine)
+// Exports disagree on whether theta or the objectness score comes first after the box. Instead of guessing
+// per row, the order is taken from SQUEAKVIEW_OBB_LAYOUT or voted on over the first frame that can tell the
+// two apart, and the decoder is specialized on it.
+
+#ifndef __OBB_LAYOUT_H__
+#define __OBB_LAYOUT_H__
+
+#include "nvdsinfer.h"
+
+enum ObbChannelOrder : int {
+  kObbOrderUnknown = 0,
+  kObbThetaObj = 1,  // [cx,cy,w,h,theta, obj, cls...]  (Ultralytics)
+  kObbObjTheta = 2,  // [cx,cy,w,h, obj, theta, cls...]
+};
+
+struct ObbLayout {
+  bool valid{false};
+  int num_preds{0};
+  int dim{0};   // values per prediction: 6 + nc
+  int nc{1};    // class-score channels; 1 means single class
+  int order{kObbOrderUnknown};
+};
+
+// [N, D] or [B, N, D] with D = 6 + nc.
+ObbLayout& obb_layout(const NvDsInferDims& dims);
+
+// Settles lay.order if it is still unknown: SQUEAKVIEW_OBB_LAYOUT=theta_obj|obj_theta wins, otherwise the
+// majority of rows where only one of channels 4/5 can be a probability and the other an angle. Frames with
+// no such row leave it unknown. Returns the order to use for this frame (theta_obj while unknown).
+int resolve_obb_order(ObbLayout& lay, const float* data);
+
+#endif
@@ -0,0 +1,66 @@
+// obb_nms.cpp  (CPU rotated NMS)
+// When the enclosing-box test is exact (iou_thr >= kObbDisjointIouMax) the pass runs on the spatial grid of
+// grid_nms.h built from the enclosing boxes, so probiou is only evaluated for boxes sharing a cell. Below that
+// bound disjoint boxes can still suppress each other and every pair is tested.
+
+#include "obb_nms.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "grid_nms.h"
+#include "parser_stats.h"
+
+namespace {
+
+thread_local std::vector<uint8_t> t_removed;
+
+} // namespace
+
+int obb_nms_cuda_min(float iou_thr) {
+  static const int forced = [] {
+    const char* v = std::getenv("SQUEAKVIEW_OBB_NMS_CUDA_MIN");
+    if (!v || !*v) return -1;
+    const int n = std::atoi(v);
+    return n > 0 ? n : INT_MAX;
+  }();
+  if (forced > 0) return forced;
+  return iou_thr >= kObbDisjointIouMax ? kObbNmsCudaMinGrid : kObbNmsCudaMinPairs;
+}
+
+int obb_nms(const ObbGauss* boxes, const int* cls, int n, float iou_thr, int* keep) {
+  if (n <= 0) return 0;
+  auto suppress = [=](int i, int j) { return obb_probiou(boxes[i], boxes[j]) > iou_thr; };
+
+  if (iou_thr >= kObbDisjointIouMax) {
+    GridNms& g = grid_nms();
+    g.begin(n);
+    for (int i = 0; i < n; ++i) {
+      const ObbGauss& b = boxes[i];
+      g.set(i, b.x - b.ex, b.y - b.ey, b.x + b.ex, b.y + b.ey, cls ? cls[i] : -1);
+    }
+    g.build();
+    const int kept = g.run(0, suppress);
+    std::copy(g.keep.begin(), g.keep.begin() + kept, keep);
+    return kept;
+  }
+
+  std::vector<uint8_t>& removed = t_removed;
+  if (removed.size() < static_cast<size_t>(n)) {
+    removed.resize(n);
+    parser_stats_add(kStatAllocations, 1);
+  }
+  std::fill(removed.begin(), removed.begin() + n, 0);
+  int kept = 0;
+  for (int i = 0; i < n; ++i) {
+    if (removed[i]) continue;
+    keep[kept++] = i;
+    for (int j = i + 1; j < n; ++j) {
+      if (!removed[j] && (!cls || cls[i] == cls[j]) && suppress(i, j)) removed[j] = 1;
+    }
+  }
+  return kept;
+}
@@ -0,0 +1,86 @@
+// obb_nms.h  (rotated-box NMS for the OBB parser, CPU and CUDA)
+// Overlap is the probabilistic IoU Ultralytics uses for OBB NMS: each (cx, cy, w, h, theta) box is treated as
+// a uniform 2D distribution, approximated by its Gaussian, and IoU = 1 - Hellinger distance of the two.
+// The per-box terms are precomputed once (ObbGauss), so a pair test is a few flops plus exp/log/sqrt, and
+// pairs whose enclosing axis-aligned boxes are disjoint are rejected before that whenever it is exact.
+
+#ifndef __OBB_NMS_H__
+#define __OBB_NMS_H__
+
+#include <cmath>
+
+#ifdef __CUDACC__
+#define OBB_HD __host__ __device__ __forceinline__
+#else
+#define OBB_HD inline
+#endif
+
+struct ObbGauss {
+  float x, y;      // centre
+  float a, b, c;   // covariance [[a, c], [c, b]]
+  float sqrt_det;  // sqrt(max(a*b - c*c, 0))
+  float ex, ey;    // half extents of the enclosing axis-aligned box
+};
+
+OBB_HD ObbGauss obb_gauss(float cx, float cy, float w, float h, float theta) {
+  const float cs = cosf(theta), sn = sinf(theta);
+  const float va = w * w / 12.f, vb = h * h / 12.f;
+  ObbGauss g;
+  g.x = cx;
+  g.y = cy;
+  g.a = va * cs * cs + vb * sn * sn;
+  g.b = va * sn * sn + vb * cs * cs;
+  g.c = (va - vb) * cs * sn;
+  g.sqrt_det = sqrtf(fmaxf(g.a * g.b - g.c * g.c, 0.f));
+  g.ex = 0.5f * (fabsf(w * cs) + fabsf(h * sn));
+  g.ey = 0.5f * (fabsf(w * sn) + fabsf(h * cs));
+  return g;
+}
+
+// Same formula and eps as ultralytics.utils.metrics.batch_probiou.
+OBB_HD float obb_probiou(const ObbGauss& p, const ObbGauss& q) {
+  const float eps = 1e-7f;
+  const float a = p.a + q.a, b = p.b + q.b, c = p.c + q.c;
+  const float dx = p.x - q.x, dy = p.y - q.y;
+  const float den = a * b - c * c + eps;
+  const float t1 = (a * dy * dy + b * dx * dx) / den * 0.25f;
+  const float t2 = (c * (q.x - p.x) * dy) / den * 0.5f;
+  const float t3 = 0.5f * logf(den / (4.f * p.sqrt_det * q.sqrt_det + eps) + eps);
+  const float bd = fminf(fmaxf(t1 + t2 + t3, eps), 100.f);
+  return 1.f - sqrtf(1.f - expf(-bd) + eps);
+}
+
+OBB_HD bool obb_aabb_overlap(const ObbGauss& p, const ObbGauss& q) {
+  return fabsf(p.x - q.x) < p.ex + q.ex && fabsf(p.y - q.y) < p.ey + q.ey;
+}
+
+// Boxes with disjoint enclosing boxes are at Bhattacharyya distance >= 0.75 (the Mahalanobis term alone
+// reaches it, the log-det term is never negative), i.e. probiou <= 0.2736. For iou thresholds at or above
+// this bound the axis-aligned test never rejects a pair that probiou would suppress.
+constexpr float kObbDisjointIouMax = 0.275f;
+
+// Candidate counts from which NvDsInferParseYoloOBB hands NMS to the GPU, i.e. where obb_nms() gets slower than a
+// synchronous obb_nms_cuda() round trip (two copies, a memset, the mask kernel and a stream sync, a few tens of us)
+// on a frame of mostly distinct boxes. Below kObbDisjointIouMax every pair is tested, ~145 us at 128 boxes and
+// ~560 us at 300, so the GPU takes over from 128, inside the default SQUEAKVIEW_TOPK of 300. At or above it the
+// grid pass stays under ~40 us at 300 boxes and reaches ~120 us at 512, so at the default SQUEAKVIEW_NMS_IOU the
+// GPU only runs once SQUEAKVIEW_TOPK is raised to 512 or more (top-K caps the candidates before NMS).
+// bench/parser_bench --parser obb_nms measures both sides on the target.
+constexpr int kObbNmsCudaMinPairs = 128;
+constexpr int kObbNmsCudaMinGrid = 512;
+
+// Candidate count from which NMS at iou_thr runs on the GPU: SQUEAKVIEW_OBB_NMS_CUDA_MIN (read once; 0 keeps it on
+// the CPU) or the crossover above.
+int obb_nms_cuda_min(float iou_thr);
+
+// Greedy NMS over n boxes sorted by descending confidence. With cls (one class per box) only boxes of the same
+// class suppress each other; nullptr is class-agnostic. Writes the surviving indices, best first, to keep
+// (room for n) and returns their count.
+int obb_nms(const ObbGauss* boxes, const int* cls, int n, float iou_thr, int* keep);
+
+// Same result as the class-agnostic obb_nms() computed on the device: one thread per (row, 64-column block)
+// fills a suppression bitmask, which the host reduces greedily, on the parser stream of batch_slot
+// (parser_stream()). Returns -1 on a CUDA error so the caller can fall back to obb_nms().
+int obb_nms_cuda(const ObbGauss* boxes, int n, float iou_thr, int batch_slot, int* keep);
+
+#endif
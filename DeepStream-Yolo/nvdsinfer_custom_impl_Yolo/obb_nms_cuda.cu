@@ -0,0 +1,115 @@
+// obb_nms_cuda.cu  (GPU rotated NMS behind obb_nms_cuda)
+// Bitmask NMS: block (row, col) compares 64 boxes of row-block `row` against the 64 boxes of column-block
+// `col` and stores one 64-bit word per box, bit j set when box j (a worse one) is suppressed by it. The host
+// walks the words in confidence order, which is the same greedy pass as obb_nms() but with every pair
+// test done in parallel.
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "cuda_workspace.h"
+#include "obb_nms.h"
+#include "parser_log.h"
+
+namespace {
+
+constexpr int kObbNmsBlock = 64;
+
+__global__ void obbNmsMaskCuda(const ObbGauss* boxes, int n, float iouThr, int prefilter, uint64_t* mask,
+    int colBlocks)
+{
+  const int rowBlock = blockIdx.y;
+  const int colBlock = blockIdx.x;
+  if (colBlock < rowBlock) {
+    return;
+  }
+
+  const int rowSize = min(n - rowBlock * kObbNmsBlock, kObbNmsBlock);
+  const int colSize = min(n - colBlock * kObbNmsBlock, kObbNmsBlock);
+
+  __shared__ ObbGauss cols[kObbNmsBlock];
+  if (threadIdx.x < colSize) {
+    cols[threadIdx.x] = boxes[colBlock * kObbNmsBlock + threadIdx.x];
+  }
+  __syncthreads();
+
+  if (threadIdx.x >= rowSize) {
+    return;
+  }
+
+  const int i = rowBlock * kObbNmsBlock + threadIdx.x;
+  const ObbGauss a = boxes[i];
+  uint64_t bits = 0;
+  const int start = colBlock == rowBlock ? threadIdx.x + 1 : 0;
+  for (int j = start; j < colSize; ++j) {
+    if (prefilter && !obb_aabb_overlap(a, cols[j])) {
+      continue;
+    }
+    if (obb_probiou(a, cols[j]) > iouThr) {
+      bits |= 1ull << j;
+    }
+  }
+  mask[(size_t) i * colBlocks + colBlock] = bits;
+}
+
+// Per-thread (i.e. per nvinfer context) buffers reused across frames.
+struct ObbNmsWorkspace {
+  DeviceBuffer<ObbGauss> boxes;
+  DeviceBuffer<uint64_t> mask;
+  PinnedBuffer<ObbGauss> hostBoxes;
+  PinnedBuffer<uint64_t> hostMask;
+};
+
+thread_local ObbNmsWorkspace obbNmsWorkspace;
+
+} // namespace
+
+int obb_nms_cuda(const ObbGauss* boxes, int n, float iou_thr, int batch_slot, int* keep)
+{
+  if (n <= 0) {
+    return 0;
+  }
+
+  const int colBlocks = (n + kObbNmsBlock - 1) / kObbNmsBlock;
+  const size_t maskWords = (size_t) n * colBlocks;
+  ObbNmsWorkspace& ws = obbNmsWorkspace;
+  if (!ws.boxes.reserve(n) || !ws.mask.reserve(maskWords) || !ws.hostBoxes.reserve(n) ||
+      !ws.hostMask.reserve(maskWords)) {
+    PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: Failed to allocate the OBB NMS workspace");
+    return -1;
+  }
+
+  cudaStream_t stream = parser_stream(batch_slot);
+  std::memcpy(ws.hostBoxes.get(), boxes, n * sizeof(ObbGauss));
+  cudaMemcpyAsync(ws.boxes.get(), ws.hostBoxes.get(), n * sizeof(ObbGauss), cudaMemcpyHostToDevice, stream);
+  // Blocks below the diagonal return without writing; their words must read as "suppresses nothing".
+  cudaMemsetAsync(ws.mask.get(), 0, maskWords * sizeof(uint64_t), stream);
+
+  const dim3 grid(colBlocks, colBlocks);
+  obbNmsMaskCuda<<<grid, kObbNmsBlock, 0, stream>>>(ws.boxes.get(), n, iou_thr, iou_thr >= kObbDisjointIouMax,
+      ws.mask.get(), colBlocks);
+  cudaMemcpyAsync(ws.hostMask.get(), ws.mask.get(), maskWords * sizeof(uint64_t), cudaMemcpyDeviceToHost, stream);
+
+  const cudaError_t err = cudaStreamSynchronize(stream);
+  if (err != cudaSuccess) {
+    PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: OBB NMS on the GPU failed: %s", cudaGetErrorString(err));
+    return -1;
+  }
+  const uint64_t* hostMask = ws.hostMask.get();
+
+  std::vector<uint64_t> removed(colBlocks, 0);
+  int kept = 0;
+  for (int i = 0; i < n; ++i) {
+    const int block = i / kObbNmsBlock;
+    if (removed[block] & (1ull << (i % kObbNmsBlock))) {
+      continue;
+    }
+    keep[kept++] = i;
+    const uint64_t* row = hostMask + (size_t) i * colBlocks;
+    for (int b = block; b < colBlocks; ++b) {
+      removed[b] |= row[b];
+    }
+  }
+  return kept;
+}
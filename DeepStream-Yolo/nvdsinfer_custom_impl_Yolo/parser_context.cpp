@@ -0,0 +1,200 @@
+// parser_context.cpp
+
+#include "parser_context.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include "frame_timing.h"
+#include "parser_trace.h"
+#include "tile_grid.h"
+
+namespace {
+
+struct SlotTracker {
+  const uint8_t* last{nullptr};
+  size_t last_bytes{0};
+  int slot{0};
+};
+
+// One tracker per nvinfer thread: every GIE runs its parser on its own output thread.
+thread_local SlotTracker t_tracker;
+
+std::atomic<uint64_t> g_slot_frames[kMaxBatchSlots];
+
+// Source size per slot packed as (w << 32) | h; 0 = not set by the runner.
+std::atomic<uint64_t> g_slot_src[kMaxBatchSlots];
+
+struct GeomCache {
+  uint64_t src_key{~0ull};
+  unsigned int net_w{0}, net_h{0};
+  LetterboxGeom geom;
+};
+
+thread_local GeomCache t_geom[kMaxBatchSlots];
+
+inline uint64_t pack_size(uint32_t w, uint32_t h) {
+  return (static_cast<uint64_t>(w) << 32) | h;
+}
+
+uint32_t env_dim(const char* name) {
+  if (const char* v = std::getenv(name)) {
+    const double d = std::atof(v);
+    if (d > 0) return static_cast<uint32_t>(d + 0.5);
+  }
+  return 0;
+}
+
+uint64_t env_source_size() {
+  static const uint64_t packed = [] {
+    // Either variable may be missing; its half stays 0 and falls back to the network size.
+    return pack_size(env_dim("SQUEAKVIEW_SRC_W"), env_dim("SQUEAKVIEW_SRC_H"));
+  }();
+  return packed;
+}
+
+} // namespace
+
+int parser_topk() {
+  static const int topk = [] {
+    if (const char* v = std::getenv("SQUEAKVIEW_TOPK")) {
+      return std::max(0, std::atoi(v));
+    }
+    return kParserDefaultTopK;
+  }();
+  return topk;
+}
+
+float parser_nms_iou() {
+  static const float iou = [] {
+    if (const char* v = std::getenv("SQUEAKVIEW_NMS_IOU")) {
+      const float f = static_cast<float>(std::atof(v));
+      if (f > 0.f && f <= 1.f) return f;
+    }
+    return kParserDefaultNmsIou;
+  }();
+  return iou;
+}
+
+bool parser_nms_class_aware() {
+  static const bool aware = [] {
+    const char* v = std::getenv("SQUEAKVIEW_NMS_CLASS_AWARE");
+    return v && std::atoi(v) == 1;
+  }();
+  return aware;
+}
+
+bool parser_detect_nms() {
+  static const bool on = [] {
+    const char* v = std::getenv("SQUEAKVIEW_DETECT_NMS");
+    return v && std::atoi(v) == 1;
+  }();
+  return on;
+}
+
+size_t layer_frame_bytes(const NvDsInferLayerInfo& L) {
+  size_t elem = 4;
+  switch (L.dataType) {
+    case NvDsInferDataType::HALF: elem = 2; break;
+    case NvDsInferDataType::INT8: elem = 1; break;
+    default: elem = 4; break;
+  }
+  size_t n = L.inferDims.numElements;
+  if (n == 0) {
+    n = L.inferDims.numDims > 0 ? 1 : 0;
+    for (unsigned int i = 0; i < L.inferDims.numDims; ++i) n *= L.inferDims.d[i];
+  }
+  return n * elem;
+}
+
+YoloOutputLayers yolo_output_layers(const std::vector<NvDsInferLayerInfo>& layers) {
+  YoloOutputLayers out;
+  for (const NvDsInferLayerInfo& L : layers) {
+    if (L.layerName && std::strcmp(L.layerName, "count") == 0 && L.dataType == NvDsInferDataType::INT32) {
+      out.count = &L;
+    } else if (!out.boxes) {
+      out.boxes = &L;
+    }
+  }
+  return out;
+}
+
+unsigned int yolo_valid_rows(const NvDsInferLayerInfo* count, unsigned int frame, unsigned int rows) {
+  if (!count) {
+    return rows;
+  }
+  if (!count->buffer) {
+    return 0;
+  }
+  const int n = static_cast<const int*>(count->buffer)[frame];
+  return n <= 0 ? 0 : std::min<unsigned int>(n, rows);
+}
+
+FrameTag tag_frame(const NvDsInferLayerInfo& L) {
+  const uint8_t* buf = static_cast<const uint8_t*>(L.buffer);
+  const size_t bytes = layer_frame_bytes(L);
+  SlotTracker& t = t_tracker;
+  // Contiguous step from the previous call -> next frame of the same batch; anything else starts a batch.
+  if (t.last && bytes > 0 && bytes == t.last_bytes && buf == t.last + bytes && t.slot + 1 < kMaxBatchSlots) {
+    ++t.slot;
+  } else {
+    t.slot = 0;
+  }
+  t.last = buf;
+  t.last_bytes = bytes;
+
+  FrameTag tag;
+  tag.batch_slot = t.slot;
+  tag.frame_num = g_slot_frames[t.slot].fetch_add(1, std::memory_order_relaxed);
+  frame_timing_open(tag, trace_now_ns());
+  return tag;
+}
+
+FrameTag batch_entry_tag(const FrameTag& tag, int entry, int entries) {
+  FrameTag t = tag;
+  t.batch_slot = std::min(tag.batch_slot * std::max(entries, 1) + entry, kMaxBatchSlots - 1);
+  return t;
+}
+
+const LetterboxGeom& letterbox_geom(int batch_slot, const NvDsInferNetworkInfo& net) {
+  const int slot = std::min(std::max(batch_slot, 0), kMaxBatchSlots - 1);
+  // With tiling a slot is one tile of its source; the source size is set per source.
+  const TileSpec& tiles = tile_spec();
+  uint64_t key = g_slot_src[tile_source(slot)].load(std::memory_order_relaxed);
+  if (key == 0) key = env_source_size();
+
+  GeomCache& c = t_geom[slot];
+  if (c.src_key == key && c.net_w == net.width && c.net_h == net.height) return c.geom;
+
+  LetterboxGeom& g = c.geom;
+  g.net_w = static_cast<float>(net.width);
+  g.net_h = static_cast<float>(net.height);
+  g.source_coords = key != 0;
+  const uint32_t w = static_cast<uint32_t>(key >> 32), h = static_cast<uint32_t>(key & 0xffffffffu);
+  g.src_w = w ? static_cast<float>(w) : g.net_w;
+  g.src_h = h ? static_cast<float>(h) : g.net_h;
+  TileRect r;
+  r.w = g.src_w;
+  r.h = g.src_h;
+  if (tiles.active()) r = tile_rect(tiles, slot % tiles.count(), g.src_w, g.src_h);
+  // The tile origin goes into the padding: (x - pad) / gain lands in source coords, letterboxed or tiled.
+  g.gain = std::min(g.net_w / r.w, g.net_h / r.h);
+  g.pad_x = 0.5f * (g.net_w - r.w * g.gain) - r.x * g.gain;
+  g.pad_y = 0.5f * (g.net_h - r.h * g.gain) - r.y * g.gain;
+  c.src_key = key;
+  c.net_w = net.width;
+  c.net_h = net.height;
+  return g;
+}
+
+extern "C" void NvDsInferSetSourceResolution(int source_id, int width, int height) {
+  const uint64_t key = (width > 0 && height > 0)
+      ? pack_size(static_cast<uint32_t>(width), static_cast<uint32_t>(height)) : 0ull;
+  if (source_id < 0) {
+    for (auto& s : g_slot_src) s.store(key, std::memory_order_relaxed);
+  } else if (source_id < kMaxBatchSlots) {
+    g_slot_src[source_id].store(key, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,81 @@
+// parser_context.h  (per-call bookkeeping shared by the pose / OBB parsers)
+// nvinfer never passes source ids or frame numbers to a parse function. For batched engines it calls the
+// parser once per frame, with each layer buffer advanced by exactly one frame of output. We recover the
+// batch slot from that pointer step. Slot i is the i-th frame of the nvstreammux batch (frame_meta.batch_id),
+// which is the source id while every camera contributes a frame to each batch.
+
+#ifndef __PARSER_CONTEXT_H__
+#define __PARSER_CONTEXT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "nvdsinfer.h"
+
+constexpr int kMaxBatchSlots = 64;
+
+struct FrameTag {
+  int batch_slot{0};      // index of this frame inside the current batch
+  uint64_t frame_num{0};  // frames parsed so far for this batch slot (0-based)
+};
+
+// Letterbox mapping between network input and source frame for one batch slot.
+struct LetterboxGeom {
+  float net_w{0}, net_h{0};
+  float src_w{0}, src_h{0};
+  float gain{1}, pad_x{0}, pad_y{0};
+  bool source_coords{false};  // src size is known (env or NvDsInferSetSourceResolution), not just net size
+};
+
+size_t layer_frame_bytes(const NvDsInferLayerInfo& L);
+
+// Output layers of a YoloLayer engine: the [N, 6] rows and, for engines built with YOLO_OUTPUT_COMPACT, the INT32
+// "count" layer holding how many of those rows are valid (nullptr for the dense output).
+struct YoloOutputLayers {
+  const NvDsInferLayerInfo* boxes{nullptr};
+  const NvDsInferLayerInfo* count{nullptr};
+};
+
+YoloOutputLayers yolo_output_layers(const std::vector<NvDsInferLayerInfo>& layers);
+
+// Valid rows of frame `frame` of the count layer's buffer, clamped to the rows a frame holds (all of them when
+// count is nullptr).
+unsigned int yolo_valid_rows(const NvDsInferLayerInfo* count, unsigned int frame, unsigned int rows);
+
+// Works out which batch slot L.buffer belongs to and advances that slot's frame counter.
+FrameTag tag_frame(const NvDsInferLayerInfo& L);
+
+// Tag for entry `entry` of a tensor that itself holds `entries` frames ([B, C, N] with B > 1): slot
+// tag.batch_slot * entries + entry, same frame_num.
+FrameTag batch_entry_tag(const FrameTag& tag, int entry, int entries);
+
+// Geometry for this batch slot at this network size. Recomputed only when the network size or the slot's
+// source resolution changes; the SQUEAKVIEW_SRC_W/H fallback is read from the environment once.
+const LetterboxGeom& letterbox_geom(int batch_slot, const NvDsInferNetworkInfo& net);
+
+// Candidates kept ahead of NMS, best first; 0 = no limit. nvinfer keeps `topk` from [class-attrs-*] to
+// itself, so the parsers take it from SQUEAKVIEW_TOPK (read once, default kParserDefaultTopK).
+constexpr int kParserDefaultTopK = 300;
+int parser_topk();
+
+// IoU threshold for the NMS run inside the library. nms-iou-threshold is not passed to parsers either, so
+// it comes from SQUEAKVIEW_NMS_IOU (read once, default kParserDefaultNmsIou).
+constexpr float kParserDefaultNmsIou = 0.45f;
+float parser_nms_iou();
+
+// Whether the pose and OBB NMS only lets boxes of the same class suppress each other, like Ultralytics'
+// default. Off unless SQUEAKVIEW_NMS_CLASS_AWARE=1 (read once), which keeps single-class heads unaffected.
+bool parser_nms_class_aware();
+
+// SQUEAKVIEW_DETECT_NMS=1 (read once) makes the bbox parser run its own per-class NMS (parser_nms_iou(), top-K
+// parser_topk()), so nvinfer can be configured with cluster-mode=4 and skip its clustering.
+bool parser_detect_nms();
+
+extern "C" {
+// Sets the source frame size used to unletterbox results of one batch slot (source_id < 0: every slot).
+// width or height <= 0 clears it back to the environment / network-size default.
+void NvDsInferSetSourceResolution(int source_id, int width, int height);
+}
+
+#endif
@@ -0,0 +1,48 @@
+// parser_log.cpp
+
+#include "parser_log.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+int initial_level() {
+  if (const char* v = std::getenv("SQUEAKVIEW_PARSER_LOG")) {
+    char* end = nullptr;
+    const long n = std::strtol(v, &end, 10);
+    if (end != v) return static_cast<int>(n);
+  }
+  return kLogWarn;
+}
+
+} // namespace
+
+std::atomic<int> g_parser_log_level{initial_level()};
+
+extern "C" void NvDsInferParserSetLogLevel(int level) {
+  g_parser_log_level.store(level, std::memory_order_relaxed);
+}
+
+void parser_log_write(int level, const char* fmt, ...) {
+  char buf[1024];
+  va_list args;
+  va_start(args, fmt);
+  int n = std::vsnprintf(buf, sizeof(buf) - 1, fmt, args);
+  va_end(args);
+  if (n < 0) return;
+  if (n > static_cast<int>(sizeof(buf)) - 2) n = static_cast<int>(sizeof(buf)) - 2;
+  buf[n++] = '\n';
+  std::fwrite(buf, 1, static_cast<size_t>(n), stdout);
+  if (level <= kLogWarn) std::fflush(stdout);
+}
+
+bool parser_log_rate_ok(std::atomic<int64_t>& last_ms, int interval_ms) {
+  const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  int64_t prev = last_ms.load(std::memory_order_relaxed);
+  if (prev != 0 && now - prev < interval_ms) return false;
+  return last_ms.compare_exchange_strong(prev, now, std::memory_order_relaxed);
+}
@@ -0,0 +1,55 @@
+// parser_log.h  (levelled, rate-limited logging for the parse callbacks)
+// Runtime level: SQUEAKVIEW_PARSER_LOG=0..4 (error, warn, info, debug, trace; default warn), or
+// NvDsInferParserSetLogLevel() at any time. Build with `make LOG_LEVEL=n` to compile out every call
+// above level n; disabled calls cost one integer compare and never evaluate their arguments.
+// Lines are formatted into a stack buffer and written with one fwrite; only warnings and errors flush.
+
+#ifndef __PARSER_LOG_H__
+#define __PARSER_LOG_H__
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef PARSER_LOG_MAX_LEVEL
+#define PARSER_LOG_MAX_LEVEL 4
+#endif
+
+enum ParserLogLevel : int { kLogError = 0, kLogWarn = 1, kLogInfo = 2, kLogDebug = 3, kLogTrace = 4 };
+
+extern "C" void NvDsInferParserSetLogLevel(int level);
+
+extern std::atomic<int> g_parser_log_level;
+
+inline bool parser_log_enabled(int level) {
+  return level <= PARSER_LOG_MAX_LEVEL && level <= g_parser_log_level.load(std::memory_order_relaxed);
+}
+
+void parser_log_write(int level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// True at most once per interval_ms for the call site owning `last_ms`.
+bool parser_log_rate_ok(std::atomic<int64_t>& last_ms, int interval_ms);
+
+#define PARSER_LOG(level, ...)                                              \
+  do {                                                                      \
+    if (parser_log_enabled(level)) parser_log_write((level), __VA_ARGS__);  \
+  } while (0)
+
+#define PARSER_LOG_ONCE(level, ...)                                         \
+  do {                                                                      \
+    if (parser_log_enabled(level)) {                                        \
+      static std::atomic<bool> logged_once_{false};                         \
+      if (!logged_once_.exchange(true, std::memory_order_relaxed))          \
+        parser_log_write((level), __VA_ARGS__);                             \
+    }                                                                       \
+  } while (0)
+
+#define PARSER_LOG_EVERY_MS(level, interval_ms, ...)                        \
+  do {                                                                      \
+    if (parser_log_enabled(level)) {                                        \
+      static std::atomic<int64_t> logged_at_ms_{0};                         \
+      if (parser_log_rate_ok(logged_at_ms_, (interval_ms)))                 \
+        parser_log_write((level), __VA_ARGS__);                             \
+    }                                                                       \
+  } while (0)
+
+#endif
@@ -0,0 +1,133 @@
+// parser_pool.cpp
+
+#include "parser_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Job {
+  const std::function<void(int)>* fn{nullptr};
+  int n{0};
+  std::atomic<int> next{0};
+  int done{0};    // guarded by Pool::m
+  int active{0};  // workers currently running indices of this job, guarded by Pool::m
+};
+
+class Pool {
+public:
+  explicit Pool(int size) {
+    for (int i = 0; i < size; ++i) workers_.emplace_back([this] { work(); });
+  }
+
+  ~Pool() {
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      stop_ = true;
+    }
+    cv_work_.notify_all();
+    for (auto& t : workers_) t.join();
+  }
+
+  int size() const { return static_cast<int>(workers_.size()); }
+
+  void run(int n, const std::function<void(int)>& fn) {
+    Job job;
+    job.fn = &fn;
+    job.n = n;
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      jobs_.push_back(&job);
+    }
+    cv_work_.notify_all();
+
+    const int mine = drain(job);
+    std::unique_lock<std::mutex> lock(m_);
+    job.done += mine;
+    jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+    cv_done_.wait(lock, [&] { return job.done == job.n && job.active == 0; });
+  }
+
+private:
+  static int drain(Job& job) {
+    int ran = 0;
+    for (int i = job.next.fetch_add(1); i < job.n; i = job.next.fetch_add(1)) {
+      (*job.fn)(i);
+      ++ran;
+    }
+    return ran;
+  }
+
+  void work() {
+    std::unique_lock<std::mutex> lock(m_);
+    for (;;) {
+      Job* job = nullptr;
+      cv_work_.wait(lock, [&] {
+        if (stop_) return true;
+        for (Job* j : jobs_) {
+          if (j->next.load() < j->n) { job = j; return true; }
+        }
+        return false;
+      });
+      if (stop_) return;
+      ++job->active;
+      lock.unlock();
+      const int ran = drain(*job);
+      lock.lock();
+      job->done += ran;
+      --job->active;
+      if (job->done == job->n && job->active == 0) cv_done_.notify_all();
+    }
+  }
+
+  std::mutex m_;
+  std::condition_variable cv_work_;
+  std::condition_variable cv_done_;
+  std::deque<Job*> jobs_;
+  std::vector<std::thread> workers_;
+  bool stop_{false};
+};
+
+int default_pool_size() {
+  if (const char* v = std::getenv("SQUEAKVIEW_PARSER_THREADS")) {
+    return std::max(0, std::atoi(v));
+  }
+  const int hw = static_cast<int>(std::thread::hardware_concurrency());
+  return std::min(3, std::max(0, hw - 1));
+}
+
+Pool& pool() {
+  static Pool p(default_pool_size());
+  return p;
+}
+
+} // namespace
+
+void parallel_for(int n, const std::function<void(int)>& fn) {
+  if (n <= 0) return;
+  if (n == 1 || pool().size() == 0) {
+    for (int i = 0; i < n; ++i) fn(i);
+    return;
+  }
+  pool().run(n, fn);
+}
+
+int parser_pool_size() {
+  return pool().size();
+}
+
+int decode_chunks(int n) {
+  static const int min_anchors = [] {
+    const char* v = std::getenv("SQUEAKVIEW_PARALLEL_DECODE");
+    return v ? std::max(0, std::atoi(v)) : kParallelDecodeMinAnchors;
+  }();
+  if (min_anchors == 0 || n < min_anchors || pool().size() == 0) return 1;
+  return (n + kDecodeChunkAnchors - 1) / kDecodeChunkAnchors;
+}
@@ -0,0 +1,29 @@
+// parser_pool.h  (small persistent worker pool shared by the parsers)
+// Workers start on first use and live for the life of the library. Size: SQUEAKVIEW_PARSER_THREADS,
+// else hardware threads - 1 capped at 3 (the caller always takes part, so 4 cores are busy at most).
+// Several nvinfer threads may call parallel_for at once; their jobs share the workers.
+
+#ifndef __PARSER_POOL_H__
+#define __PARSER_POOL_H__
+
+#include <functional>
+
+// Runs fn(i) for every i in [0, n) and returns when all calls finished. The calling thread runs indices
+// too; n <= 1 or a pool of size 0 runs everything inline. fn must not call parallel_for itself.
+void parallel_for(int n, const std::function<void(int)>& fn);
+
+// Worker threads in the pool (not counting callers).
+int parser_pool_size();
+
+// Anchor-parallel decode: a frame of at least SQUEAKVIEW_PARALLEL_DECODE anchors (read once, default
+// kParallelDecodeMinAnchors, 0 = never) is scanned in chunks of about kDecodeChunkAnchors on the pool, so a
+// chunk's slice of every channel stays in L1/L2. Each chunk collects its own candidates and the parser merges
+// them in chunk order, so the result is exactly the single-threaded one. Below the threshold (640x640 has 8400
+// anchors) the hand-off costs more than the scan.
+constexpr int kDecodeChunkAnchors = 4096;
+constexpr int kParallelDecodeMinAnchors = 16384;
+
+// Chunks to split a frame of n anchors into; 1 = scan it inline.
+int decode_chunks(int n);
+
+#endif
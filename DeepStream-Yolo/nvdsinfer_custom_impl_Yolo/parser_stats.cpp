@@ -0,0 +1,46 @@
+// parser_stats.cpp
+
+#include "parser_stats.h"
+
+#include <atomic>
+
+namespace {
+
+struct alignas(64) Counter {
+  std::atomic<uint64_t> value{0};
+};
+
+Counter g_counters[kStatCounters];
+
+uint64_t load(int counter) {
+  return g_counters[counter].value.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+void parser_stats_add(int counter, uint64_t n) {
+  g_counters[counter].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+void parser_stats_frame(uint64_t candidates, uint64_t passed, uint64_t detections) {
+  parser_stats_add(kStatFrames, 1);
+  parser_stats_add(kStatCandidates, candidates);
+  parser_stats_add(kStatPassed, passed);
+  parser_stats_add(kStatDetections, detections);
+}
+
+extern "C" void NvDsInferGetParserStats(NvDsParserStats* out) {
+  if (!out) return;
+  out->frames_parsed = load(kStatFrames);
+  out->candidates = load(kStatCandidates);
+  out->candidates_passed = load(kStatPassed);
+  out->detections = load(kStatDetections);
+  out->parse_ns = load(kStatParseNs);
+  out->nms_ns = load(kStatNmsNs);
+  out->cache_overwrites = load(kStatCacheOverwrites);
+  out->allocations = load(kStatAllocations);
+}
+
+extern "C" void NvDsInferResetParserStats() {
+  for (auto& c : g_counters) c.value.store(0, std::memory_order_relaxed);
+}
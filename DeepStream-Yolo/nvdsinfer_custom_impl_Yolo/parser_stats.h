@@ -0,0 +1,46 @@
+// parser_stats.h  (process-wide parser counters, exported through NvDsInferGetParserStats)
+// Every counter is a relaxed atomic on its own cache line, bumped once per frame (or per event) by the parse
+// threads; readers get a snapshot that is consistent per counter, not across counters.
+
+#ifndef __PARSER_STATS_H__
+#define __PARSER_STATS_H__
+
+#include <cstdint>
+
+enum ParserCounter : int {
+  kStatFrames = 0,
+  kStatCandidates,       // predictions scanned
+  kStatPassed,           // predictions above the confidence threshold
+  kStatDetections,       // objects left after NMS / top-K (what the parser returned)
+  kStatParseNs,          // wall time inside parse callbacks, NMS included
+  kStatNmsNs,            // wall time inside NMS
+  kStatCacheOverwrites,  // pose / OBB ring frames overwritten before any reader fetched them
+  kStatAllocations,      // arena, scratch and CUDA workspace growth events
+  kStatCounters,
+};
+
+// Layout mirrored by ctypes in apps/inference/runner.py; keep field order and sizes stable.
+extern "C" {
+struct NvDsParserStats {
+  uint64_t frames_parsed;
+  uint64_t candidates;
+  uint64_t candidates_passed;
+  uint64_t detections;
+  uint64_t parse_ns;
+  uint64_t nms_ns;
+  uint64_t cache_overwrites;
+  uint64_t allocations;
+};
+
+// Totals since load (or the last reset). Cheap enough to poll every frame.
+void NvDsInferGetParserStats(NvDsParserStats* out);
+
+void NvDsInferResetParserStats();
+}
+
+void parser_stats_add(int counter, uint64_t n);
+
+// One parsed frame: scanned predictions, those above threshold, and objects returned.
+void parser_stats_frame(uint64_t candidates, uint64_t passed, uint64_t detections);
+
+#endif
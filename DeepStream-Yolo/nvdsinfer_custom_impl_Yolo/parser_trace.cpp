@@ -0,0 +1,129 @@
+// parser_trace.cpp
+
+#include "parser_trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include "frame_timing.h"
+#include "parser_stats.h"
+
+namespace {
+
+// Bucket 0 holds everything below 1 us; bucket b >= 1 covers [2^((b-1)/4), 2^(b/4)) us, so 64 buckets reach ~50 s.
+constexpr int kBucketsPerOctave = 4;
+constexpr int kBuckets = 64;
+
+struct Window {
+  std::atomic<int64_t> second{-1};
+  std::atomic<uint64_t> buckets[kBuckets];
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum_ns{0};
+  std::atomic<uint64_t> max_ns{0};
+};
+
+Window g_windows[kTraceStages][kTraceWindows];
+
+const char* const kStageNames[kTraceStages] = {"enqueue", "parse", "nms", "cache", "engine_build", "calib_batch",
+                                               "capture"};
+
+int bucket_of(int64_t ns) {
+  if (ns < 1000) return 0;
+  const int b = static_cast<int>(std::log2(static_cast<double>(ns) / 1000.0) * kBucketsPerOctave) + 1;
+  return b < kBuckets ? b : kBuckets - 1;
+}
+
+double bucket_mid_us(int b) {
+  if (b == 0) return 0.5;
+  return std::exp2((b - 0.5) / kBucketsPerOctave);
+}
+
+// Claims the slot for `second`; the thread that wins the CAS clears it. Samples that race with the reset of a
+// slot may be dropped, which is fine for a monitoring histogram.
+Window& window_for(int stage, int64_t second) {
+  Window& w = g_windows[stage][second % kTraceWindows];
+  int64_t seen = w.second.load(std::memory_order_acquire);
+  if (seen < second && w.second.compare_exchange_strong(seen, second, std::memory_order_acq_rel)) {
+    for (auto& b : w.buckets) b.store(0, std::memory_order_relaxed);
+    w.count.store(0, std::memory_order_relaxed);
+    w.sum_ns.store(0, std::memory_order_relaxed);
+    w.max_ns.store(0, std::memory_order_relaxed);
+  }
+  return w;
+}
+
+double percentile(const uint64_t* buckets, uint64_t count, double q) {
+  const uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+  uint64_t seen = 0;
+  for (int b = 0; b < kBuckets; ++b) {
+    seen += buckets[b];
+    if (seen >= rank && seen > 0) return bucket_mid_us(b);
+  }
+  return bucket_mid_us(kBuckets - 1);
+}
+
+} // namespace
+
+int64_t trace_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void trace_record(int stage, int64_t ns) {
+  if (stage < 0 || stage >= kTraceStages) return;
+  if (ns < 0) ns = 0;
+  const int64_t now_ns = trace_now_ns();
+  if (stage == kTraceParse) {
+    parser_stats_add(kStatParseNs, static_cast<uint64_t>(ns));
+    frame_timing_close(now_ns);
+  } else if (stage == kTraceNms) {
+    parser_stats_add(kStatNmsNs, static_cast<uint64_t>(ns));
+  }
+  Window& w = window_for(stage, now_ns / 1000000000);
+  w.buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+  w.count.fetch_add(1, std::memory_order_relaxed);
+  w.sum_ns.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+  uint64_t prev = w.max_ns.load(std::memory_order_relaxed);
+  while (prev < static_cast<uint64_t>(ns) &&
+         !w.max_ns.compare_exchange_weak(prev, static_cast<uint64_t>(ns), std::memory_order_relaxed)) {
+  }
+}
+
+extern "C" int NvDsInferGetStageLatency(int stage, int window_s, NvDsStageLatency* out) {
+  if (stage < 0 || stage >= kTraceStages || !out) return 0;
+  if (window_s < 1) window_s = 1;
+  if (window_s > kTraceWindows - 1) window_s = kTraceWindows - 1;
+
+  uint64_t buckets[kBuckets] = {};
+  uint64_t count = 0, sum_ns = 0, max_ns = 0;
+  const int64_t now_s = trace_now_ns() / 1000000000;
+  for (int k = 0; k < window_s && now_s - k >= 0; ++k) {
+    const Window& w = g_windows[stage][(now_s - k) % kTraceWindows];
+    if (w.second.load(std::memory_order_acquire) != now_s - k) continue;
+    for (int b = 0; b < kBuckets; ++b) buckets[b] += w.buckets[b].load(std::memory_order_relaxed);
+    count += w.count.load(std::memory_order_relaxed);
+    sum_ns += w.sum_ns.load(std::memory_order_relaxed);
+    const uint64_t m = w.max_ns.load(std::memory_order_relaxed);
+    if (m > max_ns) max_ns = m;
+  }
+
+  *out = NvDsStageLatency{};
+  out->count = count;
+  if (count == 0) return 1;
+  out->mean_us = static_cast<double>(sum_ns) / static_cast<double>(count) / 1000.0;
+  out->p50_us = percentile(buckets, count, 0.50);
+  out->p90_us = percentile(buckets, count, 0.90);
+  out->p99_us = percentile(buckets, count, 0.99);
+  out->max_us = static_cast<double>(max_ns) / 1000.0;
+  return 1;
+}
+
+extern "C" const char* NvDsInferGetStageName(int stage) {
+  if (stage < 0 || stage >= kTraceStages) return nullptr;
+  return kStageNames[stage];
+}
+
+extern "C" int NvDsInferGetStageCount() {
+  return kTraceStages;
+}
@@ -0,0 +1,79 @@
+// parser_trace.h  (NVTX ranges and rolling per-stage latency histograms for the custom library)
+// TraceScope pushes an NVTX range for its lifetime (builds with `make NVTX=1`; otherwise the range compiles
+// out) and, when given a stage, adds its wall time to that stage's histogram. Histograms are kept per second
+// in a ring of kTraceWindows windows of log-spaced buckets, updated with relaxed atomics only, and read back
+// through NvDsInferGetStageLatency over the last few seconds.
+
+#ifndef __PARSER_TRACE_H__
+#define __PARSER_TRACE_H__
+
+#include <cstdint>
+
+#ifdef NVTX
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+enum TraceStage : int {
+  kTraceNone = -1,
+  kTraceEnqueue = 0,     // YoloLayer::enqueue, host side (kernel launches)
+  kTraceParse = 1,       // one parse callback, end to end
+  kTraceNms = 2,         // NMS inside a parser
+  kTraceCache = 3,       // publishing a frame to the pose / OBB rings
+  kTraceBuild = 4,       // Yolo::createEngine
+  kTraceCalibBatch = 5,  // one INT8 calibration batch handed to TensorRT
+  kTraceCapture = 6,     // capture to parse complete, per frame tagged through frame_timing.h
+  kTraceStages = 7,
+};
+
+constexpr int kTraceWindows = 16;
+
+// Layout mirrored by ctypes in apps/inference/runner.py; keep field order and sizes stable.
+extern "C" {
+struct NvDsStageLatency {
+  uint64_t count;  // samples in the window
+  double mean_us;
+  double p50_us;   // percentiles are bucket midpoints, i.e. within ~9% of the true value
+  double p90_us;
+  double p99_us;
+  double max_us;
+};
+
+// Latency of `stage` over the last window_s seconds (1 .. kTraceWindows - 1, the current second included).
+// Returns 0 for an unknown stage.
+int NvDsInferGetStageLatency(int stage, int window_s, NvDsStageLatency* out);
+
+// Stable short name of a stage ("parse", "nms", ...), nullptr for an unknown stage.
+const char* NvDsInferGetStageName(int stage);
+
+int NvDsInferGetStageCount();
+}
+
+int64_t trace_now_ns();
+
+void trace_record(int stage, int64_t ns);
+
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name, int stage = kTraceNone) : stage_(stage) {
+#ifdef NVTX
+    nvtxRangePushA(name);
+#else
+    (void) name;
+#endif
+    if (stage_ != kTraceNone) start_ = trace_now_ns();
+  }
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+  ~TraceScope() {
+    if (stage_ != kTraceNone) trace_record(stage_, trace_now_ns() - start_);
+#ifdef NVTX
+    nvtxRangePop();
+#endif
+  }
+
+ private:
+  int stage_;
+  int64_t start_{0};
+};
+
+#endif
@@ -0,0 +1,76 @@
+// pinned_pool.cpp
+
+#include "pinned_pool.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "mem_budget.h"
+#include "parser_log.h"
+
+namespace {
+
+constexpr int kPinnedMinClass = 12;  // 4 KiB
+constexpr int kPinnedClasses = 40;
+
+// In front of every block, so pinned_free() knows its class.
+struct alignas(16) PinnedHeader {
+  uint32_t size_class;
+};
+
+struct PinnedPool {
+  std::mutex mutex;
+  std::vector<PinnedHeader*> free[kPinnedClasses];
+};
+
+// Never destroyed: thread_local buffers still return their blocks while the process exits.
+PinnedPool& pool() {
+  static PinnedPool* p = new PinnedPool();
+  return *p;
+}
+
+} // namespace
+
+void* pinned_alloc(size_t bytes)
+{
+  int cls = kPinnedMinClass;
+  while (cls < kPinnedClasses && (size_t(1) << cls) < bytes + sizeof(PinnedHeader)) ++cls;
+  if (cls >= kPinnedClasses) throw std::bad_alloc();
+
+  PinnedPool& p = pool();
+  {
+    std::lock_guard<std::mutex> lock(p.mutex);
+    if (!p.free[cls].empty()) {
+      PinnedHeader* h = p.free[cls].back();
+      p.free[cls].pop_back();
+      return h + 1;
+    }
+  }
+
+  // Pooled blocks are never freed, so they stay on the parsers' account.
+  void* raw = nullptr;
+  if (mem_pinned_alloc(&raw, size_t(1) << cls, kMemParsers) != cudaSuccess) {
+    cudaGetLastError();
+    PARSER_LOG_ONCE(kLogWarn, "[parser] page-locked host memory unavailable, parser buffers use the heap");
+    raw = std::malloc(size_t(1) << cls);
+    if (!raw) throw std::bad_alloc();
+    mem_track(kMemParsers, kMemHost, size_t(1) << cls);
+  }
+  PinnedHeader* h = static_cast<PinnedHeader*>(raw);
+  h->size_class = static_cast<uint32_t>(cls);
+  return h + 1;
+}
+
+void pinned_free(void* ptr)
+{
+  if (!ptr) return;
+  PinnedHeader* h = static_cast<PinnedHeader*>(ptr) - 1;
+  PinnedPool& p = pool();
+  std::lock_guard<std::mutex> lock(p.mutex);
+  p.free[h->size_class].push_back(h);
+}
@@ -0,0 +1,37 @@
+// pinned_pool.h  (process-wide pool of page-locked host blocks, and a std allocator over it)
+// Blocks come in power-of-two size classes from cudaMallocHost and go back to a per-class free list instead of
+// cudaFreeHost, which synchronizes the device. So a buffer that grows, or a thread that exits, hands its pages
+// to the next user, and device-to-host copies into them run as asynchronous DMA. When page-locking fails (no
+// device, or the locked-memory limit is hit) a block falls back to the heap; copies into it are still correct,
+// only synchronous.
+
+#ifndef __PINNED_POOL_H__
+#define __PINNED_POOL_H__
+
+#include <cstddef>
+
+// Block of at least `bytes`, 16-byte aligned. Throws std::bad_alloc if neither pinned nor heap memory is left.
+void* pinned_alloc(size_t bytes);
+
+// Returns a block from pinned_alloc() to the pool (nullptr is ignored).
+void pinned_free(void* ptr);
+
+// For std::vector storage that device copies land in (pose_arena.h).
+template <typename T>
+struct PinnedAllocator {
+  typedef T value_type;
+
+  PinnedAllocator() = default;
+  template <typename U>
+  PinnedAllocator(const PinnedAllocator<U>&) {}
+
+  T* allocate(size_t n) { return static_cast<T*>(pinned_alloc(n * sizeof(T))); }
+  void deallocate(T* p, size_t) { pinned_free(p); }
+};
+
+template <typename T, typename U>
+bool operator==(const PinnedAllocator<T>&, const PinnedAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const PinnedAllocator<T>&, const PinnedAllocator<U>&) { return false; }
+
+#endif
@@ -0,0 +1,112 @@
+// pose_arena.cpp
+
+#include "pose_arena.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "grid_nms.h"
+#include "parser_context.h"
+#include "parser_stats.h"
+
+namespace {
+
+template <typename Vector>
+inline void grow(Vector& v, size_t n) {
+  if (v.size() < n) {
+    v.resize(n);
+    parser_stats_add(kStatAllocations, 1);
+  }
+}
+
+thread_local PoseArena t_arena;
+thread_local std::vector<PoseArena> t_batch_arenas;
+thread_local std::vector<PoseArena> t_chunk_arenas;
+
+} // namespace
+
+void PoseArena::begin(int max_candidates, int kpts_per_det) {
+  const size_t n = static_cast<size_t>(std::max(0, max_candidates));
+  grow(x1, n); grow(y1, n); grow(x2, n); grow(y2, n);
+  grow(score, n); grow(cls, n); grow(anchor, n);
+  grow(order, n); grow(hits, n);
+  count = 0;
+  kept = 0;
+  kpts = kpts_per_det;
+  stride = 5 + 3 * kpts_per_det;
+}
+
+void PoseArena::reserve_rows(int n) {
+  grow(rows, static_cast<size_t>(n) * stride);
+  grow(row_cls, static_cast<size_t>(n));
+  kept = n;
+}
+
+void PoseArena::reserve_kpts(int n) {
+  const size_t values = static_cast<size_t>(std::max(0, n)) * kpts;
+  grow(kx, values); grow(ky, values); grow(ks, values);
+}
+
+PoseArena& pose_arena() {
+  return t_arena;
+}
+
+std::vector<PoseArena>& pose_batch_arenas(int n) {
+  grow(t_batch_arenas, static_cast<size_t>(std::max(0, n)));
+  return t_batch_arenas;
+}
+
+std::vector<PoseArena>& pose_chunk_arenas(int n) {
+  grow(t_chunk_arenas, static_cast<size_t>(std::max(0, n)));
+  return t_chunk_arenas;
+}
+
+int pose_arena_rank(PoseArena& a, int topk) {
+  int n = a.count;
+  int* idx = a.order.data();
+  std::iota(idx, idx + n, 0);
+  const float* sc = a.score.data();
+  auto better = [sc](int l, int r) { return sc[l] > sc[r]; };
+  // Selection is linear, so a crowded frame only pays the sort and the grid pass on topk candidates.
+  if (topk > 0 && n > topk) {
+    std::nth_element(idx, idx + topk, idx + n, better);
+    n = topk;
+  }
+  std::sort(idx, idx + n, better);
+  return n;
+}
+
+int pose_arena_nms(PoseArena& a, int n, float iou_thr, const PoseOks* oks) {
+  int* idx = a.order.data();
+  GridNms& g = grid_nms();
+  g.begin(n);
+  const bool aware = parser_nms_class_aware();
+  for (int r = 0; r < n; ++r) {
+    const int i = idx[r];
+    g.set(r, a.x1[i], a.y1[i], a.x2[i], a.y2[i], aware ? a.cls[i] : -1);
+  }
+  g.build();
+
+  int kept;
+  if (!oks) {
+    kept = grid_nms_iou(g, iou_thr, 0);
+  } else {
+    const float* x1 = g.x1.data(); const float* y1 = g.y1.data();
+    const float* x2 = g.x2.data(); const float* y2 = g.y2.data();
+    kept = g.run(0, [=](int i, int j) {
+      const float w = std::max(0.f, std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]));
+      const float h = std::max(0.f, std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]));
+      const float inter = w * h;
+      const float area_i = std::max(0.f, x2[i] - x1[i]) * std::max(0.f, y2[i] - y1[i]);
+      const float area_j = std::max(0.f, x2[j] - x1[j]) * std::max(0.f, y2[j] - y1[j]);
+      const float iou = inter / (area_i + area_j - inter + 1e-6f);
+      if (iou <= kPoseOksMinIou) return false;
+      const float sim = pose_oks(*oks, i, j, area_i);
+      return sim >= 0.f ? sim > oks->thr : iou > iou_thr;
+    });
+  }
+  // keep[k] >= k, so compacting in place never overwrites an index still to be read.
+  for (int k = 0; k < kept; ++k) idx[k] = idx[g.keep[k]];
+  a.kept = kept;
+  return kept;
+}
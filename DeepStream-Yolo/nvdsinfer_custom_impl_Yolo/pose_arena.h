@@ -0,0 +1,75 @@
+// pose_arena.h  (per-thread structure-of-arrays scratch for the pose parsers)
+// Candidates live in parallel arrays so NMS only touches boxes and scores and works on indices.
+// Kept detections are written once into `rows` in the pose ring layout, so publishing is a single memcpy.
+// Storage only grows; after the first few frames a parser thread never allocates again. The output rows come
+// from the pinned pool, so the GPU parser copies its kept detections straight into them.
+
+#ifndef __POSE_ARENA_H__
+#define __POSE_ARENA_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pinned_pool.h"
+#include "pose_oks.h"
+
+struct PoseArena {
+  // Candidates above threshold (boxes already in source-frame coords).
+  std::vector<float> x1, y1, x2, y2, score;
+  std::vector<int> cls;
+  std::vector<int> anchor;    // prediction index in the output tensor, used to fetch keypoints later
+  std::vector<int> order;     // candidate indices; after NMS the first `kept` entries are the survivors
+  std::vector<int> hits;      // scratch for the channel-major objectness prefilter
+  // Keypoints of the ranked candidates for OKS NMS, [rank * kpts + k] (pose_oks.h); filled by the parser.
+  std::vector<float> kx, ky, ks;
+  // Kept detections: [x1,y1,x2,y2,conf, (x,y,score)*kpts] per row, `stride` floats each.
+  std::vector<float, PinnedAllocator<float>> rows;
+  std::vector<int, PinnedAllocator<int>> row_cls;
+
+  int count{0};
+  int kept{0};
+  int kpts{0};
+  int stride{0};
+
+  // Resets the arena for a new frame with room for max_candidates candidates.
+  void begin(int max_candidates, int kpts_per_det);
+
+  int push(float bx1, float by1, float bx2, float by2, float conf, int c, int a) {
+    const int i = count++;
+    x1[i] = bx1; y1[i] = by1; x2[i] = bx2; y2[i] = by2;
+    score[i] = conf; cls[i] = c; anchor[i] = a;
+    return i;
+  }
+
+  // Makes room for n output rows and sets kept = n.
+  void reserve_rows(int n);
+
+  // Makes room for the keypoints of n ranked candidates.
+  void reserve_kpts(int n);
+
+  float* row(int k) { return rows.data() + static_cast<size_t>(k) * stride; }
+  const float* row(int k) const { return rows.data() + static_cast<size_t>(k) * stride; }
+};
+
+// The calling thread's arena (one per nvinfer output thread).
+PoseArena& pose_arena();
+
+// The calling thread's arenas for batch entries 1..n-1 of a multi-frame tensor (entry 0 uses pose_arena()).
+// Each entry has its own arena, so entries can be decoded on different threads.
+std::vector<PoseArena>& pose_batch_arenas(int n);
+
+// The calling thread's arenas for the anchor chunks of one frame (parser_pool.h decode_chunks); only their
+// candidate arrays are used.
+std::vector<PoseArena>& pose_chunk_arenas(int n);
+
+// Keeps the topk best candidates (topk <= 0: all of them) and sorts those by score into order[0..n). Returns n.
+int pose_arena_rank(PoseArena& a, int topk);
+
+// Greedily drops the ranked candidates order[0..n) overlapping a better one by more than iou_thr (grid_nms.h,
+// same class only with parser_nms_class_aware()). With oks (keypoints of the n ranks) a box is dropped for its
+// keypoints instead, see pose_oks.h. Leaves the survivors, best first, in order[0..kept) and returns kept.
+// Does not touch `rows`.
+int pose_arena_nms(PoseArena& a, int n, float iou_thr, const PoseOks* oks = nullptr);
+
+#endif
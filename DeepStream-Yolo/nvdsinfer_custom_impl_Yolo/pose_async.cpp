@@ -0,0 +1,148 @@
+// pose_async.cpp
+
+#include "pose_async.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "parser_log.h"
+
+namespace {
+
+static_assert((kPoseAsyncJobs & (kPoseAsyncJobs - 1)) == 0, "kPoseAsyncJobs must be a power of two");
+
+// Bounded MPSC queue of job cells (Vyukov): a cell at ticket t holds seq t while free, t + 1 once submitted and
+// t + kPoseAsyncJobs after the worker finished it, which frees it for ticket t + kPoseAsyncJobs.
+struct Cell {
+  std::atomic<uint64_t> seq{0};
+  PoseAsyncJob job;
+};
+
+class Worker {
+public:
+  Worker() {
+    for (int i = 0; i < kPoseAsyncJobs; ++i) {
+      cells_[i].seq.store(static_cast<uint64_t>(i), std::memory_order_relaxed);
+    }
+    thread_ = std::thread([this] { work(); });
+  }
+
+  ~Worker() {
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  PoseAsyncJob* claim() {
+    uint64_t pos = enqueue_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& c = cells_[pos & (kPoseAsyncJobs - 1)];
+      const int64_t dif = static_cast<int64_t>(c.seq.load(std::memory_order_acquire)) - static_cast<int64_t>(pos);
+      if (dif == 0) {
+        if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.job.ticket = pos;
+          return &c.job;
+        }
+      } else if (dif < 0) {
+        // The worker is a full queue behind: wait for it, so frames stay in order and none is dropped.
+        PARSER_LOG_EVERY_MS(kLogWarn, 1000, "[POSE][async] worker %d frames behind, parser waiting",
+                            kPoseAsyncJobs);
+        std::this_thread::yield();
+        pos = enqueue_.load(std::memory_order_relaxed);
+      } else {
+        pos = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void submit(PoseAsyncJob* job) {
+    Cell& c = cells_[job->ticket & (kPoseAsyncJobs - 1)];
+    c.seq.store(job->ticket + 1, std::memory_order_release);
+    // Pairs with the fence in work(): either the worker sees this job or we see it going to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(m_);
+      cv_.notify_one();
+    }
+  }
+
+private:
+  bool ready(uint64_t pos) const {
+    return cells_[pos & (kPoseAsyncJobs - 1)].seq.load(std::memory_order_acquire) == pos + 1;
+  }
+
+  void work() {
+    pin();
+    uint64_t pos = 0;
+    for (;;) {
+      if (ready(pos)) {
+        Cell& c = cells_[pos & (kPoseAsyncJobs - 1)];
+        c.job.finish(c.job);
+        c.seq.store(pos + kPoseAsyncJobs, std::memory_order_release);
+        ++pos;
+        continue;
+      }
+      // Jobs submitted before the stop still run: the loop only returns once the queue is empty.
+      std::unique_lock<std::mutex> lock(m_);
+      if (stop_) return;
+      sleeping_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      cv_.wait(lock, [&] { return stop_ || ready(pos); });
+      sleeping_.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  static void pin() {
+    const char* v = std::getenv("SQUEAKVIEW_POSE_ASYNC_CPU");
+    if (!v || !*v) return;
+    const int cpu = std::atoi(v);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+      PARSER_LOG(kLogWarn, "[POSE][async] could not pin the worker to CPU %d", cpu);
+      return;
+    }
+    PARSER_LOG(kLogInfo, "[POSE][async] worker pinned to CPU %d", cpu);
+  }
+
+  Cell cells_[kPoseAsyncJobs];
+  std::atomic<uint64_t> enqueue_{0};
+  std::atomic<bool> sleeping_{false};
+  std::mutex m_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+Worker& worker() {
+  static Worker w;
+  return w;
+}
+
+} // namespace
+
+bool pose_async_enabled() {
+  static const bool on = [] {
+    const char* v = std::getenv("SQUEAKVIEW_POSE_ASYNC");
+    return v && std::atoi(v) == 1;
+  }();
+  return on;
+}
+
+PoseAsyncJob* pose_async_claim() {
+  return worker().claim();
+}
+
+void pose_async_submit(PoseAsyncJob* job) {
+  if (job) worker().submit(job);
+}
@@ -0,0 +1,44 @@
+// pose_async.h  (opt-in asynchronous V8 pose post-processing, pipelined with the next inference)
+// With SQUEAKVIEW_POSE_ASYNC=1 the V8 CPU pose parser keeps only the cheap part on nvinfer's output thread: the
+// threshold scan, the top-K ranking and the keypoint gather of the ranked candidates. Their boxes go back to
+// nvinfer at once (cluster-mode=2 dedupes them for the OSD). The candidates are handed to one worker thread
+// through a bounded lock-free queue; the worker runs the pose NMS (box IoU or OKS), the tracker and the pose cache
+// publish while nvinfer already runs the next batch. Jobs carry the FrameTag recorded at parse time, so a frame is
+// published under its own (source, frame_num) even though it lands after nvinfer pushed the buffer downstream:
+// readers that must match a buffer exactly use NvDsInferPoseAcquireFrame.
+// SQUEAKVIEW_POSE_ASYNC_CPU=<n> pins the worker to CPU n. When the worker is kPoseAsyncJobs frames behind, the
+// parser waits for it rather than dropping a frame or publishing out of order.
+
+#ifndef __POSE_ASYNC_H__
+#define __POSE_ASYNC_H__
+
+#include <cstdint>
+
+#include "parser_context.h"
+#include "pose_arena.h"
+
+constexpr int kPoseAsyncJobs = 8;  // power of two
+
+// One frame's ranked candidates: arena candidates 0..count-1 best first, their keypoints in kx/ky/ks.
+struct PoseAsyncJob {
+  FrameTag tag;
+  LetterboxGeom geom;
+  float iou_thr{0.f};
+  bool oks{false};
+  int preds{0}, candidates{0};  // for parser_stats_frame
+  PoseArena arena;
+  void (*finish)(PoseAsyncJob&){nullptr};  // run by the worker
+  uint64_t ticket{0};                       // queue position, set by pose_async_claim
+};
+
+// SQUEAKVIEW_POSE_ASYNC=1, read once.
+bool pose_async_enabled();
+
+// Claims the next job slot, waiting while the queue is full. A claimed job must be submitted; the worker takes
+// jobs in claim order. Safe from several threads.
+PoseAsyncJob* pose_async_claim();
+
+// Hands a claimed, filled job to the worker.
+void pose_async_submit(PoseAsyncJob* job);
+
+#endif
@@ -0,0 +1,186 @@
+// pose_cache.cpp  (pose frames on a FrameRing behind NvDsInferPoseAcquire / NvDsInferGetPoseCache)
+
+#include "pose_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "frame_ring.h"
+#include "half_float.h"
+#include "motion_gate.h"
+#include "parser_stats.h"
+#include "result_record.h"
+#include "result_shm.h"
+
+namespace {
+
+FrameRing<kPoseRingSlots, kPoseMaxDets, kPoseMaxValuesPerDet> g_pose_ring;
+
+thread_local std::vector<uint32_t> t_packed;
+
+// Packs count float rows (in_stride floats, kpts keypoints, a track id last with track) into t_packed.
+// Returns the words per record.
+int pack_compact(const float* rows, int count, int in_stride, int kpts, bool track) {
+  const int words = pose_compact_words(kpts);
+  const size_t need = static_cast<size_t>(count) * words;
+  if (t_packed.size() < need) {
+    t_packed.resize(need);
+    parser_stats_add(kStatAllocations, 1);
+  }
+  std::fill(t_packed.begin(), t_packed.begin() + need, 0u);
+  uint8_t* out = reinterpret_cast<uint8_t*>(t_packed.data());
+  for (int i = 0; i < count; ++i, out += 4 * words) {
+    const float* r = rows + static_cast<size_t>(i) * in_stride;
+    uint16_t head[6] = {float_to_half(r[0]), float_to_half(r[1]), float_to_half(r[2]), float_to_half(r[3]),
+                        float_to_half(r[4]), 0};
+    const int32_t id = track ? static_cast<int32_t>(r[in_stride - 1]) : -1;
+    std::memcpy(out, head, sizeof(head));
+    std::memcpy(out + sizeof(head), &id, sizeof(id));
+    const float inv_w = r[2] > r[0] ? kPoseCompactScale / (r[2] - r[0]) : 0.f;
+    const float inv_h = r[3] > r[1] ? kPoseCompactScale / (r[3] - r[1]) : 0.f;
+    uint8_t* xy = out + kPoseCompactHeaderBytes;
+    uint8_t* score = xy + 4 * kpts;
+    for (int k = 0; k < kpts; ++k) {
+      const float* kp = r + kPoseBaseValuesPerDet + 3 * k;
+      const int16_t q[2] = {
+          static_cast<int16_t>(std::min(32767.f, std::max(-32768.f, std::round((kp[0] - r[0]) * inv_w)))),
+          static_cast<int16_t>(std::min(32767.f, std::max(-32768.f, std::round((kp[1] - r[1]) * inv_h))))};
+      std::memcpy(xy + 4 * k, q, sizeof(q));
+      score[k] = static_cast<uint8_t>(std::min(255.f, std::max(0.f, std::round(kp[2] * 255.f))));
+    }
+  }
+  return words;
+}
+
+int frame_kpts(const FrameView& v) {
+  // A float row's track id is the one float that does not divide by 3.
+  return (v.flags & kPoseFrameCompact) ? pose_compact_kpts(v.width) : (v.width - kPoseBaseValuesPerDet) / 3;
+}
+
+int to_pose_frame(bool ok, const FrameView& v, NvDsPoseFrame* frame) {
+  if (!ok) return 0;
+  frame->seq = v.seq;
+  frame->frame_num = v.frame_num;
+  frame->source_id = v.source_id;
+  frame->slot = v.slot;
+  frame->count = v.count;
+  frame->kpts = frame_kpts(v);
+  frame->stride = v.width;
+  frame->flags = v.flags;
+  frame->data = v.data;
+  return 1;
+}
+
+int to_pose_view(bool ok, const FrameView& v, NvDsPoseView* view) {
+  if (!ok) return 0;
+  view->data = v.count > 0 ? v.data : nullptr;
+  view->shape[0] = v.count;
+  view->shape[1] = v.width;
+  view->strides[0] = static_cast<int64_t>(v.width) * sizeof(float);
+  view->strides[1] = sizeof(float);
+  view->seq = v.seq;
+  view->frame_num = v.frame_num;
+  view->source_id = v.source_id;
+  view->kpts = frame_kpts(v);
+  view->flags = v.flags;
+  view->token = v.slot;
+  return 1;
+}
+
+} // namespace
+
+int pose_cache_format() {
+  static const int format = [] {
+    const char* v = std::getenv("SQUEAKVIEW_POSE_FORMAT");
+    return v && std::strcmp(v, "compact") == 0 ? kPoseFormatCompact : kPoseFormatFloat;
+  }();
+  return format;
+}
+
+uint64_t publish_pose_rows(const float* rows, int count, int kpts, const FrameTag& tag, int32_t flags) {
+  const int extra = (flags & kPoseFrameTrackIds) ? 1 : 0;
+  const int in_stride = kPoseBaseValuesPerDet + 3 * std::max(0, kpts) + extra;
+  const int stride = kPoseBaseValuesPerDet + 3 * std::min(std::max(0, kpts), kPoseMaxKpts) + extra;
+  motion_observe(tag, rows, count, in_stride, kMotionXyxy, 4, kpts);
+  publish_pose_record(rows, count, in_stride, kpts, extra != 0, tag, flags & kPoseFrameSourceCoords);
+  if (pose_cache_format() == kPoseFormatCompact && rows) {
+    const int n = std::min(std::max(0, count), kPoseMaxDets);
+    const int words = pack_compact(rows, n, in_stride, std::min(std::max(0, kpts), kPoseMaxKpts), extra != 0);
+    // Records are copied as raw words; the ring and the segment never look inside a row.
+    const float* packed = reinterpret_cast<const float*>(t_packed.data());
+    flags |= kPoseFrameCompact;
+    shm_publish_rows(kShmKindPose, packed, n, words, words, tag, flags);
+    return g_pose_ring.publish(packed, n, words, words, tag, flags);
+  }
+  shm_publish_rows(kShmKindPose, rows, count, in_stride, stride, tag, flags);
+  return g_pose_ring.publish(rows, count, in_stride, stride, tag, flags);
+}
+
+extern "C" int NvDsInferPoseAcquire(int source_id, uint64_t after_seq, NvDsPoseFrame* frame) {
+  if (!frame) return 0;
+  FrameView v;
+  return to_pose_frame(g_pose_ring.acquire(source_id, after_seq, &v), v, frame);
+}
+
+extern "C" int NvDsInferPoseAcquireLatest(int source_id, NvDsPoseFrame* frame) {
+  if (!frame) return 0;
+  FrameView v;
+  return to_pose_frame(g_pose_ring.acquire_latest(source_id, &v), v, frame);
+}
+
+extern "C" int NvDsInferPoseAcquireFrame(int source_id, uint64_t frame_num, NvDsPoseFrame* frame) {
+  if (!frame) return 0;
+  FrameView v;
+  return to_pose_frame(g_pose_ring.acquire_frame(source_id, frame_num, &v), v, frame);
+}
+
+extern "C" void NvDsInferPoseRelease(const NvDsPoseFrame* frame) {
+  if (frame) g_pose_ring.release(frame->slot);
+}
+
+extern "C" int NvDsInferPoseViewAcquire(int source_id, uint64_t after_seq, NvDsPoseView* view) {
+  if (!view) return 0;
+  FrameView v;
+  return to_pose_view(g_pose_ring.acquire(source_id, after_seq, &v), v, view);
+}
+
+extern "C" int NvDsInferPoseViewAcquireLatest(int source_id, NvDsPoseView* view) {
+  if (!view) return 0;
+  FrameView v;
+  return to_pose_view(g_pose_ring.acquire_latest(source_id, &v), v, view);
+}
+
+extern "C" void NvDsInferPoseViewRelease(NvDsPoseView* view) {
+  if (!view || view->token < 0) return;
+  g_pose_ring.release(view->token);
+  view->token = -1;
+}
+
+extern "C" uint64_t NvDsInferGetPoseCache(float** data, int* count, int* kpts) {
+  FrameView v;
+  // The legacy call has no way to pass flags, so it only hands out plain float rows of 5 + 3*kpts.
+  if (!g_pose_ring.peek_latest(&v) || (v.flags & (kPoseFrameCompact | kPoseFrameTrackIds))) {
+    if (data) *data = nullptr;
+    if (count) *count = 0;
+    if (kpts) *kpts = 0;
+    return 0;
+  }
+  if (data) {
+    *data = v.count > 0 ? const_cast<float*>(v.data) : nullptr;
+  }
+  if (count) {
+    *count = v.count * v.width;
+  }
+  if (kpts) {
+    *kpts = frame_kpts(v);
+  }
+  return v.seq;
+}
+
+extern "C" int NvDsInferPoseFormat(int* version) {
+  if (version) *version = kPoseFormatVersion;
+  return pose_cache_format();
+}
@@ -0,0 +1,118 @@
+// pose_cache.h  (fixed-capacity ring of finished pose frames shared with the Python runner)
+// The parsers publish one frame per call; readers acquire a finished slot, read it in place and release it.
+// No locks. A slot is allocated for kPoseMaxDets detections the first time a frame is published to it
+// (frame_ring.h), so publishing only allocates while the ring fills up for the first time and a process that never
+// publishes a pose frame holds no ring memory.
+//
+// Rows are floats by default. SQUEAKVIEW_POSE_FORMAT=compact (read once) publishes compact records instead,
+// about 2.2x smaller for 17 keypoints, to the ring and the shared-memory segment; such frames carry
+// kPoseFrameCompact and their stride / width counts 32-bit words. A record is, little endian:
+//   uint16 box[4]      fp16 x1, y1, x2, y2
+//   uint16 conf        fp16
+//   uint16 reserved
+//   int32  track       track id, -1 untracked or without kPoseFrameTrackIds
+//   int16  xy[2*kpts]  keypoint x, y relative to the box: x = x1 + xy / kPoseCompactScale * (x2 - x1)
+//   uint8  score[kpts] keypoint score * 255
+// padded to pose_compact_words(kpts) words.
+
+#ifndef __POSE_CACHE_H__
+#define __POSE_CACHE_H__
+
+#include <cstdint>
+
+#include "parser_context.h"
+
+// Layout mirrored by ctypes in apps/inference/runner.py; keep field order and sizes stable.
+extern "C" {
+struct NvDsPoseFrame {
+  uint64_t seq;        // monotonically increasing, 0 = no frame
+  uint64_t frame_num;  // per-source frame counter (see parser_context.h)
+  int32_t source_id;   // batch slot of the frame, i.e. frame_meta.batch_id
+  int32_t slot;        // ring slot index, needed by NvDsInferPoseRelease
+  int32_t count;       // detections in data
+  int32_t kpts;        // keypoints per detection
+  int32_t stride;      // floats per detection: 5 + 3*kpts, plus 1 with kPoseFrameTrackIds (words if compact)
+  int32_t flags;       // kPoseFrame* bits
+  const float* data;   // count*stride floats: [x1,y1,x2,y2,conf, (x,y,score)*kpts (, track id)]
+};
+
+// Acquire the oldest finished frame newer than after_seq (source_id < 0 matches any source).
+// Returns 1 and fills *frame on success; the data stays valid until NvDsInferPoseRelease.
+int NvDsInferPoseAcquire(int source_id, uint64_t after_seq, NvDsPoseFrame* frame);
+
+// Acquire the newest finished frame (source_id < 0 matches any source).
+int NvDsInferPoseAcquireLatest(int source_id, NvDsPoseFrame* frame);
+
+// Acquire the frame with exactly this (source_id, frame_num); returns 0 if it is not (or no longer) in the ring.
+int NvDsInferPoseAcquireFrame(int source_id, uint64_t frame_num, NvDsPoseFrame* frame);
+
+void NvDsInferPoseRelease(const NvDsPoseFrame* frame);
+
+// The same pinned slot described as a 2-D float32 array, so readers can wrap it (numpy __array_interface__,
+// a memoryview, ...) without copying. Rows are [x1,y1,x2,y2,conf, (x,y,score)*kpts]. The memory belongs to the
+// ring and stays valid, and unchanged, until NvDsInferPoseViewRelease; never write through data.
+struct NvDsPoseView {
+  const float* data;   // nullptr when shape[0] == 0
+  int64_t shape[2];    // {detections, 5 + 3*kpts (+ 1 with kPoseFrameTrackIds)}, words per record if compact
+  int64_t strides[2];  // in bytes: {shape[1] * sizeof(float), sizeof(float)}
+  uint64_t seq;
+  uint64_t frame_num;
+  int32_t source_id;
+  int32_t kpts;
+  int32_t flags;       // kPoseFrame* bits
+  int32_t token;       // lifetime token of the pin, -1 once released
+};
+
+// Pin the oldest finished frame newer than after_seq / the newest finished frame (source_id < 0: any source).
+// Returns 1 and fills *view; every successful acquire needs exactly one NvDsInferPoseViewRelease.
+int NvDsInferPoseViewAcquire(int source_id, uint64_t after_seq, NvDsPoseView* view);
+int NvDsInferPoseViewAcquireLatest(int source_id, NvDsPoseView* view);
+
+// Unpins the slot and sets view->token to -1, so releasing the same view twice is harmless.
+void NvDsInferPoseViewRelease(NvDsPoseView* view);
+
+// Row format of published frames, kPoseFormatFloat or kPoseFormatCompact; *version (when given) is the
+// layout version of that format, kPoseFormatVersion.
+int NvDsInferPoseFormat(int* version);
+
+// Legacy single-frame view of the newest frame. The pointer is not pinned and is recycled
+// after kPoseRingSlots newer frames; prefer the acquire/release pair above. Only float rows
+// [x1,y1,x2,y2,conf, (x,y,score)*kpts] come out of it: while the newest frame carries kPoseFrameCompact
+// (SQUEAKVIEW_POSE_FORMAT=compact) or kPoseFrameTrackIds (SQUEAKVIEW_POSE_TRACK) it returns 0 as if there
+// were no frame, since it cannot tell the caller about either.
+uint64_t NvDsInferGetPoseCache(float** data, int* count, int* kpts);
+}
+
+// Coordinates are already unletterboxed to the source frame (its size was known to the parser).
+constexpr int32_t kPoseFrameSourceCoords = 1;
+// Every row ends with one more float, the track id from pose_track.h (-1 = untracked).
+constexpr int32_t kPoseFrameTrackIds = 2;
+// Rows are compact records (see the top of this file).
+constexpr int32_t kPoseFrameCompact = 4;
+
+constexpr int kPoseFormatFloat = 0;
+constexpr int kPoseFormatCompact = 1;
+constexpr int kPoseFormatVersion = 1;
+constexpr float kPoseCompactScale = 16384.f;  // keypoints from -2 to +2 box sides around x1 / y1
+constexpr int kPoseCompactHeaderBytes = 16;
+
+// 32-bit words of a compact record, and back.
+inline int pose_compact_words(int kpts) { return (kPoseCompactHeaderBytes + 5 * kpts + 3) / 4; }
+inline int pose_compact_kpts(int words) { return (4 * words - kPoseCompactHeaderBytes) / 5; }
+
+// SQUEAKVIEW_POSE_FORMAT, read once.
+int pose_cache_format();
+
+constexpr int kPoseRingSlots = 16;
+constexpr int kPoseMaxDets = 128;
+constexpr int kPoseMaxKpts = 50;
+constexpr int kPoseBaseValuesPerDet = 5;
+constexpr int kPoseMaxValuesPerDet = kPoseBaseValuesPerDet + 3 * kPoseMaxKpts + 1;
+
+// Copies count rows of 5 + 3*kpts floats (+ 1 with kPoseFrameTrackIds; the NvDsPoseFrame layout) into the
+// next free slot, packed to compact records in that format, and publishes it under tag with the given
+// kPoseFrame* flags. Returns the frame seq, or 0 when every slot was held by a
+// reader and the frame was dropped.
+uint64_t publish_pose_rows(const float* rows, int count, int kpts, const FrameTag& tag, int32_t flags);
+
+#endif
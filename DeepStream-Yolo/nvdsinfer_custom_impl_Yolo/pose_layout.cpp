@@ -0,0 +1,140 @@
+// pose_layout.cpp
+
+#include "pose_layout.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "parser_log.h"
+#include "pose_cache.h"
+
+namespace {
+
+struct LayoutCache {
+  bool set{false};
+  NvDsInferDims dims{};
+  PoseLayout lay;
+};
+
+thread_local LayoutCache t_v8;
+thread_local LayoutCache t_yolo26;
+
+bool same_dims(const NvDsInferDims& a, const NvDsInferDims& b) {
+  if (a.numDims != b.numDims) return false;
+  for (unsigned int i = 0; i < a.numDims; ++i) {
+    if (a.d[i] != b.d[i]) return false;
+  }
+  return true;
+}
+
+PoseLayout probe_v8(const NvDsInferDims& d) {
+  PoseLayout lay;
+  if (d.numDims == 2) {
+    // Common exported shape is [C, N] with C=5+nc+3*kpts, N=anchors.
+    const int a = d.d[0], b = d.d[1];
+    if (a < b) { lay.dim = a; lay.num_preds = b; lay.channel_major = true; }
+    else { lay.num_preds = a; lay.dim = b; }
+  } else if (d.numDims == 3) {
+    // [B, C, N] as exported by Ultralytics pose.
+    lay.batch = std::max(1, static_cast<int>(d.d[0]));
+    lay.dim = d.d[1];
+    lay.num_preds = d.d[2];
+    lay.channel_major = true;
+  } else {
+    return lay;
+  }
+  if (lay.dim < 5 + 3 || lay.num_preds <= 0) return lay; // needs at least obj + 1 kpt triplet
+
+  // dim = 5 + nc + 3*kpts: prefer an exact fit with no class channels, else the first k that leaves room.
+  int fallback_nc = -1, fallback_k = 0;
+  for (int k = 1; k <= kPoseMaxKpts; ++k) {
+    const int rem = lay.dim - 5 - 3 * k;
+    if (rem < 0) continue;
+    if (rem == 0) { fallback_nc = 0; fallback_k = k; break; }
+    if (fallback_nc < 0) { fallback_nc = rem; fallback_k = k; }
+  }
+  if (fallback_nc < 0) return lay;
+  lay.nc = fallback_nc;
+  lay.kpts = fallback_k;
+  lay.kpt_offset = 5 + lay.nc;
+  lay.valid = true;
+  return lay;
+}
+
+PoseLayout probe_yolo26(const NvDsInferDims& d) {
+  auto stride_matches = [](int s) { return s >= 6 && (s - 6) % 3 == 0; };
+  PoseLayout lay;
+  int a = 0, b = 0;
+  if (d.numDims == 2) { a = d.d[0]; b = d.d[1]; }
+  else if (d.numDims == 3) { lay.batch = std::max(1, static_cast<int>(d.d[0])); a = d.d[1]; b = d.d[2]; }
+  else return lay;
+
+  if (stride_matches(b)) { lay.num_preds = a; lay.dim = b; }                          // [.., N, S]
+  else if (stride_matches(a)) { lay.num_preds = b; lay.dim = a; lay.channel_major = true; } // [.., S, N]
+  else return lay;
+
+  lay.kpts = (lay.dim - 6) / 3;
+  lay.kpt_offset = 6;
+  lay.box = kPoseBoxXyxy;
+  lay.valid = lay.num_preds > 0;
+  return lay;
+}
+
+PoseLayout& cached(LayoutCache& c, const NvDsInferDims& dims, PoseLayout (*probe)(const NvDsInferDims&),
+                   const char* head) {
+  if (c.set && same_dims(c.dims, dims)) return c.lay;
+  c.lay = probe(dims);
+  c.dims = dims;
+  c.set = true;
+  if (c.lay.valid) {
+    PARSER_LOG(kLogInfo, "[POSE][%s] layout batch=%d num_preds=%d dim=%d nc=%d kpts=%d channel_major=%d",
+               head, c.lay.batch, c.lay.num_preds, c.lay.dim, c.lay.nc, c.lay.kpts, c.lay.channel_major ? 1 : 0);
+  } else {
+    PARSER_LOG(kLogWarn, "[POSE][%s] unsupported output dims (numDims=%u)", head, dims.numDims);
+  }
+  return c.lay;
+}
+
+int env_box_format() {
+  static const int fmt = [] {
+    const char* v = std::getenv("SQUEAKVIEW_POSE_BOX");
+    if (v && std::strcmp(v, "xyxy") == 0) return static_cast<int>(kPoseBoxXyxy);
+    if (v && std::strcmp(v, "cxcywh") == 0) return static_cast<int>(kPoseBoxCxcywh);
+    return static_cast<int>(kPoseBoxUnknown);
+  }();
+  return fmt;
+}
+
+} // namespace
+
+PoseLayout& pose_layout_v8(const NvDsInferDims& dims) {
+  return cached(t_v8, dims, probe_v8, "parser");
+}
+
+PoseLayout& pose_layout_yolo26(const NvDsInferDims& dims) {
+  return cached(t_yolo26, dims, probe_yolo26, "yolo26");
+}
+
+int resolve_box_format(PoseLayout& lay, const float* data, float net_w, float net_h, float conf_thr) {
+  if (lay.box != kPoseBoxUnknown) return lay.box;
+  if (env_box_format() != kPoseBoxUnknown) {
+    lay.box = env_box_format();
+    return lay.box;
+  }
+
+  int candidates = 0, xyxy_votes = 0;
+  for (int i = 0; i < lay.num_preds; ++i) {
+    if (data[lay.at(i, 4)] < conf_thr) continue;
+    const float c0 = data[lay.at(i, 0)], c1 = data[lay.at(i, 1)];
+    const float c2 = data[lay.at(i, 2)], c3 = data[lay.at(i, 3)];
+    ++candidates;
+    if (c2 > net_w || c3 > net_h || c0 > net_w || c1 > net_h) ++xyxy_votes;
+  }
+  if (candidates == 0) return kPoseBoxCxcywh;
+
+  lay.box = 2 * xyxy_votes > candidates ? kPoseBoxXyxy : kPoseBoxCxcywh;
+  PARSER_LOG(kLogInfo, "[POSE][parser] box format %s (%d of %d candidates looked like xyxy)",
+             lay.box == kPoseBoxXyxy ? "xyxy" : "cxcywh", xyxy_votes, candidates);
+  return lay.box;
+}
@@ -0,0 +1,46 @@
+// pose_layout.h  (output tensor layout of the pose heads, probed once per engine)
+// The shape rules run when a parser thread first sees a given set of dims. The box encoding of the
+// V8 head is settled from the first frame that has candidates, so the decoders can be specialized on
+// the descriptor and every box of a stream is decoded the same way.
+
+#ifndef __POSE_LAYOUT_H__
+#define __POSE_LAYOUT_H__
+
+#include <cstddef>
+
+#include "nvdsinfer.h"
+
+enum PoseBoxFormat : int { kPoseBoxUnknown = 0, kPoseBoxCxcywh = 1, kPoseBoxXyxy = 2 };
+
+struct PoseLayout {
+  bool valid{false};
+  int batch{1};          // frames in the tensor: d[0] of a 3D output, 1 otherwise
+  int num_preds{0};
+  int dim{0};            // values per prediction
+  int nc{0};             // class-score channels (V8 head; 0 or 1 means single class)
+  int kpts{0};
+  int kpt_offset{0};     // first keypoint channel
+  bool channel_major{false};
+  int box{kPoseBoxUnknown};
+
+  // Floats per batch entry.
+  size_t frame_elems() const { return static_cast<size_t>(num_preds) * dim; }
+
+  // Offset of channel c of prediction i within one batch entry.
+  size_t at(int i, int c) const {
+    return channel_major ? static_cast<size_t>(c) * num_preds + i : static_cast<size_t>(i) * dim + c;
+  }
+};
+
+// V8 / YOLO11 head: [C, N] or [N, C] (2D) and [B, C, N] (3D) with C = 5 + nc + 3*kpts.
+PoseLayout& pose_layout_v8(const NvDsInferDims& dims);
+
+// YOLO26 end-to-end head: [x1,y1,x2,y2,score,cls, kpts*3], either orientation, 2D or 3D.
+PoseLayout& pose_layout_yolo26(const NvDsInferDims& dims);
+
+// Settles lay.box if it is still unknown: SQUEAKVIEW_POSE_BOX=xyxy|cxcywh wins, otherwise the majority
+// vote of the "coordinate exceeds the network size" test over this frame's candidates. Frames without
+// candidates leave it unknown. Returns the format to use for this frame (cxcywh while unknown).
+int resolve_box_format(PoseLayout& lay, const float* data, float net_w, float net_h, float conf_thr);
+
+#endif
@@ -0,0 +1,121 @@
+// pose_oks.cpp
+
+#include "pose_oks.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "parser_log.h"
+
+namespace {
+
+constexpr float kCocoSigmas[17] = {0.026f, 0.025f, 0.025f, 0.035f, 0.035f, 0.079f, 0.079f, 0.072f, 0.072f,
+                                   0.062f, 0.062f, 0.107f, 0.107f, 0.087f, 0.087f, 0.089f, 0.089f};
+
+// Sigma of a label line: the last token after a separator, when it is a positive number. 0 = not given.
+float line_sigma(const char* line) {
+  const char* sep = nullptr;
+  for (const char* p = line; *p; ++p) {
+    if (*p == ' ' || *p == '\t' || *p == ',' || *p == ':' || *p == '=') sep = p;
+  }
+  const char* tok = sep ? sep + 1 : line;
+  char* end = nullptr;
+  const float v = std::strtof(tok, &end);
+  if (end == tok) return 0.f;
+  while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') ++end;
+  return *end == '\0' && v > 0.f ? v : 0.f;
+}
+
+// Sigmas from SQUEAKVIEW_KPT_SIGMAS, 0 where none was given; parsed once.
+const std::vector<float>& file_sigmas() {
+  static std::vector<float> sigmas;
+  static std::once_flag once;
+  std::call_once(once, [] {
+    const char* path = std::getenv("SQUEAKVIEW_KPT_SIGMAS");
+    if (!path || !*path) return;
+    if (FILE* f = std::fopen(path, "r")) {
+      char line[256];
+      while (std::fgets(line, sizeof(line), f)) {
+        char* s = line;
+        while (*s == ' ' || *s == '\t') ++s;
+        if (*s == '\0' || *s == '\n' || *s == '\r' || *s == '#') continue;
+        sigmas.push_back(line_sigma(s));
+      }
+      std::fclose(f);
+    } else {
+      for (const char* p = path; *p;) {
+        char* end = nullptr;
+        const float v = std::strtof(p, &end);
+        if (end == p) break;
+        sigmas.push_back(v > 0.f ? v : 0.f);
+        p = *end == ',' ? end + 1 : end;
+      }
+    }
+    int given = 0;
+    for (float v : sigmas) given += v > 0.f;
+    PARSER_LOG(kLogInfo, "[POSE][oks] %d keypoint sigmas from %s", given, path);
+  });
+  return sigmas;
+}
+
+struct OksWeights {
+  int kpts{-1};
+  std::vector<float> inv_8var;
+};
+
+thread_local OksWeights t_weights;
+
+} // namespace
+
+bool pose_oks_enabled() {
+  static const bool on = [] {
+    const char* v = std::getenv("SQUEAKVIEW_POSE_NMS");
+    return v && std::strcmp(v, "oks") == 0;
+  }();
+  return on;
+}
+
+float pose_oks_threshold() {
+  static const float thr = [] {
+    if (const char* v = std::getenv("SQUEAKVIEW_OKS_THR")) {
+      const float f = static_cast<float>(std::atof(v));
+      if (f > 0.f && f <= 1.f) return f;
+    }
+    return kPoseDefaultOksThr;
+  }();
+  return thr;
+}
+
+const float* pose_oks_weights(int kpts) {
+  OksWeights& w = t_weights;
+  if (w.kpts != kpts) {
+    const std::vector<float>& given = file_sigmas();
+    w.inv_8var.resize(kpts > 0 ? kpts : 0);
+    for (int k = 0; k < kpts; ++k) {
+      float s = k < static_cast<int>(given.size()) ? given[k] : 0.f;
+      if (s <= 0.f) s = kpts == 17 ? kCocoSigmas[k] : 1.f / kpts;
+      w.inv_8var[k] = 1.f / (8.f * s * s);
+    }
+    w.kpts = kpts;
+  }
+  return w.inv_8var.data();
+}
+
+float pose_oks(const PoseOks& o, int i, int j, float area) {
+  const float* xi = o.x + i * o.kpts; const float* yi = o.y + i * o.kpts; const float* si = o.score + i * o.kpts;
+  const float* xj = o.x + j * o.kpts; const float* yj = o.y + j * o.kpts; const float* sj = o.score + j * o.kpts;
+  const float inv_area = 1.f / (area + 1e-7f);
+  // Branch-free over the keypoints so the loop vectorizes; invisible keypoints are masked out of both sums.
+  float sum = 0.f, visible = 0.f;
+  for (int k = 0; k < o.kpts; ++k) {
+    const float dx = xi[k] - xj[k], dy = yi[k] - yj[k];
+    const float m = static_cast<float>((si[k] >= kPoseOksVisible) & (sj[k] >= kPoseOksVisible));
+    sum += m * std::exp(-(dx * dx + dy * dy) * o.inv_8var[k] * inv_area);
+    visible += m;
+  }
+  return visible > 0.f ? sum / visible : -1.f;
+}
@@ -0,0 +1,43 @@
+// pose_oks.h  (Object Keypoint Similarity suppression for the V8 pose NMS)
+// With SQUEAKVIEW_POSE_NMS=oks the CPU pose parser suppresses a candidate only when its keypoints match a better
+// one: box IoU above kPoseOksMinIou (the cheap prefilter) and OKS above SQUEAKVIEW_OKS_THR (default
+// kPoseDefaultOksThr). Two animals huddling share most of their box but not their keypoints, so both survive
+// without raising the IoU threshold for everyone. Pairs with no keypoint visible in both fall back to the box
+// IoU test.
+//
+// OKS is Ultralytics' kpt_iou: mean over the keypoints visible in both of exp(-d^2 / (8 sigma^2 area)), area
+// being the better box's. Sigmas are read once from SQUEAKVIEW_KPT_SIGMAS, the keypoint label file with a sigma
+// after each name ("nose 0.026"; "," ":" or "=" also separate) or a plain comma-separated list. Keypoints
+// without a sigma get the Ultralytics default: the COCO sigmas for 17 keypoints, else 1 / kpts.
+
+#ifndef __POSE_OKS_H__
+#define __POSE_OKS_H__
+
+constexpr float kPoseDefaultOksThr = 0.6f;
+constexpr float kPoseOksMinIou = 0.1f;
+constexpr float kPoseOksVisible = 0.5f;  // keypoint score from which a keypoint counts as visible
+
+// Keypoints of the ranked candidates in source coords, [rank * kpts + k], and the per-keypoint weights.
+struct PoseOks {
+  const float* x{nullptr};
+  const float* y{nullptr};
+  const float* score{nullptr};
+  const float* inv_8var{nullptr};  // 1 / (8 sigma^2) per keypoint
+  int kpts{0};
+  float thr{kPoseDefaultOksThr};
+};
+
+// SQUEAKVIEW_POSE_NMS=oks, read once.
+bool pose_oks_enabled();
+
+// SQUEAKVIEW_OKS_THR, read once.
+float pose_oks_threshold();
+
+// 1 / (8 sigma^2) for each of kpts keypoints. The file is parsed once, the weights for a keypoint count are
+// cached per thread.
+const float* pose_oks_weights(int kpts);
+
+// OKS of ranks i and j over box area `area`, or -1 when no keypoint is visible in both.
+float pose_oks(const PoseOks& o, int i, int j, float area);
+
+#endif
@@ -0,0 +1,207 @@
+// pose_track.cpp
+
+#include "pose_track.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "parser_trace.h"
+#include "pose_cache.h"
+
+namespace {
+
+constexpr float kMatchThreshold = 0.3f;  // combined similarity below which a detection starts a new track
+constexpr float kKptVisible = 0.3f;      // keypoints scored below this are neither filtered nor matched
+constexpr float kKptSigma = 0.1f;        // keypoint match falloff, as a fraction of the box scale
+constexpr float kDerivCutoff = 1.0f;     // Hz, One-Euro derivative cutoff
+// Frame interval bounds for the filter: replays faster than 120 fps are filtered as if they ran at 120 fps.
+constexpr float kMinDt = 1.f / 120.f;
+constexpr float kMaxDt = 1.f;
+constexpr float kPi = 3.14159265358979f;
+
+struct SmoothParams {
+  float min_cutoff{1.0f};
+  float beta{0.01f};
+  bool enabled{true};
+};
+
+const SmoothParams& smooth_params() {
+  static const SmoothParams params = [] {
+    SmoothParams p;
+    if (const char* v = std::getenv("SQUEAKVIEW_POSE_SMOOTH")) {
+      char* end = nullptr;
+      const float cutoff = std::strtof(v, &end);
+      if (end != v) {
+        p.enabled = cutoff > 0.f;
+        p.min_cutoff = cutoff;
+        if (*end == ',') p.beta = std::max(0.f, std::strtof(end + 1, nullptr));
+      }
+    }
+    return p;
+  }();
+  return params;
+}
+
+struct OneEuro {
+  float x{0}, dx{0};
+  bool init{false};
+
+  static float alpha(float dt, float cutoff) {
+    const float tau = 1.f / (2.f * kPi * cutoff);
+    return 1.f / (1.f + tau / dt);
+  }
+
+  float apply(float v, float dt, const SmoothParams& p) {
+    if (!init) { x = v; dx = 0; init = true; return v; }
+    dx += alpha(dt, kDerivCutoff) * ((v - x) / dt - dx);
+    x += alpha(dt, p.min_cutoff + p.beta * std::fabs(dx)) * (v - x);
+    return x;
+  }
+};
+
+struct Track {
+  int32_t id{-1};  // -1 = free slot
+  int misses{0};
+  // Last raw measurement, used for matching; the filters hold the smoothed state.
+  float box[4]{};
+  float kx[kPoseMaxKpts]{}, ky[kPoseMaxKpts]{}, ks[kPoseMaxKpts]{};
+  OneEuro fbox[4];
+  OneEuro fkx[kPoseMaxKpts], fky[kPoseMaxKpts];
+};
+
+struct SourceTracks {
+  Track tracks[kPoseMaxTracks];
+  int32_t next_id{0};
+  int64_t last_ns{0};
+};
+
+// Allocated on first use of a slot; the mutex only matters when two pose GIEs share a batch slot index.
+struct SourceState {
+  std::mutex mutex;
+  std::unique_ptr<SourceTracks> tracks;
+};
+
+SourceState g_sources[kMaxBatchSlots];
+
+thread_local std::vector<float> t_tracked;
+
+float box_iou(const float* a, const float* b) {
+  const float iw = std::max(0.f, std::min(a[2], b[2]) - std::max(a[0], b[0]));
+  const float ih = std::max(0.f, std::min(a[3], b[3]) - std::max(a[1], b[1]));
+  const float inter = iw * ih;
+  const float uni = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter;
+  return uni > 0.f ? inter / uni : 0.f;
+}
+
+// Mean Gaussian similarity of the keypoints visible in both; -1 when none are.
+float kpt_similarity(const Track& t, const float* row, int kpts) {
+  const float* kp = row + kPoseBaseValuesPerDet;
+  const float scale = std::sqrt(std::max(1.f, (row[2] - row[0]) * (row[3] - row[1])));
+  const float inv = 1.f / (2.f * (kKptSigma * scale) * (kKptSigma * scale));
+  float sum = 0.f;
+  int n = 0;
+  for (int j = 0; j < kpts; ++j) {
+    if (kp[3 * j + 2] < kKptVisible || t.ks[j] < kKptVisible) continue;
+    const float dx = kp[3 * j] - t.kx[j], dy = kp[3 * j + 1] - t.ky[j];
+    sum += std::exp(-(dx * dx + dy * dy) * inv);
+    ++n;
+  }
+  return n > 0 ? sum / n : -1.f;
+}
+
+float similarity(const Track& t, const float* row, int kpts) {
+  const float iou = box_iou(t.box, row);
+  const float ks = kpt_similarity(t, row, kpts);
+  return ks < 0.f ? iou : 0.5f * (iou + ks);
+}
+
+void start_track(Track& t, int32_t id) {
+  t = Track();
+  t.id = id;
+}
+
+void update_track(Track& t, float* row, int kpts, float dt, const SmoothParams& p) {
+  t.misses = 0;
+  for (int c = 0; c < 4; ++c) {
+    t.box[c] = row[c];
+    if (p.enabled) row[c] = t.fbox[c].apply(row[c], dt, p);
+  }
+  float* kp = row + kPoseBaseValuesPerDet;
+  for (int j = 0; j < kpts; ++j) {
+    t.kx[j] = kp[3 * j];
+    t.ky[j] = kp[3 * j + 1];
+    t.ks[j] = kp[3 * j + 2];
+    if (p.enabled && kp[3 * j + 2] >= kKptVisible) {
+      kp[3 * j] = t.fkx[j].apply(kp[3 * j], dt, p);
+      kp[3 * j + 1] = t.fky[j].apply(kp[3 * j + 1], dt, p);
+    }
+  }
+}
+
+} // namespace
+
+bool pose_tracking() {
+  static const bool on = [] {
+    const char* v = std::getenv("SQUEAKVIEW_POSE_TRACK");
+    return v && std::atoi(v) != 0;
+  }();
+  return on;
+}
+
+const float* pose_track_rows(const FrameTag& tag, PoseArena& arena, int32_t* flags) {
+  if (!pose_tracking() || tag.batch_slot < 0 || tag.batch_slot >= kMaxBatchSlots) return arena.rows.data();
+  TraceScope trace("pose_track");
+
+  const int kpts = std::min(arena.kpts, kPoseMaxKpts);
+  const int n = arena.kept;
+  const int out_stride = arena.stride + 1;
+  t_tracked.resize(static_cast<size_t>(std::max(n, 1)) * out_stride);
+  const SmoothParams& p = smooth_params();
+
+  SourceState& src = g_sources[tag.batch_slot];
+  std::lock_guard<std::mutex> lock(src.mutex);
+  if (!src.tracks) src.tracks.reset(new SourceTracks());
+  SourceTracks& st = *src.tracks;
+
+  const int64_t now = trace_now_ns();
+  const float dt = st.last_ns > 0 ? std::min(kMaxDt, std::max(kMinDt, (now - st.last_ns) * 1e-9f)) : 1.f / 30.f;
+  st.last_ns = now;
+
+  // Rows arrive best first, so they pick greedily in confidence order.
+  bool taken[kPoseMaxTracks] = {};
+  for (int k = 0; k < n; ++k) {
+    float* row = arena.row(k);
+    int best = -1;
+    float best_sim = kMatchThreshold;
+    for (int t = 0; t < kPoseMaxTracks; ++t) {
+      if (st.tracks[t].id < 0 || taken[t]) continue;
+      const float sim = similarity(st.tracks[t], row, kpts);
+      if (sim >= best_sim) { best = t; best_sim = sim; }
+    }
+    if (best < 0) {
+      for (int t = 0; t < kPoseMaxTracks; ++t) {
+        if (st.tracks[t].id < 0) { start_track(st.tracks[t], st.next_id++); best = t; break; }
+      }
+    }
+
+    float* out = t_tracked.data() + static_cast<size_t>(k) * out_stride;
+    if (best >= 0) {
+      taken[best] = true;
+      update_track(st.tracks[best], row, kpts, dt, p);
+    }
+    std::copy(row, row + arena.stride, out);
+    out[arena.stride] = best >= 0 ? static_cast<float>(st.tracks[best].id) : -1.f;
+  }
+
+  for (int t = 0; t < kPoseMaxTracks; ++t) {
+    Track& tr = st.tracks[t];
+    if (tr.id >= 0 && !taken[t] && ++tr.misses > kPoseTrackMaxMisses) tr.id = -1;
+  }
+
+  *flags |= kPoseFrameTrackIds;
+  return t_tracked.data();
+}
@@ -0,0 +1,30 @@
+// pose_track.h  (optional tracking and keypoint smoothing between NMS and the pose cache)
+// With SQUEAKVIEW_POSE_TRACK=1 every frame's kept detections are matched against the previous frames of the
+// same batch slot (greedy, on box IoU and keypoint similarity), their boxes and visible keypoints go through a
+// One-Euro filter, and each row reaches the pose cache with its track id appended (kPoseFrameTrackIds).
+// State is fixed-size per batch slot: kPoseMaxTracks tracks, each dropped after kPoseTrackMaxMisses frames
+// without a match. SQUEAKVIEW_POSE_SMOOTH="min_cutoff,beta" tunes the filter (default "1.0,0.01"; cutoff in
+// Hz, beta per pixel/s; "0" turns smoothing off and keeps only the ids).
+// The V8 parsers track before building the objects for nvinfer, so those boxes are smoothed as well; YOLO26
+// objects are emitted during the scan and stay raw.
+
+#ifndef __POSE_TRACK_H__
+#define __POSE_TRACK_H__
+
+#include <cstdint>
+
+#include "parser_context.h"
+#include "pose_arena.h"
+
+constexpr int kPoseMaxTracks = 32;
+constexpr int kPoseTrackMaxMisses = 15;
+
+// SQUEAKVIEW_POSE_TRACK, read once.
+bool pose_tracking();
+
+// Associates and smooths arena.rows[0..kept) in place for tag.batch_slot and returns the rows to publish: the
+// arena's own rows when tracking is off, else a per-thread copy with one extra float per row, the track id
+// (-1 when every track slot was taken). Adds kPoseFrameTrackIds to *flags in the second case.
+const float* pose_track_rows(const FrameTag& tag, PoseArena& arena, int32_t* flags);
+
+#endif
@@ -0,0 +1,226 @@
+// result_record.cpp  (builds result records and publishes them to the result rings, shared memory and the recorder)
+
+#include "result_record.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "frame_ring.h"
+#include "frame_timing.h"
+#include "parser_stats.h"
+#include "result_shm.h"
+#include "tensor_record.h"
+
+namespace {
+
+// The rings of the three kinds differ only in slot size; a record is one row of 32-bit words, which the ring
+// copies without looking inside.
+class ResultRing {
+ public:
+  virtual ~ResultRing() = default;
+  virtual uint64_t publish(const float* words, int width, const FrameTag& tag, int32_t flags) = 0;
+  virtual bool acquire(int source_id, uint64_t after_seq, FrameView* view) = 0;
+  virtual bool acquire_latest(int source_id, FrameView* view) = 0;
+  virtual bool acquire_frame(int source_id, uint64_t frame_num, FrameView* view) = 0;
+  virtual void release(int slot) = 0;
+};
+
+template <int MaxWords>
+class ResultRingOf : public ResultRing {
+ public:
+  uint64_t publish(const float* words, int width, const FrameTag& tag, int32_t flags) override {
+    return ring_.publish(words, 1, width, width, tag, flags);
+  }
+  bool acquire(int source_id, uint64_t after_seq, FrameView* view) override {
+    return ring_.acquire(source_id, after_seq, view);
+  }
+  bool acquire_latest(int source_id, FrameView* view) override { return ring_.acquire_latest(source_id, view); }
+  bool acquire_frame(int source_id, uint64_t frame_num, FrameView* view) override {
+    return ring_.acquire_frame(source_id, frame_num, view);
+  }
+  void release(int slot) override { ring_.release(slot); }
+
+ private:
+  FrameRing<kResultRingSlots, 1, MaxWords> ring_;
+};
+
+ResultRingOf<kResultDetectMaxWords> g_detect_ring;
+ResultRingOf<kResultPoseMaxWords> g_pose_ring;
+ResultRingOf<kResultObbMaxWords> g_obb_ring;
+
+ResultRing* ring_of(int kind) {
+  switch (kind) {
+    case kResultKindDetect: return &g_detect_ring;
+    case kResultKindPose: return &g_pose_ring;
+    case kResultKindObb: return &g_obb_ring;
+    default: return nullptr;
+  }
+}
+
+thread_local std::vector<uint32_t> t_record;
+
+bool records_enabled() {
+  static const bool enabled = [] {
+    const char* v = std::getenv("SQUEAKVIEW_RESULT_RECORDS");
+    return !v || std::strcmp(v, "0") != 0;
+  }();
+  return enabled;
+}
+
+// Zeroed record of this shape in t_record, header and offsets filled in.
+NvDsResultHeader* begin_record(uint16_t kind, uint32_t fields, int count, int kpts, const FrameTag& tag,
+                               int32_t flags) {
+  const uint32_t bytes = result_record_bytes(fields, count, kpts);
+  if (t_record.size() < bytes / 4) {
+    t_record.resize(bytes / 4);
+    parser_stats_add(kStatAllocations, 1);
+  }
+  // Padding is zeroed too, so the same results always give the same bytes.
+  std::memset(t_record.data(), 0, bytes);
+  NvDsResultHeader* h = reinterpret_cast<NvDsResultHeader*>(t_record.data());
+  h->magic = kResultMagic;
+  h->version = kResultVersion;
+  h->kind = kind;
+  h->bytes = bytes;
+  h->fields = fields;
+  h->frame_num = tag.frame_num;
+  h->source_id = tag.batch_slot;
+  h->count = count;
+  h->kpts = kpts;
+  h->flags = flags;
+  uint32_t at = sizeof(NvDsResultHeader);
+  for (int i = 0; i < kResultArrays; ++i) {
+    if (!((fields >> i) & 1)) continue;
+    h->offset[i] = at;
+    at += result_align(result_array_bytes(i, count, kpts));
+  }
+  return h;
+}
+
+template <typename T>
+T* array_of(NvDsResultHeader* h, int array) {
+  return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(h) + h->offset[array]);
+}
+
+uint64_t finish_record(const NvDsResultHeader* h, const FrameTag& tag) {
+  const int words = static_cast<int>(h->bytes / 4);
+  shm_publish_result(h->kind, t_record.data(), words, tag, h->flags);
+  parser_record_result(h);
+  return ring_of(h->kind)->publish(reinterpret_cast<const float*>(t_record.data()), words, tag, h->flags);
+}
+
+int to_result_frame(bool ok, int kind, const FrameView& v, NvDsResultFrame* frame) {
+  if (!ok) return 0;
+  // The pin is exclusive, so the PTS the application tagged since the publish can be stamped in place.
+  NvDsResultHeader* h = reinterpret_cast<NvDsResultHeader*>(const_cast<float*>(v.data));
+  NvDsFrameTiming timing;
+  if (h->pts_ns == 0 && NvDsInferGetFrameTiming(v.source_id, v.frame_num, &timing)) {
+    h->pts_ns = timing.pts_ns;
+  }
+  frame->seq = v.seq;
+  frame->kind = kind;
+  frame->slot = v.slot;
+  frame->record = h;
+  return 1;
+}
+
+} // namespace
+
+uint64_t publish_detect_record(const NvDsInferParseObjectInfo* objects, int count, const FrameTag& tag,
+                               int32_t flags) {
+  if (!records_enabled()) return 0;
+  count = objects ? std::max(0, count) : 0;
+  const int n = std::min(count, kResultDetectMaxDets);
+  NvDsResultHeader* h = begin_record(kResultKindDetect, kResultDetectFields, n, 0, tag,
+                                     flags | (n < count ? kResultTruncated : 0));
+  float* boxes = array_of<float>(h, kResultBoxes);
+  float* scores = array_of<float>(h, kResultScores);
+  int32_t* classes = array_of<int32_t>(h, kResultClasses);
+  for (int i = 0; i < n; ++i) {
+    const NvDsInferParseObjectInfo& o = objects[i];
+    boxes[4 * i + 0] = o.left;
+    boxes[4 * i + 1] = o.top;
+    boxes[4 * i + 2] = o.left + o.width;
+    boxes[4 * i + 3] = o.top + o.height;
+    scores[i] = o.detectionConfidence;
+    classes[i] = static_cast<int32_t>(o.classId);
+  }
+  return finish_record(h, tag);
+}
+
+uint64_t publish_pose_record(const float* rows, int count, int in_stride, int kpts, bool track_ids,
+                             const FrameTag& tag, int32_t flags) {
+  if (!records_enabled()) return 0;
+  count = rows ? std::max(0, count) : 0;
+  const int n = std::min(count, kPoseMaxDets);
+  const int k = std::min(std::max(0, kpts), kPoseMaxKpts);
+  const uint32_t fields = kResultPoseFields | (track_ids ? 1u << kResultTrackIds : 0u);
+  NvDsResultHeader* h = begin_record(kResultKindPose, fields, n, k, tag, flags | (n < count ? kResultTruncated : 0));
+  float* boxes = array_of<float>(h, kResultBoxes);
+  float* scores = array_of<float>(h, kResultScores);
+  float* keypoints = array_of<float>(h, kResultKeypoints);
+  int32_t* tracks = track_ids ? array_of<int32_t>(h, kResultTrackIds) : nullptr;
+  for (int i = 0; i < n; ++i) {
+    const float* r = rows + static_cast<size_t>(i) * in_stride;
+    std::memcpy(boxes + 4 * i, r, 4 * sizeof(float));
+    scores[i] = r[4];
+    std::memcpy(keypoints + static_cast<size_t>(i) * 3 * k, r + kPoseBaseValuesPerDet, 3 * k * sizeof(float));
+    if (tracks) tracks[i] = static_cast<int32_t>(r[in_stride - 1]);
+  }
+  return finish_record(h, tag);
+}
+
+uint64_t publish_obb_record(const float* rows, int count, const FrameTag& tag, int32_t flags) {
+  if (!records_enabled()) return 0;
+  count = rows ? std::max(0, count) : 0;
+  const int n = std::min(count, kObbMaxDets);
+  NvDsResultHeader* h = begin_record(kResultKindObb, kResultObbFields, n, 0, tag,
+                                     flags | (n < count ? kResultTruncated : 0));
+  float* boxes = array_of<float>(h, kResultBoxes);
+  float* scores = array_of<float>(h, kResultScores);
+  int32_t* classes = array_of<int32_t>(h, kResultClasses);
+  float* theta = array_of<float>(h, kResultTheta);
+  for (int i = 0; i < n; ++i) {
+    const float* r = rows + static_cast<size_t>(i) * kObbValuesPerDet;
+    boxes[4 * i + 0] = r[0] - 0.5f * r[2];
+    boxes[4 * i + 1] = r[1] - 0.5f * r[3];
+    boxes[4 * i + 2] = r[0] + 0.5f * r[2];
+    boxes[4 * i + 3] = r[1] + 0.5f * r[3];
+    theta[i] = r[4];
+    scores[i] = r[5];
+    classes[i] = static_cast<int32_t>(r[6]);
+  }
+  return finish_record(h, tag);
+}
+
+extern "C" int NvDsInferResultAcquire(int kind, int source_id, uint64_t after_seq, NvDsResultFrame* frame) {
+  ResultRing* ring = ring_of(kind);
+  if (!frame || !ring) return 0;
+  FrameView v;
+  return to_result_frame(ring->acquire(source_id, after_seq, &v), kind, v, frame);
+}
+
+extern "C" int NvDsInferResultAcquireLatest(int kind, int source_id, NvDsResultFrame* frame) {
+  ResultRing* ring = ring_of(kind);
+  if (!frame || !ring) return 0;
+  FrameView v;
+  return to_result_frame(ring->acquire_latest(source_id, &v), kind, v, frame);
+}
+
+extern "C" int NvDsInferResultAcquireFrame(int kind, int source_id, uint64_t frame_num, NvDsResultFrame* frame) {
+  ResultRing* ring = ring_of(kind);
+  if (!frame || !ring) return 0;
+  FrameView v;
+  return to_result_frame(ring->acquire_frame(source_id, frame_num, &v), kind, v, frame);
+}
+
+extern "C" void NvDsInferResultRelease(const NvDsResultFrame* frame) {
+  ResultRing* ring = frame ? ring_of(frame->kind) : nullptr;
+  if (ring) ring->release(frame->slot);
+}
+
+extern "C" int NvDsInferResultVersion() {
+  return kResultVersion;
+}
@@ -0,0 +1,145 @@
+// result_record.h  (one versioned binary frame record for the results of every parser)
+// The detection, pose and OBB parsers each publish a frame's results as one self-describing record, alongside the
+// legacy formats (the NvDsInferParseObjectInfo list, the pose cache rows and the OBB rows). The same bytes land in
+// a per-kind FrameRing behind NvDsInferResultAcquire, in the SQUEAKVIEW_SHM segments <name>_result_detect /
+// _result_pose / _result_obb (kShmKindResult, one record per slot) and, with SQUEAKVIEW_RECORD_RESULTS=1, in the
+// SQUEAKVIEW_RECORD file as records of parser "result". SQUEAKVIEW_RESULT_RECORDS=0 (read once) turns them off.
+//
+// A record is an NvDsResultHeader followed by structure-of-arrays fields, little endian. Field i is present when
+// bit i of `fields` is set and starts offset[i] bytes from the header; offsets are multiples of 64, so every array
+// starts on its own cache line:
+//   kResultBoxes      float[count][4]        x1, y1, x2, y2; for an OBB the box before rotation about its centre
+//   kResultScores     float[count]
+//   kResultClasses    int32[count]           detect and OBB records
+//   kResultTrackIds   int32[count]           pose records with tracking on, -1 = untracked
+//   kResultTheta      float[count]           OBB records, radians
+//   kResultKeypoints  float[count][kpts][3]  pose records, x, y, score
+// Coordinates are network pixels unless flags has kResultSourceCoords. Nothing in a record is a pointer, so it can
+// be copied, mapped or written to disk as is; readers check magic / version and skip what they don't know.
+// Records are written at parse time, before the application tags the frame's PTS, so pts_ns is only known to the
+// acquire calls below; the shared-memory and recorded copies keep 0 there and join on (source_id, frame_num).
+
+#ifndef __RESULT_RECORD_H__
+#define __RESULT_RECORD_H__
+
+#include <cstdint>
+
+#include "nvdsinfer_custom_impl.h"
+#include "obb_cache.h"
+#include "parser_context.h"
+#include "pose_cache.h"
+
+constexpr uint32_t kResultMagic = 0x52525153;  // "SQRR"
+constexpr uint16_t kResultVersion = 1;
+
+constexpr uint16_t kResultKindDetect = 1;
+constexpr uint16_t kResultKindPose = 2;
+constexpr uint16_t kResultKindObb = 3;
+constexpr int kResultKinds = 3;
+
+// Array indices of NvDsResultHeader::offset; bit i of fields is 1u << i.
+constexpr int kResultBoxes = 0;
+constexpr int kResultScores = 1;
+constexpr int kResultClasses = 2;
+constexpr int kResultTrackIds = 3;
+constexpr int kResultTheta = 4;
+constexpr int kResultKeypoints = 5;
+constexpr int kResultArrays = 8;
+
+// Coordinates are already in source-frame pixels (its size was known to the parser).
+constexpr int32_t kResultSourceCoords = 1;
+// The frame had more detections than the record holds; the first kResult*MaxDets are kept.
+constexpr int32_t kResultTruncated = 2;
+
+constexpr int kResultRingSlots = 16;
+constexpr int kResultDetectMaxDets = 1024;
+
+// Fixed binary layout shared with readers in other processes and runner.py; bump kResultVersion on any change.
+extern "C" {
+struct NvDsResultHeader {
+  uint32_t magic;       // kResultMagic
+  uint16_t version;     // kResultVersion
+  uint16_t kind;        // kResultKind*
+  uint32_t bytes;       // whole record, this header included, a multiple of 64
+  uint32_t fields;      // bit i set: array i is present
+  uint64_t frame_num;   // per-source frame counter (see parser_context.h)
+  uint64_t pts_ns;      // buffer PTS once the application tagged the frame (frame_timing.h), 0 until then
+  int32_t source_id;    // batch slot of the frame, i.e. frame_meta.batch_id
+  int32_t count;        // detections
+  int32_t kpts;         // keypoints per detection, 0 without kResultKeypoints
+  int32_t flags;        // kResult* flags
+  uint32_t offset[kResultArrays];  // bytes from the start of this header, 0 = absent
+  uint64_t reserved[6];
+};
+
+struct NvDsResultFrame {
+  uint64_t seq;                    // monotonically increasing per kind, 0 = no frame
+  int32_t kind;                    // kResultKind*
+  int32_t slot;                    // ring slot index, needed by NvDsInferResultRelease
+  const NvDsResultHeader* record;  // valid until NvDsInferResultRelease
+};
+
+// Acquire the oldest record of `kind` newer than after_seq (source_id < 0 matches any source). Returns 1 and fills
+// *frame on success; the record stays valid, and unchanged, until NvDsInferResultRelease. pts_ns is filled in here
+// when the frame was tagged after it was published.
+int NvDsInferResultAcquire(int kind, int source_id, uint64_t after_seq, NvDsResultFrame* frame);
+
+// Acquire the newest record of `kind` (source_id < 0 matches any source).
+int NvDsInferResultAcquireLatest(int kind, int source_id, NvDsResultFrame* frame);
+
+// Acquire the record of `kind` with exactly this (source_id, frame_num); returns 0 if it is no longer in the ring.
+int NvDsInferResultAcquireFrame(int kind, int source_id, uint64_t frame_num, NvDsResultFrame* frame);
+
+void NvDsInferResultRelease(const NvDsResultFrame* frame);
+
+// kResultVersion of the records this build writes.
+int NvDsInferResultVersion();
+}
+
+static_assert(sizeof(NvDsResultHeader) == 128, "NvDsResultHeader is part of the result record ABI");
+
+constexpr uint32_t result_align(uint32_t n) { return (n + 63u) & ~63u; }
+
+// Bytes of array `array` for count detections of kpts keypoints, before padding.
+constexpr uint32_t result_array_bytes(int array, uint32_t count, uint32_t kpts) {
+  return array == kResultBoxes       ? 16 * count
+         : array == kResultKeypoints ? 12 * count * kpts
+         : array < kResultKeypoints  ? 4 * count
+                                     : 0;
+}
+
+// Bytes of a record with these fields, count detections and kpts keypoints each.
+constexpr uint32_t result_record_bytes(uint32_t fields, uint32_t count, uint32_t kpts, int array = -1) {
+  return array < 0 ? static_cast<uint32_t>(sizeof(NvDsResultHeader)) + result_record_bytes(fields, count, kpts, 0)
+         : array == kResultArrays ? 0
+                                  : ((fields >> array) & 1 ? result_align(result_array_bytes(array, count, kpts)) : 0) +
+                                        result_record_bytes(fields, count, kpts, array + 1);
+}
+
+constexpr uint32_t kResultDetectFields = 1u << kResultBoxes | 1u << kResultScores | 1u << kResultClasses;
+constexpr uint32_t kResultPoseFields = 1u << kResultBoxes | 1u << kResultScores | 1u << kResultKeypoints;
+constexpr uint32_t kResultObbFields = kResultDetectFields | 1u << kResultTheta;
+
+// Largest record of each kind, in 32-bit words: what a ring slot or shared-memory slot is sized for.
+constexpr int kResultDetectMaxWords = result_record_bytes(kResultDetectFields, kResultDetectMaxDets, 0) / 4;
+constexpr int kResultPoseMaxWords =
+    result_record_bytes(kResultPoseFields | 1u << kResultTrackIds, kPoseMaxDets, kPoseMaxKpts) / 4;
+constexpr int kResultObbMaxWords = result_record_bytes(kResultObbFields, kObbMaxDets, 0) / 4;
+
+// Array `array` of a record, nullptr when it is absent.
+inline const void* result_array(const NvDsResultHeader* h, int array) {
+  return (h->fields >> array) & 1 ? reinterpret_cast<const uint8_t*>(h) + h->offset[array] : nullptr;
+}
+
+// Publish one frame's results as a record of the matching kind. `flags` takes kResultSourceCoords; count beyond the
+// kind's capacity is cut off and marked kResultTruncated. Returns the record seq, or 0 when records are off or every
+// ring slot was held by a reader.
+uint64_t publish_detect_record(const NvDsInferParseObjectInfo* objects, int count, const FrameTag& tag,
+                               int32_t flags);
+// Pose rows as publish_pose_rows takes them: in_stride floats, [x1,y1,x2,y2,conf, (x,y,score)*kpts (, track id)].
+uint64_t publish_pose_record(const float* rows, int count, int in_stride, int kpts, bool track_ids,
+                             const FrameTag& tag, int32_t flags);
+// OBB rows as publish_obb_rows takes them: [cx,cy,w,h,theta,conf,cls].
+uint64_t publish_obb_record(const float* rows, int count, const FrameTag& tag, int32_t flags);
+
+#endif
@@ -0,0 +1,169 @@
+// result_shm.cpp
+
+#include "result_shm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "obb_cache.h"
+#include "parser_log.h"
+#include "pose_cache.h"
+#include "result_record.h"
+
+namespace {
+
+constexpr uint32_t kShmSlots = 64;
+
+const std::string& shm_base_name() {
+  static const std::string name = [] {
+    const char* v = std::getenv("SQUEAKVIEW_SHM");
+    if (!v || !*v) return std::string();
+    return *v == '/' ? std::string(v) : "/" + std::string(v);
+  }();
+  return name;
+}
+
+uint64_t monotonic_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+class ShmSegment {
+ public:
+  ShmSegment(uint32_t kind, const char* suffix, uint32_t max_rows, uint32_t max_width)
+      : kind_(kind), suffix_(suffix), max_rows_(max_rows), max_width_(max_width) {}
+
+  ShmSegment(const ShmSegment&) = delete;
+  ShmSegment& operator=(const ShmSegment&) = delete;
+
+  ~ShmSegment() {
+    if (!base_) return;
+    munmap(base_, bytes_);
+    shm_unlink(name_.c_str());
+  }
+
+  void publish(const float* rows, int count, int in_width, int width, const FrameTag& tag, int32_t flags) {
+    std::call_once(once_, [this] { open(); });
+    if (!base_) return;
+
+    width = std::min(std::max(0, width), static_cast<int>(max_width_));
+    count = rows ? std::min(std::max(0, count), static_cast<int>(max_rows_)) : 0;
+
+    const uint64_t seq = next_seq_.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint8_t* at = base_ + sizeof(NvDsShmHeader) + static_cast<size_t>((seq - 1) % kShmSlots) * slot_bytes_;
+    NvDsShmSlot* slot = reinterpret_cast<NvDsShmSlot*>(at);
+    float* data = reinterpret_cast<float*>(at + sizeof(NvDsShmSlot));
+
+    // Another writer still inside this slot means the ring lapped it: drop this frame rather than tear it.
+    uint64_t lock = __atomic_load_n(&slot->lock, __ATOMIC_RELAXED);
+    if ((lock & 1) || !__atomic_compare_exchange_n(&slot->lock, &lock, lock + 1, false, __ATOMIC_RELAXED,
+                                                   __ATOMIC_RELAXED)) {
+      return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (width == in_width) {
+      std::memcpy(data, rows, static_cast<size_t>(count) * width * sizeof(float));
+    } else {
+      for (int i = 0; i < count; ++i) {
+        std::memcpy(data + static_cast<size_t>(i) * width, rows + static_cast<size_t>(i) * in_width,
+                    width * sizeof(float));
+      }
+    }
+    slot->seq = seq;
+    slot->frame_num = tag.frame_num;
+    slot->timestamp_ns = monotonic_ns();
+    slot->source_id = tag.batch_slot;
+    slot->count = count;
+    slot->width = width;
+    slot->flags = flags;
+
+    __atomic_store_n(&slot->lock, lock + 2, __ATOMIC_RELEASE);
+
+    NvDsShmHeader* header = reinterpret_cast<NvDsShmHeader*>(base_);
+    uint64_t head = __atomic_load_n(&header->head, __ATOMIC_RELAXED);
+    while (head < seq && !__atomic_compare_exchange_n(&header->head, &head, seq, true, __ATOMIC_RELEASE,
+                                                      __ATOMIC_RELAXED)) {
+    }
+  }
+
+ private:
+  void open() {
+    if (shm_base_name().empty()) return;
+    name_ = shm_base_name() + suffix_;
+    slot_bytes_ = static_cast<uint32_t>((sizeof(NvDsShmSlot) + max_rows_ * max_width_ * sizeof(float) + 63) & ~63u);
+    bytes_ = sizeof(NvDsShmHeader) + static_cast<size_t>(kShmSlots) * slot_bytes_;
+
+    const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+      PARSER_LOG(kLogWarn, "WARNING: shm_open(%s) failed, results are not shared", name_.c_str());
+      return;
+    }
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(bytes_)) == 0) {
+      p = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (p == MAP_FAILED) {
+      PARSER_LOG(kLogWarn, "WARNING: mapping %zu bytes of %s failed, results are not shared", bytes_, name_.c_str());
+      shm_unlink(name_.c_str());
+      return;
+    }
+
+    // A segment left by an earlier run is reset; readers see magic go to 0 and back once it is ready again.
+    base_ = static_cast<uint8_t*>(p);
+    NvDsShmHeader* header = reinterpret_cast<NvDsShmHeader*>(base_);
+    __atomic_store_n(&header->magic, 0u, __ATOMIC_RELEASE);
+    std::memset(base_ + sizeof(uint32_t), 0, bytes_ - sizeof(uint32_t));
+    header->version = kShmVersion;
+    header->kind = kind_ == kShmKindPose && pose_cache_format() == kPoseFormatCompact ? kShmKindPoseCompact : kind_;
+    header->slots = kShmSlots;
+    header->slot_bytes = slot_bytes_;
+    header->max_rows = max_rows_;
+    header->max_width = max_width_;
+    header->writer_pid = static_cast<uint64_t>(getpid());
+    __atomic_store_n(&header->magic, kShmMagic, __ATOMIC_RELEASE);
+    PARSER_LOG(kLogInfo, "[SHM] publishing to /dev/shm%s (%zu bytes)", name_.c_str(), bytes_);
+  }
+
+  const uint32_t kind_;
+  const char* const suffix_;
+  const uint32_t max_rows_;
+  const uint32_t max_width_;
+  std::once_flag once_;
+  std::string name_;
+  uint8_t* base_{nullptr};
+  size_t bytes_{0};
+  uint32_t slot_bytes_{0};
+  std::atomic<uint64_t> next_seq_{0};
+};
+
+ShmSegment g_pose_shm(kShmKindPose, "_pose", kPoseMaxDets, kPoseMaxValuesPerDet);
+ShmSegment g_obb_shm(kShmKindObb, "_obb", kObbMaxDets, kObbValuesPerDet);
+ShmSegment g_result_shm[kResultKinds] = {{kShmKindResult, "_result_detect", 1, kResultDetectMaxWords},
+                                         {kShmKindResult, "_result_pose", 1, kResultPoseMaxWords},
+                                         {kShmKindResult, "_result_obb", 1, kResultObbMaxWords}};
+
+} // namespace
+
+void shm_publish_rows(uint32_t kind, const float* rows, int count, int in_width, int width, const FrameTag& tag,
+                      int32_t flags) {
+  if (shm_base_name().empty()) return;
+  ShmSegment& segment = kind == kShmKindObb ? g_obb_shm : g_pose_shm;
+  segment.publish(rows, count, in_width, width, tag, flags);
+}
+
+void shm_publish_result(int result_kind, const uint32_t* record, int words, const FrameTag& tag, int32_t flags) {
+  if (shm_base_name().empty() || result_kind < 1 || result_kind > kResultKinds) return;
+  g_result_shm[result_kind - 1].publish(reinterpret_cast<const float*>(record), 1, words, words, tag, flags);
+}
@@ -0,0 +1,73 @@
+// result_shm.h  (optional POSIX shared-memory copy of the pose / OBB rings for out-of-process readers)
+// With SQUEAKVIEW_SHM=<name> set, every frame published to the pose cache also lands in /dev/shm/<name>_pose
+// and every OBB frame in /dev/shm/<name>_obb. A segment is an NvDsShmHeader followed by `slots` slots of
+// `slot_bytes` bytes: an NvDsShmSlot and then max_rows * max_width floats. Frame seq s lives in slot
+// (s - 1) % slots. Nothing in it is a pointer, so a reader maps it read-only and needs only these structs.
+//
+// Each slot is a seqlock. The writer makes `lock` odd, fills the slot, then makes it even again; a reader
+//   1. loads lock (acquire) and retries later if it is odd,
+//   2. copies the slot header and count * width floats,
+//   3. issues an acquire fence and loads lock again: the copy is valid only if it did not change.
+// header.head is the seq of the newest complete frame. A reader that falls `slots` frames behind sees a newer
+// seq in the slot it wanted and knows it dropped frames.
+// The result records of result_record.h go to /dev/shm/<name>_result_detect, _result_pose and _result_obb, one
+// record per slot (count 1, width in 32-bit words), so a reader of any parser's results needs just one decoder.
+
+#ifndef __RESULT_SHM_H__
+#define __RESULT_SHM_H__
+
+#include <cstdint>
+
+#include "parser_context.h"
+
+constexpr uint32_t kShmMagic = 0x50565153;  // "SQVP"
+constexpr uint32_t kShmVersion = 1;
+
+constexpr uint32_t kShmKindPose = 1;  // rows: [x1,y1,x2,y2,conf, (x,y,score)*kpts (, track id)], see NvDsPoseFrame
+constexpr uint32_t kShmKindObb = 2;   // rows: [cx,cy,w,h,theta,conf,cls], see NvDsObbFrame
+constexpr uint32_t kShmKindPoseCompact = 3;  // pose segment of SQUEAKVIEW_POSE_FORMAT=compact: records of
+                                             // pose_cache.h, width in 32-bit words
+constexpr uint32_t kShmKindResult = 4;       // one NvDsResultHeader record per slot (result_record.h), width in
+                                             // 32-bit words
+
+// Fixed binary layout, little endian, shared with readers in other processes; bump kShmVersion on any change.
+extern "C" {
+struct NvDsShmHeader {
+  uint32_t magic;       // kShmMagic, written last once the segment is initialized
+  uint32_t version;     // kShmVersion
+  uint32_t kind;        // kShmKind*
+  uint32_t slots;
+  uint32_t slot_bytes;  // distance between consecutive NvDsShmSlot, a multiple of 64
+  uint32_t max_rows;
+  uint32_t max_width;   // floats per row at most
+  uint32_t reserved0;
+  uint64_t head;        // seq of the newest complete frame, 0 = none yet
+  uint64_t writer_pid;
+  uint64_t reserved[2];
+};
+
+struct NvDsShmSlot {
+  uint64_t lock;          // seqlock word, odd while the writer is inside the slot
+  uint64_t seq;           // 1-based frame seq in this segment
+  uint64_t frame_num;     // per-source frame counter (see parser_context.h)
+  uint64_t timestamp_ns;  // CLOCK_MONOTONIC at publish
+  int32_t source_id;      // batch slot of the frame, i.e. frame_meta.batch_id
+  int32_t count;          // rows that follow
+  int32_t width;          // floats per row
+  int32_t flags;          // kPoseFrame* / kObbFrame* bits
+  uint64_t reserved[2];
+};
+}
+
+static_assert(sizeof(NvDsShmHeader) == 64, "NvDsShmHeader is part of the shared-memory ABI");
+static_assert(sizeof(NvDsShmSlot) == 64, "NvDsShmSlot is part of the shared-memory ABI");
+
+// Copies count rows (first `width` of every `in_width` floats) into the segment of `kind`, creating it on first
+// use. A no-op without SQUEAKVIEW_SHM, or once creating the segment failed.
+void shm_publish_rows(uint32_t kind, const float* rows, int count, int in_width, int width, const FrameTag& tag,
+                      int32_t flags);
+
+// Copies one result record of `words` 32-bit words into the segment of its result kind (kResultKind*), the same way.
+void shm_publish_result(int result_kind, const uint32_t* record, int words, const FrameTag& tag, int32_t flags);
+
+#endif
@@ -0,0 +1,304 @@
+// roi_mask.cpp
+
+#include "roi_mask.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "parser_context.h"
+#include "parser_log.h"
+#include "tile_grid.h"
+
+namespace {
+
+// Pyramid strides of the anchor-ordered heads, finest first.
+constexpr int kRoiStrides[] = {8, 16, 32, 64};
+
+struct RoiMask {
+  bool rect{false};
+  float x1{0}, y1{0}, x2{1}, y2{1};  // rect, normalized
+  int w{0}, h{0};
+  std::vector<uint8_t> px;
+
+  // (u, v) in normalized frame coordinates; the letterbox padding is outside by construction.
+  bool inside(float u, float v) const {
+    if (u < 0.f || v < 0.f || u >= 1.f || v >= 1.f) return false;
+    if (rect) return u >= x1 && u < x2 && v >= y1 && v < y2;
+    return px[static_cast<size_t>(v * h) * w + static_cast<size_t>(u * w)] != 0;
+  }
+};
+
+struct SlotRoi {
+  std::mutex mutex;
+  std::shared_ptr<const RoiMask> mask;
+  std::atomic<uint64_t> gen{0};  // 0 = no ROI
+};
+
+SlotRoi g_roi[kMaxBatchSlots];
+std::atomic<int> g_roi_slots{0};
+std::atomic<uint64_t> g_roi_gen{0};
+std::atomic<uint64_t> g_view_ids{0};
+
+struct ViewCache {
+  uint64_t gen{0};
+  unsigned int net_w{0}, net_h{0};
+  int num_anchors{-1};
+  float gain{0}, pad_x{0}, pad_y{0}, src_w{0}, src_h{0};
+  std::vector<uint8_t> bytes;
+  RoiView view;
+};
+
+thread_local ViewCache t_views[kMaxBatchSlots];
+
+void set_slot(int slot, const std::shared_ptr<const RoiMask>& mask) {
+  SlotRoi& s = g_roi[slot];
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.mask != !mask) g_roi_slots.fetch_add(mask ? 1 : -1, std::memory_order_relaxed);
+  s.mask = mask;
+  s.gen.store(mask ? g_roi_gen.fetch_add(1, std::memory_order_relaxed) + 1 : 0, std::memory_order_release);
+}
+
+void set_sources(int source_id, const std::shared_ptr<const RoiMask>& mask) {
+  if (source_id < 0) {
+    for (int s = 0; s < kMaxBatchSlots; ++s) set_slot(s, mask);
+  } else if (source_id < kMaxBatchSlots) {
+    set_slot(source_id, mask);
+  }
+}
+
+std::shared_ptr<const RoiMask> slot_mask(int slot, uint64_t* gen) {
+  SlotRoi& s = g_roi[slot];
+  std::lock_guard<std::mutex> lock(s.mutex);
+  *gen = s.gen.load(std::memory_order_relaxed);
+  return s.mask;
+}
+
+std::shared_ptr<const RoiMask> make_rect(float x1, float y1, float x2, float y2) {
+  if (!(x2 > x1) || !(y2 > y1)) return nullptr;
+  std::shared_ptr<RoiMask> m = std::make_shared<RoiMask>();
+  m->rect = true;
+  m->x1 = x1; m->y1 = y1; m->x2 = x2; m->y2 = y2;
+  return m;
+}
+
+// Next integer of a PGM header, skipping whitespace and '#' comments; -1 on a malformed header.
+int pgm_int(std::FILE* f) {
+  int c = std::fgetc(f);
+  while (c != EOF && (std::isspace(c) || c == '#')) {
+    if (c == '#') {
+      while (c != EOF && c != '\n') c = std::fgetc(f);
+    }
+    c = std::fgetc(f);
+  }
+  int v = 0, digits = 0;
+  while (c != EOF && std::isdigit(c)) {
+    v = v * 10 + (c - '0');
+    c = std::fgetc(f);
+    ++digits;
+  }
+  return digits > 0 && digits < 9 ? v : -1;
+}
+
+// Binary 8-bit PGM (P5).
+std::shared_ptr<const RoiMask> load_pgm(const std::string& path) {
+  std::FILE* f = std::fopen(path.c_str(), "rb");
+  if (!f) {
+    PARSER_LOG(kLogWarn, "WARNING: cannot open ROI mask %s", path.c_str());
+    return nullptr;
+  }
+  std::shared_ptr<RoiMask> m = std::make_shared<RoiMask>();
+  char magic[2] = {0, 0};
+  bool ok = std::fread(magic, 1, 2, f) == 2 && magic[0] == 'P' && magic[1] == '5';
+  int maxval = 0;
+  if (ok) {
+    m->w = pgm_int(f);
+    m->h = pgm_int(f);
+    maxval = pgm_int(f);  // consumes the single whitespace byte before the pixels
+    ok = m->w > 0 && m->h > 0 && maxval > 0 && maxval < 256;
+  }
+  if (ok) {
+    m->px.resize(static_cast<size_t>(m->w) * m->h);
+    ok = std::fread(m->px.data(), 1, m->px.size(), f) == m->px.size();
+  }
+  std::fclose(f);
+  if (!ok) {
+    PARSER_LOG(kLogWarn, "WARNING: %s is not an 8-bit binary PGM, ROI ignored", path.c_str());
+    return nullptr;
+  }
+  return m;
+}
+
+// "x1,y1,x2,y2" or a PGM path.
+std::shared_ptr<const RoiMask> parse_spec(const std::string& spec) {
+  float v[4];
+  char tail = 0;
+  if (std::sscanf(spec.c_str(), "%f,%f,%f,%f%c", &v[0], &v[1], &v[2], &v[3], &tail) == 4) {
+    std::shared_ptr<const RoiMask> m = make_rect(v[0], v[1], v[2], v[3]);
+    if (!m) PARSER_LOG(kLogWarn, "WARNING: empty ROI rectangle %s ignored", spec.c_str());
+    return m;
+  }
+  return load_pgm(spec);
+}
+
+bool load_env() {
+  const char* env = std::getenv("SQUEAKVIEW_ROI");
+  if (!env) return true;
+  std::string all(env);
+  size_t start = 0;
+  while (start <= all.size()) {
+    size_t end = all.find(';', start);
+    if (end == std::string::npos) end = all.size();
+    std::string entry = all.substr(start, end - start);
+    start = end + 1;
+    entry.erase(0, entry.find_first_not_of(" \t"));
+    entry.erase(entry.find_last_not_of(" \t") + 1);
+    if (entry.empty()) continue;
+
+    int source = -1;
+    const size_t eq = entry.find('=');
+    if (eq != std::string::npos) {
+      const std::string id = entry.substr(0, eq);
+      source = id == "*" ? -1 : std::atoi(id.c_str());
+      entry = entry.substr(eq + 1);
+    }
+    if (std::shared_ptr<const RoiMask> m = parse_spec(entry)) {
+      set_sources(source, m);
+      PARSER_LOG(kLogInfo, "[ROI] source %s: %s", source < 0 ? "*" : std::to_string(source).c_str(),
+                 entry.c_str());
+    }
+  }
+  return true;
+}
+
+bool env_loaded() {
+  static const bool loaded = load_env();
+  return loaded;
+}
+
+// Samples m at the centers of a grid_w x grid_h grid over the network input.
+void sample_grid(const RoiMask& m, const LetterboxGeom& g, int grid_w, int grid_h, uint8_t* out) {
+  const float sx = g.net_w / grid_w, sy = g.net_h / grid_h;
+  const float inv_w = 1.f / (g.gain * g.src_w), inv_h = 1.f / (g.gain * g.src_h);
+  for (int y = 0; y < grid_h; ++y) {
+    const float v = ((y + 0.5f) * sy - g.pad_y) * inv_h;
+    for (int x = 0; x < grid_w; ++x) {
+      const float u = ((x + 0.5f) * sx - g.pad_x) * inv_w;
+      out[static_cast<size_t>(y) * grid_w + x] = m.inside(u, v) ? 1 : 0;
+    }
+  }
+}
+
+int grid_cells(unsigned int size, int stride) {
+  return static_cast<int>((size + stride - 1) / stride);
+}
+
+// Levels of the stride pyramid whose cells add up to num_anchors, 0 if none does.
+int pyramid_levels(const NvDsInferNetworkInfo& net, int num_anchors) {
+  int total = 0;
+  for (int l = 0; l < static_cast<int>(sizeof(kRoiStrides) / sizeof(kRoiStrides[0])); ++l) {
+    total += grid_cells(net.width, kRoiStrides[l]) * grid_cells(net.height, kRoiStrides[l]);
+    if (total == num_anchors && l >= 2) return l + 1;
+  }
+  return 0;
+}
+
+} // namespace
+
+bool roi_any() {
+  return env_loaded() && g_roi_slots.load(std::memory_order_relaxed) > 0;
+}
+
+RoiView roi_view(int batch_slot, const NvDsInferNetworkInfo& net, int num_anchors) {
+  if (!roi_any() || net.width == 0 || net.height == 0) return RoiView();
+  const int slot = std::min(std::max(batch_slot, 0), kMaxBatchSlots - 1);
+  // ROIs are set per source; a tile slot samples its source's mask through the tile geometry.
+  const int source = tile_source(slot);
+  const uint64_t gen = g_roi[source].gen.load(std::memory_order_acquire);
+  if (gen == 0) return RoiView();
+
+  const LetterboxGeom& g = letterbox_geom(slot, net);
+  ViewCache& c = t_views[slot];
+  if (c.gen == gen && c.net_w == net.width && c.net_h == net.height && c.num_anchors == num_anchors &&
+      c.gain == g.gain && c.pad_x == g.pad_x && c.pad_y == g.pad_y && c.src_w == g.src_w && c.src_h == g.src_h) {
+    return c.view;
+  }
+
+  uint64_t mask_gen = 0;
+  const std::shared_ptr<const RoiMask> mask = slot_mask(source, &mask_gen);
+  if (!mask) return RoiView();
+
+  const int cw = grid_cells(net.width, kRoiCellStride), ch = grid_cells(net.height, kRoiCellStride);
+  const size_t cells = static_cast<size_t>(cw) * ch;
+  const int levels = num_anchors > 0 ? pyramid_levels(net, num_anchors) : 0;
+  c.bytes.resize(cells + (levels > 0 ? num_anchors : 0));
+  sample_grid(*mask, g, cw, ch, c.bytes.data());
+  size_t at = cells;
+  for (int l = 0; l < levels; ++l) {
+    const int gw = grid_cells(net.width, kRoiStrides[l]), gh = grid_cells(net.height, kRoiStrides[l]);
+    sample_grid(*mask, g, gw, gh, c.bytes.data() + at);
+    at += static_cast<size_t>(gw) * gh;
+  }
+  if (num_anchors > 0 && levels == 0) {
+    PARSER_LOG_ONCE(kLogInfo, "[ROI] %d anchors are not a stride pyramid at %ux%u, gating on box centers",
+                    num_anchors, net.width, net.height);
+  }
+
+  c.gen = mask_gen;
+  c.net_w = net.width;
+  c.net_h = net.height;
+  c.num_anchors = num_anchors;
+  c.gain = g.gain; c.pad_x = g.pad_x; c.pad_y = g.pad_y; c.src_w = g.src_w; c.src_h = g.src_h;
+  c.view.id = g_view_ids.fetch_add(1, std::memory_order_relaxed) + 1;
+  c.view.cells = c.bytes.data();
+  c.view.cells_w = cw;
+  c.view.cells_h = ch;
+  c.view.anchors = levels > 0 ? c.bytes.data() + cells : nullptr;
+  c.view.bytes = c.bytes.size();
+  return c.view;
+}
+
+bool roi_fill_grid(int batch_slot, const NvDsInferNetworkInfo& net, int grid_w, int grid_h, uint8_t* out) {
+  const size_t n = static_cast<size_t>(grid_w) * grid_h;
+  std::shared_ptr<const RoiMask> mask;
+  if (roi_any()) {
+    uint64_t gen = 0;
+    mask = slot_mask(std::min(std::max(batch_slot, 0), kMaxBatchSlots - 1), &gen);
+  }
+  if (!mask || net.width == 0 || net.height == 0) {
+    std::memset(out, 1, n);
+    return false;
+  }
+  sample_grid(*mask, letterbox_geom(batch_slot, net), grid_w, grid_h, out);
+  return true;
+}
+
+extern "C" int NvDsInferSetRoiMask(int source_id, const uint8_t* mask, int width, int height) {
+  env_loaded();
+  if (!mask) {
+    set_sources(source_id, nullptr);
+    return 1;
+  }
+  if (width <= 0 || height <= 0) return 0;
+  std::shared_ptr<RoiMask> m = std::make_shared<RoiMask>();
+  m->w = width;
+  m->h = height;
+  m->px.assign(mask, mask + static_cast<size_t>(width) * height);
+  set_sources(source_id, m);
+  return 1;
+}
+
+extern "C" int NvDsInferSetRoiRect(int source_id, float x1, float y1, float x2, float y2) {
+  env_loaded();
+  std::shared_ptr<const RoiMask> m = make_rect(x1, y1, x2, y2);
+  if (!m) return 0;
+  set_sources(source_id, m);
+  return 1;
+}
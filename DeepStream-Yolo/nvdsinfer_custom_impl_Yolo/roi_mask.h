@@ -0,0 +1,67 @@
+// roi_mask.h  (per-source region of interest, checked before anchors are decoded)
+// A source's ROI is a binary mask over its camera frame: a normalized rectangle or an 8-bit PGM (nonzero =
+// inside), stretched over the whole frame. SQUEAKVIEW_ROI sets them once at load, as ';'-separated entries
+// "[<source>=]<x1>,<y1>,<x2>,<y2>" or "[<source>=]<file.pgm>" (no source: every source); the runner can
+// replace them later through NvDsInferSetRoiMask / NvDsInferSetRoiRect. Sources are batch slots, as in
+// parser_context.h. A source without an ROI is decoded exactly as before.
+//
+// The decoders never look at the mask itself. For every network size and letterbox geometry it is resampled
+// at the cell centers of a stride-kRoiCellStride grid, and, for heads whose rows are a stride pyramid
+// (8/16/32[/64], the Ultralytics export order), at every anchor center, so a skipped anchor costs one byte
+// load. Heads in any other order are checked on the decoded box center against the fine grid instead.
+
+#ifndef __ROI_MASK_H__
+#define __ROI_MASK_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "nvdsinfer.h"
+
+constexpr int kRoiCellStride = 8;
+
+// One slot's ROI resampled for one network size, geometry and anchor count. The pointers stay valid until
+// the same thread asks for the same slot again.
+struct RoiView {
+  uint64_t id{0};                   // 0 = no ROI; otherwise changes whenever the mask or the geometry does
+  const uint8_t* cells{nullptr};    // cells_w x cells_h, row-major, 1 = inside
+  int cells_w{0}, cells_h{0};
+  const uint8_t* anchors{nullptr};  // one byte per anchor, right after cells; nullptr if not a stride pyramid
+  size_t bytes{0};                  // cells and anchors together
+
+  bool active() const { return id != 0; }
+
+  bool anchor_outside(int i) const { return anchors && !anchors[i]; }
+
+  // Whether a candidate whose anchor could not be checked has its box center (network coords) outside.
+  bool center_outside(float x1, float y1, float x2, float y2) const {
+    if (!cells || anchors) return false;
+    const int cx = static_cast<int>(0.5f * (x1 + x2) * (1.f / kRoiCellStride));
+    const int cy = static_cast<int>(0.5f * (y1 + y2) * (1.f / kRoiCellStride));
+    return !cells[clampi(cy, cells_h) * cells_w + clampi(cx, cells_w)];
+  }
+
+ private:
+  static int clampi(int v, int n) { return v < 0 ? 0 : (v >= n ? n - 1 : v); }
+};
+
+// num_anchors: rows per frame of the head (0 when only the cell grid is wanted).
+RoiView roi_view(int batch_slot, const NvDsInferNetworkInfo& net, int num_anchors);
+
+// Resamples slot's ROI at the cell centers of a grid_w x grid_h grid over the network input (YoloLayer heads).
+// Writes all ones and returns false when the slot has none.
+bool roi_fill_grid(int batch_slot, const NvDsInferNetworkInfo& net, int grid_w, int grid_h, uint8_t* out);
+
+// Whether any slot has an ROI; one relaxed load.
+bool roi_any();
+
+extern "C" {
+// Replaces the ROI of one source (source_id < 0: every source) with a width x height mask over its frame,
+// row-major, nonzero = inside. mask == nullptr clears it. Returns 0 for bad arguments.
+int NvDsInferSetRoiMask(int source_id, const uint8_t* mask, int width, int height);
+
+// Same with a rectangle in normalized frame coordinates.
+int NvDsInferSetRoiRect(int source_id, float x1, float y1, float x2, float y2);
+}
+
+#endif
@@ -0,0 +1,200 @@
+// simd_scan.cpp
+
+#include "simd_scan.h"
+
+#include <cstddef>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIMD_SCAN_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_SCAN_X86 1
+#endif
+
+namespace {
+
+inline int scan_tail(const float* v, int i, int n, float thr, int* out, int count) {
+  for (; i < n; ++i) {
+    if (!(v[i] < thr)) out[count++] = i;
+  }
+  return count;
+}
+
+// Appends base + set bit positions of mask.
+inline int emit_bits(unsigned int mask, int base, int* out, int count) {
+  while (mask) {
+    out[count++] = base + __builtin_ctz(mask);
+    mask &= mask - 1;
+  }
+  return count;
+}
+
+inline int boxes_tail(const float* rows, int i, int n, const float* thr, int num_thr, int* out, int count) {
+  for (; i < n; ++i) {
+    const float* p = rows + static_cast<size_t>(i) * 6;
+    const float cf = p[5];
+    // Range-check the float first so the int conversion below is always defined.
+    if (!(cf > -1.f && cf < static_cast<float>(num_thr))) continue;
+    if (!(p[4] < thr[static_cast<int>(cf)])) out[count++] = i;
+  }
+  return count;
+}
+
+inline bool uniform(const float* thr, int num_thr) {
+  for (int c = 1; c < num_thr; ++c) {
+    if (thr[c] != thr[0]) return false;
+  }
+  return true;
+}
+
+#if SIMD_SCAN_NEON
+
+int scan_neon(const float* v, int n, float thr, int* out) {
+  const float32x4_t t = vdupq_n_f32(thr);
+  const uint32_t lane_bits[4] = {1, 2, 4, 8};
+  const uint32x4_t bits = vld1q_u32(lane_bits);
+  int count = 0, i = 0;
+  for (; i + 16 <= n; i += 16) {
+    // Lanes pass when !(v < thr); AND with lane bits and horizontally add to get a 4-bit mask per vector.
+    const uint32x4_t m0 = vmvnq_u32(vcltq_f32(vld1q_f32(v + i), t));
+    const uint32x4_t m1 = vmvnq_u32(vcltq_f32(vld1q_f32(v + i + 4), t));
+    const uint32x4_t m2 = vmvnq_u32(vcltq_f32(vld1q_f32(v + i + 8), t));
+    const uint32x4_t m3 = vmvnq_u32(vcltq_f32(vld1q_f32(v + i + 12), t));
+    if (vmaxvq_u32(vorrq_u32(vorrq_u32(m0, m1), vorrq_u32(m2, m3))) == 0) continue;
+    const unsigned int mask = vaddvq_u32(vandq_u32(m0, bits)) | (vaddvq_u32(vandq_u32(m1, bits)) << 4) |
+                              (vaddvq_u32(vandq_u32(m2, bits)) << 8) | (vaddvq_u32(vandq_u32(m3, bits)) << 12);
+    count = emit_bits(mask, i, out, count);
+  }
+  return scan_tail(v, i, n, thr, out, count);
+}
+
+// Four rows per step: vld3q splits 12 floats into stride-3 lanes, so lanes 1 and 3 of val[1] / val[2] hold the
+// score / class of two rows; vuzp2q collects them from two loads.
+int boxes_neon(const float* rows, int n, const float* thr, int num_thr, int* out) {
+  const bool same = uniform(thr, num_thr);
+  const float32x4_t t0 = vdupq_n_f32(thr[0]);
+  const float32x4_t lo = vdupq_n_f32(-1.f);
+  const float32x4_t hi = vdupq_n_f32(static_cast<float>(num_thr));
+  const uint32_t lane_bits[4] = {1, 2, 4, 8};
+  const uint32x4_t bits = vld1q_u32(lane_bits);
+  int count = 0, i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const float* p = rows + static_cast<size_t>(i) * 6;
+    const float32x4x3_t a = vld3q_f32(p);
+    const float32x4x3_t b = vld3q_f32(p + 12);
+    const float32x4_t score = vuzp2q_f32(a.val[1], b.val[1]);
+    const float32x4_t cls = vuzp2q_f32(a.val[2], b.val[2]);
+    const uint32x4_t valid = vandq_u32(vcgtq_f32(cls, lo), vcltq_f32(cls, hi));
+    float32x4_t t = t0;
+    if (!same) {
+      // No gather on NEON; invalid lanes look up class 0 and are masked off below.
+      const int32x4_t c = vreinterpretq_s32_u32(vandq_u32(vreinterpretq_u32_s32(vcvtq_s32_f32(cls)), valid));
+      t = vsetq_lane_f32(thr[vgetq_lane_s32(c, 0)], t, 0);
+      t = vsetq_lane_f32(thr[vgetq_lane_s32(c, 1)], t, 1);
+      t = vsetq_lane_f32(thr[vgetq_lane_s32(c, 2)], t, 2);
+      t = vsetq_lane_f32(thr[vgetq_lane_s32(c, 3)], t, 3);
+    }
+    const uint32x4_t m = vandq_u32(vmvnq_u32(vcltq_f32(score, t)), valid);
+    const unsigned int mask = vaddvq_u32(vandq_u32(m, bits));
+    if (mask) count = emit_bits(mask, i, out, count);
+  }
+  return boxes_tail(rows, i, n, thr, num_thr, out, count);
+}
+
+#endif
+
+#if SIMD_SCAN_X86
+
+__attribute__((target("avx2"))) int scan_avx2(const float* v, int n, float thr, int* out) {
+  const __m256 t = _mm256_set1_ps(thr);
+  int count = 0, i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const unsigned int lo = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(v + i), t, _CMP_NLT_UQ)));
+    const unsigned int hi = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(v + i + 8), t, _CMP_NLT_UQ)));
+    const unsigned int mask = lo | (hi << 8);
+    if (mask) count = emit_bits(mask, i, out, count);
+  }
+  return scan_tail(v, i, n, thr, out, count);
+}
+
+int scan_sse2(const float* v, int n, float thr, int* out) {
+  const __m128 t = _mm_set1_ps(thr);
+  int count = 0, i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const unsigned int lo = static_cast<unsigned int>(_mm_movemask_ps(_mm_cmpnlt_ps(_mm_loadu_ps(v + i), t)));
+    const unsigned int hi = static_cast<unsigned int>(_mm_movemask_ps(_mm_cmpnlt_ps(_mm_loadu_ps(v + i + 4), t)));
+    const unsigned int mask = lo | (hi << 4);
+    if (mask) count = emit_bits(mask, i, out, count);
+  }
+  return scan_tail(v, i, n, thr, out, count);
+}
+
+// Eight rows per step; score, class and the per-class threshold are gathered.
+__attribute__((target("avx2"))) int boxes_avx2(const float* rows, int n, const float* thr, int num_thr, int* out) {
+  const __m256i offsets = _mm256_setr_epi32(0, 6, 12, 18, 24, 30, 36, 42);
+  const __m256 lo = _mm256_set1_ps(-1.f);
+  const __m256 hi = _mm256_set1_ps(static_cast<float>(num_thr));
+  int count = 0, i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const float* p = rows + static_cast<size_t>(i) * 6;
+    const __m256 score = _mm256_i32gather_ps(p + 4, offsets, 4);
+    const __m256 cls = _mm256_i32gather_ps(p + 5, offsets, 4);
+    const __m256 valid = _mm256_and_ps(_mm256_cmp_ps(cls, lo, _CMP_GT_OQ), _mm256_cmp_ps(cls, hi, _CMP_LT_OQ));
+    // Invalid lanes look up class 0 and are masked off below.
+    const __m256i c = _mm256_and_si256(_mm256_cvttps_epi32(cls), _mm256_castps_si256(valid));
+    const __m256 t = _mm256_i32gather_ps(thr, c, 4);
+    const __m256 pass = _mm256_and_ps(_mm256_cmp_ps(score, t, _CMP_NLT_UQ), valid);
+    const unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(pass));
+    if (mask) count = emit_bits(mask, i, out, count);
+  }
+  return boxes_tail(rows, i, n, thr, num_thr, out, count);
+}
+
+// Rows are interleaved, so without a gather SSE2 has nothing to gain over the scalar loop.
+int boxes_scalar(const float* rows, int n, const float* thr, int num_thr, int* out) {
+  return boxes_tail(rows, 0, n, thr, num_thr, out, 0);
+}
+
+typedef int (*ScanFn)(const float*, int, float, int*);
+typedef int (*BoxesFn)(const float*, int, const float*, int, int*);
+
+bool has_avx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+ScanFn pick_x86() {
+  return has_avx2() ? scan_avx2 : scan_sse2;
+}
+
+BoxesFn pick_boxes_x86() {
+  return has_avx2() ? boxes_avx2 : boxes_scalar;
+}
+
+#endif
+
+} // namespace
+
+int threshold_indices(const float* v, int n, float thr, int* out) {
+#if SIMD_SCAN_NEON
+  return scan_neon(v, n, thr, out);
+#elif SIMD_SCAN_X86
+  static const ScanFn fn = pick_x86();
+  return fn(v, n, thr, out);
+#else
+  return scan_tail(v, 0, n, thr, out, 0);
+#endif
+}
+
+int box_candidates(const float* rows, int n, const float* thr, int num_thr, int* out) {
+  if (num_thr <= 0) return 0;
+#if SIMD_SCAN_NEON
+  return boxes_neon(rows, n, thr, num_thr, out);
+#elif SIMD_SCAN_X86
+  static const BoxesFn fn = pick_boxes_x86();
+  return fn(rows, n, thr, num_thr, out);
+#else
+  return boxes_tail(rows, 0, n, thr, num_thr, out, 0);
+#endif
+}
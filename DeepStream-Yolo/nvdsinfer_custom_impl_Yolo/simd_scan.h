@@ -0,0 +1,18 @@
+// simd_scan.h  (vectorized threshold scans that pick candidates before a decoder touches the full rows)
+// threshold_indices scans one contiguous score channel (channel-major pose heads); box_candidates scans the
+// [N, 6] rows of the detection head. NEON on aarch64 (Jetson), AVX2 on x86-64 when the CPU has it, else
+// SSE2 / scalar.
+
+#ifndef __SIMD_SCAN_H__
+#define __SIMD_SCAN_H__
+
+// Writes the indices i in [0, n) with !(v[i] < thr) to out in ascending order and returns how many.
+// NaN scores pass, matching the scalar `if (score < thr) continue;`. out must hold n ints.
+int threshold_indices(const float* v, int n, float thr, int* out);
+
+// For rows [x1,y1,x2,y2,score,class] (6 floats each): writes the indices of rows whose truncated class c
+// lies in [0, num_thr) and whose score passes !(score < thr[c]), ascending, and returns how many.
+// Rows with an out-of-range class are rejected. out must hold n ints.
+int box_candidates(const float* rows, int n, const float* thr, int num_thr, int* out);
+
+#endif
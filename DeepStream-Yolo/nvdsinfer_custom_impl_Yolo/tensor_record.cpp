@@ -0,0 +1,214 @@
+// tensor_record.cpp
+
+#include "tensor_record.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include <cuda_runtime_api.h>
+
+#include "parser_context.h"
+#include "parser_log.h"
+#include "parser_trace.h"
+#include "result_record.h"
+
+namespace {
+
+struct Recorder {
+  std::atomic<bool> on{false};
+  std::mutex mutex;
+  FILE* file{nullptr};
+  uint64_t bytes{0};
+  uint64_t max_bytes{0};
+  uint64_t index{0};
+  std::vector<char> staging;  // device buffers are copied here before the write
+};
+
+// Same rule as tag_frame in parser_context.cpp, run on layer 0 of the calling thread's calls.
+struct SlotStep {
+  const uint8_t* last{nullptr};
+  size_t last_bytes{0};
+  uint32_t slot{0};
+};
+
+thread_local SlotStep t_step;
+
+Recorder& recorder() {
+  static Recorder r;
+  static std::once_flag once;
+  std::call_once(once, [] {
+    const char* path = std::getenv("SQUEAKVIEW_RECORD");
+    if (!path || !*path) return;
+    long mb = 1024;
+    if (const char* v = std::getenv("SQUEAKVIEW_RECORD_MAX_MB")) mb = std::max(1L, std::atol(v));
+    r.max_bytes = static_cast<uint64_t>(mb) << 20;
+
+    r.file = std::fopen(path, "wb");
+    NvDsRecordFileHeader h{};
+    std::memcpy(h.magic, kRecordFileMagic, sizeof(h.magic));
+    h.version = kRecordVersion;
+    if (!r.file || std::fwrite(&h, sizeof(h), 1, r.file) != 1) {
+      PARSER_LOG(kLogError, "[RECORD] could not open %s for writing", path);
+      if (r.file) std::fclose(r.file);
+      r.file = nullptr;
+      return;
+    }
+    r.bytes = sizeof(h);
+    r.on.store(true, std::memory_order_release);
+    PARSER_LOG(kLogInfo, "[RECORD] recording parser inputs to %s (up to %ld MB)", path, mb);
+  });
+  return r;
+}
+
+// Nvinfer hands the parsers host copies, but a parser can also be fed device memory (the CUDA parsers in a
+// custom pipeline, the replay bench); ask the runtime rather than guess.
+bool is_device_pointer(const void* p) {
+  cudaPointerAttributes attr;
+  if (cudaPointerGetAttributes(&attr, p) != cudaSuccess) {
+    cudaGetLastError();  // plain host memory on CUDA < 11
+    return false;
+  }
+#if CUDART_VERSION >= 10000
+  return attr.type == cudaMemoryTypeDevice;
+#else
+  return attr.memoryType == cudaMemoryTypeDevice;
+#endif
+}
+
+size_t padded(size_t n) {
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+// Turns recording off for good; the file keeps every complete record written so far.
+void stop(Recorder& r, const char* why) {
+  r.on.store(false, std::memory_order_relaxed);
+  std::fclose(r.file);
+  r.file = nullptr;
+  PARSER_LOG(kLogWarn, "[RECORD] recording stopped after %llu calls: %s", static_cast<unsigned long long>(r.index),
+             why);
+}
+
+} // namespace
+
+void parser_record(const char* name, const std::vector<NvDsInferLayerInfo>& layers, const NvDsInferNetworkInfo& net,
+                   const NvDsInferParseDetectionParams& params) {
+  Recorder& r = recorder();
+  if (!r.on.load(std::memory_order_acquire)) return;
+
+  NvDsRecordHeader h{};
+  h.magic = kRecordMagic;
+  h.time_ns = trace_now_ns();
+  std::snprintf(h.parser, sizeof(h.parser), "%s", name);
+  h.net_width = net.width;
+  h.net_height = net.height;
+  h.net_channels = net.channels;
+  h.num_layers = static_cast<uint32_t>(layers.size());
+  h.num_classes = static_cast<uint32_t>(params.perClassPreclusterThreshold.size());
+  if (!layers.empty()) {
+    const uint8_t* buf = static_cast<const uint8_t*>(layers[0].buffer);
+    const size_t frame = layer_frame_bytes(layers[0]);
+    SlotStep& t = t_step;
+    const bool next = t.last && frame > 0 && frame == t.last_bytes && buf == t.last + frame;
+    t.slot = next && t.slot + 1 < kMaxBatchSlots ? t.slot + 1 : 0;
+    t.last = buf;
+    t.last_bytes = frame;
+    h.batch_slot = t.slot;
+  }
+
+  size_t bytes = sizeof(h) + padded(h.num_classes * sizeof(float));
+  for (const NvDsInferLayerInfo& L : layers) {
+    bytes += sizeof(NvDsRecordLayer) + padded(L.buffer ? layer_frame_bytes(L) : 0);
+  }
+  h.bytes = static_cast<uint32_t>(bytes);
+
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (!r.file) return;
+  if (r.bytes + bytes > r.max_bytes) {
+    stop(r, "SQUEAKVIEW_RECORD_MAX_MB reached");
+    return;
+  }
+  h.index = r.index;
+
+  static const char kZeros[8] = {};
+  bool ok = std::fwrite(&h, sizeof(h), 1, r.file) == 1;
+  const size_t thr_bytes = h.num_classes * sizeof(float);
+  if (ok && thr_bytes) {
+    ok = std::fwrite(params.perClassPreclusterThreshold.data(), thr_bytes, 1, r.file) == 1 &&
+         std::fwrite(kZeros, padded(thr_bytes) - thr_bytes, 1, r.file) <= 1;
+  }
+  for (size_t i = 0; ok && i < layers.size(); ++i) {
+    const NvDsInferLayerInfo& L = layers[i];
+    NvDsRecordLayer d{};
+    std::snprintf(d.name, sizeof(d.name), "%s", L.layerName ? L.layerName : "");
+    d.data_type = static_cast<int32_t>(L.dataType);
+    d.num_dims = std::min<uint32_t>(L.inferDims.numDims, kRecordMaxDims);
+    for (uint32_t k = 0; k < d.num_dims; ++k) d.dims[k] = L.inferDims.d[k];
+    d.bytes = L.buffer ? layer_frame_bytes(L) : 0;
+    ok = std::fwrite(&d, sizeof(d), 1, r.file) == 1;
+    if (!ok || d.bytes == 0) continue;
+
+    const void* src = L.buffer;
+    if (is_device_pointer(L.buffer)) {
+      r.staging.resize(d.bytes);
+      if (cudaMemcpy(r.staging.data(), L.buffer, d.bytes, cudaMemcpyDeviceToHost) != cudaSuccess) {
+        stop(r, "could not copy a device buffer");
+        return;
+      }
+      src = r.staging.data();
+    }
+    ok = std::fwrite(src, d.bytes, 1, r.file) == 1 &&
+         std::fwrite(kZeros, padded(d.bytes) - d.bytes, 1, r.file) <= 1;
+  }
+  if (!ok) {
+    stop(r, "write failed");
+    return;
+  }
+  r.bytes += bytes;
+  ++r.index;
+}
+
+void parser_record_result(const NvDsResultHeader* record) {
+  static const bool results = [] {
+    const char* v = std::getenv("SQUEAKVIEW_RECORD_RESULTS");
+    return v && std::strcmp(v, "1") == 0;
+  }();
+  if (!results || !record) return;
+  Recorder& r = recorder();
+  if (!r.on.load(std::memory_order_acquire)) return;
+
+  NvDsRecordHeader h{};
+  h.magic = kRecordMagic;
+  h.time_ns = trace_now_ns();
+  std::snprintf(h.parser, sizeof(h.parser), "%s", "result");
+  h.num_layers = 1;
+  h.batch_slot = static_cast<uint32_t>(record->source_id);
+
+  NvDsRecordLayer d{};
+  std::snprintf(d.name, sizeof(d.name), "%s", "result");
+  d.data_type = static_cast<int32_t>(NvDsInferDataType::INT8);
+  d.num_dims = 1;
+  d.dims[0] = record->bytes;
+  d.bytes = record->bytes;
+  // record->bytes is a multiple of 64, so the data needs no padding.
+  const size_t bytes = sizeof(h) + sizeof(d) + record->bytes;
+  h.bytes = static_cast<uint32_t>(bytes);
+
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (!r.file) return;
+  if (r.bytes + bytes > r.max_bytes) {
+    stop(r, "SQUEAKVIEW_RECORD_MAX_MB reached");
+    return;
+  }
+  h.index = r.index;
+  if (std::fwrite(&h, sizeof(h), 1, r.file) != 1 || std::fwrite(&d, sizeof(d), 1, r.file) != 1 ||
+      std::fwrite(record, record->bytes, 1, r.file) != 1) {
+    stop(r, "write failed");
+    return;
+  }
+  r.bytes += bytes;
+  ++r.index;
+}
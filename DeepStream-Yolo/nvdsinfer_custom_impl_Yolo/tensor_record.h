@@ -0,0 +1,69 @@
+// tensor_record.h  (record the output tensors handed to the parsers, for offline replay by bench/replay_bench)
+// With SQUEAKVIEW_RECORD=<path> set, every exported parse callback first appends its call to <path>: the parser
+// name, the network size, the pre-cluster thresholds and every output layer (name, data type, inferDims and the
+// raw bytes of the frame nvinfer handed over, copied off the GPU when the buffer is device memory). Recording
+// stops once the file reaches SQUEAKVIEW_RECORD_MAX_MB (default 1024). Without the variable a call costs one
+// load of a static.
+//
+// File layout, little endian: an NvDsRecordFileHeader, then records. A record is an NvDsRecordHeader,
+// num_classes floats of pre-cluster thresholds and num_layers times an NvDsRecordLayer followed by its bytes,
+// padded to 8. header.bytes covers the whole record, so readers can skip parsers they don't know. A replay
+// lays the frames of one batch (slot 0 up to the next slot 0) out back to back again, so the parsers recover the
+// same batch slots and therefore the same ROIs and letterbox geometry.
+// With SQUEAKVIEW_RECORD_RESULTS=1 as well, every result record the parsers publish (result_record.h) follows the
+// call it came from as a record of parser "result": one layer named "result", INT8 data, dims {bytes}, holding the
+// NvDsResultHeader record as is. A replay skips them; they are the live results to diff the replayed ones against.
+
+#ifndef __TENSOR_RECORD_H__
+#define __TENSOR_RECORD_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "nvdsinfer_custom_impl.h"
+
+struct NvDsResultHeader;
+
+constexpr char kRecordFileMagic[8] = {'S', 'Q', 'V', 'R', 'E', 'C', '0', '1'};
+constexpr uint32_t kRecordMagic = 0x52565153;  // "SQVR"
+constexpr uint32_t kRecordVersion = 1;
+constexpr int kRecordMaxDims = 8;
+
+// Fixed binary layout shared with bench/replay_bench.cpp; bump kRecordVersion on any change.
+struct NvDsRecordFileHeader {
+  char magic[8];  // kRecordFileMagic
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct NvDsRecordHeader {
+  uint32_t magic;        // kRecordMagic
+  uint32_t bytes;        // whole record, this header included
+  uint64_t index;        // records written before this one
+  int64_t time_ns;       // CLOCK_MONOTONIC at the call
+  char parser[16];       // exported entry point, see parser_record
+  uint32_t net_width;
+  uint32_t net_height;
+  uint32_t net_channels;
+  uint32_t num_layers;
+  uint32_t num_classes;  // floats of perClassPreclusterThreshold that follow
+  uint32_t batch_slot;   // slot within the batch by the pointer step of layer 0, as tag_frame would see it
+};
+
+struct NvDsRecordLayer {
+  char name[64];
+  int32_t data_type;  // NvDsInferDataType
+  uint32_t num_dims;
+  uint32_t dims[kRecordMaxDims];
+  uint64_t bytes;     // data bytes that follow, before padding
+};
+
+// Appends one call of parser `name` ("yolo", "cuda", "v8pose", ... as bench/replay_bench knows them) when
+// recording is on. Thread-safe; a failed write turns recording off.
+void parser_record(const char* name, const std::vector<NvDsInferLayerInfo>& layers, const NvDsInferNetworkInfo& net,
+                   const NvDsInferParseDetectionParams& params);
+
+// Appends a result record (an NvDsResultHeader and its arrays) when recording and SQUEAKVIEW_RECORD_RESULTS=1.
+void parser_record_result(const NvDsResultHeader* record);
+
+#endif
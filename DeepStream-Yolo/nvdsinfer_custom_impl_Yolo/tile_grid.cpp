@@ -0,0 +1,152 @@
+// tile_grid.cpp
+
+#include "tile_grid.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include "grid_nms.h"
+#include "parser_context.h"
+#include "parser_log.h"
+
+namespace {
+
+// Tile rows gathered for one source frame; `seen` has bit t set once tile t was added.
+struct SourceFuse {
+  std::mutex mutex;
+  uint64_t seen{0};
+  int stride{0};
+  std::vector<float> rows;
+  std::vector<int> cls;
+  std::vector<int> tile;
+};
+
+SourceFuse g_fuse[kMaxBatchSlots];
+
+thread_local std::vector<int> t_order;
+
+void fuse(SourceFuse& f, int source, float iou_thr, TileFused& out) {
+  const int n = static_cast<int>(f.cls.size());
+  const int stride = f.stride;
+  std::vector<int>& order = t_order;
+  order.resize(n);
+  for (int i = 0; i < n; ++i) order[i] = i;
+  const float* rows = f.rows.data();
+  std::sort(order.begin(), order.end(),
+            [rows, stride](int l, int r) { return rows[l * stride + 4] > rows[r * stride + 4]; });
+
+  GridNms& g = grid_nms();
+  g.begin(n);
+  const bool aware = parser_nms_class_aware();
+  for (int r = 0; r < n; ++r) {
+    const float* p = rows + static_cast<size_t>(order[r]) * stride;
+    g.set(r, p[0], p[1], p[2], p[3], aware ? f.cls[order[r]] : -1);
+  }
+  g.build();
+  const int* tile = f.tile.data();
+  const int* ord = order.data();
+  const float* x1 = g.x1.data(); const float* y1 = g.y1.data();
+  const float* x2 = g.x2.data(); const float* y2 = g.y2.data();
+  const int kept = g.run(0, [=](int i, int j) {
+    if (tile[ord[i]] == tile[ord[j]]) return false;
+    const float w = std::max(0.f, std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]));
+    const float h = std::max(0.f, std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]));
+    const float area_i = std::max(0.f, x2[i] - x1[i]) * std::max(0.f, y2[i] - y1[i]);
+    const float area_j = std::max(0.f, x2[j] - x1[j]) * std::max(0.f, y2[j] - y1[j]);
+    return w * h / (std::min(area_i, area_j) + 1e-6f) > iou_thr;
+  });
+
+  out.source = source;
+  out.count = kept;
+  out.rows.resize(static_cast<size_t>(kept) * stride);
+  out.cls.resize(kept);
+  for (int k = 0; k < kept; ++k) {
+    const int i = order[g.keep[k]];
+    std::copy(rows + static_cast<size_t>(i) * stride, rows + static_cast<size_t>(i + 1) * stride,
+              out.rows.begin() + static_cast<size_t>(k) * stride);
+    out.cls[k] = f.cls[i];
+  }
+
+  f.seen = 0;
+  f.rows.clear();
+  f.cls.clear();
+  f.tile.clear();
+}
+
+} // namespace
+
+const TileSpec& tile_spec() {
+  static const TileSpec spec = [] {
+    TileSpec s;
+    const char* v = std::getenv("SQUEAKVIEW_TILES");
+    if (!v || !*v) return s;
+    int cols = 0, rows = 0;
+    float overlap = kTileDefaultOverlap;
+    const int got = std::sscanf(v, "%dx%d,%f", &cols, &rows, &overlap);
+    if (got < 2 || cols < 1 || rows < 1 || cols * rows > 64 || overlap < 0.f || overlap >= 1.f) {
+      PARSER_LOG(kLogWarn, "[TILES] ignoring SQUEAKVIEW_TILES=\"%s\" (want <cols>x<rows>[,<overlap>], at most "
+                 "64 tiles, overlap in [0, 1))", v);
+      return s;
+    }
+    s.cols = cols;
+    s.rows = rows;
+    s.overlap = overlap;
+    PARSER_LOG(kLogInfo, "[TILES] %dx%d tiles, overlap %.2f, batch slot = source * %d + tile", cols, rows, overlap,
+               cols * rows);
+    return s;
+  }();
+  return spec;
+}
+
+TileRect tile_rect(const TileSpec& spec, int tile, float src_w, float src_h) {
+  // cols tiles of side w overlapping by overlap * w span the frame: w * (cols - (cols - 1) * overlap) = src_w.
+  TileRect r;
+  r.w = src_w / (spec.cols - (spec.cols - 1) * spec.overlap);
+  r.h = src_h / (spec.rows - (spec.rows - 1) * spec.overlap);
+  r.x = (tile % spec.cols) * r.w * (1.f - spec.overlap);
+  r.y = (tile / spec.cols) * r.h * (1.f - spec.overlap);
+  return r;
+}
+
+bool tile_fuse_add(int slot, const float* rows, const int* cls, int n, int stride, float iou_thr,
+                   TileFused& out) {
+  const TileSpec& spec = tile_spec();
+  const int tiles = spec.count();
+  const int source = std::min(slot / tiles, kMaxBatchSlots - 1);
+  const int tile = slot % tiles;
+  const uint64_t bit = 1ull << tile;
+  const uint64_t all = tiles == 64 ? ~0ull : (1ull << tiles) - 1;
+
+  SourceFuse& f = g_fuse[source];
+  std::lock_guard<std::mutex> lock(f.mutex);
+  // A tile seen twice means the previous frame lost a tile; fuse what it has before starting the next one.
+  bool done = false;
+  if ((f.seen & bit) || (f.seen && f.stride != stride)) {
+    fuse(f, source, iou_thr, out);
+    done = true;
+  }
+  f.stride = stride;
+  f.rows.insert(f.rows.end(), rows, rows + static_cast<size_t>(n) * stride);
+  f.cls.insert(f.cls.end(), cls, cls + n);
+  f.tile.insert(f.tile.end(), n, tile);
+  f.seen |= bit;
+  if (!done && f.seen == all) {
+    fuse(f, source, iou_thr, out);
+    done = true;
+  }
+  return done;
+}
+
+extern "C" int NvDsInferGetTileCount() {
+  return tile_spec().count();
+}
+
+extern "C" int NvDsInferGetTileRect(int tile, int width, int height, float* rect) {
+  const TileSpec& spec = tile_spec();
+  if (!rect || tile < 0 || tile >= spec.count() || width <= 0 || height <= 0) return 0;
+  const TileRect r = tile_rect(spec, tile, static_cast<float>(width), static_cast<float>(height));
+  rect[0] = r.x; rect[1] = r.y; rect[2] = r.w; rect[3] = r.h;
+  return 1;
+}
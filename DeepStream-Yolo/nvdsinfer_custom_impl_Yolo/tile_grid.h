@@ -0,0 +1,68 @@
+// tile_grid.h  (tiled high-resolution inference: tile geometry and cross-tile fusion)
+// With SQUEAKVIEW_TILES="<cols>x<rows>[,<overlap>]" (e.g. "2x2,0.2") every source frame reaches the engine as
+// cols * rows overlapping crops instead of one letterboxed frame, batched back to back: batch slot
+// source * tiles + tile. The crops come from upstream (nvdspreprocess ROIs with input-tensor-from-meta in
+// nvinfer); NvDsInferGetTileRect gives their rectangles so the preprocess config and the parsers agree.
+// Neighbouring tiles overlap by `overlap` of a tile's side (default kTileDefaultOverlap).
+//
+// letterbox_geom() of a tile slot maps the tile's network input straight to source-frame coordinates (the tile
+// origin is folded into the padding), so the parsers' unletterbox needs no change. The V8 pose parser hands the
+// kept rows of every tile to tile_fuse_add(); the tile that completes a source frame fuses them in one greedy
+// pass and publishes the result under the source's slot. Across tiles a box is dropped when a better one of
+// another tile covers it by more than the NMS IoU as intersection over the smaller box, so a box cut at a seam
+// merges into the whole one next door (rows of the same tile were already NMSed).
+
+#ifndef __TILE_GRID_H__
+#define __TILE_GRID_H__
+
+#include <cstdint>
+#include <vector>
+
+constexpr float kTileDefaultOverlap = 0.2f;
+
+struct TileSpec {
+  int cols{1}, rows{1};
+  float overlap{0.f};
+
+  int count() const { return cols * rows; }
+  bool active() const { return count() > 1; }
+};
+
+// SQUEAKVIEW_TILES, read once; cols = rows = 1 (inactive) when unset or malformed.
+const TileSpec& tile_spec();
+
+// Source slot of batch slot `slot`: slot / tiles, the slot itself without tiling.
+inline int tile_source(int slot) {
+  const TileSpec& spec = tile_spec();
+  return spec.active() ? slot / spec.count() : slot;
+}
+
+struct TileRect {
+  float x{0}, y{0}, w{0}, h{0};
+};
+
+// Rectangle of tile `tile` (row-major) of a src_w x src_h frame.
+TileRect tile_rect(const TileSpec& spec, int tile, float src_w, float src_h);
+
+// Fused rows of one source frame, best first.
+struct TileFused {
+  int source{0};
+  int count{0};
+  std::vector<float> rows;  // `stride` floats per row, [x1,y1,x2,y2,conf, ...]
+  std::vector<int> cls;
+};
+
+// Adds the n kept rows (stride floats each, boxes in source coords) of tile slot `slot` to its source frame.
+// Returns true when this call completed the frame (every tile seen, or a tile repeated before the frame was
+// complete, in which case what was gathered is fused) and leaves the fused rows in out. Thread-safe.
+bool tile_fuse_add(int slot, const float* rows, const int* cls, int n, int stride, float iou_thr,
+                   TileFused& out);
+
+extern "C" {
+// Tile count of SQUEAKVIEW_TILES (1 when tiling is off).
+int NvDsInferGetTileCount();
+// Writes x, y, w, h of tile `tile` of a width x height frame to rect; returns 0 for an invalid tile.
+int NvDsInferGetTileRect(int tile, int width, int height, float* rect);
+}
+
+#endif
@@ -27,6 +27,12 @@
 
 #include <iomanip>
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <experimental/filesystem>
 
 static void
@@ -68,48 +74,338 @@ fileExists(const std::string fileName, bool verbose)
   return true;
 }
 
-std::vector<float>
-loadWeights(const std::string weightsFilePath)
+bool
+readBinaryFile(const std::string& filePath, std::vector<char>& data)
+{
+  std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+  if (!file.good()) {
+    return false;
+  }
+  const std::streamsize size = file.tellg();
+  if (size <= 0) {
+    return false;
+  }
+  data.resize(size);
+  file.seekg(0, std::ios::beg);
+  return static_cast<bool>(file.read(data.data(), size));
+}
+
+bool
+writeBinaryFile(const std::string& filePath, const void* data, size_t size)
 {
-  assert(fileExists(weightsFilePath));
+  // Written next to the target and renamed over it, so a concurrent reader never sees a partial file
+  const std::string tmpPath = filePath + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!file.good() || !file.write(static_cast<const char*>(data), size)) {
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmpPath.c_str(), filePath.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+DarknetWeights::~DarknetWeights()
+{
+  unload();
+}
+
+void
+DarknetWeights::unload()
+{
+  if (m_Map != nullptr) {
+    munmap(m_Map, m_MapSize);
+  }
+  m_Map = nullptr;
+  m_MapSize = 0;
+  m_Span = WeightsSpan();
+}
+
+bool
+DarknetWeights::load(const std::string& weightsFilePath)
+{
+  unload();
+  if (!fileExists(weightsFilePath)) {
+    return false;
+  }
   std::cout << "\nLoading pre-trained weights" << std::endl;
 
-  std::vector<float> weights;
+  if (weightsFilePath.find(".weights") == std::string::npos) {
+    std::cerr << "\nFile " << weightsFilePath << " is not supported" << std::endl;
+    return false;
+  }
 
-  if (weightsFilePath.find(".weights") != std::string::npos) {
-    std::ifstream file(weightsFilePath, std::ios_base::binary);
-    assert(file.good());
-    std::string line;
+  const int fd = open(weightsFilePath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "\nCould not open " << weightsFilePath << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t) (3 * sizeof(int32_t))) {
+    std::cerr << "\nFile " << weightsFilePath << " is too short to be a Darknet weights file" << std::endl;
+    close(fd);
+    return false;
+  }
+  m_MapSize = st.st_size;
+  m_Map = mmap(nullptr, m_MapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m_Map == MAP_FAILED) {
+    m_Map = nullptr;
+    std::cerr << "\nCould not map " << weightsFilePath << std::endl;
+    return false;
+  }
+  // The layer builders walk the file front to back exactly once
+  madvise(m_Map, m_MapSize, MADV_SEQUENTIAL | MADV_WILLNEED);
 
-    if (weightsFilePath.find("yolov2") != std::string::npos &&
-        weightsFilePath.find("yolov2-tiny") == std::string::npos) {
-      // Remove 4 int32 bytes of data from the stream belonging to the header
-      file.ignore(4 * 4);
+  // Header: int32 major, minor, revision, then "seen" as uint64 from version 0.2 on and as int32 before
+  const int32_t* header = static_cast<const int32_t*>(m_Map);
+  const int32_t major = header[0];
+  const int32_t minor = header[1];
+  if (major < 0 || minor < 0 || major >= 1000 || minor >= 1000) {
+    std::cerr << "\nFile " << weightsFilePath << " has an invalid header (version " << major << "." << minor << ")" <<
+        std::endl;
+    return false;
+  }
+  const size_t headerSize = 3 * sizeof(int32_t) + ((major * 10 + minor) >= 2 ? sizeof(uint64_t) : sizeof(int32_t));
+  if (m_MapSize < headerSize || (m_MapSize - headerSize) % sizeof(float) != 0) {
+    std::cerr << "\nFile " << weightsFilePath << " is truncated: " << m_MapSize - std::min(m_MapSize, headerSize) <<
+        " payload bytes is not a whole number of floats" << std::endl;
+    return false;
+  }
+
+  m_Span.data = reinterpret_cast<const float*>(static_cast<const char*>(m_Map) + headerSize);
+  m_Span.count = (m_MapSize - headerSize) / sizeof(float);
+
+  std::cout << "Loading " << weightsFilePath << " complete" << std::endl;
+  std::cout << "Total weights read: " << m_Span.size() << std::endl;
+
+  return true;
+}
+
+// Minimal protobuf wire-format reader, enough to walk ModelProto -> GraphProto -> TensorProto
+struct ProtoReader {
+  const uint8_t* p;
+  const uint8_t* end;
+
+  bool varint(uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+      const uint8_t b = *p++;
+      v |= (uint64_t) (b & 0x7f) << shift;
+      if (!(b & 0x80)) {
+        return true;
+      }
     }
-    else {
-      // Remove 5 int32 bytes of data from the stream belonging to the header
-      file.ignore(4 * 5);
+    return false;
+  }
+
+  // field < 0 at the end of the message or on malformed input
+  int next(uint32_t& wire) {
+    uint64_t tag;
+    if (p >= end || !varint(tag)) {
+      return -1;
     }
+    wire = tag & 7;
+    return (int) (tag >> 3);
+  }
 
-    char floatWeight[4];
-    while (!file.eof()) {
-      file.read(floatWeight, 4);
-      assert(file.gcount() == 4);
-      weights.push_back(*reinterpret_cast<float*>(floatWeight));
-      if (file.peek() == std::istream::traits_type::eof()) {
-        break;
-      }
+  bool bytes(ProtoReader& sub) {
+    uint64_t n;
+    if (!varint(n) || n > (uint64_t) (end - p)) {
+      return false;
     }
+    sub.p = p;
+    sub.end = p + n;
+    p += n;
+    return true;
   }
-  else {
-    std::cerr << "\nFile " << weightsFilePath << " is not supported" << std::endl;
-    assert(0);
+
+  bool skip(uint32_t wire) {
+    uint64_t v;
+    ProtoReader sub;
+    if (wire == 0) {
+      return varint(v);
+    }
+    if (wire == 2) {
+      return bytes(sub);
+    }
+    const ptrdiff_t n = wire == 1 ? 8 : wire == 5 ? 4 : -1;
+    if (n < 0 || end - p < n) {
+      return false;
+    }
+    p += n;
+    return true;
   }
 
-  std::cout << "Loading " << weightsFilePath << " complete" << std::endl;
-  std::cout << "Total weights read: " << weights.size() << std::endl;
+  std::string str() const { return std::string((const char*) p, end - p); }
+};
+
+static bool
+mapReadOnly(const std::string& filePath, void*& data, size_t& size)
+{
+  const int fd = open(filePath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  size = st.st_size;
+  data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    data = nullptr;
+    return false;
+  }
+  return true;
+}
+
+OnnxExternalWeights::~OnnxExternalWeights()
+{
+  unload();
+}
+
+void
+OnnxExternalWeights::unload()
+{
+  if (m_Model.data != nullptr) {
+    munmap(m_Model.data, m_Model.size);
+  }
+  m_Model = Mapping();
+  for (auto& file : m_DataFiles) {
+    munmap(file.second.data, file.second.size);
+  }
+  m_DataFiles.clear();
+  m_Initializers.clear();
+}
 
-  return weights;
+size_t
+OnnxExternalWeights::mappedBytes() const
+{
+  size_t total = 0;
+  for (const Initializer& init : m_Initializers) {
+    total += init.size;
+  }
+  return total;
+}
+
+bool
+OnnxExternalWeights::load(const std::string& onnxFilePath)
+{
+  unload();
+  if (!mapReadOnly(onnxFilePath, m_Model.data, m_Model.size)) {
+    return false;
+  }
+
+  const size_t slash = onnxFilePath.rfind('/');
+  const std::string modelDir = slash == std::string::npos ? "" : onnxFilePath.substr(0, slash + 1);
+
+  bool ok = true;
+  ProtoReader model{static_cast<const uint8_t*>(m_Model.data), static_cast<const uint8_t*>(m_Model.data) +
+      m_Model.size};
+  uint32_t wire;
+  int field;
+  while (ok && (field = model.next(wire)) >= 0) {
+    ProtoReader graph;
+    // ModelProto.graph = 7
+    if (field != 7 || wire != 2) {
+      ok = model.skip(wire);
+      continue;
+    }
+    ok = model.bytes(graph);
+    while (ok && (field = graph.next(wire)) >= 0) {
+      ProtoReader tensor;
+      // GraphProto.initializer = 5
+      if (field != 5 || wire != 2) {
+        ok = graph.skip(wire);
+        continue;
+      }
+      ok = graph.bytes(tensor);
+
+      std::string name, location;
+      uint64_t offset = 0, length = 0, dataLocation = 0;
+      bool hasLength = false;
+      while (ok && (field = tensor.next(wire)) >= 0) {
+        ProtoReader sub;
+        // TensorProto.name = 8, external_data = 13 (key = 1, value = 2), data_location = 14
+        if (field == 8 && wire == 2) {
+          ok = tensor.bytes(sub);
+          name = sub.str();
+        }
+        else if (field == 13 && wire == 2) {
+          ok = tensor.bytes(sub);
+          ProtoReader key, value;
+          while (ok && (field = sub.next(wire)) >= 0) {
+            if (wire != 2) {
+              ok = sub.skip(wire);
+            }
+            else {
+              ok = sub.bytes(field == 1 ? key : value);
+            }
+          }
+          if (ok && key.p != nullptr && value.p != nullptr) {
+            const std::string k = key.str();
+            const std::string v = value.str();
+            if (k == "location") {
+              location = v;
+            }
+            else if (k == "offset") {
+              offset = std::strtoull(v.c_str(), nullptr, 10);
+            }
+            else if (k == "length") {
+              length = std::strtoull(v.c_str(), nullptr, 10);
+              hasLength = true;
+            }
+          }
+        }
+        else if (field == 14 && wire == 0) {
+          ok = tensor.varint(dataLocation);
+        }
+        else {
+          ok = tensor.skip(wire);
+        }
+      }
+      // TensorProto.EXTERNAL = 1
+      if (!ok || dataLocation != 1 || location == "" || name == "") {
+        continue;
+      }
+
+      const std::string dataPath = location[0] == '/' ? location : modelDir + location;
+      auto file = m_DataFiles.find(dataPath);
+      if (file == m_DataFiles.end()) {
+        Mapping mapping;
+        if (!mapReadOnly(dataPath, mapping.data, mapping.size)) {
+          std::cerr << "\nCould not map ONNX external data " << dataPath << std::endl;
+          ok = false;
+          break;
+        }
+        // The parser hands the initializers to the builder roughly in file order
+        madvise(mapping.data, mapping.size, MADV_SEQUENTIAL);
+        file = m_DataFiles.emplace(dataPath, mapping).first;
+      }
+      if (!hasLength && offset <= file->second.size) {
+        length = file->second.size - offset;
+      }
+      if (offset > file->second.size || length > file->second.size - offset) {
+        std::cerr << "\nInitializer " << name << " lies outside " << dataPath << std::endl;
+        ok = false;
+        break;
+      }
+      m_Initializers.push_back({name, static_cast<const char*>(file->second.data) + offset, (size_t) length});
+    }
+  }
+
+  if (!ok || m_Initializers.empty()) {
+    unload();
+    return false;
+  }
+  return true;
 }
 
 std::string
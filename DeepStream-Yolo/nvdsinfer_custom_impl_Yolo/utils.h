@@ -35,13 +35,92 @@
 
 #include "NvInfer.h"
 
+#include "layers/weights_span.h"
+
 std::string trim(std::string s);
 
 float clamp(const float val, const float minVal, const float maxVal);
 
 bool fileExists(const std::string fileName, bool verbose = true);
 
-std::vector<float> loadWeights(const std::string weightsFilePath);
+// Darknet .weights file mapped read-only. The header (major, minor, revision, seen) is validated and skipped;
+// span() is the float payload straight from the page cache, valid until unload() or destruction.
+class DarknetWeights {
+  public:
+    DarknetWeights() = default;
+    ~DarknetWeights();
+    DarknetWeights(const DarknetWeights&) = delete;
+    DarknetWeights& operator=(const DarknetWeights&) = delete;
+
+    bool load(const std::string& weightsFilePath);
+    void unload();
+    const WeightsSpan& span() const { return m_Span; }
+
+  private:
+    void* m_Map = nullptr;
+    size_t m_MapSize = 0;
+    WeightsSpan m_Span;
+};
+
+// ONNX model whose initializers live in external data files, mapped read-only. load() maps the model file (just
+// the graph for such models) and every data file its top-level initializers point into; initializers() are
+// slices of those mappings for IParser::loadInitializer, so the parser never reads the weights into its own
+// buffers. The pages are file-backed and can be dropped under memory pressure instead of swapped. Valid until
+// unload() or destruction, which must come after the engine build. load() is false when the model keeps its
+// weights inline or can't be scanned.
+class OnnxExternalWeights {
+  public:
+    struct Initializer {
+      std::string name;
+      const void* data;
+      size_t size;
+    };
+
+    OnnxExternalWeights() = default;
+    ~OnnxExternalWeights();
+    OnnxExternalWeights(const OnnxExternalWeights&) = delete;
+    OnnxExternalWeights& operator=(const OnnxExternalWeights&) = delete;
+
+    bool load(const std::string& onnxFilePath);
+    void unload();
+    const void* model() const { return m_Model.data; }
+    size_t modelSize() const { return m_Model.size; }
+    const std::vector<Initializer>& initializers() const { return m_Initializers; }
+    size_t mappedBytes() const;
+
+  private:
+    struct Mapping {
+      void* data = nullptr;
+      size_t size = 0;
+    };
+
+    Mapping m_Model;
+    std::map<std::string, Mapping> m_DataFiles;
+    std::vector<Initializer> m_Initializers;
+};
+
+bool readBinaryFile(const std::string& filePath, std::vector<char>& data);
+
+bool writeBinaryFile(const std::string& filePath, const void* data, size_t size);
+
+#if NV_TENSORRT_MAJOR >= 10
+// Feeds a plan file to IRuntime::deserializeCudaEngine in pieces instead of one in-memory copy
+class PlanFileReader : public nvinfer1::IStreamReader {
+  public:
+    explicit PlanFileReader(const std::string& filePath) : m_File(filePath, std::ios::binary) {}
+
+    int64_t read(void* destination, int64_t nbBytes) override {
+      if (!m_File.good()) {
+        return 0;
+      }
+      m_File.read(static_cast<char*>(destination), nbBytes);
+      return m_File.gcount();
+    }
+
+  private:
+    std::ifstream m_File;
+};
+#endif
 
 std::string dimsToString(const nvinfer1::Dims d);
 
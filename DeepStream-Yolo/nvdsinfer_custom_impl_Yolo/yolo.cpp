@@ -27,11 +27,167 @@
 
 #include "yolo.h"
 #include "yoloPlugins.h"
+#include "build_report.h"
+#include "dynamic_ranges.h"
+#include "mem_budget.h"
+#include "parser_trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
 
 #ifdef OPENCV
 #include "calibrator.h"
 #endif
 
+#if NV_TENSORRT_MAJOR >= 8
+// YOLO_TIMING_CACHE, or <model dir>/<model name>_<device>_trt<major>.<minor>.timing.cache. Timings depend on the
+// GPU and the TensorRT version, not on the batch size or precision, so every variant of a model shares the file.
+static std::string
+timingCachePath(const std::string& modelPath, const std::string& modelName)
+{
+  if (getenv("YOLO_TIMING_CACHE")) {
+    return getenv("YOLO_TIMING_CACHE");
+  }
+
+  std::string device = "gpu";
+  int deviceId = 0;
+  cudaDeviceProp prop;
+  if (cudaGetDevice(&deviceId) == cudaSuccess && cudaGetDeviceProperties(&prop, deviceId) == cudaSuccess) {
+    device = prop.name;
+  }
+  std::transform(device.begin(), device.end(), device.begin(), [] (uint8_t c) {
+    return std::isalnum(c) ? std::tolower(c) : '_';
+  });
+
+  const std::string dir = modelPath.substr(0, modelPath.rfind("/") + 1);
+  return dir + modelName + "_" + device + "_trt" + std::to_string(NV_TENSORRT_MAJOR) + "." +
+      std::to_string(NV_TENSORRT_MINOR) + ".timing.cache";
+}
+#endif
+
+// YOLO_OPT_PROFILES=1,2,4: one optimization profile per listed batch size, used as that profile's OPT point.
+// Every profile keeps MIN=1 and MAX=batch-size so any of them can run any batch; nvinfer binds profile 0, other
+// applications pick the profile matching the batch they run. Without the variable: a single OPT=batch-size profile.
+static std::vector<int>
+optimizationProfileBatches(const uint& maxBatchSize)
+{
+  std::vector<int> batches;
+  if (getenv("YOLO_OPT_PROFILES")) {
+    std::stringstream list(getenv("YOLO_OPT_PROFILES"));
+    std::string item;
+    while (std::getline(list, item, ',')) {
+      const int batch = std::atoi(item.c_str());
+      if (batch < 1 || batch > (int) maxBatchSize) {
+        std::cerr << "WARNING: Ignoring YOLO_OPT_PROFILES entry '" << item << "', it must be in [1, " << maxBatchSize
+            << "]\n" << std::endl;
+        continue;
+      }
+      if (std::find(batches.begin(), batches.end(), batch) == batches.end()) {
+        batches.push_back(batch);
+      }
+    }
+  }
+  if (batches.empty()) {
+    batches.push_back(maxBatchSize);
+  }
+  return batches;
+}
+
+// INT8 without int8-calib-file: INT8_DYNAMIC_RANGES=<json|csv|calibration cache> sets per-tensor ranges exported
+// from QAT or an earlier calibration (without it every tensor gets +-1, which builds but loses accuracy). The
+// layers producing the YoloLayer inputs and any whose name contains an INT8_FP16_LAYERS entry run in FP16, as
+// do tensors without a range
+static void
+applyDynamicRanges(nvinfer1::INetworkDefinition* network, nvinfer1::IBuilderConfig* config)
+{
+  DynamicRanges ranges;
+  const bool imported = getenv("INT8_DYNAMIC_RANGES") && loadDynamicRanges(getenv("INT8_DYNAMIC_RANGES"), ranges);
+  if (!imported) {
+    std::cerr << "WARNING: No int8-calib-file or INT8_DYNAMIC_RANGES file, using a dynamic range of +-1 for every "
+        "tensor\n" << std::endl;
+  }
+
+  int applied = 0;
+  int missing = 0;
+  auto setRange = [&](nvinfer1::ITensor* tensor) {
+    if (!imported) {
+      tensor->setDynamicRange(-1.0f, 1.0f);
+      return;
+    }
+    DynamicRanges::const_iterator it = ranges.find(tensor->getName());
+    if (it != ranges.end()) {
+      tensor->setDynamicRange(it->second.first, it->second.second);
+      ++applied;
+    }
+    else {
+      ++missing;
+    }
+  };
+  for (INT i = 0; i < network->getNbInputs(); ++i) {
+    setRange(network->getInput(i));
+  }
+  for (INT i = 0; i < network->getNbLayers(); ++i) {
+    nvinfer1::ILayer* layer = network->getLayer(i);
+    for (INT j = 0; j < layer->getNbOutputs(); ++j) {
+      setRange(layer->getOutput(j));
+    }
+  }
+
+  std::vector<std::string> patterns;
+  if (getenv("INT8_FP16_LAYERS")) {
+    std::stringstream list(getenv("INT8_FP16_LAYERS"));
+    std::string item;
+    while (std::getline(list, item, ',')) {
+      if (item != "") {
+        patterns.push_back(item);
+      }
+    }
+  }
+  std::set<const nvinfer1::ITensor*> headInputs;
+  for (INT i = 0; i < network->getNbLayers(); ++i) {
+    nvinfer1::ILayer* layer = network->getLayer(i);
+    if (layer->getType() == nvinfer1::LayerType::kPLUGIN_V2) {
+      for (INT j = 0; j < layer->getNbInputs(); ++j) {
+        headInputs.insert(layer->getInput(j));
+      }
+    }
+  }
+  int kept = 0;
+  for (INT i = 0; i < network->getNbLayers(); ++i) {
+    nvinfer1::ILayer* layer = network->getLayer(i);
+    if (layer->getType() == nvinfer1::LayerType::kPLUGIN_V2) {
+      continue;
+    }
+    bool sensitive = false;
+    for (INT j = 0; j < layer->getNbOutputs() && !sensitive; ++j) {
+      sensitive = headInputs.count(layer->getOutput(j)) > 0;
+    }
+    const std::string layerName = layer->getName();
+    for (size_t j = 0; j < patterns.size() && !sensitive; ++j) {
+      sensitive = layerName.find(patterns[j]) != std::string::npos;
+    }
+    if (sensitive) {
+      layer->setPrecision(nvinfer1::DataType::kHALF);
+      ++kept;
+    }
+  }
+
+  config->setFlag(nvinfer1::BuilderFlag::kFP16);
+  if (kept > 0) {
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 2)
+    config->setFlag(nvinfer1::BuilderFlag::kPREFER_PRECISION_CONSTRAINTS);
+#endif
+  }
+  if (imported) {
+    std::cout << "Dynamic ranges: " << applied << " tensors set, " << missing << " without a range (FP16), " <<
+        kept << " layers kept out of INT8\n" << std::endl;
+  }
+}
+
 Yolo::Yolo(const NetworkInfo& networkInfo) : m_InputBlobName(networkInfo.inputBlobName),
     m_NetworkType(networkInfo.networkType), m_ModelName(networkInfo.modelName),
     m_OnnxFilePath(networkInfo.onnxFilePath), m_WtsFilePath(networkInfo.wtsFilePath),
@@ -40,7 +196,9 @@ Yolo::Yolo(const NetworkInfo& networkInfo) : m_InputBlobName(networkInfo.inputBl
     m_DeviceType(networkInfo.deviceType), m_NumDetectedClasses(networkInfo.numDetectedClasses),
     m_ClusterMode(networkInfo.clusterMode), m_NetworkMode(networkInfo.networkMode),
     m_ScaleFactor(networkInfo.scaleFactor), m_Offsets(networkInfo.offsets), m_WorkspaceSize(networkInfo.workspaceSize),
-    m_InputFormat(networkInfo.inputFormat), m_InputC(0), m_InputH(0), m_InputW(0), m_InputSize(0), m_NumClasses(0),
+    m_InputFormat(networkInfo.inputFormat), m_MaintainAspectRatio(networkInfo.maintainAspectRatio),
+    m_SymmetricPadding(networkInfo.symmetricPadding), m_EngineFilePath(networkInfo.engineFilePath),
+    m_DLACore(networkInfo.dlaCore), m_InputC(0), m_InputH(0), m_InputW(0), m_InputSize(0), m_NumClasses(0),
     m_LetterBox(0), m_NewCoords(0), m_YoloCount(0)
 {
 }
@@ -60,6 +218,8 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
 {
   assert(builder);
 
+  TraceScope trace("Yolo::createEngine", kTraceBuild);
+
 #if NV_TENSORRT_MAJOR < 8
   nvinfer1::IBuilderConfig* config = builder->createBuilderConfig();
   if (m_WorkspaceSize > 0) {
@@ -76,6 +236,7 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
   nvonnxparser::IParser* parser;
 
   if (m_NetworkType == "onnx") {
+    TraceScope defineTrace("parse_onnx");
 
 #if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR > 0)
     parser = nvonnxparser::createParser(*network, *builder->getLogger());
@@ -83,7 +244,27 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
     parser = nvonnxparser::createParser(*network, logger);
 #endif
 
-    if (!parser->parseFromFile(m_OnnxFilePath.c_str(), static_cast<INT>(nvinfer1::ILogger::Severity::kWARNING))) {
+    bool parsed = false;
+#if NV_TENSORRT_MAJOR > 10 || (NV_TENSORRT_MAJOR == 10 && NV_TENSORRT_MINOR >= 8)
+    // Initializers in external data files go to the parser straight from their mappings, so only the builder
+    // holds a copy of the weights during the build. YOLO_ONNX_MMAP=0 falls back to parseFromFile.
+    const bool mapWeights = !(getenv("YOLO_ONNX_MMAP") && std::string(getenv("YOLO_ONNX_MMAP")) == "0");
+    if (mapWeights && m_OnnxWeights.load(m_OnnxFilePath)) {
+      parsed = parser->loadModelProto(m_OnnxWeights.model(), m_OnnxWeights.modelSize(), m_OnnxFilePath.c_str());
+      for (const OnnxExternalWeights::Initializer& init : m_OnnxWeights.initializers()) {
+        parsed = parsed && parser->loadInitializer(init.name.c_str(), init.data, init.size);
+      }
+      parsed = parsed && parser->parseModelProto();
+      if (parsed) {
+        std::cout << "Mapped " << m_OnnxWeights.initializers().size() << " external initializers (" <<
+            m_OnnxWeights.mappedBytes() / (1024 * 1024) << " MiB)\n" << std::endl;
+      }
+    }
+    else
+#endif
+    parsed = parser->parseFromFile(m_OnnxFilePath.c_str(), static_cast<INT>(nvinfer1::ILogger::Severity::kWARNING));
+
+    if (!parsed) {
       std::cerr << "\nCould not parse the ONNX file\n" << std::endl;
 
 #if NV_TENSORRT_MAJOR >= 8
@@ -102,6 +283,7 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
     m_InputW = network->getInput(0)->getDimensions().d[3];
   }
   else {
+    TraceScope defineTrace("build_darknet_network");
     m_ConfigBlocks = parseConfigFile(m_CfgFilePath);
     parseConfigBlocks();
     if (parseModel(*network) != NVDSINFER_SUCCESS) {
@@ -118,20 +300,26 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
   }
 
   if ((m_NetworkType == "darknet" && !m_ImplicitBatch) || network->getInput(0)->getDimensions().d[0] == -1) {
-    nvinfer1::IOptimizationProfile* profile = builder->createOptimizationProfile();
-    assert(profile);
-    for (INT i = 0; i < network->getNbInputs(); ++i) {
-      nvinfer1::ITensor* input = network->getInput(i);
-      nvinfer1::Dims inputDims = input->getDimensions();
-      nvinfer1::Dims dims = inputDims;
-      dims.d[0] = 1;
-      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMIN, dims);
-      dims.d[0] = m_BatchSize;
-      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kOPT, dims);
-      dims.d[0] = m_BatchSize;
-      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMAX, dims);
-    }
-    config->addOptimizationProfile(profile);
+    const std::vector<int> batches = optimizationProfileBatches(m_BatchSize);
+    for (const int& optBatch : batches) {
+      nvinfer1::IOptimizationProfile* profile = builder->createOptimizationProfile();
+      assert(profile);
+      for (INT i = 0; i < network->getNbInputs(); ++i) {
+        nvinfer1::ITensor* input = network->getInput(i);
+        nvinfer1::Dims inputDims = input->getDimensions();
+        nvinfer1::Dims dims = inputDims;
+        dims.d[0] = 1;
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMIN, dims);
+        dims.d[0] = optBatch;
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kOPT, dims);
+        dims.d[0] = m_BatchSize;
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMAX, dims);
+      }
+      config->addOptimizationProfile(profile);
+    }
+    if (batches.size() > 1) {
+      std::cout << "Building " << batches.size() << " optimization profiles\n" << std::endl;
+    }
   }
 
   std::cout << "\nBuilding the TensorRT Engine\n" << std::endl;
@@ -179,20 +367,124 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
         std::cerr << "INT8_CALIB_BATCH_SIZE not set" << std::endl;
         assert(0);
       }
+      // Under a memory budget the calibration batch shrinks until its device input and its two host slots fit in
+      // half of what is left, keeping the rest for the builder workspace
+      if (mem_budget(kMemDevice) > 0 || mem_budget(kMemPinned) > 0) {
+        const size_t sampleBytes = (size_t) m_InputC * m_InputH * m_InputW * sizeof(float);
+        const size_t fit = std::max<size_t>(1,
+            std::min(mem_budget_left(kMemDevice) / 2, mem_budget_left(kMemPinned) / 4) / sampleBytes);
+        if ((size_t) calib_batch_size > fit) {
+          std::cout << "Calibration batch size reduced from " << calib_batch_size << " to " << fit <<
+              " to fit SQUEAKVIEW_MEM_BUDGET\n" << std::endl;
+          calib_batch_size = static_cast<int>(fit);
+        }
+      }
       nvinfer1::IInt8EntropyCalibrator2* calibrator = new Int8EntropyCalibrator2(calib_batch_size, m_InputC, m_InputH,
-          m_InputW, m_ScaleFactor, m_Offsets, m_InputFormat, calib_image_list, m_Int8CalibPath);
+          m_InputW, m_ScaleFactor, m_Offsets, m_InputFormat, calib_image_list, m_Int8CalibPath,
+          m_MaintainAspectRatio, m_SymmetricPadding);
       config->setInt8Calibrator(calibrator);
 #else
       assert(0 && "OpenCV is required to run INT8 calibrator\n");
 #endif
 
     }
+    else {
+      applyDynamicRanges(network, config);
+    }
+  }
+
+  if (m_DeviceType == "kDLA") {
+    if (builder->getNbDLACores() > 0) {
+      // Layers DLA can't run fall back to the GPU instead of failing the build
+      config->setDefaultDeviceType(nvinfer1::DeviceType::kDLA);
+      config->setDLACore(m_DLACore);
+      config->setFlag(nvinfer1::BuilderFlag::kGPU_FALLBACK);
+      std::cout << "Building for DLA core " << m_DLACore << " with GPU fallback\n" << std::endl;
+    }
+    else {
+      std::cerr << "WARNING: enable-dla is set but the platform has no DLA cores, building for the GPU\n" << std::endl;
+    }
+  }
+
+#if NV_TENSORRT_MAJOR >= 8
+  if (getenv("YOLO_SPARSITY") && std::atoi(getenv("YOLO_SPARSITY")) == 1) {
+    config->setFlag(nvinfer1::BuilderFlag::kSPARSE_WEIGHTS);
+  }
+  // Weights can be swapped later without a rebuild (engine_refit.h)
+  if (getenv("YOLO_REFIT") && std::atoi(getenv("YOLO_REFIT")) == 1) {
+    config->setFlag(nvinfer1::BuilderFlag::kREFIT);
+  }
+#endif
+
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 6)
+  if (getenv("YOLO_BUILDER_OPT_LEVEL")) {
+    config->setBuilderOptimizationLevel(std::atoi(getenv("YOLO_BUILDER_OPT_LEVEL")));
+  }
+#endif
+
+  // YOLO_FP32_LAYERS=name1,name2: layers whose name contains one of the entries are kept in FP32 in FP16/INT8
+  // engines (e.g. the detection head when reduced precision costs accuracy)
+  if (getenv("YOLO_FP32_LAYERS") && m_NetworkMode != "FP32") {
+    std::vector<std::string> patterns;
+    std::stringstream list(getenv("YOLO_FP32_LAYERS"));
+    std::string item;
+    while (std::getline(list, item, ',')) {
+      if (item != "") {
+        patterns.push_back(item);
+      }
+    }
+    int constrained = 0;
+    for (INT i = 0; i < network->getNbLayers(); ++i) {
+      nvinfer1::ILayer* layer = network->getLayer(i);
+      const std::string layerName = layer->getName();
+      for (const std::string& pattern : patterns) {
+        if (layerName.find(pattern) != std::string::npos) {
+          layer->setPrecision(nvinfer1::DataType::kFLOAT);
+          ++constrained;
+          break;
+        }
+      }
+    }
+    if (constrained > 0) {
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 2)
+      config->setFlag(nvinfer1::BuilderFlag::kOBEY_PRECISION_CONSTRAINTS);
+#else
+      config->setFlag(nvinfer1::BuilderFlag::kSTRICT_TYPES);
+#endif
+    }
+    std::cout << "Keeping " << constrained << " layers in FP32\n" << std::endl;
   }
 
 #ifdef GRAPH
   config->setProfilingVerbosity(nvinfer1::ProfilingVerbosity::kDETAILED);
 #endif
 
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 5)
+  if (buildReportIterations() > 0) {
+    config->setProfilingVerbosity(nvinfer1::ProfilingVerbosity::kDETAILED);
+  }
+#endif
+
+#if NV_TENSORRT_MAJOR >= 8
+  // Tactic timings are reused across rebuilds and across the batch-size / precision variants of the model
+  const std::string cachePath = timingCachePath(m_NetworkType == "onnx" ? m_OnnxFilePath : m_CfgFilePath,
+      m_ModelName);
+  std::vector<char> cacheData;
+  if (readBinaryFile(cachePath, cacheData)) {
+    std::cout << "Loading timing cache: " << cachePath << "\n" << std::endl;
+  }
+  nvinfer1::ITimingCache* timingCache = config->createTimingCache(cacheData.data(), cacheData.size());
+  if (timingCache == nullptr && !cacheData.empty()) {
+    std::cerr << "WARNING: Timing cache " << cachePath << " is unusable, starting an empty one\n" << std::endl;
+    timingCache = config->createTimingCache(nullptr, 0);
+  }
+  if (timingCache != nullptr && !config->setTimingCache(*timingCache, false)) {
+    std::cerr << "WARNING: Could not attach the timing cache\n" << std::endl;
+    delete timingCache;
+    timingCache = nullptr;
+  }
+#endif
+
 #if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR > 0)
   nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(*builder->getLogger());
 #else
@@ -201,9 +493,70 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
 
   assert(runtime);
 
-  nvinfer1::IHostMemory* serializedEngine = builder->buildSerializedNetwork(*network, *config);
+  // The builder workspace is capped at the device budget left and accounted to the build while it runs
+  size_t workspaceCharge = 0;
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 4)
+  if (mem_budget(kMemDevice) > 0) {
+    const size_t left = mem_budget_left(kMemDevice);
+    workspaceCharge = config->getMemoryPoolLimit(nvinfer1::MemoryPoolType::kWORKSPACE);
+    if (workspaceCharge > left) {
+      std::cout << "Builder workspace capped at " << (left >> 20) << " MiB to fit SQUEAKVIEW_MEM_BUDGET\n" <<
+          std::endl;
+      config->setMemoryPoolLimit(nvinfer1::MemoryPoolType::kWORKSPACE, left);
+      workspaceCharge = left;
+    }
+    mem_track(kMemBuild, kMemDevice, workspaceCharge);
+  }
+#endif
+
+  nvinfer1::IHostMemory* serializedEngine = nullptr;
+  {
+    TraceScope buildTrace("buildSerializedNetwork");
+    serializedEngine = builder->buildSerializedNetwork(*network, *config);
+  }
+  mem_release(kMemBuild, kMemDevice, workspaceCharge);
+
+  // The network definition, the ONNX parser and the Darknet weights are only needed by the builder: release them
+  // before the engine is deserialized so they don't add to the startup peak
+#if NV_TENSORRT_MAJOR >= 8
+  if (m_NetworkType == "onnx") {
+    delete parser;
+  }
+  delete network;
+#else
+  if (m_NetworkType == "onnx") {
+    parser->destroy();
+  }
+  config->destroy();
+  network->destroy();
+#endif
+  destroyNetworkUtils();
+
+  nvinfer1::ICudaEngine* engine = nullptr;
+  if (serializedEngine != nullptr && serializedEngine->size() > 0) {
+    TraceScope deserializeTrace("save_and_deserialize");
+    // Save the plan to the engine path nvinfer loads next time, so later starts skip the build
+    const bool saved = m_EngineFilePath != "" &&
+        writeBinaryFile(m_EngineFilePath, serializedEngine->data(), serializedEngine->size());
+    if (saved) {
+      std::cout << "Engine plan saved to " << m_EngineFilePath << "\n" << std::endl;
+    }
 
-  nvinfer1::ICudaEngine* engine = runtime->deserializeCudaEngine(serializedEngine->data(), serializedEngine->size());
+#if NV_TENSORRT_MAJOR >= 10
+    // Stream it back from the file, so the plan and the engine are never in memory at the same time
+    if (saved) {
+      delete serializedEngine;
+      serializedEngine = nullptr;
+      PlanFileReader reader(m_EngineFilePath);
+      engine = runtime->deserializeCudaEngine(reader);
+    }
+    else {
+      engine = runtime->deserializeCudaEngine(serializedEngine->data(), serializedEngine->size());
+    }
+#else
+    engine = runtime->deserializeCudaEngine(serializedEngine->data(), serializedEngine->size());
+#endif
+  }
   if (engine) {
     std::cout << "Building complete\n" << std::endl;
   }
@@ -214,7 +567,20 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
 #if NV_TENSORRT_MAJOR >= 8
   delete serializedEngine;
 #else
-  serializedEngine->destroy();
+  if (serializedEngine != nullptr) {
+    serializedEngine->destroy();
+  }
+#endif
+
+#if NV_TENSORRT_MAJOR >= 8
+  if (timingCache != nullptr) {
+    nvinfer1::IHostMemory* cacheBlob = timingCache->serialize();
+    if (engine && cacheBlob != nullptr && writeBinaryFile(cachePath, cacheBlob->data(), cacheBlob->size())) {
+      std::cout << "Timing cache saved to " << cachePath << "\n" << std::endl;
+    }
+    delete cacheBlob;
+    delete timingCache;
+  }
 #endif
 
 #ifdef GRAPH
@@ -237,18 +603,10 @@ Yolo::createEngine(nvinfer1::IBuilder* builder)
 
 #endif
 
-#if NV_TENSORRT_MAJOR >= 8
-  if (m_NetworkType == "onnx") {
-    delete parser;
+  if (engine && buildReportIterations() > 0) {
+    TraceScope reportTrace("build_report");
+    writeBuildReport(engine, buildReportPath(m_EngineFilePath), buildReportIterations(), m_NetworkMode);
   }
-  delete network;
-#else
-  if (m_NetworkType == "onnx") {
-    parser->destroy();
-  }
-  config->destroy();
-  network->destroy();
-#endif
 
   return engine;
 }
@@ -257,12 +615,39 @@ NvDsInferStatus
 Yolo::parseModel(nvinfer1::INetworkDefinition& network) {
   destroyNetworkUtils();
 
-  std::vector<float> weights = loadWeights(m_WtsFilePath);
+  // The layers hand slices of the mapping to TensorRT, so it stays until destroyNetworkUtils() after the build.
+  // With YOLO_WEIGHTS_BLOB=1 they take their tensors from the packed blob when it matches the weights and the cfg;
+  // otherwise they read the .weights file and this build records the blob for the next one.
+  const std::string blobPath = weightsBlobPath(m_WtsFilePath);
+  WeightsSpan weights;
+  if (weightsBlobEnabled() && m_WeightsBlob.open(blobPath, m_WtsFilePath, m_CfgFilePath)) {
+    weights.count = m_WeightsBlob.totalConsumed();
+    weights.blob = &m_WeightsBlob;
+  }
+  else {
+    if (!m_DarknetWeights.load(m_WtsFilePath)) {
+      std::cerr << "Loading the Darknet weights failed" << std::endl;
+      return NVDSINFER_CUSTOM_LIB_FAILED;
+    }
+    weights = m_DarknetWeights.span();
+    if (weightsBlobEnabled()) {
+      m_WeightsBlob.beginRecord();
+      weights.blob = &m_WeightsBlob;
+    }
+  }
   std::cout << "Building YOLO network\n" << std::endl;
   NvDsInferStatus status = buildYoloNetwork(weights, network);
+  {
+    // The folded kernels were queued while the layers were defined; the blob and the build read them
+    TraceScope prepareTrace("prepare_darknet_weights");
+    m_WeightsArena.prepare();
+  }
 
   if (status == NVDSINFER_SUCCESS) {
     std::cout << "Building YOLO network complete" << std::endl;
+    if (m_WeightsBlob.recording()) {
+      m_WeightsBlob.write(blobPath, m_WtsFilePath, m_CfgFilePath);
+    }
   }
   else {
     std::cerr << "Building YOLO network failed" << std::endl;
@@ -272,7 +657,7 @@ Yolo::parseModel(nvinfer1::INetworkDefinition& network) {
 }
 
 NvDsInferStatus
-Yolo::buildYoloNetwork(std::vector<float>& weights, nvinfer1::INetworkDefinition& network)
+Yolo::buildYoloNetwork(const WeightsSpan& weights, nvinfer1::INetworkDefinition& network)
 {
   int weightPtr = 0;
 
@@ -290,179 +675,184 @@ Yolo::buildYoloNetwork(std::vector<float>& weights, nvinfer1::INetworkDefinition
   uint yoloCountInputs = 0;
 
   for (uint i = 0; i < m_ConfigBlocks.size(); ++i) {
+    CfgBlock& block = m_ConfigBlocks.at(i);
     std::string layerIndex = "(" + std::to_string(tensorOutputs.size()) + ")";
 
-    if (m_ConfigBlocks.at(i).at("type") == "net")
+    switch (block.layerType) {
+      case CfgLayerType::kNet:
         printLayerInfo("", "Layer", "Input Shape", "Output Shape", "WeightPtr");
-    else if (m_ConfigBlocks.at(i).at("type") == "conv" || m_ConfigBlocks.at(i).at("type") == "convolutional") {
-      int channels = getNumChannels(previous);
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = convolutionalLayer(i, m_ConfigBlocks.at(i), weights, m_TrtWeights, weightPtr, channels, previous,
-          &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "conv_" + m_ConfigBlocks.at(i).at("activation");
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, std::to_string(weightPtr));
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "deconv" || m_ConfigBlocks.at(i).at("type") == "deconvolutional") {
-      int channels = getNumChannels(previous);
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = deconvolutionalLayer(i, m_ConfigBlocks.at(i), weights, m_TrtWeights, weightPtr, channels, previous,
-          &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "deconv";
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, std::to_string(weightPtr));
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "batchnorm") {
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = batchnormLayer(i, m_ConfigBlocks.at(i), weights, m_TrtWeights, weightPtr, previous, &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "batchnorm_" + m_ConfigBlocks.at(i).at("activation");
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, std::to_string(weightPtr));
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "implicit" || m_ConfigBlocks.at(i).at("type") == "implicit_add" ||
-        m_ConfigBlocks.at(i).at("type") == "implicit_mul") {
-      previous = implicitLayer(i, m_ConfigBlocks.at(i), weights, m_TrtWeights, weightPtr, &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "implicit";
-      printLayerInfo(layerIndex, layerName, "-", outputVol, std::to_string(weightPtr));
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "shift_channels" ||
-        m_ConfigBlocks.at(i).at("type") == "control_channels") {
-      assert(m_ConfigBlocks.at(i).find("from") != m_ConfigBlocks.at(i).end());
-      int from = stoi(m_ConfigBlocks.at(i).at("from"));
-      if (from > 0) {
-        from = from - i + 1;
-      }
-      assert((i - 2 >= 0) && (i - 2 < tensorOutputs.size()));
-      assert((i + from - 1 >= 0) && (i + from - 1 < tensorOutputs.size()));
-      assert(i + from - 1 < i - 2);
-
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = channelsLayer(i, m_ConfigBlocks.at(i), previous, tensorOutputs[i + from - 1], &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = m_ConfigBlocks.at(i).at("type") + ": " + std::to_string(i + from - 1);
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "shortcut") {
-      assert(m_ConfigBlocks.at(i).find("from") != m_ConfigBlocks.at(i).end());
-      int from = stoi(m_ConfigBlocks.at(i).at("from"));
-      if (from > 0) {
-        from = from - i + 1;
-      }
-      assert((i - 2 >= 0) && (i - 2 < tensorOutputs.size()));
-      assert((i + from - 1 >= 0) && (i + from - 1 < tensorOutputs.size()));
-      assert(i + from - 1 < i - 2);
-
-      std::string activation = "linear";
-      if (m_ConfigBlocks.at(i).find("activation") != m_ConfigBlocks.at(i).end()) {
-        activation = m_ConfigBlocks.at(i).at("activation");
-      }
-
-      std::string inputVol = dimsToString(previous->getDimensions());
-      std::string shortcutVol = dimsToString(tensorOutputs[i + from - 1]->getDimensions());
-      previous = shortcutLayer(i, activation, inputVol, shortcutVol, m_ConfigBlocks.at(i), previous,
-          tensorOutputs[i + from - 1], &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "shortcut_" + activation + ": " + std::to_string(i + from - 1);
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
-
-      if (inputVol != shortcutVol) {
-        std::cout << inputVol << " +" << shortcutVol << std::endl;
-      }
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "sam") {
-      assert(m_ConfigBlocks.at(i).find("from") != m_ConfigBlocks.at(i).end());
-      int from = stoi(m_ConfigBlocks.at(i).at("from"));
-      if (from > 0) {
-        from = from - i + 1;
-      }
-      assert((i - 2 >= 0) && (i - 2 < tensorOutputs.size()));
-      assert((i + from - 1 >= 0) && (i + from - 1 < tensorOutputs.size()));
-      assert(i + from - 1 < i - 2);
-
-      std::string activation = "linear";
-      if (m_ConfigBlocks.at(i).find("activation") != m_ConfigBlocks.at(i).end()) {
-        activation = m_ConfigBlocks.at(i).at("activation");
-      }
-
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = samLayer(i, activation, m_ConfigBlocks.at(i), previous, tensorOutputs[i + from - 1], &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "sam_" + activation + ": " + std::to_string(i + from - 1);
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "route") {
-      std::string layers;
-      previous = routeLayer(i, layers, m_ConfigBlocks.at(i), tensorOutputs, &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "route: " + layers;
-      printLayerInfo(layerIndex, layerName, "-", outputVol, "-");
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "upsample") {
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = upsampleLayer(i, m_ConfigBlocks[i], previous, &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = "upsample";
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "max" || m_ConfigBlocks.at(i).at("type") == "maxpool" ||
-        m_ConfigBlocks.at(i).at("type") == "avg" || m_ConfigBlocks.at(i).at("type") == "avgpool") {
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = poolingLayer(i, m_ConfigBlocks.at(i), previous, &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = m_ConfigBlocks.at(i).at("type");
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "reorg" || m_ConfigBlocks.at(i).at("type") == "reorg3d") {
-      std::string inputVol = dimsToString(previous->getDimensions());
-      previous = reorgLayer(i, m_ConfigBlocks.at(i), previous, &network);
-      assert(previous != nullptr);
-      std::string outputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      std::string layerName = m_ConfigBlocks.at(i).at("type");
-      printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "yolo" || m_ConfigBlocks.at(i).at("type") == "region") {
-      std::string blobName = m_ConfigBlocks.at(i).at("type") == "yolo" ? "yolo_" + std::to_string(i) :
-          "region_" + std::to_string(i);
-      nvinfer1::Dims prevTensorDims = previous->getDimensions();
-      TensorInfo& curYoloTensor = m_YoloTensors.at(yoloCountInputs);
-      curYoloTensor.blobName = blobName;
-      curYoloTensor.gridSizeY = prevTensorDims.d[2];
-      curYoloTensor.gridSizeX = prevTensorDims.d[3];
-      std::string inputVol = dimsToString(previous->getDimensions());
-      tensorOutputs.push_back(previous);
-      yoloTensorInputs[yoloCountInputs] = previous;
-      ++yoloCountInputs;
-      std::string layerName = m_ConfigBlocks.at(i).at("type");
-      printLayerInfo(layerIndex, layerName, inputVol, "-", "-");
-    }
-    else if (m_ConfigBlocks.at(i).at("type") == "dropout") {
-      // pass
-    }
-    else {
-      std::cerr << "\nUnsupported layer type --> \"" << m_ConfigBlocks.at(i).at("type") << "\"" << std::endl;
-      assert(0);
+        break;
+      case CfgLayerType::kConvolutional: {
+        int channels = getNumChannels(previous);
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = convolutionalLayer(i, block.params, weights, m_WeightsArena, weightPtr, channels, previous,
+            &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "conv_" + block.activation;
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, std::to_string(weightPtr));
+        break;
+      }
+      case CfgLayerType::kDeconvolutional: {
+        int channels = getNumChannels(previous);
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = deconvolutionalLayer(i, block.params, weights, m_WeightsArena, weightPtr, channels, previous,
+            &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "deconv";
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, std::to_string(weightPtr));
+        break;
+      }
+      case CfgLayerType::kBatchnorm: {
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = batchnormLayer(i, block.params, weights, m_WeightsArena, weightPtr, previous, &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "batchnorm_" + block.activation;
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, std::to_string(weightPtr));
+        break;
+      }
+      case CfgLayerType::kImplicit: {
+        previous = implicitLayer(i, block.params, weights, weightPtr, &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "implicit";
+        printLayerInfo(layerIndex, layerName, "-", outputVol, std::to_string(weightPtr));
+        break;
+      }
+      case CfgLayerType::kChannels: {
+        assert(block.hasFrom);
+        int from = block.from;
+        if (from > 0) {
+          from = from - i + 1;
+        }
+        assert((i - 2 >= 0) && (i - 2 < tensorOutputs.size()));
+        assert((i + from - 1 >= 0) && (i + from - 1 < tensorOutputs.size()));
+        assert(i + from - 1 < i - 2);
+
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = channelsLayer(i, block.params, previous, tensorOutputs[i + from - 1], &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = block.type + ": " + std::to_string(i + from - 1);
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
+        break;
+      }
+      case CfgLayerType::kShortcut: {
+        assert(block.hasFrom);
+        int from = block.from;
+        if (from > 0) {
+          from = from - i + 1;
+        }
+        assert((i - 2 >= 0) && (i - 2 < tensorOutputs.size()));
+        assert((i + from - 1 >= 0) && (i + from - 1 < tensorOutputs.size()));
+        assert(i + from - 1 < i - 2);
+
+        const std::string& activation = block.activation;
+
+        std::string inputVol = dimsToString(previous->getDimensions());
+        std::string shortcutVol = dimsToString(tensorOutputs[i + from - 1]->getDimensions());
+        previous = shortcutLayer(i, activation, inputVol, shortcutVol, block.params, previous,
+            tensorOutputs[i + from - 1], &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "shortcut_" + activation + ": " + std::to_string(i + from - 1);
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
+
+        if (inputVol != shortcutVol) {
+          std::cout << inputVol << " +" << shortcutVol << std::endl;
+        }
+        break;
+      }
+      case CfgLayerType::kSam: {
+        assert(block.hasFrom);
+        int from = block.from;
+        if (from > 0) {
+          from = from - i + 1;
+        }
+        assert((i - 2 >= 0) && (i - 2 < tensorOutputs.size()));
+        assert((i + from - 1 >= 0) && (i + from - 1 < tensorOutputs.size()));
+        assert(i + from - 1 < i - 2);
+
+        const std::string& activation = block.activation;
+
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = samLayer(i, activation, block.params, previous, tensorOutputs[i + from - 1], &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "sam_" + activation + ": " + std::to_string(i + from - 1);
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
+        break;
+      }
+      case CfgLayerType::kRoute: {
+        std::string layers;
+        previous = routeLayer(i, layers, block.params, tensorOutputs, &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "route: " + layers;
+        printLayerInfo(layerIndex, layerName, "-", outputVol, "-");
+        break;
+      }
+      case CfgLayerType::kUpsample: {
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = upsampleLayer(i, block.params, previous, &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = "upsample";
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
+        break;
+      }
+      case CfgLayerType::kPooling: {
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = poolingLayer(i, block.params, previous, &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = block.type;
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
+        break;
+      }
+      case CfgLayerType::kReorg: {
+        std::string inputVol = dimsToString(previous->getDimensions());
+        previous = reorgLayer(i, block.params, previous, &network);
+        assert(previous != nullptr);
+        std::string outputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        std::string layerName = block.type;
+        printLayerInfo(layerIndex, layerName, inputVol, outputVol, "-");
+        break;
+      }
+      case CfgLayerType::kYolo:
+      case CfgLayerType::kRegion: {
+        std::string blobName = (block.layerType == CfgLayerType::kYolo ? "yolo_" : "region_") + std::to_string(i);
+        nvinfer1::Dims prevTensorDims = previous->getDimensions();
+        TensorInfo& curYoloTensor = m_YoloTensors.at(yoloCountInputs);
+        curYoloTensor.blobName = blobName;
+        curYoloTensor.gridSizeY = prevTensorDims.d[2];
+        curYoloTensor.gridSizeX = prevTensorDims.d[3];
+        std::string inputVol = dimsToString(previous->getDimensions());
+        tensorOutputs.push_back(previous);
+        yoloTensorInputs[yoloCountInputs] = previous;
+        ++yoloCountInputs;
+        std::string layerName = block.type;
+        printLayerInfo(layerIndex, layerName, inputVol, "-", "-");
+        break;
+      }
+      case CfgLayerType::kDropout:
+        break;
+      default:
+        std::cerr << "\nUnsupported layer type --> \"" << block.type << "\"" << std::endl;
+        assert(0);
     }
   }
 
@@ -478,8 +868,39 @@ Yolo::buildYoloNetwork(std::vector<float>& weights, nvinfer1::INetworkDefinition
       outputSize += curYoloTensor.numBBoxes * curYoloTensor.gridSizeY * curYoloTensor.gridSizeX;
     }
 
+    // Optional objectness gate baked into the engine: anchors below it skip the box and class decode. It must not
+    // exceed the lowest pre-cluster-threshold, since the final score is class probability * objectness
+    float objectnessGate = 0.0f;
+    if (getenv("YOLO_OBJECTNESS_GATE")) {
+      objectnessGate = std::stof(getenv("YOLO_OBJECTNESS_GATE"));
+      std::cout << "NOTE: YoloLayer objectness gate set to " << objectnessGate << " (YOLO_OBJECTNESS_GATE)\n" <<
+          std::endl;
+    }
+
+    // Optional FP16 [B, N, 6] output: half the output bandwidth and D2H copy, read by both bbox parsers
+    const bool outputHalf = getenv("YOLO_OUTPUT_FP16") && std::atoi(getenv("YOLO_OUTPUT_FP16")) == 1 &&
+        m_YoloCount <= static_cast<uint>(kYoloMaxHeads);
+    if (outputHalf) {
+      std::cout << "NOTE: YoloLayer output is FP16 (YOLO_OUTPUT_FP16)\n" << std::endl;
+    }
+
+    // Optional compact output: at most YOLO_OUTPUT_COMPACT rows per image scoring >= YOLO_COMPACT_THRESHOLD, plus
+    // their count, so the parsers only read the valid prefix
+    uint maxDetections = 0;
+    float compactThreshold = 0.25f;
+    if (getenv("YOLO_OUTPUT_COMPACT") && m_YoloCount <= static_cast<uint>(kYoloMaxHeads)) {
+      maxDetections = std::min<uint64_t>(std::max(std::atoi(getenv("YOLO_OUTPUT_COMPACT")), 0), outputSize);
+      if (getenv("YOLO_COMPACT_THRESHOLD")) {
+        compactThreshold = std::stof(getenv("YOLO_COMPACT_THRESHOLD"));
+      }
+      if (maxDetections > 0) {
+        std::cout << "NOTE: YoloLayer output is compact, up to " << maxDetections << " boxes with score >= " <<
+            compactThreshold << " per image (YOLO_OUTPUT_COMPACT)\n" << std::endl;
+      }
+    }
+
     nvinfer1::IPluginV2DynamicExt* yoloPlugin = new YoloLayer(m_InputW, m_InputH, m_NumClasses, m_NewCoords,
-        m_YoloTensors, outputSize);
+        m_YoloTensors, outputSize, objectnessGate, outputHalf, maxDetections, compactThreshold);
     assert(yoloPlugin != nullptr);
     nvinfer1::IPluginV2Layer* yolo = network.addPluginV2(yoloTensorInputs, m_YoloCount, *yoloPlugin);
     assert(yolo != nullptr);
@@ -491,6 +912,14 @@ Yolo::buildYoloNetwork(std::vector<float>& weights, nvinfer1::INetworkDefinition
     outputlayerName = "output";
     detection_output->setName(outputlayerName.c_str());
     network.markOutput(*detection_output);
+    if (outputHalf) {
+      detection_output->setType(nvinfer1::DataType::kHALF);
+    }
+    if (maxDetections > 0) {
+      nvinfer1::ITensor* count_output = yolo->getOutput(1);
+      count_output->setName("count");
+      network.markOutput(*count_output);
+    }
   }
   else {
     std::cerr << "\nError in yolo cfg file" << std::endl;
@@ -508,15 +937,72 @@ Yolo::buildYoloNetwork(std::vector<float>& weights, nvinfer1::INetworkDefinition
   return NVDSINFER_SUCCESS;
 }
 
-std::vector<std::map<std::string, std::string>>
+static CfgLayerType
+cfgLayerType(const std::string& type)
+{
+  static const std::map<std::string, CfgLayerType> types = {
+    {"net", CfgLayerType::kNet},
+    {"conv", CfgLayerType::kConvolutional}, {"convolutional", CfgLayerType::kConvolutional},
+    {"deconv", CfgLayerType::kDeconvolutional}, {"deconvolutional", CfgLayerType::kDeconvolutional},
+    {"batchnorm", CfgLayerType::kBatchnorm},
+    {"implicit", CfgLayerType::kImplicit}, {"implicit_add", CfgLayerType::kImplicit},
+    {"implicit_mul", CfgLayerType::kImplicit},
+    {"shift_channels", CfgLayerType::kChannels}, {"control_channels", CfgLayerType::kChannels},
+    {"shortcut", CfgLayerType::kShortcut},
+    {"sam", CfgLayerType::kSam},
+    {"route", CfgLayerType::kRoute},
+    {"upsample", CfgLayerType::kUpsample},
+    {"max", CfgLayerType::kPooling}, {"maxpool", CfgLayerType::kPooling}, {"avg", CfgLayerType::kPooling},
+    {"avgpool", CfgLayerType::kPooling},
+    {"reorg", CfgLayerType::kReorg}, {"reorg3d", CfgLayerType::kReorg},
+    {"yolo", CfgLayerType::kYolo},
+    {"region", CfgLayerType::kRegion},
+    {"dropout", CfgLayerType::kDropout}
+  };
+  std::map<std::string, CfgLayerType>::const_iterator it = types.find(type);
+  return it != types.end() ? it->second : CfgLayerType::kUnsupported;
+}
+
+static void
+finishCfgBlock(CfgBlock& block)
+{
+  block.type = block.params.at("type");
+  block.layerType = cfgLayerType(block.type);
+  std::map<std::string, std::string>::const_iterator it = block.params.find("activation");
+  if (it != block.params.end()) {
+    block.activation = it->second;
+  }
+  it = block.params.find("from");
+  if (it != block.params.end()) {
+    block.from = std::stoi(it->second);
+    block.hasFrom = true;
+  }
+}
+
+std::vector<CfgBlock>
 Yolo::parseConfigFile(const std::string cfgFilePath)
 {
   assert(fileExists(cfgFilePath));
+
+  // Repeat builds in one process (several GIEs, batch / precision variants) reuse the tokenized blocks while
+  // the file is unchanged
+  static std::mutex cacheMutex;
+  static std::map<std::string, std::pair<int64_t, std::vector<CfgBlock>>> cache;
+  struct stat st;
+  const int64_t mtime = stat(cfgFilePath.c_str(), &st) == 0 ? (int64_t) st.st_mtime : -1;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(cfgFilePath);
+    if (it != cache.end() && mtime >= 0 && it->second.first == mtime) {
+      return it->second.second;
+    }
+  }
+
   std::ifstream file(cfgFilePath);
   assert(file.good());
   std::string line;
-  std::vector<std::map<std::string, std::string>> blocks;
-  std::map<std::string, std::string> block;
+  std::vector<CfgBlock> blocks;
+  CfgBlock block;
 
   while (getline(file, line)) {
     if (line.size() == 0 || line.front() == ' ' || line.front() == '#') {
@@ -525,31 +1011,39 @@ Yolo::parseConfigFile(const std::string cfgFilePath)
 
     line = trim(line);
     if (line.front() == '[') {
-      if (block.size() > 0) {
+      if (block.params.size() > 0) {
+        finishCfgBlock(block);
         blocks.push_back(block);
-        block.clear();
+        block = CfgBlock();
       }
       std::string key = "type";
       std::string value = trim(line.substr(1, line.size() - 2));
-      block.insert(std::pair<std::string, std::string>(key, value));
+      block.params.insert(std::pair<std::string, std::string>(key, value));
     }
     else {
       int cpos = line.find('=');
       std::string key = trim(line.substr(0, cpos));
       std::string value = trim(line.substr(cpos + 1));
-      block.insert(std::pair<std::string, std::string>(key, value));
+      block.params.insert(std::pair<std::string, std::string>(key, value));
     }
   }
 
+  finishCfgBlock(block);
   blocks.push_back(block);
+
+  if (mtime >= 0) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache[cfgFilePath] = std::make_pair(mtime, blocks);
+  }
   return blocks;
 }
 
 void
 Yolo::parseConfigBlocks()
 {
-  for (auto block : m_ConfigBlocks) {
-    if (block.at("type") == "net") {
+  for (const CfgBlock& cfgBlock : m_ConfigBlocks) {
+    const std::map<std::string, std::string>& block = cfgBlock.params;
+    if (cfgBlock.layerType == CfgLayerType::kNet) {
       assert((block.find("channels") != block.end()) && "Missing 'channels' param in network cfg");
       assert((block.find("height") != block.end()) && "Missing 'height' param in network cfg");
       assert((block.find("width") != block.end()) && "Missing 'width' param in network cfg");
@@ -564,7 +1058,7 @@ Yolo::parseConfigBlocks()
         m_LetterBox = std::stoul(block.at("letter_box"));
       }
     }
-    else if ((block.at("type") == "region") || (block.at("type") == "yolo")) {
+    else if (cfgBlock.layerType == CfgLayerType::kRegion || cfgBlock.layerType == CfgLayerType::kYolo) {
       assert((block.find("num") != block.end()) &&
           std::string("Missing 'num' param in " + block.at("type") + " layer").c_str());
       assert((block.find("classes") != block.end()) &&
@@ -632,10 +1126,8 @@ Yolo::parseConfigBlocks()
 void
 Yolo::destroyNetworkUtils()
 {
-  for (uint i = 0; i < m_TrtWeights.size(); ++i) {
-    if (m_TrtWeights[i].count > 0) {
-      free(const_cast<void*>(m_TrtWeights[i].values));
-    }
-  }
-  m_TrtWeights.clear();
+  m_WeightsArena.clear();
+  m_WeightsBlob.close();
+  m_DarknetWeights.unload();
+  m_OnnxWeights.unload();
 }
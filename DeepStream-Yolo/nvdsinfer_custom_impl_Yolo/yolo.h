@@ -40,6 +40,7 @@
 #include "layers/upsample_layer.h"
 #include "layers/pooling_layer.h"
 #include "layers/reorg_layer.h"
+#include "layers/weights_blob.h"
 
 #if NV_TENSORRT_MAJOR >= 8
 #define INT int32_t
@@ -68,6 +69,7 @@ struct NetworkInfo
   int implicitBatch;
   std::string int8CalibPath;
   std::string deviceType;
+  int dlaCore;
   uint numDetectedClasses;
   int clusterMode;
   std::string networkMode;
@@ -75,6 +77,9 @@ struct NetworkInfo
   const float* offsets;
   uint workspaceSize;
   int inputFormat;
+  int maintainAspectRatio;
+  int symmetricPadding;
+  std::string engineFilePath;
 };
 
 struct TensorInfo
@@ -88,6 +93,24 @@ struct TensorInfo
   std::vector<int> mask;
 };
 
+enum class CfgLayerType : uint8_t {
+  kNet, kConvolutional, kDeconvolutional, kBatchnorm, kImplicit, kChannels, kShortcut, kSam, kRoute, kUpsample,
+  kPooling, kReorg, kYolo, kRegion, kDropout, kUnsupported
+};
+
+// One [section] of a Darknet cfg, tokenized once by parseConfigFile: the section name resolved to a layer type
+// plus the fields the network builder reads for every layer; params keeps all key=value pairs (and "type") for
+// the layer builders.
+struct CfgBlock
+{
+  CfgLayerType layerType {CfgLayerType::kUnsupported};
+  std::string type;
+  std::string activation {"linear"};
+  int from {0};
+  bool hasFrom {false};
+  std::map<std::string, std::string> params;
+};
+
 class Yolo : public IModelParser {
   public:
     Yolo(const NetworkInfo& networkInfo);
@@ -126,6 +149,10 @@ class Yolo : public IModelParser {
     const float* m_Offsets;
     const uint m_WorkspaceSize;
     const int m_InputFormat;
+    const int m_MaintainAspectRatio;
+    const int m_SymmetricPadding;
+    const std::string m_EngineFilePath;
+    const int m_DLACore;
 
     uint m_InputC;
     uint m_InputH;
@@ -137,13 +164,16 @@ class Yolo : public IModelParser {
     uint m_YoloCount;
 
     std::vector<TensorInfo> m_YoloTensors;
-    std::vector<std::map<std::string, std::string>> m_ConfigBlocks;
-    std::vector<nvinfer1::Weights> m_TrtWeights;
+    std::vector<CfgBlock> m_ConfigBlocks;
+    DarknetWeights m_DarknetWeights;
+    WeightsBlob m_WeightsBlob;
+    OnnxExternalWeights m_OnnxWeights;
+    WeightsArena m_WeightsArena;
 
   private:
-    NvDsInferStatus buildYoloNetwork(std::vector<float>& weights, nvinfer1::INetworkDefinition& network);
+    NvDsInferStatus buildYoloNetwork(const WeightsSpan& weights, nvinfer1::INetworkDefinition& network);
 
-    std::vector<std::map<std::string, std::string>> parseConfigFile(const std::string cfgFilePath);
+    std::vector<CfgBlock> parseConfigFile(const std::string cfgFilePath);
 
     void parseConfigBlocks();
 
@@ -7,10 +7,12 @@
 
 inline __device__ float sigmoidGPU(const float& x) { return 1.0f / (1.0f + __expf(-x)); }
 
+template <uint NC>
 __global__ void gpuYoloLayer(const float* input, float* output, const uint netWidth, const uint netHeight,
-    const uint gridSizeX, const uint gridSizeY, const uint numOutputClasses, const uint numBBoxes,
+    const uint gridSizeX, const uint gridSizeY, const uint numClasses, const uint numBBoxes,
     const uint64_t lastInputSize, const float scaleXY, const float* anchors, const int* mask)
 {
+  const uint numOutputClasses = NC > 0 ? NC : numClasses;
   uint x_id = blockIdx.x * blockDim.x + threadIdx.x;
   uint y_id = blockIdx.y * blockDim.y + threadIdx.y;
   uint z_id = blockIdx.z * blockDim.z + threadIdx.z;
@@ -72,8 +74,12 @@ cudaError_t cudaYoloLayer(const void* input, void* output, const uint& batchSize
   dim3 number_of_blocks((gridSizeX / threads_per_block.x) + 1, (gridSizeY / threads_per_block.y) + 1,
       (numBBoxes / threads_per_block.z) + 1);
 
+  // Specialized on the common class counts, so the class loop has a constant trip count and unrolls
+  auto kernel = numOutputClasses == 1 ? gpuYoloLayer<1> :
+      numOutputClasses == 80 ? gpuYoloLayer<80> : gpuYoloLayer<0>;
+
   for (unsigned int batch = 0; batch < batchSize; ++batch) {
-    gpuYoloLayer<<<number_of_blocks, threads_per_block, 0, stream>>>(
+    kernel<<<number_of_blocks, threads_per_block, 0, stream>>>(
         reinterpret_cast<const float*> (input) + (batch * inputSize),
         reinterpret_cast<float*> (output) + (batch * 6 * outputSize),
         netWidth, netHeight, gridSizeX, gridSizeY, numOutputClasses, numBBoxes, lastInputSize, scaleXY,
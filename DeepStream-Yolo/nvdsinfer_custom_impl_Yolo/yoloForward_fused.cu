@@ -0,0 +1,449 @@
+// yoloForward_fused.cu  (fused YoloLayer decode: all heads and batch elements in one grid)
+// One thread per (batch element, head, anchor, grid cell). Thread t of a batch element belongs to the last head
+// whose threadStart <= t; within a head, neighbouring threads take neighbouring grid cells of the same anchor,
+// so the channel loads of a warp are contiguous. Each head kind does the same math as its per-head kernel in
+// yoloForward.cu, yoloForward_nc.cu and yoloForward_v2.cu.
+// The class count is a template parameter for the common values (1 and 80), so the class loop unrolls
+// and for single-class models the argmax is a single compare; other counts take the runtime loop (NC = 0).
+// Heads are laid out back to back exactly as their output rows are, so thread t writes output row t and a block
+// owns one contiguous run of rows. The rows are staged in shared memory and stored as float4 (half2 for FP16
+// output), instead of every thread issuing six scalar stores a row apart.
+// With many classes (LANES = kYoloClassLanes) the class loop dominates, so LANES lanes share a row: a warp covers
+// 32 / LANES neighbouring rows, every lane decodes the row's box (its lanes load the same addresses, served by one
+// transaction) and takes every LANES-th class, and a shuffle reduction merges the partial maxima, ties going to
+// the lower class like the serial loop. Each class load of a warp is then LANES runs of 32 / LANES contiguous
+// elements (a 32-byte sector in FP32), and a row's 80 classes take 20 iterations with 4x as many warps in
+// flight to hide the load latency.
+
+#include "yoloForward_fused.h"
+
+#include <algorithm>
+
+#include <cuda_fp16.h>
+
+namespace {
+
+constexpr int kFusedBlock = 256;
+
+// Resident blocks per SM for the persistent compact kernel: 8 x 256 threads fill an SM's 2048 thread slots
+constexpr int kCompactBlocksPerSm = 8;
+
+__device__ inline float fusedSigmoid(const float x) { return 1.0f / (1.0f + __expf(-x)); }
+
+__device__ inline float loadInput(const float* p, const float) { return *p; }
+
+__device__ inline float loadInput(const __half* p, const float) { return __half2float(*p); }
+
+__device__ inline float loadInput(const int8_t* p, const float scale) { return static_cast<float>(*p) * scale; }
+
+// Region classes: single-pass softmax + argmax, as softmaxArgmaxGPU in yoloForward_v2.cu
+template <typename T>
+__device__ inline void regionSoftmaxArgmax(const T* in, const float scale, const int numGridCells,
+    const uint numClasses, float& maxProb, int& maxIndex)
+{
+  float largest = -INFINITY;
+  float sum = 0.0f;
+  for (uint i = 0; i < numClasses; ++i) {
+    const float val = loadInput(in + (5 + i) * numGridCells, scale);
+    if (val > largest) {
+      sum = sum * __expf(largest - val) + 1.0f;
+      largest = val;
+      maxIndex = i;
+    }
+    else {
+      sum += __expf(val - largest);
+    }
+  }
+  maxProb = maxIndex >= 0 ? 1.0f / sum : 0.0f;
+}
+
+// Lanes sharing the class loop of the row of `lane`: 32 / LANES apart, so that lanes of one slice are neighbours
+template <uint LANES>
+__device__ inline unsigned int classGroupMask(const uint lane)
+{
+  unsigned int mask = 0;
+  for (uint s = 0; s < LANES; ++s) {
+    mask |= 1u << (lane % (32 / LANES) + s * (32 / LANES));
+  }
+  return mask;
+}
+
+// Merges the partial argmax of the group's lanes; every lane ends with the row's result
+template <uint LANES>
+__device__ inline void classArgmaxReduce(float& maxProb, int& maxIndex, const unsigned int groupMask)
+{
+  for (uint offset = 32 / LANES; offset < 32; offset <<= 1) {
+    const float prob = __shfl_xor_sync(groupMask, maxProb, offset);
+    const int index = __shfl_xor_sync(groupMask, maxIndex, offset);
+    if (prob > maxProb || (prob == maxProb && index >= 0 && (maxIndex < 0 || index < maxIndex))) {
+      maxProb = prob;
+      maxIndex = index;
+    }
+  }
+}
+
+// Row t, by the lane taking classes slice, slice + LANES, ... The row's lanes take the same branches (they read the
+// same values), so they all reach the reduction.
+template <typename T, uint NC, uint LANES>
+__device__ inline void decodeRow(const YoloLayerParams& params, const uint64_t t, float* out, const uint slice,
+    const unsigned int groupMask)
+{
+  const uint batch = t / params.threadsPerBatch;
+  const uint local = t % params.threadsPerBatch;
+
+  uint h = params.numHeads - 1;
+  while (h > 0 && params.heads[h].threadStart > local) {
+    --h;
+  }
+  const YoloHeadParams& head = params.heads[h];
+
+  const uint numClasses = NC > 0 ? NC : params.numClasses;
+  const int numGridCells = head.gridSizeX * head.gridSizeY;
+  const uint cell = local - head.threadStart;
+  const uint z_id = cell / numGridCells;
+  const int bbindex = cell % numGridCells;
+  const uint x_id = bbindex % head.gridSizeX;
+  const uint y_id = bbindex / head.gridSizeX;
+
+  if (params.roi && !params.roi[(uint64_t) batch * params.roiPerBatch + head.roiStart + bbindex]) {
+    out[0] = out[1] = out[2] = out[3] = out[4] = 0.0f;
+    out[5] = -1.0f;
+    return;
+  }
+
+  const T* input = static_cast<const T*>(head.input) + batch * head.inputSize;
+  const int stride = numGridCells * (5 + numClasses);
+  const T* in = input + bbindex + z_id * stride;
+  const float scale = head.scale;
+
+  // Objectness first: below the gate the row is marked empty after a single load
+  const float rawObjectness = loadInput(in + 4 * numGridCells, scale);
+  const bool activated = head.kind == kYoloHeadNewCoords;
+  if (rawObjectness < (activated ? params.objectnessGate : params.objectnessLogit)) {
+    out[0] = out[1] = out[2] = out[3] = out[4] = 0.0f;
+    out[5] = -1.0f;
+    return;
+  }
+  const float objectness = activated ? rawObjectness : fusedSigmoid(rawObjectness);
+
+  float xc, yc, w, h_;
+  if (head.kind == kRegionHead) {
+    xc = (fusedSigmoid(loadInput(in, scale)) + x_id) * params.netWidth / head.gridSizeX;
+    yc = (fusedSigmoid(loadInput(in + numGridCells, scale)) + y_id) * params.netHeight / head.gridSizeY;
+    w = __expf(loadInput(in + 2 * numGridCells, scale)) * head.anchors[z_id * 2] * params.netWidth / head.gridSizeX;
+    h_ = __expf(loadInput(in + 3 * numGridCells, scale)) * head.anchors[z_id * 2 + 1] * params.netHeight /
+        head.gridSizeY;
+  }
+  else {
+    const float alpha = head.scaleXY;
+    const float beta = -0.5 * (head.scaleXY - 1);
+    const int anchor = head.mask[z_id] * 2;
+    if (activated) {
+      xc = (loadInput(in, scale) * alpha + beta + x_id) * params.netWidth / head.gridSizeX;
+      yc = (loadInput(in + numGridCells, scale) * alpha + beta + y_id) * params.netHeight / head.gridSizeY;
+      w = __powf(loadInput(in + 2 * numGridCells, scale) * 2, 2) * head.anchors[anchor];
+      h_ = __powf(loadInput(in + 3 * numGridCells, scale) * 2, 2) * head.anchors[anchor + 1];
+    }
+    else {
+      xc = (fusedSigmoid(loadInput(in, scale)) * alpha + beta + x_id) * params.netWidth / head.gridSizeX;
+      yc = (fusedSigmoid(loadInput(in + numGridCells, scale)) * alpha + beta + y_id) * params.netHeight /
+          head.gridSizeY;
+      w = __expf(loadInput(in + 2 * numGridCells, scale)) * head.anchors[anchor];
+      h_ = __expf(loadInput(in + 3 * numGridCells, scale)) * head.anchors[anchor + 1];
+    }
+  }
+
+  float maxProb = 0.0f;
+  int maxIndex = -1;
+
+  if (head.kind == kRegionHead) {
+    regionSoftmaxArgmax(in, scale, numGridCells, numClasses, maxProb, maxIndex);
+  }
+  else {
+    for (uint i = slice; i < numClasses; i += LANES) {
+      const float raw = loadInput(in + (5 + i) * numGridCells, scale);
+      const float prob = activated ? raw : fusedSigmoid(raw);
+      if (prob > maxProb) {
+        maxProb = prob;
+        maxIndex = i;
+      }
+    }
+    if (LANES > 1) {
+      classArgmaxReduce<LANES>(maxProb, maxIndex, groupMask);
+    }
+  }
+
+  out[0] = xc - w * 0.5;
+  out[1] = yc - h_ * 0.5;
+  out[2] = xc + w * 0.5;
+  out[3] = yc + h_ * 0.5;
+  out[4] = maxProb * objectness;
+  out[5] = (float) maxIndex;
+}
+
+// Copies the block's staged rows to the output. blockStart * 6 values is a multiple of 16 bytes in either
+// precision, so the vector stores are aligned.
+__device__ inline void storeRows(const float* tile, float* out, const uint values)
+{
+  const uint vectors = values / 4;
+  float4* out4 = reinterpret_cast<float4*>(out);
+  const float4* tile4 = reinterpret_cast<const float4*>(tile);
+  for (uint i = threadIdx.x; i < vectors; i += kFusedBlock) {
+    out4[i] = tile4[i];
+  }
+  for (uint i = vectors * 4 + threadIdx.x; i < values; i += kFusedBlock) {
+    out[i] = tile[i];
+  }
+}
+
+// Rows have an even number of values, so they pack into half2 without a tail
+__device__ inline void storeRows(const float* tile, __half* out, const uint values)
+{
+  const uint pairs = values / 2;
+  __half2* out2 = reinterpret_cast<__half2*>(out);
+  const float2* tile2 = reinterpret_cast<const float2*>(tile);
+  for (uint i = threadIdx.x; i < pairs; i += kFusedBlock) {
+    out2[i] = __float22half2_rn(tile2[i]);
+  }
+}
+
+// Rows per block: kFusedBlock / LANES, the row of a thread: its warp's rows, then its lane within the slice
+template <typename T, typename O, uint NC, uint LANES>
+__global__ void gpuYoloLayerFused(const YoloLayerParams params, O* output, const uint64_t totalThreads)
+{
+  constexpr uint rowsPerBlock = kFusedBlock / LANES;
+  __shared__ __align__(16) float tile[rowsPerBlock * 6];
+
+  const uint lane = threadIdx.x & 31;
+  const uint rowInBlock = threadIdx.x / 32 * (32 / LANES) + lane % (32 / LANES);
+  const uint64_t blockStart = (uint64_t) blockIdx.x * rowsPerBlock;
+  const uint64_t t = blockStart + rowInBlock;
+  if (t < totalThreads) {
+    // The row's lanes write the same values to its tile row
+    decodeRow<T, NC, LANES>(params, t, tile + rowInBlock * 6, lane / (32 / LANES), classGroupMask<LANES>(lane));
+  }
+  __syncthreads();
+
+  const uint rows = min((uint64_t) rowsPerBlock, totalThreads - blockStart);
+  storeRows(tile, output + blockStart * 6, rows * 6);
+}
+
+template <typename O, uint NC, uint LANES>
+void launchYoloLayerFused(const YoloLayerParams& params, const YoloInputType& inputType, O* output,
+    const uint64_t totalThreads, cudaStream_t stream)
+{
+  constexpr uint rowsPerBlock = kFusedBlock / LANES;
+  const unsigned int blocks = (totalThreads + rowsPerBlock - 1) / rowsPerBlock;
+  switch (inputType) {
+    case kYoloInputHalf:
+      gpuYoloLayerFused<__half, O, NC, LANES><<<blocks, kFusedBlock, 0, stream>>>(params, output, totalThreads);
+      break;
+    case kYoloInputInt8:
+      gpuYoloLayerFused<int8_t, O, NC, LANES><<<blocks, kFusedBlock, 0, stream>>>(params, output, totalThreads);
+      break;
+    default:
+      gpuYoloLayerFused<float, O, NC, LANES><<<blocks, kFusedBlock, 0, stream>>>(params, output, totalThreads);
+      break;
+  }
+}
+
+// Lanes per row for params: classLanes when it is set, else by class count
+inline bool
+useClassLanes(const YoloLayerParams& params)
+{
+  if (params.classLanes != 0) {
+    return params.classLanes == kYoloClassLanes;
+  }
+  return params.numClasses >= (uint) kYoloClassLanesMinClasses;
+}
+
+template <typename O>
+void dispatchYoloLayerFused(const YoloLayerParams& params, const YoloInputType& inputType, O* output,
+    const uint64_t totalThreads, cudaStream_t stream)
+{
+  const bool lanes = useClassLanes(params);
+  switch (params.numClasses) {
+    case 1:
+      launchYoloLayerFused<O, 1, 1>(params, inputType, output, totalThreads, stream);
+      break;
+    case 80:
+      if (lanes) {
+        launchYoloLayerFused<O, 80, kYoloClassLanes>(params, inputType, output, totalThreads, stream);
+      }
+      else {
+        launchYoloLayerFused<O, 80, 1>(params, inputType, output, totalThreads, stream);
+      }
+      break;
+    default:
+      if (lanes) {
+        launchYoloLayerFused<O, 0, kYoloClassLanes>(params, inputType, output, totalThreads, stream);
+      }
+      else {
+        launchYoloLayerFused<O, 0, 1>(params, inputType, output, totalThreads, stream);
+      }
+      break;
+  }
+}
+
+__device__ inline void storeRow(const float* row, float* out)
+{
+  for (int i = 0; i < 6; ++i) {
+    out[i] = row[i];
+  }
+}
+
+__device__ inline void storeRow(const float* row, __half* out)
+{
+  __half2* out2 = reinterpret_cast<__half2*>(out);
+  for (int i = 0; i < 3; ++i) {
+    out2[i] = __floats2half2_rn(row[2 * i], row[2 * i + 1]);
+  }
+}
+
+// Persistent grid: the blocks stride over every row of the batch instead of one block per 256 rows. A warp
+// appends its passing rows with one atomicAdd per batch element it covers (usually one), each lane taking the
+// slot after its passing neighbours. The loop bound is warp-uniform, so every lane reaches the ballots. With
+// LANES > 1 only the first lane of each row appends it.
+template <typename T, typename O, uint NC, uint LANES>
+__global__ void gpuYoloLayerCompact(const YoloLayerParams params, O* output, int* counts, const uint maxDetections,
+    const float threshold, const uint64_t totalThreads)
+{
+  constexpr uint rowsPerBlock = kFusedBlock / LANES;
+  const uint lane = threadIdx.x & 31;
+  const uint slice = lane / (32 / LANES);
+  const uint rowInBlock = threadIdx.x / 32 * (32 / LANES) + lane % (32 / LANES);
+  const unsigned int groupMask = classGroupMask<LANES>(lane);
+  const uint64_t stride = (uint64_t) gridDim.x * rowsPerBlock;
+
+  for (uint64_t first = (uint64_t) blockIdx.x * rowsPerBlock; first < totalThreads; first += stride) {
+    const uint64_t t = first + rowInBlock;
+    float row[6];
+    uint batch = 0;
+    bool pass = false;
+    if (t < totalThreads) {
+      decodeRow<T, NC, LANES>(params, t, row, slice, groupMask);
+      batch = t / params.threadsPerBatch;
+      pass = slice == 0 && row[5] >= 0.0f && row[4] >= threshold;
+    }
+
+    unsigned int pending = __ballot_sync(0xffffffff, pass);
+    while (pending) {
+      const int leader = __ffs(pending) - 1;
+      const uint leaderBatch = __shfl_sync(0xffffffff, batch, leader);
+      const unsigned int peers = pending & __ballot_sync(0xffffffff, batch == leaderBatch);
+      int base = 0;
+      if (lane == leader) {
+        base = atomicAdd(counts + leaderBatch, __popc(peers));
+      }
+      base = __shfl_sync(0xffffffff, base, leader);
+      if (peers & (1u << lane)) {
+        const uint slot = base + __popc(peers & ((1u << lane) - 1));
+        if (slot < maxDetections) {
+          storeRow(row, output + ((uint64_t) leaderBatch * maxDetections + slot) * 6);
+        }
+      }
+      pending &= ~peers;
+    }
+  }
+}
+
+template <typename O, uint NC, uint LANES>
+void launchYoloLayerCompact(const YoloLayerParams& params, const YoloInputType& inputType, O* output, int* counts,
+    const uint& maxDetections, const float& threshold, const int& multiProcessors, const uint64_t totalThreads,
+    cudaStream_t stream)
+{
+  constexpr uint rowsPerBlock = kFusedBlock / LANES;
+  const uint64_t needed = (totalThreads + rowsPerBlock - 1) / rowsPerBlock;
+  const unsigned int blocks = std::min<uint64_t>(needed,
+      (uint64_t) std::max(multiProcessors, 1) * kCompactBlocksPerSm);
+
+  switch (inputType) {
+    case kYoloInputHalf:
+      gpuYoloLayerCompact<__half, O, NC, LANES><<<blocks, kFusedBlock, 0, stream>>>(params, output, counts,
+          maxDetections, threshold, totalThreads);
+      break;
+    case kYoloInputInt8:
+      gpuYoloLayerCompact<int8_t, O, NC, LANES><<<blocks, kFusedBlock, 0, stream>>>(params, output, counts,
+          maxDetections, threshold, totalThreads);
+      break;
+    default:
+      gpuYoloLayerCompact<float, O, NC, LANES><<<blocks, kFusedBlock, 0, stream>>>(params, output, counts,
+          maxDetections, threshold, totalThreads);
+      break;
+  }
+}
+
+template <typename O>
+void dispatchYoloLayerCompact(const YoloLayerParams& params, const YoloInputType& inputType, O* output, int* counts,
+    const uint& maxDetections, const float& threshold, const int& multiProcessors, const uint64_t totalThreads,
+    cudaStream_t stream)
+{
+  const bool lanes = useClassLanes(params);
+  switch (params.numClasses) {
+    case 1:
+      launchYoloLayerCompact<O, 1, 1>(params, inputType, output, counts, maxDetections, threshold, multiProcessors,
+          totalThreads, stream);
+      break;
+    case 80:
+      if (lanes) {
+        launchYoloLayerCompact<O, 80, kYoloClassLanes>(params, inputType, output, counts, maxDetections, threshold,
+            multiProcessors, totalThreads, stream);
+      }
+      else {
+        launchYoloLayerCompact<O, 80, 1>(params, inputType, output, counts, maxDetections, threshold,
+            multiProcessors, totalThreads, stream);
+      }
+      break;
+    default:
+      if (lanes) {
+        launchYoloLayerCompact<O, 0, kYoloClassLanes>(params, inputType, output, counts, maxDetections, threshold,
+            multiProcessors, totalThreads, stream);
+      }
+      else {
+        launchYoloLayerCompact<O, 0, 1>(params, inputType, output, counts, maxDetections, threshold,
+            multiProcessors, totalThreads, stream);
+      }
+      break;
+  }
+}
+
+} // namespace
+
+cudaError_t cudaYoloLayerFused(const YoloLayerParams& params, const YoloInputType& inputType, void* output,
+    const bool& halfOutput, const uint& batchSize, cudaStream_t stream)
+{
+  const uint64_t totalThreads = (uint64_t) batchSize * params.threadsPerBatch;
+  if (totalThreads == 0) {
+    return cudaSuccess;
+  }
+
+  if (halfOutput) {
+    dispatchYoloLayerFused(params, inputType, reinterpret_cast<__half*> (output), totalThreads, stream);
+  }
+  else {
+    dispatchYoloLayerFused(params, inputType, reinterpret_cast<float*> (output), totalThreads, stream);
+  }
+  return cudaGetLastError();
+}
+
+
+cudaError_t cudaYoloLayerCompact(const YoloLayerParams& params, const YoloInputType& inputType, void* output,
+    int* counts, const bool& halfOutput, const uint& maxDetections, const float& threshold,
+    const int& multiProcessors, const uint& batchSize, cudaStream_t stream)
+{
+  cudaError_t err = cudaMemsetAsync(counts, 0, sizeof(int) * batchSize, stream);
+  const uint64_t totalThreads = (uint64_t) batchSize * params.threadsPerBatch;
+  if (err != cudaSuccess || totalThreads == 0 || maxDetections == 0) {
+    return err;
+  }
+
+  if (halfOutput) {
+    dispatchYoloLayerCompact(params, inputType, reinterpret_cast<__half*> (output), counts, maxDetections, threshold,
+        multiProcessors, totalThreads, stream);
+  }
+  else {
+    dispatchYoloLayerCompact(params, inputType, reinterpret_cast<float*> (output), counts, maxDetections, threshold,
+        multiProcessors, totalThreads, stream);
+  }
+  return cudaGetLastError();
+}
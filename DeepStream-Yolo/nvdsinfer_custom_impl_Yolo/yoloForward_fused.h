@@ -0,0 +1,82 @@
+// yoloForward_fused.h  (one decode launch for every YOLO head and batch element)
+// The heads are read in the precision TensorRT hands the plugin (FP32, FP16 or INT8 with a per-head scale), so
+// FP16/INT8 engines need no reformat layer in front of it. The boxes are written as FP32, or as FP16 for engines
+// built with YOLO_OUTPUT_FP16=1 (half the output bandwidth and D2H copy).
+// The per-head parameters travel by value in the kernel argument block, which the GPU serves from its constant
+// bank. That keeps them per-launch: several engines can run the plugin at once without sharing a __constant__
+// symbol.
+
+#ifndef __YOLO_FORWARD_FUSED_H__
+#define __YOLO_FORWARD_FUSED_H__
+
+#include <stdint.h>
+
+#include <cuda_runtime_api.h>
+
+// More heads than this fall back to one launch per head and batch element.
+constexpr int kYoloMaxHeads = 8;
+
+// From this many classes up, kYoloClassLanes lanes of a warp share each row's class loop (see classLanes).
+constexpr int kYoloClassLanes = 4;
+constexpr int kYoloClassLanesMinClasses = 32;
+
+enum YoloHeadKind : uint32_t {
+  kYoloHead = 0,           // sigmoid box, anchors[mask[z]]
+  kYoloHeadNewCoords = 1,  // new_coords=1: box already activated, (2x)^2 anchor scale
+  kRegionHead = 2,         // YOLOv2 region: anchors[z], softmax classes
+};
+
+enum YoloInputType : uint32_t {
+  kYoloInputFloat = 0,
+  kYoloInputHalf = 1,
+  kYoloInputInt8 = 2,
+};
+
+struct YoloHeadParams {
+  const void* input;        // YoloInputType elements
+  float scale;              // INT8 dequantization scale
+  const float* anchors;
+  const int* mask;
+  uint64_t inputSize;       // elements per batch element
+  uint32_t threadStart;     // first thread, and first output row, of this head within one batch element
+  uint32_t gridSizeX;
+  uint32_t gridSizeY;
+  uint32_t numBBoxes;
+  float scaleXY;
+  uint32_t kind;
+  uint32_t roiStart;        // first byte of this head's grid cells within one batch element's ROI block
+};
+
+struct YoloLayerParams {
+  YoloHeadParams heads[kYoloMaxHeads];
+  uint32_t numHeads;
+  uint32_t threadsPerBatch;  // sum of numBBoxes * gridSizeX * gridSizeY over the heads, i.e. output rows
+  uint32_t netWidth;
+  uint32_t netHeight;
+  uint32_t numClasses;
+  // Anchors whose objectness is below the gate are written as {0, 0, 0, 0, 0, -1} without decoding the box or
+  // the classes. objectnessLogit is the same gate before the sigmoid, for the heads that apply one. Both are
+  // -INFINITY when the gate is off.
+  float objectnessGate;
+  float objectnessLogit;
+  // gridSizeX * gridSizeY flags per head and batch element (roi_mask.h), 0 = outside the source's ROI. Rows of
+  // outside cells are written empty like gated ones. nullptr when no source has an ROI.
+  const uint8_t* roi;
+  uint32_t roiPerBatch;
+  // Lanes that decode one row together, each taking every classLanes-th class before a shuffle argmax: 1 or
+  // kYoloClassLanes. 0 picks kYoloClassLanes from kYoloClassLanesMinClasses classes up, 1 below.
+  uint32_t classLanes;
+};
+
+cudaError_t cudaYoloLayerFused(const YoloLayerParams& params, const YoloInputType& inputType, void* output,
+    const bool& halfOutput, const uint& batchSize, cudaStream_t stream);
+
+// Compact output (YOLO_OUTPUT_COMPACT): rows with a class and a score >= threshold are appended to the
+// [batchSize, maxDetections, 6] output of their batch element in no particular order, and counts[b] is the
+// number of such rows, which exceeds maxDetections when some had no room. Rows past the count are left as they
+// were. The kernel is persistent, a fixed number of blocks on each of the multiProcessors SMs of the device.
+cudaError_t cudaYoloLayerCompact(const YoloLayerParams& params, const YoloInputType& inputType, void* output,
+    int* counts, const bool& halfOutput, const uint& maxDetections, const float& threshold,
+    const int& multiProcessors, const uint& batchSize, cudaStream_t stream);
+
+#endif
@@ -7,30 +7,34 @@
 
 inline __device__ float sigmoidGPU(const float& x) { return 1.0f / (1.0f + __expf(-x)); }
 
-__device__ void softmaxGPU(const float* input, const int bbindex, const int numGridCells, uint z_id,
-    const uint numOutputClasses, float temp, float* output)
+// Single-pass softmax + argmax: keeps the running max, the sum of exp(x - max) and the argmax in registers. The
+// winning class' probability is exp(max - max) / sum = 1 / sum.
+__forceinline__ __device__ void softmaxArgmaxGPU(const float* input, const int bbindex, const int numGridCells,
+    uint z_id, const uint numOutputClasses, float& maxProb, int& maxIndex)
 {
-  int i;
-  float sum = 0;
   float largest = -INFINITY;
-  for (i = 0; i < numOutputClasses; ++i) {
-    int val = input[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + (5 + i))];
-    largest = (val>largest) ? val : largest;
-  }
-  for (i = 0; i < numOutputClasses; ++i) {
-    float e = __expf(input[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + (5 + i))] / temp - largest / temp);
-    sum += e;
-    output[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + (5 + i))] = e;
-  }
-  for (i = 0; i < numOutputClasses; ++i) {
-    output[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + (5 + i))] /= sum;
+  float sum = 0.0f;
+  maxIndex = -1;
+  for (uint i = 0; i < numOutputClasses; ++i) {
+    const float val = input[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + (5 + i))];
+    if (val > largest) {
+      sum = sum * __expf(largest - val) + 1.0f;
+      largest = val;
+      maxIndex = i;
+    }
+    else {
+      sum += __expf(val - largest);
+    }
   }
+  maxProb = maxIndex >= 0 ? 1.0f / sum : 0.0f;
 }
 
-__global__ void gpuRegionLayer(const float* input, float* softmax, float* output, const uint netWidth,
-    const uint netHeight, const uint gridSizeX, const uint gridSizeY, const uint numOutputClasses, const uint numBBoxes,
+template <uint NC>
+__global__ void gpuRegionLayer(const float* input, float* output, const uint netWidth,
+    const uint netHeight, const uint gridSizeX, const uint gridSizeY, const uint numClasses, const uint numBBoxes,
     const uint64_t lastInputSize, const float* anchors)
 {
+  const uint numOutputClasses = NC > 0 ? NC : numClasses;
   uint x_id = blockIdx.x * blockDim.x + threadIdx.x;
   uint y_id = blockIdx.y * blockDim.y + threadIdx.y;
   uint z_id = blockIdx.z * blockDim.z + threadIdx.z;
@@ -56,18 +60,9 @@ __global__ void gpuRegionLayer(const float* input, float* softmax, float* output
 
   const float objectness = sigmoidGPU(input[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + 4)]);
 
-  softmaxGPU(input, bbindex, numGridCells, z_id, numOutputClasses, 1.0, softmax);
-
-  float maxProb = 0.0f;
-  int maxIndex = -1;
-
-  for (uint i = 0; i < numOutputClasses; ++i) {
-    float prob = softmax[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + (5 + i))];
-    if (prob > maxProb) {
-      maxProb = prob;
-      maxIndex = i;
-    }
-  }
+  float maxProb;
+  int maxIndex;
+  softmaxArgmaxGPU(input, bbindex, numGridCells, z_id, numOutputClasses, maxProb, maxIndex);
 
   int count = numGridCells * z_id + bbindex + lastInputSize;
 
@@ -79,12 +74,12 @@ __global__ void gpuRegionLayer(const float* input, float* softmax, float* output
   output[count * 6 + 5] = (float) maxIndex;
 }
 
-cudaError_t cudaRegionLayer(const void* input, void* softmax, void* output, const uint& batchSize,
+cudaError_t cudaRegionLayer(const void* input, void* output, const uint& batchSize,
     const uint64_t& inputSize, const uint64_t& outputSize, const uint64_t& lastInputSize, const uint& netWidth,
     const uint& netHeight, const uint& gridSizeX, const uint& gridSizeY, const uint& numOutputClasses,
     const uint& numBBoxes, const void* anchors, cudaStream_t stream);
 
-cudaError_t cudaRegionLayer(const void* input, void* softmax, void* output, const uint& batchSize,
+cudaError_t cudaRegionLayer(const void* input, void* output, const uint& batchSize,
     const uint64_t& inputSize, const uint64_t& outputSize, const uint64_t& lastInputSize, const uint& netWidth,
     const uint& netHeight, const uint& gridSizeX, const uint& gridSizeY, const uint& numOutputClasses,
     const uint& numBBoxes, const void* anchors, cudaStream_t stream)
@@ -93,10 +88,13 @@ cudaError_t cudaRegionLayer(const void* input, void* softmax, void* output, cons
   dim3 number_of_blocks((gridSizeX / threads_per_block.x) + 1, (gridSizeY / threads_per_block.y) + 1,
       (numBBoxes / threads_per_block.z) + 1);
 
+  // Specialized on the common class counts, so the class loop has a constant trip count and unrolls
+  auto kernel = numOutputClasses == 1 ? gpuRegionLayer<1> :
+      numOutputClasses == 80 ? gpuRegionLayer<80> : gpuRegionLayer<0>;
+
   for (unsigned int batch = 0; batch < batchSize; ++batch) {
-    gpuRegionLayer<<<number_of_blocks, threads_per_block, 0, stream>>>(
+    kernel<<<number_of_blocks, threads_per_block, 0, stream>>>(
         reinterpret_cast<const float*> (input) + (batch * inputSize),
-        reinterpret_cast<float*> (softmax) + (batch * inputSize),
         reinterpret_cast<float*> (output) + (batch * 6 * outputSize),
         netWidth, netHeight, gridSizeX, gridSizeY, numOutputClasses, numBBoxes, lastInputSize,
         reinterpret_cast<const float*> (anchors));
@@ -24,18 +24,44 @@
  */
 
 #include "yoloPlugins.h"
+#include "mem_budget.h"
+#include "parser_trace.h"
+#include "roi_mask.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace {
   template <typename T>
   void write(char*& buffer, const T& val) {
-    *reinterpret_cast<T*>(buffer) = val;
+    std::memcpy(buffer, &val, sizeof(T));
     buffer += sizeof(T);
   }
   template <typename T>
   void read(const char*& buffer, T& val) {
-    val = *reinterpret_cast<const T*>(buffer);
+    std::memcpy(&val, buffer, sizeof(T));
     buffer += sizeof(T);
   }
+  // uint count, then the elements as one block: the same bytes as writing them one by one
+  template <typename T>
+  void writeArray(char*& buffer, const std::vector<T>& values) {
+    write(buffer, static_cast<uint>(values.size()));
+    if (!values.empty()) {
+      std::memcpy(buffer, values.data(), sizeof(T) * values.size());
+    }
+    buffer += sizeof(T) * values.size();
+  }
+  template <typename T>
+  void readArray(const char*& buffer, std::vector<T>& values) {
+    uint size;
+    read(buffer, size);
+    values.resize(size);
+    if (size > 0) {
+      std::memcpy(values.data(), buffer, sizeof(T) * size);
+    }
+    buffer += sizeof(T) * size;
+  }
 }
 
 cudaError_t cudaYoloLayer_nc(const void* input, void* output, const uint& batchSize, const uint64_t& inputSize,
@@ -48,12 +74,69 @@ cudaError_t cudaYoloLayer(const void* input, void* output, const uint& batchSize
     const uint& gridSizeX, const uint& gridSizeY, const uint& numOutputClasses, const uint& numBBoxes,
     const float& scaleXY, const void* anchors, const void* mask, cudaStream_t stream);
 
-cudaError_t cudaRegionLayer(const void* input, void* softmax, void* output, const uint& batchSize,
+cudaError_t cudaRegionLayer(const void* input, void* output, const uint& batchSize,
     const uint64_t& inputSize, const uint64_t& outputSize, const uint64_t& lastInputSize, const uint& netWidth,
     const uint& netHeight, const uint& gridSizeX, const uint& gridSizeY, const uint& numOutputClasses,
     const uint& numBBoxes, const void* anchors, cudaStream_t stream);
 
-YoloLayer::YoloLayer(const void* data, size_t length) {
+YoloLayerDeviceParams::~YoloLayerDeviceParams()
+{
+  mem_device_free(anchors);
+  mem_device_free(mask);
+}
+
+bool
+YoloLayerDeviceParams::upload(const std::vector<TensorInfo>& yoloTensors, const YoloLayerParams& launch)
+{
+  if (ready.load(std::memory_order_acquire)) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (ready.load(std::memory_order_relaxed)) {
+    return true;
+  }
+
+  std::vector<float> hostAnchors;
+  std::vector<int> hostMask;
+  anchorOffsets.clear();
+  maskOffsets.clear();
+  for (const TensorInfo& curYoloTensor : yoloTensors) {
+    anchorOffsets.push_back(hostAnchors.size());
+    maskOffsets.push_back(hostMask.size());
+    hostAnchors.insert(hostAnchors.end(), curYoloTensor.anchors.begin(), curYoloTensor.anchors.end());
+    hostMask.insert(hostMask.end(), curYoloTensor.mask.begin(), curYoloTensor.mask.end());
+  }
+
+  bool ok = true;
+  if (!hostAnchors.empty()) {
+    ok = mem_device_alloc((void**) &anchors, sizeof(float) * hostAnchors.size(), kMemPlugin) == cudaSuccess &&
+        cudaMemcpy(anchors, hostAnchors.data(), sizeof(float) * hostAnchors.size(), cudaMemcpyHostToDevice) ==
+        cudaSuccess;
+  }
+  if (ok && !hostMask.empty()) {
+    ok = mem_device_alloc((void**) &mask, sizeof(int) * hostMask.size(), kMemPlugin) == cudaSuccess &&
+        cudaMemcpy(mask, hostMask.data(), sizeof(int) * hostMask.size(), cudaMemcpyHostToDevice) == cudaSuccess;
+  }
+  if (!ok) {
+    std::cerr << "ERROR: Failed to upload the YoloLayer anchors and masks" << std::endl;
+    mem_device_free(anchors);
+    mem_device_free(mask);
+    anchors = nullptr;
+    mask = nullptr;
+    return false;
+  }
+
+  fused = launch;
+  for (uint i = 0; i < fused.numHeads && i < anchorOffsets.size(); ++i) {
+    fused.heads[i].anchors = anchors + anchorOffsets[i];
+    fused.heads[i].mask = mask + maskOffsets[i];
+  }
+
+  ready.store(true, std::memory_order_release);
+  return true;
+}
+
+YoloLayer::YoloLayer(const void* data, size_t length) : m_Params(std::make_shared<YoloLayerDeviceParams>()) {
   const char* d = static_cast<const char*>(data);
 
   read(d, m_NetWidth);
@@ -71,30 +154,36 @@ YoloLayer::YoloLayer(const void* data, size_t length) {
     read(d, curYoloTensor.numBBoxes);
     read(d, curYoloTensor.scaleXY);
 
-    uint anchorsSize;
-    read(d, anchorsSize);
-    for (uint j = 0; j < anchorsSize; ++j) {
-      float result;
-      read(d, result);
-      curYoloTensor.anchors.push_back(result);
-    }
-
-    uint maskSize;
-    read(d, maskSize);
-    for (uint j = 0; j < maskSize; ++j) {
-      int result;
-      read(d, result);
-      curYoloTensor.mask.push_back(result);
-    }
+    readArray(d, curYoloTensor.anchors);
+    readArray(d, curYoloTensor.mask);
 
     m_YoloTensors.push_back(curYoloTensor);
   }
+
+  if (d + sizeof(m_ObjectnessGate) <= static_cast<const char*>(data) + length) {
+    read(d, m_ObjectnessGate);
+  }
+  if (d + sizeof(m_RoiInWorkspace) <= static_cast<const char*>(data) + length) {
+    read(d, m_RoiInWorkspace);
+  }
+  if (d + sizeof(m_OutputHalf) <= static_cast<const char*>(data) + length) {
+    read(d, m_OutputHalf);
+  }
+  if (d + sizeof(m_MaxDetections) + sizeof(m_CompactThreshold) <= static_cast<const char*>(data) + length) {
+    read(d, m_MaxDetections);
+    read(d, m_CompactThreshold);
+  }
 };
 
 YoloLayer::YoloLayer(const uint& netWidth, const uint& netHeight, const uint& numClasses, const uint& newCoords,
-    const std::vector<TensorInfo>& yoloTensors, const uint64_t& outputSize) : m_NetWidth(netWidth),
-    m_NetHeight(netHeight), m_NumClasses(numClasses), m_NewCoords(newCoords), m_YoloTensors(yoloTensors),
-    m_OutputSize(outputSize)
+    const std::vector<TensorInfo>& yoloTensors, const uint64_t& outputSize, const float& objectnessGate,
+    const bool& outputHalf, const uint& maxDetections, const float& compactThreshold) :
+    m_NetWidth(netWidth), m_NetHeight(netHeight), m_NumClasses(numClasses), m_NewCoords(newCoords),
+    m_YoloTensors(yoloTensors), m_OutputSize(outputSize), m_ObjectnessGate(objectnessGate), m_RoiInWorkspace(1),
+    m_OutputHalf(outputHalf && yoloTensors.size() <= static_cast<size_t>(kYoloMaxHeads)),
+    m_MaxDetections(yoloTensors.size() <= static_cast<size_t>(kYoloMaxHeads) ? maxDetections : 0),
+    m_CompactThreshold(compactThreshold),
+    m_Params(std::make_shared<YoloLayerDeviceParams>())
 {
   assert(m_NetWidth > 0);
   assert(m_NetHeight > 0);
@@ -102,10 +191,48 @@ YoloLayer::YoloLayer(const uint& netWidth, const uint& netHeight, const uint& nu
   assert(m_OutputSize > 0);
 };
 
+YoloLayer::~YoloLayer()
+{
+  terminate();
+}
+
+int
+YoloLayer::initialize() noexcept
+{
+  if (!m_Params) {
+    m_Params = std::make_shared<YoloLayerDeviceParams>();
+  }
+  int device = 0;
+  if (cudaGetDevice(&device) != cudaSuccess ||
+      cudaDeviceGetAttribute(&m_MultiProcessors, cudaDevAttrMultiProcessorCount, device) != cudaSuccess) {
+    m_MultiProcessors = 0;
+  }
+  return m_Params->upload(m_YoloTensors, fusedParams()) ? 0 : -1;
+}
+
+void
+YoloLayer::terminate() noexcept
+{
+  // The device parameters go with the last plugin that shares them
+  m_Params.reset();
+  mem_device_free(m_DeviceRoi);
+  m_DeviceRoi = nullptr;
+  m_DeviceRoiBytes = 0;
+  m_RoiIds.clear();
+}
+
 nvinfer1::IPluginV2DynamicExt*
 YoloLayer::clone() const noexcept
 {
-  return new YoloLayer(m_NetWidth, m_NetHeight, m_NumClasses, m_NewCoords, m_YoloTensors, m_OutputSize);
+  YoloLayer* plugin = new YoloLayer(m_NetWidth, m_NetHeight, m_NumClasses, m_NewCoords, m_YoloTensors, m_OutputSize,
+      m_ObjectnessGate, m_OutputHalf != 0, m_MaxDetections, m_CompactThreshold);
+  plugin->setPluginNamespace(m_Namespace.c_str());
+  plugin->m_RoiInWorkspace = m_RoiInWorkspace;
+  plugin->m_MultiProcessors = m_MultiProcessors;
+  if (m_Params) {
+    plugin->m_Params = m_Params;
+  }
+  return plugin;
 }
 
 size_t
@@ -132,6 +259,12 @@ YoloLayer::getSerializationSize() const noexcept
     totalSize += sizeof(uint) + sizeof(curYoloTensor.mask[0]) * curYoloTensor.mask.size();
   }
 
+  totalSize += sizeof(m_ObjectnessGate);
+  totalSize += sizeof(m_RoiInWorkspace);
+  totalSize += sizeof(m_OutputHalf);
+  totalSize += sizeof(m_MaxDetections);
+  totalSize += sizeof(m_CompactThreshold);
+
   return totalSize;
 }
 
@@ -155,26 +288,27 @@ YoloLayer::serialize(void* buffer) const noexcept
     write(d, curYoloTensor.numBBoxes);
     write(d, curYoloTensor.scaleXY);
 
-    uint anchorsSize = curYoloTensor.anchors.size();
-    write(d, anchorsSize);
-    for (uint j = 0; j < anchorsSize; ++j) {
-      write(d, curYoloTensor.anchors[j]);
-    }
-
-    uint maskSize = curYoloTensor.mask.size();
-    write(d, maskSize);
-    for (uint j = 0; j < maskSize; ++j) {
-      write(d, curYoloTensor.mask[j]);
-    }
+    writeArray(d, curYoloTensor.anchors);
+    writeArray(d, curYoloTensor.mask);
   }
+
+  write(d, m_ObjectnessGate);
+  write(d, m_RoiInWorkspace);
+  write(d, m_OutputHalf);
+  write(d, m_MaxDetections);
+  write(d, m_CompactThreshold);
 }
 
 nvinfer1::DimsExprs
 YoloLayer::getOutputDimensions(INT index, const nvinfer1::DimsExprs* inputs, INT nbInputDims,
     nvinfer1::IExprBuilder& exprBuilder)noexcept
 {
-  assert(index < 1);
-  return nvinfer1::DimsExprs{3, {inputs->d[0], exprBuilder.constant(static_cast<int>(m_OutputSize)),
+  assert(index < getNbOutputs());
+  if (index == 1) {
+    return nvinfer1::DimsExprs{2, {inputs->d[0], exprBuilder.constant(1)}};
+  }
+  const uint64_t rows = m_MaxDetections > 0 ? m_MaxDetections : m_OutputSize;
+  return nvinfer1::DimsExprs{3, {inputs->d[0], exprBuilder.constant(static_cast<int>(rows)),
       exprBuilder.constant(6)}};
 }
 
@@ -182,14 +316,57 @@ bool
 YoloLayer::supportsFormatCombination(INT pos, const nvinfer1::PluginTensorDesc* inOut, INT nbInputs, INT nbOutputs)
     noexcept
 {
-  return inOut[pos].format == nvinfer1::TensorFormat::kLINEAR && inOut[pos].type == nvinfer1::DataType::kFLOAT;
+  const nvinfer1::PluginTensorDesc& desc = inOut[pos];
+  if (desc.format != nvinfer1::TensorFormat::kLINEAR) {
+    return false;
+  }
+  if (pos > nbInputs) {
+    return desc.type == nvinfer1::DataType::kINT32;
+  }
+  if (pos == nbInputs) {
+    return desc.type == (m_OutputHalf ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kFLOAT);
+  }
+  // The fused kernel reads the heads in their own precision, but all of them in the same one
+  if (pos > 0) {
+    return desc.type == inOut[0].type;
+  }
+  if (m_YoloTensors.size() > static_cast<size_t>(kYoloMaxHeads)) {
+    return desc.type == nvinfer1::DataType::kFLOAT;
+  }
+  return desc.type == nvinfer1::DataType::kFLOAT || desc.type == nvinfer1::DataType::kHALF ||
+      desc.type == nvinfer1::DataType::kINT8;
+}
+
+size_t
+YoloLayer::roiCellsPerBatch() const
+{
+  size_t perBatch = 0;
+  for (const TensorInfo& t : m_YoloTensors) {
+    perBatch += t.gridSizeX * t.gridSizeY;
+  }
+  return perBatch;
+}
+
+size_t
+YoloLayer::getWorkspaceSize(const nvinfer1::PluginTensorDesc* inputs, INT nbInputs,
+    const nvinfer1::PluginTensorDesc* outputs, INT nbOutputs) const noexcept
+{
+  // Room for the ROI cells of a full batch; the fused path is the only one that gates on them
+  if (!m_RoiInWorkspace || m_YoloTensors.size() > static_cast<size_t>(kYoloMaxHeads)) {
+    return 0;
+  }
+  const int maxBatch = nbInputs > 0 && inputs[0].dims.nbDims > 0 ? inputs[0].dims.d[0] : 1;
+  return roiCellsPerBatch() * std::max(1, maxBatch);
 }
 
 nvinfer1::DataType
 YoloLayer::getOutputDataType(INT index, const nvinfer1::DataType* inputTypes, INT nbInputs) const noexcept
 {
-  assert(index < 1);
-  return nvinfer1::DataType::kFLOAT;
+  assert(index < getNbOutputs());
+  if (index == 1) {
+    return nvinfer1::DataType::kINT32;
+  }
+  return m_OutputHalf ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kFLOAT;
 }
 
 void
@@ -201,40 +378,170 @@ YoloLayer::configurePlugin(const nvinfer1::DynamicPluginTensorDesc* in, INT nbIn
   assert(in->desc.dims.d != nullptr);
 }
 
+YoloLayerParams
+YoloLayer::fusedParams() const
+{
+  YoloLayerParams params {};
+  if (m_YoloTensors.size() > static_cast<size_t>(kYoloMaxHeads)) {
+    return params;
+  }
+  params.numHeads = m_YoloTensors.size();
+  params.netWidth = m_NetWidth;
+  params.netHeight = m_NetHeight;
+  params.numClasses = m_NumClasses;
+  params.objectnessGate = -INFINITY;
+  params.objectnessLogit = -INFINITY;
+  // Score = class probability * objectness, so a compact row never has objectness below the compact threshold
+  const float gate = m_MaxDetections > 0 ? std::max(m_ObjectnessGate, m_CompactThreshold) : m_ObjectnessGate;
+  if (gate > 0.0f) {
+    params.objectnessGate = gate;
+    params.objectnessLogit = gate < 1.0f ? std::log(gate / (1.0f - gate)) : INFINITY;
+  }
+
+  for (uint i = 0; i < params.numHeads; ++i) {
+    const TensorInfo& curYoloTensor = m_YoloTensors.at(i);
+    YoloHeadParams& head = params.heads[i];
+    const uint numCells = curYoloTensor.numBBoxes * curYoloTensor.gridSizeY * curYoloTensor.gridSizeX;
+
+    head.inputSize = (uint64_t) numCells * (4 + 1 + m_NumClasses);
+    head.threadStart = params.threadsPerBatch;
+    head.gridSizeX = curYoloTensor.gridSizeX;
+    head.gridSizeY = curYoloTensor.gridSizeY;
+    head.numBBoxes = curYoloTensor.numBBoxes;
+    head.scaleXY = curYoloTensor.scaleXY;
+    head.roiStart = params.roiPerBatch;
+    params.roiPerBatch += curYoloTensor.gridSizeX * curYoloTensor.gridSizeY;
+    if (curYoloTensor.mask.size() > 0) {
+      head.kind = m_NewCoords ? kYoloHeadNewCoords : kYoloHead;
+    }
+    else {
+      head.kind = kRegionHead;
+    }
+
+    params.threadsPerBatch += numCells;
+  }
+  assert(params.threadsPerBatch == m_OutputSize);
+
+  return params;
+}
+
+const uint8_t*
+YoloLayer::updateRoi(int batchSize, void* workspace, cudaStream_t stream)
+{
+  if (!roi_any()) {
+    return nullptr;
+  }
+
+  NvDsInferNetworkInfo net {m_NetWidth, m_NetHeight, 3};
+  std::vector<uint64_t> ids(batchSize);
+  bool active = false;
+  for (int b = 0; b < batchSize; ++b) {
+    ids[b] = roi_view(b, net, 0).id;
+    active = active || ids[b] != 0;
+  }
+  if (!active) {
+    return nullptr;
+  }
+
+  const bool changed = ids != m_RoiIds;
+  if (changed) {
+    const size_t perBatch = roiCellsPerBatch();
+    m_HostRoi.resize(perBatch * batchSize);
+    for (int b = 0; b < batchSize; ++b) {
+      uint8_t* out = m_HostRoi.data() + perBatch * b;
+      for (const TensorInfo& t : m_YoloTensors) {
+        roi_fill_grid(b, net, t.gridSizeX, t.gridSizeY, out);
+        out += t.gridSizeX * t.gridSizeY;
+      }
+    }
+    m_RoiIds = ids;
+  }
+
+  // The workspace holds nothing between enqueues, so the cells are copied every time; they are a few KiB and
+  // the copy from pageable memory is staged before it returns
+  uint8_t* device = static_cast<uint8_t*>(workspace);
+  if (!m_RoiInWorkspace) {
+    if (!changed && m_DeviceRoi != nullptr) {
+      return m_DeviceRoi;
+    }
+    if (m_HostRoi.size() > m_DeviceRoiBytes) {
+      mem_device_free(m_DeviceRoi);
+      m_DeviceRoiBytes = 0;
+      if (mem_device_alloc((void**) &m_DeviceRoi, m_HostRoi.size(), kMemPlugin) != cudaSuccess) {
+        m_DeviceRoi = nullptr;
+        m_RoiIds.clear();
+        return nullptr;
+      }
+      m_DeviceRoiBytes = m_HostRoi.size();
+    }
+    device = m_DeviceRoi;
+  }
+  if (device == nullptr ||
+      cudaMemcpyAsync(device, m_HostRoi.data(), m_HostRoi.size(), cudaMemcpyHostToDevice, stream) != cudaSuccess) {
+    m_RoiIds.clear();
+    return nullptr;
+  }
+  return device;
+}
+
 INT
 YoloLayer::enqueue(const nvinfer1::PluginTensorDesc* inputDesc, const nvinfer1::PluginTensorDesc*  outputDesc,
     void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept
 {
+  TraceScope trace("YoloLayer::enqueue", kTraceEnqueue);
+
   INT batchSize = inputDesc[0].dims.d[0];
 
-  uint64_t lastInputSize = 0;
+  if ((!m_Params || !m_Params->ready.load(std::memory_order_acquire)) && initialize() != 0) {
+    return -1;
+  }
+  const YoloLayerDeviceParams& deviceParams = *m_Params;
 
   uint yoloTensorsSize = m_YoloTensors.size();
+
+  if (yoloTensorsSize <= kYoloMaxHeads) {
+    YoloInputType inputType = kYoloInputFloat;
+    if (inputDesc[0].type == nvinfer1::DataType::kHALF) {
+      inputType = kYoloInputHalf;
+    }
+    else if (inputDesc[0].type == nvinfer1::DataType::kINT8) {
+      inputType = kYoloInputInt8;
+    }
+
+    YoloLayerParams params = deviceParams.fused;
+    params.roi = updateRoi(batchSize, workspace, stream);
+    for (uint i = 0; i < yoloTensorsSize; ++i) {
+      params.heads[i].input = inputs[i];
+      params.heads[i].scale = inputDesc[i].scale != 0.0f ? inputDesc[i].scale : 1.0f / 128.0f;
+    }
+
+    if (m_MaxDetections > 0) {
+      CUDA_CHECK(cudaYoloLayerCompact(params, inputType, outputs[0], static_cast<int*>(outputs[1]), m_OutputHalf != 0,
+          m_MaxDetections, m_CompactThreshold, m_MultiProcessors, batchSize, stream));
+    }
+    else {
+      CUDA_CHECK(cudaYoloLayerFused(params, inputType, outputs[0], m_OutputHalf != 0, batchSize, stream));
+    }
+    return 0;
+  }
+
+  // More heads than one launch can describe: one launch per head and batch element
+  uint64_t lastInputSize = 0;
+
   for (uint i = 0; i < yoloTensorsSize; ++i) {
-    TensorInfo& curYoloTensor = m_YoloTensors.at(i);
+    TraceScope headTrace("YoloLayer::head");
+    const TensorInfo& curYoloTensor = m_YoloTensors.at(i);
 
     const uint numBBoxes = curYoloTensor.numBBoxes;
     const float scaleXY = curYoloTensor.scaleXY;
     const uint gridSizeX = curYoloTensor.gridSizeX;
     const uint gridSizeY = curYoloTensor.gridSizeY;
-    const std::vector<float> anchors = curYoloTensor.anchors;
-    const std::vector<int> mask = curYoloTensor.mask;
-
-    void* d_anchors;
-    void* d_mask;
-    if (anchors.size() > 0) {
-      CUDA_CHECK(cudaMalloc(&d_anchors, sizeof(float) * anchors.size()));
-      CUDA_CHECK(cudaMemcpyAsync(d_anchors, anchors.data(), sizeof(float) * anchors.size(), cudaMemcpyHostToDevice,
-          stream));
-    }
-    if (mask.size() > 0) {
-      CUDA_CHECK(cudaMalloc(&d_mask, sizeof(int) * mask.size()));
-      CUDA_CHECK(cudaMemcpyAsync(d_mask, mask.data(), sizeof(int) * mask.size(), cudaMemcpyHostToDevice, stream));
-    }
+    const void* d_anchors = deviceParams.anchors + deviceParams.anchorOffsets[i];
+    const void* d_mask = deviceParams.mask + deviceParams.maskOffsets[i];
 
     const uint64_t inputSize = (numBBoxes * (4 + 1 + m_NumClasses)) * gridSizeY * gridSizeX;
 
-    if (mask.size() > 0) {
+    if (curYoloTensor.mask.size() > 0) {
       if (m_NewCoords) {
         CUDA_CHECK(cudaYoloLayer_nc(inputs[i], outputs[0], batchSize, inputSize, m_OutputSize, lastInputSize,
             m_NetWidth, m_NetHeight, gridSizeX, gridSizeY, m_NumClasses, numBBoxes, scaleXY, d_anchors, d_mask,
@@ -246,21 +553,8 @@ YoloLayer::enqueue(const nvinfer1::PluginTensorDesc* inputDesc, const nvinfer1::
       }
     }
     else {
-      void* softmax;
-      CUDA_CHECK(cudaMalloc(&softmax, sizeof(float) * inputSize * batchSize));
-      CUDA_CHECK(cudaMemsetAsync((float*)softmax, 0, sizeof(float) * inputSize * batchSize, stream));
-
-      CUDA_CHECK(cudaRegionLayer(inputs[i], softmax, outputs[0], batchSize, inputSize, m_OutputSize, lastInputSize,
+      CUDA_CHECK(cudaRegionLayer(inputs[i], outputs[0], batchSize, inputSize, m_OutputSize, lastInputSize,
           m_NetWidth, m_NetHeight, gridSizeX, gridSizeY, m_NumClasses, numBBoxes, d_anchors, stream));
-
-      CUDA_CHECK(cudaFree(softmax));
-    }
-
-    if (anchors.size() > 0) {
-      CUDA_CHECK(cudaFree(d_anchors));
-    }
-    if (mask.size() > 0) {
-      CUDA_CHECK(cudaFree(d_mask));
     }
 
     lastInputSize += numBBoxes * gridSizeY * gridSizeX;
@@ -26,9 +26,14 @@
 #ifndef __YOLO_PLUGINS__
 #define __YOLO_PLUGINS__
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include <cuda_runtime_api.h>
 
 #include "yolo.h"
+#include "yoloForward_fused.h"
 
 #define CUDA_CHECK(status) {                                                                                           \
   if (status != 0) {                                                                                                   \
@@ -43,18 +48,42 @@ namespace {
   const char* YOLOLAYER_PLUGIN_NAME {"YoloLayer_TRT"};
 } // namespace
 
+// Anchors and masks of every head in device memory, uploaded once and read-only afterwards. clone() hands the
+// same instance to the plugin of every execution context of an engine, so contexts enqueueing on their own
+// streams share one copy and never allocate, free or lock on the enqueue path. fused is the fused kernel's
+// launch block with everything but the per-enqueue inputs, INT8 scales and ROI cells filled in, so an enqueue
+// copies it and patches those.
+struct YoloLayerDeviceParams {
+  ~YoloLayerDeviceParams();
+
+  // First call uploads and completes fused with the device anchors and masks; later calls return its result.
+  // Safe from several contexts at once.
+  bool upload(const std::vector<TensorInfo>& yoloTensors, const YoloLayerParams& launch);
+
+  std::atomic<bool> ready {false};
+  std::mutex mutex;
+  float* anchors {nullptr};
+  int* mask {nullptr};
+  std::vector<size_t> anchorOffsets;
+  std::vector<size_t> maskOffsets;
+  YoloLayerParams fused {};
+};
+
 class YoloLayer : public nvinfer1::IPluginV2DynamicExt {
   public:
     YoloLayer(const void* data, size_t length);
 
     YoloLayer(const uint& netWidth, const uint& netHeight, const uint& numClasses, const uint& newCoords,
-        const std::vector<TensorInfo>& yoloTensors, const uint64_t& outputSize);
+        const std::vector<TensorInfo>& yoloTensors, const uint64_t& outputSize, const float& objectnessGate = 0.0f,
+        const bool& outputHalf = false, const uint& maxDetections = 0, const float& compactThreshold = 0.0f);
+
+    ~YoloLayer() override;
 
     nvinfer1::IPluginV2DynamicExt* clone() const noexcept override;
 
-    int initialize() noexcept override { return 0; }
+    int initialize() noexcept override;
 
-    void terminate() noexcept override {}
+    void terminate() noexcept override;
 
     void destroy() noexcept override { delete this; }
 
@@ -62,13 +91,13 @@ class YoloLayer : public nvinfer1::IPluginV2DynamicExt {
 
     void serialize(void* buffer) const noexcept override;
 
-    int getNbOutputs() const noexcept override { return 1; }
+    int getNbOutputs() const noexcept override { return m_MaxDetections > 0 ? 2 : 1; }
 
     nvinfer1::DimsExprs getOutputDimensions(INT index, const nvinfer1::DimsExprs* inputs, INT nbInputDims,
         nvinfer1::IExprBuilder& exprBuilder) noexcept override;
 
     size_t getWorkspaceSize(const nvinfer1::PluginTensorDesc* inputs, INT nbInputs,
-        const nvinfer1::PluginTensorDesc* outputs, INT nbOutputs) const noexcept override { return 0; }
+        const nvinfer1::PluginTensorDesc* outputs, INT nbOutputs) const noexcept override;
 
     bool supportsFormatCombination(INT pos, const nvinfer1::PluginTensorDesc* inOut, INT nbInputs, INT nbOutputs)
         noexcept override;
@@ -96,6 +125,15 @@ class YoloLayer : public nvinfer1::IPluginV2DynamicExt {
         void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept override;
 
   private:
+    // Device ROI cells of the first batchSize slots for the fused kernel, nullptr when none of them has an ROI
+    const uint8_t* updateRoi(int batchSize, void* workspace, cudaStream_t stream);
+
+    // ROI cells of every head for one batch element
+    size_t roiCellsPerBatch() const;
+
+    // Launch-invariant part of the fused kernel's parameters (see YoloLayerDeviceParams::fused)
+    YoloLayerParams fusedParams() const;
+
     std::string m_Namespace {""};
     uint m_NetWidth {0};
     uint m_NetHeight {0};
@@ -103,6 +141,33 @@ class YoloLayer : public nvinfer1::IPluginV2DynamicExt {
     uint m_NewCoords {0};
     std::vector<TensorInfo> m_YoloTensors;
     uint64_t m_OutputSize {0};
+    // Anchors below this objectness are dropped in the kernel (0 = off). Serialized last, so engines built before
+    // it existed still deserialize
+    float m_ObjectnessGate {0.0f};
+    // 1 when the engine reserved plugin workspace for the ROI cells (getWorkspaceSize). Serialized after the gate;
+    // plans built before it keep their ROI in a per-context device buffer
+    uint32_t m_RoiInWorkspace {0};
+    // 1 when the [B, N, 6] output is FP16 (YOLO_OUTPUT_FP16). Fused path only, so never set on engines with more
+    // than kYoloMaxHeads heads. Serialized after m_RoiInWorkspace; older plans have FP32 output
+    uint32_t m_OutputHalf {0};
+    // Compact output (YOLO_OUTPUT_COMPACT): up to m_MaxDetections rows scoring >= m_CompactThreshold per batch
+    // element, plus a [B, 1] INT32 count as a second output; 0 = the dense [B, m_OutputSize, 6] output. Fused
+    // path only, like m_OutputHalf, and serialized after it
+    uint32_t m_MaxDetections {0};
+    float m_CompactThreshold {0.0f};
+    // SM count of the device, read in initialize() for the compact kernel's grid; not serialized
+    int m_MultiProcessors {0};
+
+    // Shared by the clones of every execution context (see YoloLayerDeviceParams)
+    std::shared_ptr<YoloLayerDeviceParams> m_Params;
+
+    // ROI cells of every head per batch element; rebuilt on the host when a slot's ROI or geometry changes and
+    // copied into the workspace at every enqueue. Only the fused path gates on it; engines with more than
+    // kYoloMaxHeads heads leave it to the parser. Per context, like the enqueue calls that use it
+    std::vector<uint8_t> m_HostRoi;
+    std::vector<uint64_t> m_RoiIds;
+    uint8_t* m_DeviceRoi {nullptr};
+    size_t m_DeviceRoiBytes {0};
 };
 
 class YoloLayerPluginCreator : public nvinfer1::IPluginCreator {
@@ -2,11 +2,11 @@
 // DeepStream nvinfer postprocessor for Ultralytics YOLO11-OBB / YOLOv8-OBB
 // Decodes one output tensor shaped [N, D] where D = 5 + 1 + nc  (cx,cy,w,h,theta, obj, class_scores...)
 // Some exports place 'obj' before theta: [cx,cy,w,h,obj,theta, class_scores...].
-// This parser supports BOTH layouts via a small runtime check.
+// This parser supports BOTH layouts; which one an engine uses is settled once (see obb_layout.h).
 //
-// It returns axis-aligned boxes to DeepStream (so you get immediate OSD),
-// and (optionally) attaches the 5-tuple OBB (cx,cy,w,h,theta) as user meta for a
-// later overlay step if you want true rotated drawing.
+// It returns axis-aligned boxes to DeepStream (so you get immediate OSD), and
+// publishes the full (cx,cy,w,h,theta,conf,cls) rows of every frame to the OBB
+// ring (NvDsInferObbAcquire*, obb_cache.h) for rotated drawing and analysis.
 //
 // Exports two common symbol names:
 //   NvDsInferParseYoloV8OBB
@@ -24,6 +24,16 @@
 #include "nvdsinfer_custom_impl.h"
 #include "nvdsinfer.h"
 
+#include "obb_cache.h"
+#include "obb_layout.h"
+#include "obb_nms.h"
+#include "parser_context.h"
+#include "parser_pool.h"
+#include "parser_stats.h"
+#include "parser_trace.h"
+#include "roi_mask.h"
+#include "tensor_record.h"
+
 static inline float clampf(float v, float lo, float hi) {
     return std::min(std::max(v, lo), hi);
 }
@@ -34,145 +44,202 @@ struct OBBDet {
     int   cls;
 };
 
-// IoU on AABB for NMS (fast + compatible with DS OSD)
-static inline float iou_aabb(const OBBDet& a, const OBBDet& b) {
-    float ax1 = a.cx - a.w*0.5f, ay1 = a.cy - a.h*0.5f;
-    float ax2 = a.cx + a.w*0.5f, ay2 = a.cy + a.h*0.5f;
-    float bx1 = b.cx - b.w*0.5f, by1 = b.cy - b.h*0.5f;
-    float bx2 = b.cx + b.w*0.5f, by2 = b.cy + b.h*0.5f;
-    float xx1 = std::max(ax1, bx1), yy1 = std::max(ay1, by1);
-    float xx2 = std::min(ax2, bx2), yy2 = std::min(ay2, by2);
-    float w = std::max(0.0f, xx2 - xx1), h = std::max(0.0f, yy2 - yy1);
-    float inter = w*h;
-    float areaA = std::max(0.0f, ax2-ax1) * std::max(0.0f, ay2-ay1);
-    float areaB = std::max(0.0f, bx2-bx1) * std::max(0.0f, by2-by1);
-    float uni = areaA + areaB - inter + 1e-6f;
-    return inter / uni;
+// nvinfer's per-class pre-cluster thresholds and the library's NMS IoU, as in the pose parser.
+struct ObbThresholds {
+    const float* cls{nullptr};
+    int num_cls{0};
+    float min{0.25f};
+    float iou{kParserDefaultNmsIou};
+
+    float of(int c) const { return num_cls == 0 ? min : cls[c < num_cls ? c : 0]; }
+};
+
+static ObbThresholds obb_thresholds(const NvDsInferParseDetectionParams& params, float fallback = 0.25f) {
+    ObbThresholds t;
+    const std::vector<float>& thr = params.perClassPreclusterThreshold;
+    t.cls = thr.data();
+    t.num_cls = static_cast<int>(thr.size());
+    t.min = thr.empty() ? fallback : *std::min_element(thr.begin(), thr.end());
+    t.iou = parser_nms_iou();
+    return t;
 }
 
-// Try to decode one vector [D] into OBBDet.
-// Supports TWO common layouts:
-//  L0: [cx,cy,w,h,theta, obj, cls...]   (Ultralytics typical)
-//  L1: [cx,cy,w,h, obj, theta, cls...]  (some exports)
-// Returns false if conf below threshold or dims invalid.
-static bool decode_one(const float* p, int D, int nc, float inW, float inH,
-                       float conf_thr, OBBDet& out) {
-    if (D < 6 + nc) return false;
-    float cx = p[0], cy = p[1], w = p[2], h = p[3];
-    // Decide where obj/theta live:
-    // Heuristic: theta should be in ~[-pi, pi], obj in [0,1].
-    float cand_theta0 = p[4];
-    float cand_obj0   = p[5];
-    float cand_obj1   = p[4];
-    float cand_theta1 = p[5];
-
-    bool layout0 = (std::fabs(cand_theta0) <= 3.5f) && (cand_obj0 >= 0.f && cand_obj0 <= 1.0001f);
-    bool layout1 = (std::fabs(cand_theta1) <= 3.5f) && (cand_obj1 >= 0.f && cand_obj1 <= 1.0001f);
-
-    float theta = 0.f, obj = 0.f;
-    int cls_offset = 0;
-    if (layout0 && !layout1) {
-        theta = cand_theta0; obj = cand_obj0; cls_offset = 6;
-    } else if (layout1 && !layout0) {
-        obj = cand_obj1; theta = cand_theta1; cls_offset = 6;
-    } else {
-        // fallback: assume Ultralytics (theta at [4], obj at [5])
-        theta = cand_theta0; obj = cand_obj0; cls_offset = 6;
+// Decodes the rows [first, last) of one [N, D] frame above their class threshold into dets, specialized on the
+// probed channel order (ObjFirst: [cx,cy,w,h, obj, theta, cls...]) and on single-class heads, so the row loop has
+// no layout branches. Rows are rejected on the lowest class threshold before the class scores are read.
+template <bool ObjFirst, bool SingleClass>
+static void scan_obb(const float* data, const ObbLayout& lay, const RoiView& roi, float inW, float inH,
+                     const ObbThresholds& thr, int first, int last, std::vector<OBBDet>& dets) {
+    const int D = lay.dim;
+    for (int i=first; i<last; ++i) {
+        if (roi.anchor_outside(i)) continue;
+        const float* p = data + static_cast<size_t>(i)*D;
+        const float obj = ObjFirst ? p[4] : p[5];
+        if (obj < thr.min) continue;
+
+        // class picking
+        int bestId = 0; float bestSc = 1.f;
+        if (!SingleClass) {
+            bestSc = 0.f;
+            for (int c=0; c<lay.nc; ++c) {
+                float sc = p[6 + c];
+                if (sc > bestSc) { bestSc = sc; bestId = c; }
+            }
+        }
+        const float conf = obj * bestSc;
+        if (conf < thr.of(bestId)) continue;
+        if (roi.center_outside(p[0], p[1], p[0], p[1])) continue;
+
+        // clamp to input dims (engine input coordinates)
+        OBBDet d{};
+        d.cx = clampf(p[0], 0.f, inW - 1.f);
+        d.cy = clampf(p[1], 0.f, inH - 1.f);
+        d.w  = std::max(0.f, std::min(std::fabs(p[2]), inW));
+        d.h  = std::max(0.f, std::min(std::fabs(p[3]), inH));
+        d.theta = ObjFirst ? p[5] : p[4];    // radians (expected)
+        d.conf  = conf;
+        d.cls   = bestId;
+        dets.emplace_back(d);
     }
+}
 
-    if (obj < conf_thr) return false;
+typedef void (*ScanObbFn)(const float*, const ObbLayout&, const RoiView&, float, float, const ObbThresholds&, int,
+                          int, std::vector<OBBDet>&);
 
-    // class picking
-    int bestId = 0; float bestSc = 1.f;
-    if (nc > 1) {
-        bestSc = 0.f;
-        for (int c=0; c<nc; ++c) {
-            float sc = p[cls_offset + c];
-            if (sc > bestSc) { bestSc = sc; bestId = c; }
-        }
+// Indexed [obj_first][single_class].
+static const ScanObbFn kScanObb[2][2] = {
+    {scan_obb<false, false>, scan_obb<false, true>},
+    {scan_obb<true, false>, scan_obb<true, true>},
+};
+
+// Large frames are scanned in anchor chunks on the pool (decode_chunks); the chunks' detections are appended
+// in chunk order, so dets matches the single pass.
+static void scan_frame(const float* data, const ObbLayout& lay, bool objFirst, const RoiView& roi, float inW,
+                       float inH, const ObbThresholds& thr, std::vector<OBBDet>& dets) {
+    const ScanObbFn scan = kScanObb[objFirst][lay.nc <= 1];
+    const int n = lay.num_preds;
+    const int chunks = decode_chunks(n);
+    if (chunks <= 1) {
+        scan(data, lay, roi, inW, inH, thr, 0, n, dets);
+        return;
     }
-    float conf = obj * bestSc;
-    if (conf < conf_thr) return false;
-
-    // clamp to input dims (engine input coordinates)
-    OBBDet d{};
-    d.cx = clampf(cx, 0.f, inW - 1.f);
-    d.cy = clampf(cy, 0.f, inH - 1.f);
-    d.w  = std::max(0.f, std::min(std::fabs(w), inW));
-    d.h  = std::max(0.f, std::min(std::fabs(h), inH));
-    d.theta = theta;    // radians (expected)
-    d.conf  = conf;
-    d.cls   = bestId;
-    out = d;
-    return true;
+    thread_local std::vector<std::vector<OBBDet>> parts;
+    if (parts.size() < static_cast<size_t>(chunks)) {
+        parts.resize(chunks);
+        parser_stats_add(kStatAllocations, 1);
+    }
+    const int len = (n + chunks - 1) / chunks;
+    parallel_for(chunks, [&](int c) {
+        const int first = std::min(n, c * len), last = std::min(n, first + len);
+        parts[c].clear();
+        scan(data, lay, roi, inW, inH, thr, first, last, parts[c]);
+    });
+    for (int c = 0; c < chunks; ++c) dets.insert(dets.end(), parts[c].begin(), parts[c].end());
 }
 
 // dim = 5 (cx,cy,w,h,theta) + 1 (obj) + nc
 static bool decode_all(const NvDsInferLayerInfo& L,
                        const NvDsInferNetworkInfo& net,
-                       std::vector<OBBDet>& out,
-                       float conf_thr = 0.25f, float iou_thr = 0.45f) {
+                       const FrameTag& tag,
+                       const ObbThresholds& thr,
+                       std::vector<OBBDet>& out) {
     if (!L.buffer) return false;
     const float* data = static_cast<const float*>(L.buffer);
 
-    int N=0, D=0;
-    if (L.inferDims.numDims == 2) { N = L.inferDims.d[0]; D = L.inferDims.d[1]; }
-    else if (L.inferDims.numDims == 3) { N = L.inferDims.d[1]; D = L.inferDims.d[2]; }
-    else return false;
-
-    // infer nc from D
-    int nc = D - 6;  // assume [5 obb + 1 obj] + nc
-    if (nc < 1) nc = 1;  // guard
+    ObbLayout& lay = obb_layout(L.inferDims);
+    if (!lay.valid) return false;
 
     const float inW = static_cast<float>(net.width);
     const float inH = static_cast<float>(net.height);
 
-    std::vector<OBBDet> dets; dets.reserve(N);
-    for (int i=0; i<N; ++i) {
-        const float* p = data + i*D;
-        OBBDet d;
-        if (decode_one(p, D, nc, inW, inH, conf_thr, d)) {
-            dets.emplace_back(d);
-        }
+    std::vector<OBBDet> dets; dets.reserve(lay.num_preds);
+    const bool objFirst = resolve_obb_order(lay, data) == kObbObjTheta;
+    scan_frame(data, lay, objFirst, roi_view(tag.batch_slot, net, lay.num_preds), inW, inH, thr, dets);
+
+    TraceScope nmsTrace("obb_nms", kTraceNms);
+    const size_t passed = dets.size();
+
+    // Top-K first: the sort and the NMS only ever see topk candidates.
+    auto better = [](const OBBDet&a,const OBBDet&b){return a.conf>b.conf;};
+    const int topk = parser_topk();
+    if (topk > 0 && dets.size() > static_cast<size_t>(topk)) {
+        std::nth_element(dets.begin(), dets.begin() + topk, dets.end(), better);
+        dets.resize(topk);
     }
+    std::sort(dets.begin(), dets.end(), better);
 
-    // NMS on AABB
-    std::sort(dets.begin(), dets.end(), [](const OBBDet&a,const OBBDet&b){return a.conf>b.conf;});
-    std::vector<char> rem(dets.size(),0); std::vector<OBBDet> keep; keep.reserve(dets.size());
-    for (size_t i=0;i<dets.size();++i) {
-        if (rem[i]) continue; keep.push_back(dets[i]);
-        for (size_t j=i+1;j<dets.size();++j) if (!rem[j] && iou_aabb(dets[i], dets[j])>iou_thr) rem[j]=1;
+    // Rotated NMS (probiou): elongated neighbours at an angle no longer suppress each other through
+    // their overlapping axis-aligned boxes.
+    const int n = static_cast<int>(dets.size());
+    std::vector<ObbGauss> g(n);
+    for (int i=0; i<n; ++i) g[i] = obb_gauss(dets[i].cx, dets[i].cy, dets[i].w, dets[i].h, dets[i].theta);
+    // Class-aware NMS of a multi-class head stays on the CPU, the GPU mask is class-agnostic.
+    std::vector<int> cls;
+    if (parser_nms_class_aware() && lay.nc > 1) {
+        cls.resize(n);
+        for (int i=0; i<n; ++i) cls[i] = dets[i].cls;
     }
-    out.swap(keep);
+    std::vector<int> kept(n);
+    int numKept = n >= obb_nms_cuda_min(thr.iou) && cls.empty() ?
+        obb_nms_cuda(g.data(), n, thr.iou, tag.batch_slot, kept.data()) : -1;
+    if (numKept < 0) numKept = obb_nms(g.data(), cls.empty() ? nullptr : cls.data(), n, thr.iou, kept.data());
+
+    out.clear(); out.reserve(numKept);
+    for (int k=0; k<numKept; ++k) out.push_back(dets[kept[k]]);
+    parser_stats_frame(lay.num_preds, passed, numKept);
     return true;
 }
 
+// Publishes the rotated boxes to the OBB ring (obb_cache.h), which is how theta reaches consumers: the
+// objects handed back to nvinfer only carry the unrotated w x h box about the centre. Rows are mapped to the
+// source frame when its size is known; the letterbox is a uniform scale, so theta is unchanged.
+static void publish_obb_frame(const std::vector<OBBDet>& dets, const FrameTag& tag, const NvDsInferNetworkInfo& net) {
+    TraceScope trace("obb_cache_update", kTraceCache);
+    thread_local std::vector<float> rows;
+    const LetterboxGeom& g = letterbox_geom(tag.batch_slot, net);
+    const int n = std::min(static_cast<int>(dets.size()), kObbMaxDets);
+    rows.resize(static_cast<size_t>(n) * kObbValuesPerDet);
+    for (int i=0; i<n; ++i) {
+        const OBBDet& d = dets[i];
+        float* r = rows.data() + static_cast<size_t>(i) * kObbValuesPerDet;
+        r[0] = d.cx; r[1] = d.cy; r[2] = d.w; r[3] = d.h;
+        if (g.source_coords) {
+            r[0] = clampf((d.cx - g.pad_x) / g.gain, 0.f, g.src_w - 1.f);
+            r[1] = clampf((d.cy - g.pad_y) / g.gain, 0.f, g.src_h - 1.f);
+            r[2] = d.w / g.gain; r[3] = d.h / g.gain;
+        }
+        r[4] = d.theta; r[5] = d.conf; r[6] = static_cast<float>(d.cls);
+    }
+    publish_obb_rows(rows.data(), n, tag, g.source_coords ? kObbFrameSourceCoords : 0);
+}
+
 static bool parse_obb_internal(const std::vector<NvDsInferLayerInfo>& layers,
                                const NvDsInferNetworkInfo& net,
-                               const NvDsInferParseDetectionParams& /*params*/,
+                               const NvDsInferParseDetectionParams& params,
                                std::vector<NvDsInferObjectDetectionInfo>& objects)
 {
+    TraceScope trace("parse_obb", kTraceParse);
     if (layers.empty()) return false;
     const NvDsInferLayerInfo* L = &layers[0];
     for (auto& li: layers) if (li.dataType == NvDsInferDataType::FLOAT) { L=&li; break; }
 
+    const FrameTag tag = tag_frame(*L);
     std::vector<OBBDet> dets;
-    if (!decode_all(*L, net, dets)) return false;
+    if (!decode_all(*L, net, tag, obb_thresholds(params), dets)) return false;
 
     objects.clear(); objects.reserve(dets.size());
     for (const auto& d : dets) {
         NvDsInferObjectDetectionInfo o{};
         o.classId = d.cls;
         o.detectionConfidence = d.conf;
-        // Convert to AABB for DS box drawing now
+        // The box before rotation, for DS box drawing; theta only travels in the OBB ring
         float x1 = d.cx - d.w*0.5f, y1 = d.cy - d.h*0.5f;
         float w  = std::max(0.f, d.w);
         float h  = std::max(0.f, d.h);
         o.left = x1; o.top = y1; o.width = w; o.height = h;
         objects.emplace_back(o);
-        // NOTE: If you want rotated drawing, we can add user meta here
-        // with (cx,cy,w,h,theta) and consume it in a small OSD adapter.
     }
+    publish_obb_frame(dets, tag, net);
     return true;
 }
 
@@ -182,6 +249,7 @@ extern "C" bool NvDsInferParseYoloV8OBB(
     const NvDsInferParseDetectionParams& params,
     std::vector<NvDsInferObjectDetectionInfo>& objects)
 {
+    parser_record("v8obb", layers, net, params);
     return parse_obb_internal(layers, net, params, objects);
 }
 
@@ -191,6 +259,7 @@ extern "C" bool NvDsInferParseYoloOBB(
     const NvDsInferParseDetectionParams& params,
     std::vector<NvDsInferObjectDetectionInfo>& objects)
 {
+    parser_record("obb", layers, net, params);
     return parse_obb_internal(layers, net, params, objects);
 }
 
@@ -4,408 +4,465 @@
 // Compile into libnvdsinfer_custom_impl_Yolo.so (Makefile edits below).
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
-#include <iomanip>
-#include <iostream>
-#include <mutex>
 #include <vector>
 #include "nvdsinfer_custom_impl.h"
 #include "nvdsinfer.h"
 
-struct PoseDet {
-  float x1,y1,x2,y2, conf; int cls;
-  std::vector<float> kpts; // size 3*kpts: x,y,score (in input-pixel coords)
-};
+#include "parser_log.h"
+#include "parser_pool.h"
+#include "parser_stats.h"
+#include "parser_trace.h"
+#include "pose_arena.h"
+#include "pose_async.h"
+#include "pose_cache.h"
+#include "pose_layout.h"
+#include "pose_oks.h"
+#include "pose_track.h"
+#include "roi_mask.h"
+#include "simd_scan.h"
+#include "tensor_record.h"
+#include "tile_grid.h"
 
 namespace {
 
-struct PoseCache {
-  std::mutex mtx;
-  uint64_t seq{0};
-  int kpts{0};
-  std::vector<float> flat; // [x1,y1,x2,y2,conf, kpts...]
-} g_pose_cache;
-
-constexpr int kBaseValuesPerDet = 5;
-
-void update_pose_cache(const std::vector<PoseDet>& dets, int kpts) {
-  std::lock_guard<std::mutex> lock(g_pose_cache.mtx);
-  g_pose_cache.seq++;
-  g_pose_cache.kpts = kpts;
-  const int stride = kBaseValuesPerDet + 3 * std::max(0, kpts);
-  g_pose_cache.flat.clear();
-  g_pose_cache.flat.reserve(static_cast<size_t>(dets.size()) * stride);
-  for (const auto& d : dets) {
-    g_pose_cache.flat.push_back(d.x1);
-    g_pose_cache.flat.push_back(d.y1);
-    g_pose_cache.flat.push_back(d.x2);
-    g_pose_cache.flat.push_back(d.y2);
-    g_pose_cache.flat.push_back(d.conf);
-    g_pose_cache.flat.insert(g_pose_cache.flat.end(), d.kpts.begin(), d.kpts.end());
-  }
-  std::cout << std::fixed << std::setprecision(4);
-  if (!dets.empty()) {
-    const auto& first = dets.front();
-    float kp0 = first.kpts.empty() ? 0.f : first.kpts[0];
-    std::cout << "[POSE][parser] seq=" << g_pose_cache.seq
-              << " dets=" << dets.size()
-              << " conf=" << first.conf
-              << " kp0=" << kp0 << std::endl;
+void update_pose_cache(PoseArena& arena, const FrameTag& tag, const LetterboxGeom& geom) {
+  TraceScope trace("pose_cache_update", kTraceCache);
+  int32_t flags = geom.source_coords ? kPoseFrameSourceCoords : 0;
+  const float* rows = pose_track_rows(tag, arena, &flags);
+  const uint64_t seq = publish_pose_rows(rows, arena.kept, arena.kpts, tag, flags);
+  if (arena.kept > 0) {
+    const float* first = arena.row(0);
+    PARSER_LOG(kLogDebug, "[POSE][parser] seq=%llu slot=%d dets=%d conf=%.4f kp0=%.4f",
+               static_cast<unsigned long long>(seq), tag.batch_slot, arena.kept, first[4],
+               arena.kpts > 0 ? first[5] : 0.f);
   } else {
-    std::cout << "[POSE][parser] seq=" << g_pose_cache.seq << " dets=0" << std::endl;
+    PARSER_LOG(kLogDebug, "[POSE][parser] seq=%llu slot=%d dets=0",
+               static_cast<unsigned long long>(seq), tag.batch_slot);
   }
 }
 
 } // namespace
 
-extern "C" uint64_t NvDsInferGetPoseCache(float** data, int* count, int* kpts) {
-  std::lock_guard<std::mutex> lock(g_pose_cache.mtx);
-  if (data) {
-    *data = g_pose_cache.flat.empty() ? nullptr : g_pose_cache.flat.data();
-  }
-  if (count) {
-    *count = static_cast<int>(g_pose_cache.flat.size());
-  }
-  if (kpts) {
-    *kpts = g_pose_cache.kpts;
-  }
-  return g_pose_cache.seq;
-}
-
-static inline float iou_xyxy(const PoseDet& a, const PoseDet& b) {
-  float xx1 = std::max(a.x1, b.x1), yy1 = std::max(a.y1, b.y1);
-  float xx2 = std::min(a.x2, b.x2), yy2 = std::min(a.y2, b.y2);
-  float w = std::max(0.f, xx2-xx1), h = std::max(0.f, yy2-yy1);
-  float inter = w*h;
-  float areaA = std::max(0.f, a.x2-a.x1)*std::max(0.f, a.y2-a.y1);
-  float areaB = std::max(0.f, b.x2-b.x1)*std::max(0.f, b.y2-b.y1);
-  return inter / (areaA + areaB - inter + 1e-6f);
+// Undo letterbox padding to map 640x640 net coords back to source frame (e.g., 1440x1080).
+static inline void unletterbox(float& x, float& y, const LetterboxGeom& g) {
+  x = (x - g.pad_x) / g.gain;
+  y = (y - g.pad_y) / g.gain;
+  x = std::min(std::max(x, 0.f), g.src_w - 1.f);
+  y = std::min(std::max(y, 0.f), g.src_h - 1.f);
 }
 
-static inline float env_or_default(const char* name, float fallback) {
-  if (const char* v = std::getenv(name)) {
-    try { return std::stof(v); } catch (...) { return fallback; }
+static inline float class_threshold(const NvDsInferParseDetectionParams& params, int cls, float fallback) {
+  if (cls >= 0 && static_cast<size_t>(cls) < params.perClassPreclusterThreshold.size()) {
+    return params.perClassPreclusterThreshold[cls];
+  }
+  if (!params.perClassPreclusterThreshold.empty()) {
+    return params.perClassPreclusterThreshold[0];
   }
   return fallback;
 }
 
-// Undo letterbox padding to map 640x640 net coords back to source frame (e.g., 1440x1080).
-static inline void unletterbox(float& x, float& y,
-                               float gain, float pad_x, float pad_y,
-                               float src_w, float src_h) {
-  x = (x - pad_x) / gain;
-  y = (y - pad_y) / gain;
-  x = std::min(std::max(x, 0.f), src_w - 1.f);
-  y = std::min(std::max(y, 0.f), src_h - 1.f);
-}
+// Thresholds of one V8 parse call: nvinfer's pre-cluster threshold per class (pre-cluster-threshold and
+// [class-attrs-<id>]), their minimum as the objectness prefilter (conf = obj * class score never exceeds obj),
+// and the NMS IoU, which nvinfer keeps to itself and parser_nms_iou() supplies.
+struct PoseThresholds {
+  const float* cls{nullptr};
+  int num_cls{0};
+  float min{0.25f};
+  float iou{kParserDefaultNmsIou};
 
-static bool decode(const NvDsInferLayerInfo& L,
-                   const NvDsInferNetworkInfo& net,
-                   std::vector<PoseDet>& out,
-                   float conf_thr=0.25f, float iou_thr=0.45f)
-{
-  if (!L.buffer) return false;
-  const float* data = static_cast<const float*>(L.buffer);
+  float of(int c) const { return num_cls == 0 ? min : cls[c < num_cls ? c : 0]; }
+};
 
-  int num_preds = 0, dim = 0;
-  bool channel_major = false;
-  int stride = 0;
-
-  if (L.inferDims.numDims == 2) {
-    int a = L.inferDims.d[0];
-    int b = L.inferDims.d[1];
-    // Common exported shape is [C, N] with C=5+nc+3*kpts, N=anchors.
-    if (a < b) { dim = a; num_preds = b; channel_major = true; stride = num_preds; }
-    else { num_preds = a; dim = b; stride = dim; }
-    std::cout << "[POSE][parser] dims=" << a << "x" << b
-              << " (2D) -> num_preds=" << num_preds << " dim=" << dim
-              << " channel_major=" << (channel_major ? 1 : 0) << std::endl;
-  } else if (L.inferDims.numDims == 3) {
-    // Assume [B, C, N] as exported by Ultralytics pose: C = 5 + nc + 3*kpts, N = anchors.
-    dim = L.inferDims.d[1];
-    num_preds = L.inferDims.d[2];
-    channel_major = true;              // data laid out as channel-major
-    stride = num_preds;                // step between channel values
-    std::cout << "[POSE][parser] dims=" << L.inferDims.d[0] << "x" << dim << "x" << num_preds
-              << " (channel-major) -> num_preds=" << num_preds << " dim=" << dim << std::endl;
-  } else {
-    return false;
-  }
+static PoseThresholds pose_thresholds(const NvDsInferParseDetectionParams& params, float fallback = 0.25f) {
+  PoseThresholds t;
+  const std::vector<float>& thr = params.perClassPreclusterThreshold;
+  t.cls = thr.data();
+  t.num_cls = static_cast<int>(thr.size());
+  t.min = thr.empty() ? fallback : *std::min_element(thr.begin(), thr.end());
+  t.iou = parser_nms_iou();
+  return t;
+}
 
-  if (dim < 5 + 3) return false; // sanity: needs at least obj + 1 kpt triplet
-
-  // Auto-infer (nc, kpts) given dim = 5 + nc + 3*kpts
-  int max_kpts = 50; // guard
-  int nc = 1, kpts = 17;
-  bool inferred=false;
-  int fallback_nc = -1, fallback_k = 0;
-  for (int guess_k=1; guess_k<=max_kpts; ++guess_k) {
-    int rem = dim - 5 - 3*guess_k;
-    if (rem < 0) continue;
-    if (rem == 0) {
-      nc = 0;
-      kpts = guess_k;
-      inferred = true;
-      break;
+// Candidate scan for the V8 head, specialized on the cached layout so the inner loop has no layout branches.
+// ChannelMajor: [C, N] (each channel contiguous) vs [N, C]; Xyxy: box encoding; SingleClass: nc <= 1.
+// Channel-major tensors are prefiltered with a SIMD pass over the objectness channel; only anchors that
+// pass it, and lie inside the slot's ROI, are read across the other channels. Rows are rejected on the lowest
+// class threshold before the class scores are read, then on their own class' threshold.
+// Scans anchors [first, last) only, so a frame can be split into chunks (scan_frame).
+template <bool ChannelMajor, bool Xyxy, bool SingleClass>
+static void scan_v8(const float* data, const PoseLayout& lay, const LetterboxGeom& geom, const RoiView& roi,
+                    const PoseThresholds& thr, int first, int last, PoseArena& arena)
+{
+  const size_t cs = ChannelMajor ? static_cast<size_t>(lay.num_preds) : 1;
+  const int* hits = arena.hits.data();
+  const int m = ChannelMajor ? threshold_indices(data + 4 * cs + first, last - first, thr.min, arena.hits.data())
+                             : last - first;
+  for (int h = 0; h < m; ++h) {
+    const int i = first + (ChannelMajor ? hits[h] : h);
+    if (roi.anchor_outside(i)) continue;
+    const float* p = ChannelMajor ? data + i : data + static_cast<size_t>(i) * lay.dim;
+    const float obj = p[4 * cs];
+    if (!ChannelMajor && obj < thr.min) continue;
+
+    int best_id = 0; float best_sc = 1.f;
+    if (!SingleClass) {
+      best_sc = 0.f;
+      for (int c = 0; c < lay.nc; ++c) { const float sc = p[(5 + c) * cs]; if (sc > best_sc) { best_sc = sc; best_id = c; } }
     }
-    if (fallback_nc < 0) {
-      fallback_nc = rem;
-      fallback_k = guess_k;
+    const float conf = obj * best_sc;
+    if (conf < thr.of(best_id)) continue;
+
+    const float b0 = p[0], b1 = p[cs], b2 = p[2 * cs], b3 = p[3 * cs];
+    float x1, y1, x2, y2;
+    if (Xyxy) {
+      x1 = b0; y1 = b1; x2 = b2; y2 = b3;
+    } else {
+      x1 = b0 - 0.5f*b2; y1 = b1 - 0.5f*b3; x2 = b0 + 0.5f*b2; y2 = b1 + 0.5f*b3;
     }
+    if (roi.center_outside(x1, y1, x2, y2)) continue;
+    PARSER_LOG(kLogTrace, "[POSE][parser] pre-unletterbox box=(%.4f,%.4f)-(%.4f,%.4f)", x1, y1, x2, y2);
+    unletterbox(x1, y1, geom);
+    unletterbox(x2, y2, geom);
+    arena.push(x1, y1, x2, y2, conf, best_id, i);
   }
-  if (!inferred) {
-    if (fallback_nc < 0) return false;
-    nc = fallback_nc;
-    kpts = fallback_k;
-  }
+}
 
-  const float inW = static_cast<float>(net.width);
-  const float inH = static_cast<float>(net.height);
-  // Allow overriding source frame size via env so we can unletterbox correctly.
-  const float src_w = env_or_default("SQUEAKVIEW_SRC_W", inW);
-  const float src_h = env_or_default("SQUEAKVIEW_SRC_H", inH);
-  const float gain  = std::min(inW / src_w, inH / src_h);
-  const float pad_x = 0.5f * (inW - src_w * gain);
-  const float pad_y = 0.5f * (inH - src_h * gain);
-  static bool dbg_geom = false;
-  if (!dbg_geom) {
-    std::cout << "[POSE][parser] geom src=(" << src_w << "x" << src_h << ") net=("
-              << inW << "x" << inH << ") gain=" << gain
-              << " pad=(" << pad_x << "," << pad_y << ")\n";
-    dbg_geom = true;
-  }
+typedef void (*ScanV8Fn)(const float*, const PoseLayout&, const LetterboxGeom&, const RoiView&, const PoseThresholds&,
+                         int, int, PoseArena&);
 
-  std::vector<PoseDet> dets; dets.reserve(num_preds);
-  static bool debug_raw_printed = false;
-  static bool debug_det_printed = false;
+// Indexed [channel_major][xyxy][single_class].
+static const ScanV8Fn kScanV8[2][2][2] = {
+  {{scan_v8<false, false, false>, scan_v8<false, false, true>}, {scan_v8<false, true, false>, scan_v8<false, true, true>}},
+  {{scan_v8<true, false, false>, scan_v8<true, false, true>}, {scan_v8<true, true, false>, scan_v8<true, true, true>}},
+};
 
-  std::vector<float> row(dim);
+// Candidates of one frame into arena, in anchor order. With split, a large frame is scanned in chunks on the
+// pool (decode_chunks) and the chunks' candidates are appended in chunk order, the same order as one pass.
+static void scan_frame(const float* data, const PoseLayout& lay, bool xyxy, const LetterboxGeom& geom,
+                       const RoiView& roi, const PoseThresholds& thr, bool split, PoseArena& arena)
+{
+  const ScanV8Fn scan = kScanV8[lay.channel_major][xyxy][lay.nc <= 1];
+  const int n = lay.num_preds;
+  const int chunks = split ? decode_chunks(n) : 1;
+  if (chunks <= 1) {
+    scan(data, lay, geom, roi, thr, 0, n, arena);
+    return;
+  }
+  std::vector<PoseArena>& parts = pose_chunk_arenas(chunks);
+  const int len = (n + chunks - 1) / chunks;
+  parallel_for(chunks, [&](int c) {
+    const int first = std::min(n, c * len), last = std::min(n, first + len);
+    parts[c].begin(last - first, lay.kpts);
+    scan(data, lay, geom, roi, thr, first, last, parts[c]);
+  });
+  for (int c = 0; c < chunks; ++c) {
+    const PoseArena& p = parts[c];
+    for (int i = 0; i < p.count; ++i) arena.push(p.x1[i], p.y1[i], p.x2[i], p.y2[i], p.score[i], p.cls[i], p.anchor[i]);
+  }
+}
 
-  for (int i=0;i<num_preds;++i) {
-    const float* p = nullptr;
-    if (channel_major) {
-      for (int c=0;c<dim;++c) {
-        row[c] = data[c*stride + i];
-      }
-      p = row.data();
-    } else {
-      p = data + i*dim;
+static void log_first_rows(const float* data, const PoseLayout& lay, const PoseArena& arena) {
+  static std::atomic<bool> debug_raw_printed{false};
+  static std::atomic<bool> debug_det_printed{false};
+  if (!parser_log_enabled(kLogDebug)) return;
+  auto dump = [&](int i, const char* what) {
+    char line[512]; int n = 0;
+    for (int t = 0; t < std::min(lay.dim, 32) && n < static_cast<int>(sizeof(line)) - 16; ++t) {
+      n += std::snprintf(line + n, sizeof(line) - n, t ? ", %.4f" : "%.4f", data[lay.at(i, t)]);
     }
+    PARSER_LOG(kLogDebug, "[POSE][parser] %s: %s", what, line);
+  };
+  if (!debug_raw_printed.exchange(true)) dump(0, "raw row0");
+  if (arena.count > 0 && !debug_det_printed.exchange(true)) dump(arena.anchor[0], "first det row");
+}
 
-    float cx=p[0], cy=p[1], w=p[2], h=p[3], obj=p[4];
-    if (!debug_raw_printed) {
-      std::cout << "[POSE][parser] raw row0: ";
-      for (int t=0; t<std::min(dim, 32); ++t) {
-        std::cout << p[t] << (t+1 < std::min(dim, 32) ? ", " : "");
-      }
-      std::cout << std::endl;
-      debug_raw_printed = true;
+// Keypoints of the ranked candidates src.order[0..ranked) into dst.kx/ky/ks in source coords, for OKS NMS
+// and for the async worker, which can no longer read the tensor.
+static void gather_ranked_kpts(const float* data, const PoseLayout& lay, const LetterboxGeom& geom,
+                               const PoseArena& src, int ranked, PoseArena& dst)
+{
+  dst.reserve_kpts(ranked);
+  for (int r = 0; r < ranked; ++r) {
+    const int a = src.anchor[src.order[r]];
+    for (int j = 0; j < lay.kpts; ++j) {
+      const int ch = lay.kpt_offset + 3 * j;
+      const size_t at = static_cast<size_t>(r) * lay.kpts + j;
+      float kx = data[lay.at(a, ch)], ky = data[lay.at(a, ch + 1)];
+      unletterbox(kx, ky, geom);
+      dst.kx[at] = kx; dst.ky[at] = ky; dst.ks[at] = data[lay.at(a, ch + 2)];
     }
-    if (obj < conf_thr) continue;
+  }
+}
 
-    // class score
-    int bestId = 0; float bestSc = 1.f;
-    if (nc>1) {
-      bestSc = 0.f;
-      for (int c=0;c<nc;++c) { float sc=p[5+c]; if (sc>bestSc){bestSc=sc; bestId=c;} }
-    }
-    float conf = obj * bestSc;
-    if (conf < conf_thr) continue;
-
-    PoseDet d{};
-    d.cls = bestId; d.conf = conf;
-    if (!debug_det_printed) {
-      std::cout << "[POSE][parser] det row center=(" << cx << "," << cy << ") size=(" << w << "," << h
-                << ") obj=" << obj << " bestSc=" << bestSc << " conf=" << conf << std::endl;
-      for (int k=0;k< std::min(kpts,3); ++k) {
-        const float* kp = p + 5 + nc + 3*k;
-        std::cout << "   kp" << k << ": [" << kp[0] << ", " << kp[1] << ", " << kp[2] << "]" << std::endl;
-      }
-      debug_det_printed = true;
-    }
-    // Some exports output xyxy instead of cxcywh. Heuristically detect if width/height look like coords.
-    bool xyxy = (w > inW) || (h > inH) || (cx > inW) || (cy > inH);
-    float x1, y1, x2, y2;
-    if (xyxy) {
-      x1 = cx; y1 = cy; x2 = w; y2 = h;
+static PoseOks ranked_oks(const PoseArena& a) {
+  PoseOks oks;
+  oks.x = a.kx.data(); oks.y = a.ky.data(); oks.score = a.ks.data();
+  oks.inv_8var = pose_oks_weights(a.kpts);
+  oks.kpts = a.kpts;
+  oks.thr = pose_oks_threshold();
+  return oks;
+}
+
+// Worker side of async mode (pose_async.h): NMS over the job's ranked candidates, then the rows from the
+// gathered keypoints, the tracker and the pose cache under the frame's own tag.
+static void finish_async(PoseAsyncJob& job) {
+  TraceScope trace("pose_async_finish");
+  PoseArena& a = job.arena;
+  const int n = a.count;
+  for (int r = 0; r < n; ++r) a.order[r] = r;
+  {
+    TraceScope nmsTrace("pose_nms", kTraceNms);
+    if (job.oks) {
+      const PoseOks oks = ranked_oks(a);
+      pose_arena_nms(a, n, job.iou_thr, &oks);
     } else {
-      x1 = cx - 0.5f*w; y1 = cy - 0.5f*h; x2 = cx + 0.5f*w; y2 = cy + 0.5f*h;
+      pose_arena_nms(a, n, job.iou_thr);
     }
-    d.x1 = x1; d.y1 = y1; d.x2 = x2; d.y2 = y2;
-    if (!debug_det_printed) {
-      std::cout << "[POSE][parser] pre-unletterbox box=(" << x1 << "," << y1 << ")-("
-                << x2 << "," << y2 << ")\n";
-    }
-    unletterbox(d.x1, d.y1, gain, pad_x, pad_y, src_w, src_h);
-    unletterbox(d.x2, d.y2, gain, pad_x, pad_y, src_w, src_h);
-
-    const float* kp = p + 5 + nc;
-    d.kpts.resize(3*kpts);
-    for (int k=0;k<kpts;++k) {
-      float kx=kp[3*k+0], ky=kp[3*k+1], ks=kp[3*k+2];
-      unletterbox(kx, ky, gain, pad_x, pad_y, src_w, src_h);
-      d.kpts[3*k+0]=kx; d.kpts[3*k+1]=ky; d.kpts[3*k+2]=ks;
-    }
-    dets.emplace_back(std::move(d));
   }
-
-  // NMS
-  std::sort(dets.begin(), dets.end(), [](const PoseDet&a,const PoseDet&b){return a.conf>b.conf;});
-  std::vector<char> rem(dets.size(),0); std::vector<PoseDet> keep; keep.reserve(dets.size());
-  for (size_t i=0;i<dets.size();++i) {
-    if (rem[i]) continue;
-    keep.push_back(dets[i]);
-    for (size_t j=i+1;j<dets.size();++j) {
-      if (!rem[j] && iou_xyxy(dets[i],dets[j])>iou_thr) rem[j]=1;
+  a.reserve_rows(a.kept);
+  for (int k = 0; k < a.kept; ++k) {
+    const int c = a.order[k];
+    float* out = a.row(k);
+    out[0] = a.x1[c]; out[1] = a.y1[c]; out[2] = a.x2[c]; out[3] = a.y2[c];
+    out[4] = a.score[c];
+    a.row_cls[k] = a.cls[c];
+    const size_t at = static_cast<size_t>(c) * a.kpts;
+    for (int j = 0; j < a.kpts; ++j) {
+      out[5 + 3 * j + 0] = a.kx[at + j]; out[5 + 3 * j + 1] = a.ky[at + j]; out[5 + 3 * j + 2] = a.ks[at + j];
     }
   }
-  std::cout << "[POSE][parser] preds=" << num_preds << " dim=" << dim
-            << " dets_before_nms=" << dets.size() << " dets_after_nms=" << keep.size()
-            << " channel_major=" << (channel_major ? 1 : 0) << std::endl;
-  update_pose_cache(keep, kpts);
-  out.swap(keep);
-  return true;
+  parser_stats_frame(job.preds, job.candidates, a.kept);
+  update_pose_cache(a, job.tag, job.geom);
 }
 
-static inline float class_threshold(const NvDsInferParseDetectionParams& params, int cls, float fallback) {
-  if (cls >= 0 && static_cast<size_t>(cls) < params.perClassPreclusterThreshold.size()) {
-    return params.perClassPreclusterThreshold[cls];
+// Async mode: hands the ranked candidates to the worker and leaves their boxes in arena as this call's objects,
+// for nvinfer's clustering to dedupe.
+static void defer_frame(const float* data, const PoseLayout& lay, const LetterboxGeom& geom, const FrameTag& tag,
+                        PoseArena& arena, const PoseThresholds& thr, int ranked)
+{
+  PoseAsyncJob* job = pose_async_claim();
+  job->tag = tag;
+  job->geom = geom;
+  job->iou_thr = thr.iou;
+  job->oks = pose_oks_enabled() && lay.kpts > 0;
+  job->preds = lay.num_preds;
+  job->candidates = arena.count;
+  job->finish = finish_async;
+  PoseArena& a = job->arena;
+  a.begin(ranked, lay.kpts);
+  for (int r = 0; r < ranked; ++r) {
+    const int c = arena.order[r];
+    a.push(arena.x1[c], arena.y1[c], arena.x2[c], arena.y2[c], arena.score[c], arena.cls[c], arena.anchor[c]);
   }
-  if (!params.perClassPreclusterThreshold.empty()) {
-    return params.perClassPreclusterThreshold[0];
+  gather_ranked_kpts(data, lay, geom, arena, ranked, a);
+  pose_async_submit(job);
+
+  arena.reserve_rows(ranked);
+  for (int k = 0; k < ranked; ++k) {
+    const int c = arena.order[k];
+    float* out = arena.row(k);
+    out[0] = arena.x1[c]; out[1] = arena.y1[c]; out[2] = arena.x2[c]; out[3] = arena.y2[c];
+    out[4] = arena.score[c];
+    arena.row_cls[k] = arena.cls[c];
   }
-  return fallback;
 }
 
-static bool decode_yolo26_pose(const NvDsInferLayerInfo& L,
-                               const NvDsInferNetworkInfo& net,
-                               const NvDsInferParseDetectionParams& params,
-                               std::vector<PoseDet>& dets,
-                               std::vector<NvDsInferInstanceMaskInfo>& objects,
-                               float conf_thr = 0.25f) {
-  if (!L.buffer) return false;
-  const float* data = static_cast<const float*>(L.buffer);
+// Tiled mode (tile_grid.h): the tile's rows join its source frame. The tile that completes the frame gets the
+// fused rows back in arena, so they also become the objects of this call, and publishes them under the source's
+// slot; the other tiles are left with none.
+static void publish_tile(PoseArena& arena, const FrameTag& tag, const LetterboxGeom& geom, float iou_thr) {
+  thread_local TileFused fused;
+  if (!tile_fuse_add(tag.batch_slot, arena.rows.data(), arena.row_cls.data(), arena.kept, arena.stride, iou_thr,
+                     fused)) {
+    arena.kept = 0;
+    return;
+  }
+  arena.reserve_rows(fused.count);
+  std::copy(fused.rows.begin(), fused.rows.end(), arena.rows.begin());
+  std::copy(fused.cls.begin(), fused.cls.end(), arena.row_cls.begin());
+  FrameTag source = tag;
+  source.batch_slot = fused.source;
+  update_pose_cache(arena, source, geom);
+}
 
-  int num_preds = 0;
-  int stride = 0;
-  bool channel_major = false;
-  auto stride_matches = [](int d) -> bool { return d >= 6 && ((d - 6) % 3 == 0); };
-
-  if (L.inferDims.numDims == 2) {
-    int d0 = L.inferDims.d[0];
-    int d1 = L.inferDims.d[1];
-    if (stride_matches(d1)) {
-      num_preds = d0;
-      stride = d1;
-      channel_major = false;
-    } else if (stride_matches(d0)) {
-      num_preds = d1;
-      stride = d0;
-      channel_major = true;
+// Decodes one batch entry of the V8 head into arena and publishes it to the pose cache under tag. split: the
+// anchor scan may use the pool (not from inside the batch's parallel_for).
+static void decode_frame(const float* data, const PoseLayout& lay, bool xyxy, const NvDsInferNetworkInfo& net,
+                         const LetterboxGeom& geom, const FrameTag& tag, PoseArena& arena,
+                         const PoseThresholds& thr, bool split)
+{
+  TraceScope trace("pose_decode_frame");
+  arena.begin(lay.num_preds, lay.kpts);
+  const RoiView roi = roi_view(tag.batch_slot, net, lay.num_preds);
+  scan_frame(data, lay, xyxy, geom, roi, thr, split, arena);
+  log_first_rows(data, lay, arena);
+
+  // NMS on indices; keypoints are only decoded for the survivors, and for the top-K ahead of OKS NMS.
+  const int before_nms = arena.count;
+  if (pose_async_enabled() && !tile_spec().active()) {
+    defer_frame(data, lay, geom, tag, arena, thr, pose_arena_rank(arena, parser_topk()));
+    return;
+  }
+  {
+    TraceScope nmsTrace("pose_nms", kTraceNms);
+    const int ranked = pose_arena_rank(arena, parser_topk());
+    if (pose_oks_enabled() && lay.kpts > 0) {
+      gather_ranked_kpts(data, lay, geom, arena, ranked, arena);
+      const PoseOks oks = ranked_oks(arena);
+      pose_arena_nms(arena, ranked, thr.iou, &oks);
     } else {
-      std::cout << "[POSE][yolo26] invalid dims=" << d0 << "x" << d1 << " (2D)" << std::endl;
-      return false;
+      pose_arena_nms(arena, ranked, thr.iou);
     }
-  } else if (L.inferDims.numDims == 3) {
-    int d0 = L.inferDims.d[0];
-    int d1 = L.inferDims.d[1];
-    int d2 = L.inferDims.d[2];
-    (void)d0;
-    if (stride_matches(d2)) {
-      num_preds = d1;
-      stride = d2;
-      channel_major = false;  // [B, N, stride]
-    } else if (stride_matches(d1)) {
-      num_preds = d2;
-      stride = d1;
-      channel_major = true;   // [B, stride, N]
-    } else {
-      std::cout << "[POSE][yolo26] invalid dims=" << d0 << "x" << d1 << "x" << d2 << " (3D)" << std::endl;
-      return false;
+  }
+  arena.reserve_rows(arena.kept);
+  for (int k = 0; k < arena.kept; ++k) {
+    const int c = arena.order[k];
+    const int a = arena.anchor[c];
+    float* out = arena.row(k);
+    out[0] = arena.x1[c]; out[1] = arena.y1[c]; out[2] = arena.x2[c]; out[3] = arena.y2[c];
+    out[4] = arena.score[c];
+    arena.row_cls[k] = arena.cls[c];
+    for (int j = 0; j < lay.kpts; ++j) {
+      const int ch = lay.kpt_offset + 3 * j;
+      float kx = data[lay.at(a, ch)], ky = data[lay.at(a, ch + 1)];
+      unletterbox(kx, ky, geom);
+      out[5 + 3 * j + 0] = kx; out[5 + 3 * j + 1] = ky; out[5 + 3 * j + 2] = data[lay.at(a, ch + 2)];
     }
-  } else {
-    return false;
   }
+  PARSER_LOG_EVERY_MS(kLogInfo, 1000, "[POSE][parser] preds=%d dim=%d dets_before_nms=%d dets_after_nms=%d channel_major=%d",
+                      lay.num_preds, lay.dim, before_nms, arena.kept, lay.channel_major ? 1 : 0);
+  parser_stats_frame(lay.num_preds, before_nms, arena.kept);
+  if (tile_spec().active()) {
+    publish_tile(arena, tag, geom, thr.iou);
+    return;
+  }
+  update_pose_cache(arena, tag, geom);
+}
+
+// Decodes every batch entry of L. Entry 0 lands in arena (it feeds the objects returned to nvinfer);
+// entries 1..B-1 of a multi-frame [B, C, N] tensor are decoded in parallel into their own arenas and
+// only reach the pose cache, under the slots given by batch_entry_tag().
+static bool decode(const NvDsInferLayerInfo& L,
+                   const NvDsInferNetworkInfo& net,
+                   const FrameTag& tag,
+                   PoseArena& arena,
+                   const PoseThresholds& thr)
+{
+  if (!L.buffer) return false;
+  const float* data = static_cast<const float*>(L.buffer);
 
-  if (stride < 6 || ((stride - 6) % 3 != 0)) {
-    std::cout << "[POSE][yolo26] stride mismatch: stride=" << stride << std::endl;
-    return false;
+  PoseLayout& lay = pose_layout_v8(L.inferDims);
+  if (!lay.valid) return false;
+
+  // Source size comes from NvDsInferSetSourceResolution or SQUEAKVIEW_SRC_W/H, resolved once per slot.
+  const LetterboxGeom& geom = letterbox_geom(tag.batch_slot, net);
+  PARSER_LOG_ONCE(kLogInfo, "[POSE][parser] geom src=(%.0fx%.0f) net=(%.0fx%.0f) gain=%.4f pad=(%.1f,%.1f)",
+                  geom.src_w, geom.src_h, geom.net_w, geom.net_h, geom.gain, geom.pad_x, geom.pad_y);
+
+  const bool xyxy = resolve_box_format(lay, data, geom.net_w, geom.net_h, thr.min) == kPoseBoxXyxy;
+  if (lay.batch == 1) {
+    decode_frame(data, lay, xyxy, net, geom, tag, arena, thr, true);
+    return true;
   }
-  const int kpts = (stride - 6) / 3;
-
-  const float inW = static_cast<float>(net.width);
-  const float inH = static_cast<float>(net.height);
-  const float src_w = env_or_default("SQUEAKVIEW_SRC_W", inW);
-  const float src_h = env_or_default("SQUEAKVIEW_SRC_H", inH);
-  const float gain = std::min(inW / src_w, inH / src_h);
-  const float pad_x = 0.5f * (inW - src_w * gain);
-  const float pad_y = 0.5f * (inH - src_h * gain);
-
-  dets.clear();
-  dets.reserve(num_preds);
-  objects.clear();
-  objects.reserve(num_preds);
 
-  std::vector<float> row;
-  if (channel_major) {
-    row.resize(static_cast<size_t>(stride));
+  std::vector<PoseArena>& extra = pose_batch_arenas(lay.batch);
+  parallel_for(lay.batch, [&](int b) {
+    const FrameTag t = batch_entry_tag(tag, b, lay.batch);
+    decode_frame(data + b * lay.frame_elems(), lay, xyxy, net, letterbox_geom(t.batch_slot, net), t,
+                 b == 0 ? arena : extra[b], thr, false);
+  });
+  return true;
+}
+
+// Keypoints of a YOLO26 object travel in its instance mask payload, so they stay with their NvDsObjectMeta
+// through clustering, the tracker and batching: mask_width 3 x mask_height kpts floats, (u, v, score) per
+// keypoint with u, v relative to the box (0..1 inside it), so they follow whatever is done to rect_params.
+// nvinfer copies the payload into mask_params and delete[]s it.
+static void attach_keypoints(NvDsInferInstanceMaskInfo& o, const float* kp, int kpts) {
+  if (kpts <= 0) return;
+  float* m = new float[3 * kpts];
+  const float inv_w = o.width > 0.f ? 1.f / o.width : 0.f;
+  const float inv_h = o.height > 0.f ? 1.f / o.height : 0.f;
+  for (int k = 0; k < kpts; ++k) {
+    m[3 * k + 0] = (kp[3 * k + 0] - o.left) * inv_w;
+    m[3 * k + 1] = (kp[3 * k + 1] - o.top) * inv_h;
+    m[3 * k + 2] = kp[3 * k + 2];
   }
+  o.mask = m;
+  o.mask_width = 3;
+  o.mask_height = static_cast<unsigned int>(kpts);
+  o.mask_size = static_cast<unsigned int>(sizeof(float) * 3 * kpts);
+}
 
-  for (int i = 0; i < num_preds; ++i) {
-    const float* p = nullptr;
-    if (channel_major) {
-      for (int c = 0; c < stride; ++c) {
-        row[c] = data[c * num_preds + i];
-      }
-      p = row.data();
-    } else {
-      p = data + i * stride;
-    }
+template <bool ChannelMajor>
+static void scan_yolo26(const float* data, const PoseLayout& lay, const LetterboxGeom& geom, const RoiView& roi,
+                        const NvDsInferParseDetectionParams& params, float conf_thr,
+                        PoseArena& arena, std::vector<NvDsInferInstanceMaskInfo>* objects)
+{
+  const int n = lay.num_preds;
+  const size_t cs = ChannelMajor ? static_cast<size_t>(n) : 1;
+  // Lowest threshold any class can get from class_threshold(): a safe prefilter for the score channel.
+  float min_thr = conf_thr;
+  if (!params.perClassPreclusterThreshold.empty()) {
+    min_thr = *std::min_element(params.perClassPreclusterThreshold.begin(), params.perClassPreclusterThreshold.end());
+  }
+  const int* hits = arena.hits.data();
+  const int m = ChannelMajor ? threshold_indices(data + 4 * cs, n, min_thr, arena.hits.data()) : n;
+  for (int h = 0; h < m; ++h) {
+    const int i = ChannelMajor ? hits[h] : h;
+    const float* p = ChannelMajor ? data + i : data + static_cast<size_t>(i) * lay.dim;
 
     float x1 = p[0];
-    float y1 = p[1];
-    float x2 = p[2];
-    float y2 = p[3];
-    float obj = p[4];
-    int cls = static_cast<int>(std::lround(p[5]));
+    float y1 = p[cs];
+    float x2 = p[2 * cs];
+    float y2 = p[3 * cs];
+    float obj = p[4 * cs];
+    int cls = static_cast<int>(std::lround(p[5 * cs]));
     if (cls < 0) continue;
     if (params.numClassesConfigured > 0 && static_cast<unsigned int>(cls) >= params.numClassesConfigured) {
       continue;
     }
     float thr = class_threshold(params, cls, conf_thr);
     if (obj < thr) continue;
+    // End-to-end rows are not in anchor order, so the ROI is checked on the box center.
+    if (roi.center_outside(x1, y1, x2, y2)) continue;
 
     // Unletterbox xyxy coords from net space back to src space.
-    unletterbox(x1, y1, gain, pad_x, pad_y, src_w, src_h);
-    unletterbox(x2, y2, gain, pad_x, pad_y, src_w, src_h);
+    unletterbox(x1, y1, geom);
+    unletterbox(x2, y2, geom);
     float bx1 = std::min(x1, x2);
     float by1 = std::min(y1, y2);
     float bx2 = std::max(x1, x2);
     float by2 = std::max(y1, y2);
 
-    PoseDet d{};
-    d.cls = cls;
-    d.conf = obj;
-    d.x1 = bx1;
-    d.y1 = by1;
-    d.x2 = bx2;
-    d.y2 = by2;
-    d.kpts.resize(static_cast<size_t>(3 * kpts));
-    const float* kp = p + 6;
-    for (int k = 0; k < kpts; ++k) {
-      float kx = kp[3 * k + 0];
-      float ky = kp[3 * k + 1];
-      float ks = kp[3 * k + 2];
-      unletterbox(kx, ky, gain, pad_x, pad_y, src_w, src_h);
-      d.kpts[3 * k + 0] = kx;
-      d.kpts[3 * k + 1] = ky;
-      d.kpts[3 * k + 2] = ks;
+    // No NMS for yolo26 (end-to-end head), so every candidate becomes an output row.
+    const int k_out = arena.kept;
+    arena.reserve_rows(k_out + 1);
+    float* out = arena.row(k_out);
+    out[0] = bx1;
+    out[1] = by1;
+    out[2] = bx2;
+    out[3] = by2;
+    out[4] = obj;
+    arena.row_cls[k_out] = cls;
+    const float* kp = p + lay.kpt_offset * cs;
+    for (int k = 0; k < lay.kpts; ++k) {
+      float kx = kp[(3 * k + 0) * cs];
+      float ky = kp[(3 * k + 1) * cs];
+      float ks = kp[(3 * k + 2) * cs];
+      unletterbox(kx, ky, geom);
+      out[5 + 3 * k + 0] = kx;
+      out[5 + 3 * k + 1] = ky;
+      out[5 + 3 * k + 2] = ks;
     }
-    dets.emplace_back(std::move(d));
 
+    if (!objects) continue;
     NvDsInferInstanceMaskInfo o{};
     o.classId = static_cast<unsigned int>(cls);
     o.left = bx1;
@@ -413,38 +470,74 @@ static bool decode_yolo26_pose(const NvDsInferLayerInfo& L,
     o.width = std::max(0.f, bx2 - bx1);
     o.height = std::max(0.f, by2 - by1);
     o.detectionConfidence = obj;
-    o.mask = nullptr;
-    o.mask_width = 0;
-    o.mask_height = 0;
-    o.mask_size = 0;
-    objects.emplace_back(o);
+    attach_keypoints(o, out + 5, lay.kpts);
+    objects->emplace_back(o);
   }
+}
 
-  update_pose_cache(dets, kpts);
+static bool decode_yolo26_pose(const NvDsInferLayerInfo& L,
+                               const NvDsInferNetworkInfo& net,
+                               const NvDsInferParseDetectionParams& params,
+                               const FrameTag& tag,
+                               PoseArena& arena,
+                               std::vector<NvDsInferInstanceMaskInfo>& objects,
+                               float conf_thr = 0.25f) {
+  if (!L.buffer) return false;
+  const float* data = static_cast<const float*>(L.buffer);
+
+  const PoseLayout& lay = pose_layout_yolo26(L.inferDims);
+  if (!lay.valid) return false;
+
+  objects.clear();
+  objects.reserve(lay.num_preds);
+
+  // Same batch split as decode(): entry 0 also produces the objects, other entries only the pose cache.
+  std::vector<PoseArena>& extra = pose_batch_arenas(lay.batch);
+  parallel_for(lay.batch, [&](int b) {
+    const FrameTag t = lay.batch == 1 ? tag : batch_entry_tag(tag, b, lay.batch);
+    const LetterboxGeom& geom = letterbox_geom(t.batch_slot, net);
+    const float* entry = data + b * lay.frame_elems();
+    TraceScope frameTrace("pose_decode_frame");
+    PoseArena& a = b == 0 ? arena : extra[b];
+    a.begin(lay.num_preds, lay.kpts);
+    a.reserve_rows(0);
+    std::vector<NvDsInferInstanceMaskInfo>* out = b == 0 ? &objects : nullptr;
+    const RoiView roi = roi_view(t.batch_slot, net, 0);
+    if (lay.channel_major) {
+      scan_yolo26<true>(entry, lay, geom, roi, params, conf_thr, a, out);
+    } else {
+      scan_yolo26<false>(entry, lay, geom, roi, params, conf_thr, a, out);
+    }
+    parser_stats_frame(lay.num_preds, a.kept, a.kept);
+    update_pose_cache(a, t, geom);
+  });
   return true;
 }
 
 static bool parse_pose_internal(const std::vector<NvDsInferLayerInfo>& layers,
                                 const NvDsInferNetworkInfo& net,
-                                const NvDsInferParseDetectionParams&,
+                                const NvDsInferParseDetectionParams& params,
                                 std::vector<NvDsInferObjectDetectionInfo>& objects)
 {
+  TraceScope trace("parse_pose", kTraceParse);
   if (layers.empty()) return false;
   // pick first FP32 layer or fallback
   const NvDsInferLayerInfo* L=&layers[0];
   for (auto& li: layers) if (li.dataType==NvDsInferDataType::FLOAT) { L=&li; break; }
 
-  std::vector<PoseDet> dets;
-  if (!decode(*L, net, dets)) return false;
+  const FrameTag tag = tag_frame(*L);
+  PoseArena& arena = pose_arena();
+  if (!decode(*L, net, tag, arena, pose_thresholds(params))) return false;
 
-  objects.clear(); objects.reserve(dets.size());
-  for (auto& d: dets) {
+  objects.clear(); objects.reserve(arena.kept);
+  for (int k = 0; k < arena.kept; ++k) {
+    const float* d = arena.row(k);
     NvDsInferObjectDetectionInfo o{};
-    o.classId = d.cls; o.detectionConfidence = d.conf;
-    o.left = d.x1; o.top = d.y1; o.width = std::max(0.f, d.x2-d.x1); o.height = std::max(0.f, d.y2-d.y1);
+    o.classId = arena.row_cls[k]; o.detectionConfidence = d[4];
+    o.left = d[0]; o.top = d[1]; o.width = std::max(0.f, d[2]-d[0]); o.height = std::max(0.f, d[3]-d[1]);
     objects.emplace_back(o);
   }
-  std::cout << "[POSE][parser] objects_emitted=" << objects.size() << std::endl;
+  PARSER_LOG(kLogDebug, "[POSE][parser] objects_emitted=%zu", objects.size());
   return true;
 }
 
@@ -454,6 +547,7 @@ extern "C" bool NvDsInferParseYoloV8Pose(
   const NvDsInferParseDetectionParams& params,
   std::vector<NvDsInferObjectDetectionInfo>& objects)
 {
+  parser_record("v8pose", layers, net, params);
   return parse_pose_internal(layers, net, params, objects);
 }
 
@@ -463,6 +557,7 @@ extern "C" bool NvDsInferParseYoloV8PoseBoxes(
   const NvDsInferParseDetectionParams& params,
   std::vector<NvDsInferObjectDetectionInfo>& objects)
 {
+  parser_record("v8pose_boxes", layers, net, params);
   return parse_pose_internal(layers, net, params, objects);
 }
 
@@ -472,13 +567,15 @@ extern "C" bool NvDsInferParseYolo26Pose(
   const NvDsInferParseDetectionParams& params,
   std::vector<NvDsInferInstanceMaskInfo>& objects)
 {
+  parser_record("yolo26pose", layers, net, params);
+  TraceScope trace("NvDsInferParseYolo26Pose", kTraceParse);
   if (layers.empty()) return false;
   const NvDsInferLayerInfo* L = &layers[0];
   for (auto& li : layers) {
     if (li.dataType == NvDsInferDataType::FLOAT) { L = &li; break; }
   }
-  std::vector<PoseDet> dets;
-  return decode_yolo26_pose(*L, net, params, dets, objects);
+  const FrameTag tag = tag_frame(*L);
+  return decode_yolo26_pose(*L, net, params, tag, pose_arena(), objects);
 }
 
 CHECK_CUSTOM_INSTANCE_MASK_PARSE_FUNC_PROTOTYPE(NvDsInferParseYolo26Pose);
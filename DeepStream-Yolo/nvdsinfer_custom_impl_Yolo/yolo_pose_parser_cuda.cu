@@ -0,0 +1,432 @@
+// yolo_pose_parser_cuda.cu  (GPU twin of NvDsInferParseYoloV8Pose)
+// Threshold, compact, NMS, keypoint decode and unletterbox all run on the device; only the surviving
+// detections are copied back, already in the pose ring row layout ([x1,y1,x2,y2,conf, (x,y,score)*kpts]).
+// Like NvDsInferParseYoloCuda, the layer buffer is read in place by the kernels (nvinfer keeps its
+// host output buffers in pinned memory, which the device can address directly).
+// Exports NvDsInferParseYoloV8PoseCuda.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <thrust/device_ptr.h>
+#include <thrust/system/cuda/execution_policy.h>
+#include <thrust/sort.h>
+
+#include "nvdsinfer_custom_impl.h"
+
+#include "cuda_workspace.h"
+#include "parser_log.h"
+#include "parser_stats.h"
+#include "parser_trace.h"
+#include "pose_arena.h"
+#include "pose_cache.h"
+#include "pose_layout.h"
+#include "pose_track.h"
+#include "roi_mask.h"
+#include "tensor_record.h"
+
+namespace {
+
+constexpr int kPoseNmsMax = 4096;     // candidates considered by NMS (highest confidence first)
+constexpr int kPoseNmsThreads = 1024;
+
+struct PoseCandidate {
+  float x1, y1, x2, y2, conf;
+  int cls;
+  int anchor;
+};
+
+struct PoseCandidateGreater {
+  __host__ __device__ bool operator()(const PoseCandidate& a, const PoseCandidate& b) const {
+    return a.conf > b.conf;
+  }
+};
+
+__device__ __forceinline__ void unletterboxCuda(float& x, float& y, float gain, float padX, float padY,
+    float srcW, float srcH)
+{
+  x = fminf(fmaxf((x - padX) / gain, 0.f), srcW - 1.f);
+  y = fminf(fmaxf((y - padY) / gain, 0.f), srcH - 1.f);
+}
+
+__device__ __forceinline__ float iouCuda(const PoseCandidate& a, const PoseCandidate& b)
+{
+  const float w = fmaxf(0.f, fminf(a.x2, b.x2) - fmaxf(a.x1, b.x1));
+  const float h = fmaxf(0.f, fminf(a.y2, b.y2) - fmaxf(a.y1, b.y1));
+  const float inter = w * h;
+  const float areaA = fmaxf(0.f, a.x2 - a.x1) * fmaxf(0.f, a.y2 - a.y1);
+  const float areaB = fmaxf(0.f, b.x2 - b.x1) * fmaxf(0.f, b.y2 - b.y1);
+  return inter / (areaA + areaB - inter + 1e-6f);
+}
+
+// One thread per anchor. In the channel-major layout neighbouring threads read neighbouring floats of
+// every channel, so the reads coalesce without the host-side transpose. roiAnchors / roiCells are the
+// slot's RoiView on the device (both nullptr without an ROI). The layout and the single-class case are template
+// parameters, as in the CPU scan, so neither costs a branch per anchor. Anchors are rejected on minThr, the lowest
+// class threshold, before the class scores are read, then on classThr of their class (numThr of them, the first
+// one for classes past the end, minThr when there are none).
+template <bool ChannelMajor, bool SingleClass>
+__global__ void decodePoseCandidatesCuda(PoseCandidate* cand, int* candCount, const float* data, int numPreds,
+    int dim, int nc, int xyxy, float minThr, const float* classThr, int numThr, const uint8_t* roiAnchors,
+    const uint8_t* roiCells, int roiW, int roiH)
+{
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= numPreds || (roiAnchors && !roiAnchors[i])) {
+    return;
+  }
+
+  const int cs = ChannelMajor ? numPreds : 1;
+  const float* p = ChannelMajor ? data + i : data + (size_t) i * dim;
+
+  const float obj = p[4 * cs];
+  if (obj < minThr) {
+    return;
+  }
+
+  int bestId = 0;
+  float bestSc = 1.f;
+  if (!SingleClass) {
+    bestSc = 0.f;
+    for (int c = 0; c < nc; ++c) {
+      const float sc = p[(5 + c) * cs];
+      if (sc > bestSc) { bestSc = sc; bestId = c; }
+    }
+  }
+  const float conf = obj * bestSc;
+  if (conf < (numThr == 0 ? minThr : classThr[bestId < numThr ? bestId : 0])) {
+    return;
+  }
+
+  const float cx = p[0], cy = p[cs], w = p[2 * cs], h = p[3 * cs];
+  PoseCandidate c;
+  if (xyxy) {
+    c.x1 = cx; c.y1 = cy; c.x2 = w; c.y2 = h;
+  }
+  else {
+    c.x1 = cx - 0.5f * w; c.y1 = cy - 0.5f * h; c.x2 = cx + 0.5f * w; c.y2 = cy + 0.5f * h;
+  }
+  if (roiCells && !roiAnchors) {
+    const int gx = min(max((int) (0.5f * (c.x1 + c.x2) / kRoiCellStride), 0), roiW - 1);
+    const int gy = min(max((int) (0.5f * (c.y1 + c.y2) / kRoiCellStride), 0), roiH - 1);
+    if (!roiCells[gy * roiW + gx]) {
+      return;
+    }
+  }
+  c.conf = conf;
+  c.cls = bestId;
+  c.anchor = i;
+
+  cand[atomicAdd(candCount, 1)] = c;
+}
+
+// Greedy NMS over confidence-sorted candidates in a single block. Boxes are still in network space,
+// which gives the same suppression as the CPU path since unletterbox is a uniform scale + shift. With classAware
+// only candidates of the same class suppress each other (parser_nms_class_aware()). Every thread reads kept and
+// removed[i] between the barrier ending one step and the one after the read in the next, as in nmsReduceCuda, so
+// all of them leave the loop on the same step.
+__global__ void nmsPoseCandidatesCuda(const PoseCandidate* cand, int count, float iouThr, int classAware,
+    int* keep, int* keepCount, int maxKeep)
+{
+  __shared__ unsigned char removed[kPoseNmsMax];
+  __shared__ int kept;
+
+  for (int j = threadIdx.x; j < count; j += blockDim.x) {
+    removed[j] = 0;
+  }
+  if (threadIdx.x == 0) {
+    kept = 0;
+  }
+  __syncthreads();
+
+  for (int i = 0; i < count && kept < maxKeep; ++i) {
+    const bool alive = !removed[i];
+    __syncthreads();
+    if (alive) {
+      const PoseCandidate a = cand[i];
+      for (int j = i + 1 + threadIdx.x; j < count; j += blockDim.x) {
+        if (!removed[j] && (!classAware || cand[j].cls == a.cls) && iouCuda(a, cand[j]) > iouThr) {
+          removed[j] = 1;
+        }
+      }
+      if (threadIdx.x == 0) {
+        keep[kept++] = i;
+      }
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    *keepCount = kept;
+  }
+}
+
+// One block per kept detection: writes the unletterboxed box and keypoints as one output row.
+__global__ void gatherPoseDetsCuda(float* out, int* outCls, const int* keep, const int* keepCount,
+    const PoseCandidate* cand, const float* data, int numPreds, int dim, int channelMajor, int kptOffset, int kpts,
+    float gain, float padX, float padY, float srcW, float srcH)
+{
+  const int k = blockIdx.x;
+  if (k >= *keepCount) {
+    return;
+  }
+
+  const PoseCandidate c = cand[keep[k]];
+  const int cs = channelMajor ? numPreds : 1;
+  const float* p = channelMajor ? data + c.anchor : data + (size_t) c.anchor * dim;
+  float* row = out + (size_t) k * (kPoseBaseValuesPerDet + 3 * kpts);
+
+  if (threadIdx.x == 0) {
+    float x1 = c.x1, y1 = c.y1, x2 = c.x2, y2 = c.y2;
+    unletterboxCuda(x1, y1, gain, padX, padY, srcW, srcH);
+    unletterboxCuda(x2, y2, gain, padX, padY, srcW, srcH);
+    row[0] = x1; row[1] = y1; row[2] = x2; row[3] = y2;
+    row[4] = c.conf;
+    outCls[k] = c.cls;
+  }
+
+  const int kptBase = kptOffset;
+  for (int j = threadIdx.x; j < kpts; j += blockDim.x) {
+    float kx = p[(kptBase + 3 * j + 0) * cs];
+    float ky = p[(kptBase + 3 * j + 1) * cs];
+    const float ks = p[(kptBase + 3 * j + 2) * cs];
+    unletterboxCuda(kx, ky, gain, padX, padY, srcW, srcH);
+    row[kPoseBaseValuesPerDet + 3 * j + 0] = kx;
+    row[kPoseBaseValuesPerDet + 3 * j + 1] = ky;
+    row[kPoseBaseValuesPerDet + 3 * j + 2] = ks;
+  }
+}
+
+// Per-thread (i.e. per nvinfer context) buffers reused across frames.
+struct PoseCudaWorkspace {
+  DeviceBuffer<PoseCandidate> candidates;
+  DeviceBuffer<int> counts;
+  DeviceBuffer<int> keep;
+  DeviceBuffer<float> rows;
+  DeviceBuffer<int> rowCls;
+  PinnedBuffer<int> hostCounts;
+  DeviceBuffer<float> classThr;
+  PinnedBuffer<float> hostClassThr;
+  std::vector<float> uploadedThr;  // what classThr holds
+  StreamGraphCache decodeGraphs;
+  SlotUploadCache roi;
+};
+
+thread_local PoseCudaWorkspace poseCudaWorkspace;
+
+} // namespace
+
+// Decodes one batch entry of the V8 head on the GPU into arena and publishes it to the pose cache under tag, with
+// the thresholds and class-threshold table the caller set up in ws. Returns false on a CUDA error.
+static bool decodePoseFrameCuda(PoseCudaWorkspace& ws, cudaStream_t stream, const float* data, const PoseLayout& lay,
+    int xyxy, const NvDsInferNetworkInfo& networkInfo, const LetterboxGeom& geom, const FrameTag& tag,
+    PoseArena& arena, float confThr, float iouThr, int numThr)
+{
+  const int rowStride = kPoseBaseValuesPerDet + 3 * lay.kpts;
+  const size_t rowFloats = static_cast<size_t>(kPoseMaxDets) * rowStride;
+
+  // The ROI tables are uploaded outside the graph; a new upload lands in the same device buffer.
+  const RoiView roi = roi_view(tag.batch_slot, networkInfo, lay.num_preds);
+  const uint8_t* roiCells = roi.active() ? ws.roi.get(tag.batch_slot, roi.id, roi.cells, roi.bytes, stream) : nullptr;
+  const uint8_t* roiAnchors = roiCells && roi.anchors ? roiCells + (roi.anchors - roi.cells) : nullptr;
+
+  int* candCount = ws.counts.get(); // [candidates, kept]
+  int* keepCount = candCount + 1;
+  // The sort and the NMS launch need the candidate count on the host. Up to there the work has a fixed shape per
+  // output buffer and layout, so it can be replayed from a CUDA graph (SQUEAKVIEW_CUDA_GRAPH=1).
+  // The thresholds are baked into the captured launch; they share a key word with xyxy (bit 0).
+  uint32_t minThrBits;
+  std::memcpy(&minThrBits, &confThr, sizeof(minThrBits));
+  const uint64_t thrWord = static_cast<uint64_t>(xyxy) | static_cast<uint64_t>(numThr) << 1 |
+      static_cast<uint64_t>(minThrBits) << 32;
+  const GraphKey key {reinterpret_cast<uintptr_t>(data), static_cast<uintptr_t>(lay.num_preds),
+      static_cast<uintptr_t>(lay.dim), static_cast<uintptr_t>(lay.channel_major), static_cast<uintptr_t>(lay.nc),
+      static_cast<uintptr_t>(thrWord), reinterpret_cast<uintptr_t>(ws.candidates.get()),
+      reinterpret_cast<uintptr_t>(candCount), reinterpret_cast<uintptr_t>(ws.hostCounts.get()),
+      reinterpret_cast<uintptr_t>(roiAnchors ? roiAnchors : roiCells)};
+  cudaError_t err = ws.decodeGraphs.run(key, stream, [&](cudaStream_t s) {
+    cudaMemsetAsync(candCount, 0, 2 * sizeof(int), s);
+
+    int threads_per_block = 256;
+    int number_of_blocks = ((lay.num_preds) / threads_per_block) + 1;
+
+    const bool single = lay.nc <= 1;
+    auto decode = lay.channel_major ? (single ? decodePoseCandidatesCuda<true, true> :
+        decodePoseCandidatesCuda<true, false>) : (single ? decodePoseCandidatesCuda<false, true> :
+        decodePoseCandidatesCuda<false, false>);
+    decode<<<number_of_blocks, threads_per_block, 0, s>>>(ws.candidates.get(), candCount, data, lay.num_preds,
+        lay.dim, lay.nc, xyxy, confThr, ws.classThr.get(), numThr, roiAnchors, roiCells, roi.cells_w, roi.cells_h);
+
+    cudaMemcpyAsync(ws.hostCounts.get(), candCount, sizeof(int), cudaMemcpyDeviceToHost, s);
+  });
+  if (err == cudaSuccess) {
+    err = cudaStreamSynchronize(stream);
+  }
+  if (err != cudaSuccess) {
+    PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: pose candidate decode failed: %s", cudaGetErrorString(err));
+    return false;
+  }
+
+  const int numCandidates = ws.hostCounts.get()[0];
+  const int topk = parser_topk();
+  const int nmsCount = std::min(std::min(numCandidates, kPoseNmsMax), topk > 0 ? topk : kPoseNmsMax);
+  int numKept = 0;
+
+  // The kept rows are copied straight into the arena, whose row storage is pinned (pose_arena.h).
+  arena.begin(0, lay.kpts);
+  arena.reserve_rows(kPoseMaxDets);
+
+  if (numCandidates > 0) {
+    TraceScope nmsTrace("pose_nms_cuda", kTraceNms);
+    thrust::device_ptr<PoseCandidate> cand = thrust::device_pointer_cast(ws.candidates.get());
+    ScratchAllocator scratch(stream);
+    thrust::sort(thrust::cuda::par(scratch).on(stream), cand, cand + numCandidates, PoseCandidateGreater());
+
+    if (pose_oks_enabled()) {
+      PARSER_LOG_ONCE(kLogWarn, "[POSE][cuda] SQUEAKVIEW_POSE_NMS=oks only applies to the CPU pose parser, "
+          "NvDsInferParseYoloV8PoseCuda keeps box IoU NMS");
+    }
+    nmsPoseCandidatesCuda<<<1, kPoseNmsThreads, 0, stream>>>(
+        ws.candidates.get(), nmsCount, iouThr, parser_nms_class_aware() && lay.nc > 1, ws.keep.get(), keepCount,
+        kPoseMaxDets);
+
+    gatherPoseDetsCuda<<<kPoseMaxDets, 32, 0, stream>>>(
+        ws.rows.get(), ws.rowCls.get(), ws.keep.get(), keepCount, ws.candidates.get(), data, lay.num_preds,
+        lay.dim, lay.channel_major, lay.kpt_offset, lay.kpts, geom.gain, geom.pad_x, geom.pad_y, geom.src_w,
+        geom.src_h);
+
+    // One round trip: the full (small) row block comes back together with the kept count.
+    cudaMemcpyAsync(ws.hostCounts.get() + 1, keepCount, sizeof(int), cudaMemcpyDeviceToHost, stream);
+    cudaMemcpyAsync(arena.rows.data(), ws.rows.get(), rowFloats * sizeof(float), cudaMemcpyDeviceToHost, stream);
+    cudaMemcpyAsync(arena.row_cls.data(), ws.rowCls.get(), kPoseMaxDets * sizeof(int), cudaMemcpyDeviceToHost,
+        stream);
+    err = cudaStreamSynchronize(stream);
+    if (err != cudaSuccess) {
+      PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: pose NMS failed: %s", cudaGetErrorString(err));
+      return false;
+    }
+
+    numKept = ws.hostCounts.get()[1];
+  }
+
+  parser_stats_frame(lay.num_preds, numCandidates, numKept);
+  arena.kept = numKept;
+
+  // Before the objects are built, so nvinfer gets the smoothed boxes too.
+  int32_t flags = geom.source_coords ? kPoseFrameSourceCoords : 0;
+  const float* rows = pose_track_rows(tag, arena, &flags);
+
+  {
+    TraceScope cacheTrace("pose_cache_update", kTraceCache);
+    publish_pose_rows(rows, numKept, lay.kpts, tag, flags);
+  }
+  return true;
+}
+
+extern "C" bool
+NvDsInferParseYoloV8PoseCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList);
+
+static bool NvDsInferParseCustomYoloV8PoseCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList)
+{
+  if (outputLayersInfo.empty()) {
+    PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: Could not find output layer in pose parsing");
+    return false;
+  }
+
+  const NvDsInferLayerInfo* output = &outputLayersInfo[0];
+  for (auto& li : outputLayersInfo) {
+    if (li.dataType == NvDsInferDataType::FLOAT) { output = &li; break; }
+  }
+  if (!output->buffer) {
+    return false;
+  }
+
+  PoseLayout& lay = pose_layout_v8(output->inferDims);
+  if (!lay.valid) {
+    PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: Unsupported pose output dims in pose parsing");
+    return false;
+  }
+
+  const FrameTag tag = tag_frame(*output);
+
+  // Same thresholds as the CPU parser so the two paths stay interchangeable: nvinfer's per-class pre-cluster
+  // thresholds and the library's NMS IoU.
+  const std::vector<float>& classThr = detectionParams.perClassPreclusterThreshold;
+  const float confThr = classThr.empty() ? 0.25f : *std::min_element(classThr.begin(), classThr.end());
+  const float iouThr = parser_nms_iou();
+
+  const LetterboxGeom& geom = letterbox_geom(tag.batch_slot, networkInfo);
+
+  const float* data = static_cast<const float*>(output->buffer);
+  const int xyxy = resolve_box_format(lay, data, geom.net_w, geom.net_h, confThr) == kPoseBoxXyxy;
+  const int rowStride = kPoseBaseValuesPerDet + 3 * lay.kpts;
+
+  PoseCudaWorkspace& ws = poseCudaWorkspace;
+  cudaStream_t stream = parser_stream(tag.batch_slot);
+  const size_t rowFloats = static_cast<size_t>(kPoseMaxDets) * rowStride;
+  if (!ws.candidates.reserve(lay.num_preds) || !ws.counts.reserve(2) || !ws.keep.reserve(kPoseMaxDets) ||
+      !ws.rows.reserve(rowFloats) || !ws.rowCls.reserve(kPoseMaxDets) || !ws.hostCounts.reserve(2)) {
+    PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: Failed to allocate the pose parsing workspace");
+    return false;
+  }
+
+  // The class thresholds only change with the config; like the ROI tables they are uploaded outside the graph.
+  const int numThr = static_cast<int>(classThr.size());
+  if (numThr > 0 && classThr != ws.uploadedThr) {
+    if (!ws.classThr.reserve(numThr) || !ws.hostClassThr.reserve(numThr)) {
+      PARSER_LOG_EVERY_MS(kLogError, 1000, "ERROR: Failed to allocate the pose parsing workspace");
+      return false;
+    }
+    std::copy(classThr.begin(), classThr.end(), ws.hostClassThr.get());
+    cudaMemcpyAsync(ws.classThr.get(), ws.hostClassThr.get(), numThr * sizeof(float), cudaMemcpyHostToDevice,
+        stream);
+    ws.uploadedThr = classThr;
+  }
+
+  // Entries of a multi-frame [B, C, N] tensor run one after the other on the slot's stream, which the workspace
+  // is reused across. Entry 0 feeds the objects returned to nvinfer, entries 1..B-1 only reach the pose cache
+  // under their batch_entry_tag() slots, as in the CPU parser.
+  PoseArena& arena = pose_arena();
+  std::vector<PoseArena>* extra = lay.batch > 1 ? &pose_batch_arenas(lay.batch) : nullptr;
+  for (int b = 0; b < lay.batch; ++b) {
+    const FrameTag t = lay.batch == 1 ? tag : batch_entry_tag(tag, b, lay.batch);
+    if (!decodePoseFrameCuda(ws, stream, data + b * lay.frame_elems(), lay, xyxy, networkInfo,
+            b == 0 ? geom : letterbox_geom(t.batch_slot, networkInfo), t, b == 0 ? arena : (*extra)[b], confThr,
+            iouThr, numThr)) {
+      return false;
+    }
+  }
+
+  const int numKept = arena.kept;
+  objectList.clear();
+  objectList.reserve(numKept);
+  for (int k = 0; k < numKept; ++k) {
+    const float* r = arena.row(k);
+    NvDsInferParseObjectInfo o{};
+    o.classId = arena.row_cls[k];
+    o.detectionConfidence = r[4];
+    o.left = r[0];
+    o.top = r[1];
+    o.width = std::max(0.f, r[2] - r[0]);
+    o.height = std::max(0.f, r[3] - r[1]);
+    objectList.push_back(o);
+  }
+
+  return true;
+}
+
+extern "C" bool
+NvDsInferParseYoloV8PoseCuda(std::vector<NvDsInferLayerInfo> const& outputLayersInfo,
+    NvDsInferNetworkInfo const& networkInfo, NvDsInferParseDetectionParams const& detectionParams,
+    std::vector<NvDsInferParseObjectInfo>& objectList)
+{
+  parser_record("v8pose_cuda", outputLayersInfo, networkInfo, detectionParams);
+  TraceScope trace("NvDsInferParseYoloV8PoseCuda", kTraceParse);
+  return NvDsInferParseCustomYoloV8PoseCuda(outputLayersInfo, networkInfo, detectionParams, objectList);
+}
+
+CHECK_CUSTOM_PARSE_FUNC_PROTOTYPE(NvDsInferParseYoloV8PoseCuda);
@@ -56,6 +56,198 @@ def ts() -> str:
     return time.strftime("%H:%M:%S")
 
 
+_POSE_FRAME_SOURCE_COORDS = 1  # kPoseFrameSourceCoords: rows are already in source-frame pixels
+_POSE_FRAME_TRACK_IDS = 2  # kPoseFrameTrackIds: every row ends with the parser's track id
+_POSE_FRAME_COMPACT = 4  # kPoseFrameCompact: rows are compact records, stride counts 32-bit words
+_POSE_COMPACT_SCALE = 16384.0  # kPoseCompactScale
+_POSE_COMPACT_HEADER = 16  # kPoseCompactHeaderBytes
+
+
+def _unpack_compact_pose(records: np.ndarray, kpt_count: int, track_ids: bool) -> np.ndarray:
+    """Compact pose records (pose_cache.h) -> float rows [x1,y1,x2,y2,conf, (x,y,score)*kpts (, track id)]."""
+    raw = np.ascontiguousarray(records).view(np.uint8).reshape(records.shape[0], -1)
+    n, k = raw.shape[0], max(0, kpt_count)
+    head = raw[:, :10].copy().view("<f2").astype(np.float32)
+    xy = raw[:, _POSE_COMPACT_HEADER:_POSE_COMPACT_HEADER + 4 * k].copy().view("<i2").astype(np.float32)
+    xy = xy.reshape(n, k, 2) / _POSE_COMPACT_SCALE
+    score = raw[:, _POSE_COMPACT_HEADER + 4 * k:_POSE_COMPACT_HEADER + 5 * k].astype(np.float32) / 255.0
+    kps = np.empty((n, k, 3), np.float32)
+    kps[:, :, 0] = head[:, 0:1] + xy[:, :, 0] * (head[:, 2:3] - head[:, 0:1])
+    kps[:, :, 1] = head[:, 1:2] + xy[:, :, 1] * (head[:, 3:4] - head[:, 1:2])
+    kps[:, :, 2] = score
+    rows = np.empty((n, 5 + 3 * k + (1 if track_ids else 0)), np.float32)
+    rows[:, :5] = head
+    rows[:, 5:5 + 3 * k] = kps.reshape(n, -1)
+    if track_ids:
+        rows[:, -1] = raw[:, 12:16].copy().view("<i4")[:, 0]
+    return rows
+
+
+_RESULT_MAGIC = 0x52525153  # kResultMagic, "SQRR"
+_RESULT_VERSION = 1  # kResultVersion
+_RESULT_KIND_POSE = 2  # kResultKindPose
+_RESULT_BOXES, _RESULT_SCORES, _RESULT_CLASSES, _RESULT_TRACK_IDS, _RESULT_THETA, _RESULT_KEYPOINTS = range(6)
+_RESULT_SOURCE_COORDS = 1  # kResultSourceCoords
+
+
+class _ResultHeader(ctypes.Structure):
+    """Mirror of NvDsResultHeader in nvdsinfer_custom_impl_Yolo/result_record.h."""
+
+    _fields_ = [
+        ("magic", ctypes.c_uint32),
+        ("version", ctypes.c_uint16),
+        ("kind", ctypes.c_uint16),
+        ("bytes", ctypes.c_uint32),
+        ("fields", ctypes.c_uint32),
+        ("frame_num", ctypes.c_uint64),
+        ("pts_ns", ctypes.c_uint64),
+        ("source_id", ctypes.c_int32),
+        ("count", ctypes.c_int32),
+        ("kpts", ctypes.c_int32),
+        ("flags", ctypes.c_int32),
+        ("offset", ctypes.c_uint32 * 8),
+        ("reserved", ctypes.c_uint64 * 6),
+    ]
+
+
+class _ResultFrame(ctypes.Structure):
+    """Mirror of NvDsResultFrame in nvdsinfer_custom_impl_Yolo/result_record.h."""
+
+    _fields_ = [
+        ("seq", ctypes.c_uint64),
+        ("kind", ctypes.c_int32),
+        ("slot", ctypes.c_int32),
+        ("record", ctypes.POINTER(_ResultHeader)),
+    ]
+
+
+def _result_array(header: _ResultHeader, index: int, ctype, shape: tuple[int, ...]) -> np.ndarray | None:
+    """Array `index` of a pinned result record as a numpy view, or None when the record does not carry it."""
+    if not header.fields >> index & 1 or not all(shape):
+        return None
+    base = ctypes.addressof(header) + int(header.offset[index])
+    return np.ctypeslib.as_array(ctypes.cast(base, ctypes.POINTER(ctype)), shape=shape)
+
+
+def _result_pose_rows(header: _ResultHeader) -> np.ndarray:
+    """Pose record -> float rows [x1,y1,x2,y2,conf, (x,y,score)*kpts (, track id)], a copy."""
+    n, k = int(header.count), max(0, int(header.kpts))
+    tracks = _result_array(header, _RESULT_TRACK_IDS, ctypes.c_int32, (n,))
+    rows = np.empty((n, 5 + 3 * k + (1 if header.fields >> _RESULT_TRACK_IDS & 1 else 0)), np.float32)
+    if n == 0:
+        return rows
+    rows[:, :4] = _result_array(header, _RESULT_BOXES, ctypes.c_float, (n, 4))
+    rows[:, 4] = _result_array(header, _RESULT_SCORES, ctypes.c_float, (n,))
+    keypoints = _result_array(header, _RESULT_KEYPOINTS, ctypes.c_float, (n, 3 * k))
+    if keypoints is not None:
+        rows[:, 5:5 + 3 * k] = keypoints
+    if tracks is not None:
+        rows[:, -1] = tracks
+    return rows
+
+
+class _PoseFrame(ctypes.Structure):
+    """Mirror of NvDsPoseFrame in nvdsinfer_custom_impl_Yolo/pose_cache.h."""
+
+    _fields_ = [
+        ("seq", ctypes.c_uint64),
+        ("frame_num", ctypes.c_uint64),
+        ("source_id", ctypes.c_int32),
+        ("slot", ctypes.c_int32),
+        ("count", ctypes.c_int32),
+        ("kpts", ctypes.c_int32),
+        ("stride", ctypes.c_int32),
+        ("flags", ctypes.c_int32),
+        ("data", ctypes.POINTER(ctypes.c_float)),
+    ]
+
+
+class _PoseView(ctypes.Structure):
+    """Mirror of NvDsPoseView in nvdsinfer_custom_impl_Yolo/pose_cache.h."""
+
+    _fields_ = [
+        ("data", ctypes.POINTER(ctypes.c_float)),
+        ("shape", ctypes.c_int64 * 2),
+        ("strides", ctypes.c_int64 * 2),
+        ("seq", ctypes.c_uint64),
+        ("frame_num", ctypes.c_uint64),
+        ("source_id", ctypes.c_int32),
+        ("kpts", ctypes.c_int32),
+        ("flags", ctypes.c_int32),
+        ("token", ctypes.c_int32),
+    ]
+
+
+class _StageLatency(ctypes.Structure):
+    """Mirror of NvDsStageLatency in nvdsinfer_custom_impl_Yolo/parser_trace.h."""
+
+    _fields_ = [
+        ("count", ctypes.c_uint64),
+        ("mean_us", ctypes.c_double),
+        ("p50_us", ctypes.c_double),
+        ("p90_us", ctypes.c_double),
+        ("p99_us", ctypes.c_double),
+        ("max_us", ctypes.c_double),
+    ]
+
+
+class _ParserStats(ctypes.Structure):
+    """Mirror of NvDsParserStats in nvdsinfer_custom_impl_Yolo/parser_stats.h."""
+
+    _fields_ = [
+        ("frames_parsed", ctypes.c_uint64),
+        ("candidates", ctypes.c_uint64),
+        ("candidates_passed", ctypes.c_uint64),
+        ("detections", ctypes.c_uint64),
+        ("parse_ns", ctypes.c_uint64),
+        ("nms_ns", ctypes.c_uint64),
+        ("cache_overwrites", ctypes.c_uint64),
+        ("allocations", ctypes.c_uint64),
+    ]
+
+
+_MEM_COMPONENTS = ("parsers", "plugin", "calibrator", "build")
+_MEM_KINDS = ("device", "pinned", "host")
+
+
+class _MemoryStats(ctypes.Structure):
+    """Mirror of NvDsMemoryStats in nvdsinfer_custom_impl_Yolo/mem_budget.h."""
+
+    _fields_ = [
+        ("current", (ctypes.c_uint64 * len(_MEM_KINDS)) * len(_MEM_COMPONENTS)),
+        ("peak", (ctypes.c_uint64 * len(_MEM_KINDS)) * len(_MEM_COMPONENTS)),
+        ("total_peak", ctypes.c_uint64 * len(_MEM_KINDS)),
+        ("budget", ctypes.c_uint64 * len(_MEM_KINDS)),
+        ("refused", ctypes.c_uint64),
+    ]
+
+
+class _FrameTiming(ctypes.Structure):
+    """Mirror of NvDsFrameTiming in nvdsinfer_custom_impl_Yolo/frame_timing.h."""
+
+    _fields_ = [
+        ("frame_num", ctypes.c_uint64),
+        ("pts_ns", ctypes.c_uint64),
+        ("capture_ns", ctypes.c_int64),
+        ("parse_start_ns", ctypes.c_int64),
+        ("parsed_ns", ctypes.c_int64),
+        ("source_id", ctypes.c_int32),
+        ("reserved", ctypes.c_int32),
+    ]
+
+
+class _MotionState(ctypes.Structure):
+    """Mirror of NvDsMotionState in nvdsinfer_custom_impl_Yolo/motion_gate.h."""
+
+    _fields_ = [
+        ("motion", ctypes.c_double),
+        ("quiet_s", ctypes.c_double),
+        ("frames", ctypes.c_uint64),
+        ("idle", ctypes.c_int32),
+        ("detections", ctypes.c_int32),
+    ]
+
+
 def _read_rss_kb() -> int:
     """Return current process RSS in KB using /proc (no extra deps)."""
     try:
@@ -208,6 +400,9 @@ class App:
                     if lp.exists():
                         names = [ln.strip() for ln in lp.read_text().splitlines() if ln.strip()]
                         self.kp_names = names if names else None
+                        # OKS NMS in the lib takes its keypoint sigmas from the same file ("<name> <sigma>").
+                        if os.environ.get("SQUEAKVIEW_POSE_NMS") == "oks":
+                            os.environ.setdefault("SQUEAKVIEW_KPT_SIGMAS", str(lp))
             except Exception as exc:
                 print(f"[{ts()}] [POSE] unable to load keypoint labels: {exc}")
         # Skeleton toggle via file
@@ -240,10 +435,51 @@ class App:
         self._infer_history: deque[tuple[float, float]] = deque()
         self._stream_history: deque[float] = deque()
         self._stream_fps: float = float("nan")
-        self._pose_cache_seq: int = 0
-        self._pose_cache_last: list[dict] | None = None
+        # Last decoded pose frame per batch slot: slot -> (seq, detections); -1 is the legacy single-slot cache.
+        self._pose_cache_by_slot: dict[int, tuple[int, list[dict]]] = {}
+        # Set once an object carried its keypoints in mask_params (NvDsInferParseYolo26Pose); the cache is then
+        # only read for frames without objects.
+        self._pose_kpts_in_meta = False
         self._pose_cache_fn = None
         self._pose_cache_lib = None
+        self._pose_acquire_fn = None
+        self._pose_release_fn = None
+        self._pose_view_acquire_fn = None
+        self._pose_view_release_fn = None
+        self._result_acquire_fn = None
+        self._result_release_fn = None
+        self._pose_set_source_res_fn = None
+        self._stage_latency_fn = None
+        self._stage_names: list[str] = []
+        self._parser_stats_fn = None
+        self._parser_stats_last: dict[str, int] = {}
+        self._parser_stats_polled = 0.0
+        self._memory_stats_fn = None
+        self._memory_refused = 0
+        # nvinfer interval recommended by the lib's motion gate (SQUEAKVIEW_MOTION_GATE); polled once a second.
+        self._infer_interval_fn = None
+        self._motion_state_fn = None
+        self._infer_interval = 0
+        self._infer_interval_polled = 0.0
+        # Weight refit of a YOLO_REFIT=1 engine: write an ONNX path into refit_weights.txt in the run dir.
+        self._refit_fn = None
+        self.refit_ctrl_path = self.run_dir / "refit_weights.txt"
+        # YOLO_HOT_SWAP=1: nvinfer starts on a fallback engine; the finished background build is swapped in.
+        self._engine_swap_fn = None
+        # SQUEAKVIEW_RECORD=1 records the parser inputs of this run for `make replay` (see tensor_record.h).
+        if os.environ.get("SQUEAKVIEW_RECORD") == "1":
+            os.environ["SQUEAKVIEW_RECORD"] = str(self.run_dir / "tensors.sqvrec")
+            print(f"[{ts()}] [INFO] recording parser inputs to {os.environ['SQUEAKVIEW_RECORD']}", flush=True)
+        # nvinfer keeps nms-iou-threshold to itself; hand it to the lib's own NMS unless SQUEAKVIEW_NMS_IOU is set.
+        if "SQUEAKVIEW_NMS_IOU" not in os.environ:
+            nms_iou = self._load_nms_iou(Path(config.cfg_path))
+            if nms_iou > 0.0:
+                os.environ["SQUEAKVIEW_NMS_IOU"] = str(nms_iou)
+        # Capture-to-parse latency: every frame leaving nvinfer is tagged with its PTS and capture time.
+        self._tag_timing_fn = None
+        self._get_timing_fn = None
+        self._capture_base_ns: int | None = None
+        self._pose_source_res: dict[int, tuple[int, int]] = {}
         # Draw all keypoints by default; can be overridden via pose-draw-threshold in the config
         self.pose_draw_score_thresh = self._load_pose_draw_thresh(config.cfg_path) if self.pose_mode else 0.0
         self.pose_draw_radius = 8
@@ -266,6 +502,8 @@ class App:
         except Exception:
             self._surf_debug_limit = 15
         GLib.timeout_add_seconds(1, self._poll_skeleton_toggle)
+        GLib.timeout_add_seconds(1, self._poll_refit_request)
+        GLib.timeout_add_seconds(2, self._poll_engine_swap)
         if self.pose_mode:
             self._init_pose_cache_helper()
         print(f"[{ts()}] [INFO] run dir:      {self.run_dir}", flush=True)
@@ -294,7 +532,7 @@ class App:
                         net_dims = (net_w, net_h)
                 except Exception:
                     net_dims = None
-            if line.startswith("parse-bbox-func-name"):
+            if line.startswith(("parse-bbox-func-name", "parse-bbox-instance-mask-func-name")):
                 parser_name = line.split("=", 1)[1].strip()
             if line.startswith("labelfile-path"):
                 try:
@@ -328,6 +566,23 @@ class App:
                     return 0.0
         return 0.0
 
+    @staticmethod
+    def _load_nms_iou(cfg_path: Path) -> float:
+        try:
+            lines = Path(cfg_path).read_text().splitlines()
+        except Exception:
+            return 0.0
+        for line in lines:
+            raw = line.strip()
+            if not raw or raw.startswith("#"):
+                continue
+            if raw.lower().startswith("nms-iou-threshold"):
+                try:
+                    return float(raw.split("=", 1)[1].strip())
+                except Exception:
+                    return 0.0
+        return 0.0
+
     def build(self) -> None:
         cfg = self.config
         sock = cfg.sock
@@ -537,6 +792,7 @@ class App:
         buf = info.get_buffer()
         if buf is None:
             return Gst.PadProbeReturn.OK
+        self._tag_frame_timing(buf)
         key = hash(buf)
         start = self._infer_starts.pop(key, None)
         if start is None:
@@ -558,6 +814,8 @@ class App:
             avg_latency = sum(lat for _, lat in self._infer_history) / len(self._infer_history)
         if getattr(self, '_perf_writer', None):
             self._write_perf_row(stream_fps=self._stream_fps, infer_fps=fps, latency_ms=avg_latency)
+        self._poll_parser_stats()
+        self._poll_infer_interval()
         return Gst.PadProbeReturn.OK
 
     @staticmethod
@@ -605,10 +863,320 @@ class App:
             ]
             self._pose_cache_lib = lib
             self._pose_cache_fn = fn
+            if hasattr(lib, "NvDsInferPoseAcquireLatest") and hasattr(lib, "NvDsInferPoseRelease"):
+                acquire = lib.NvDsInferPoseAcquireLatest
+                acquire.restype = ctypes.c_int
+                acquire.argtypes = [ctypes.c_int, ctypes.POINTER(_PoseFrame)]
+                release = lib.NvDsInferPoseRelease
+                release.restype = None
+                release.argtypes = [ctypes.POINTER(_PoseFrame)]
+                self._pose_acquire_fn = acquire
+                self._pose_release_fn = release
+            if hasattr(lib, "NvDsInferPoseViewAcquireLatest") and hasattr(lib, "NvDsInferPoseViewRelease"):
+                view_acquire = lib.NvDsInferPoseViewAcquireLatest
+                view_acquire.restype = ctypes.c_int
+                view_acquire.argtypes = [ctypes.c_int, ctypes.POINTER(_PoseView)]
+                view_release = lib.NvDsInferPoseViewRelease
+                view_release.restype = None
+                view_release.argtypes = [ctypes.POINTER(_PoseView)]
+                self._pose_view_acquire_fn = view_acquire
+                self._pose_view_release_fn = view_release
+            records_on = os.environ.get("SQUEAKVIEW_RESULT_RECORDS", "1") != "0"
+            if records_on and hasattr(lib, "NvDsInferResultAcquireLatest") and hasattr(lib, "NvDsInferResultVersion"):
+                lib.NvDsInferResultVersion.restype = ctypes.c_int
+                if lib.NvDsInferResultVersion() == _RESULT_VERSION:
+                    result_acquire = lib.NvDsInferResultAcquireLatest
+                    result_acquire.restype = ctypes.c_int
+                    result_acquire.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.POINTER(_ResultFrame)]
+                    result_release = lib.NvDsInferResultRelease
+                    result_release.restype = None
+                    result_release.argtypes = [ctypes.POINTER(_ResultFrame)]
+                    self._result_acquire_fn = result_acquire
+                    self._result_release_fn = result_release
+            if hasattr(lib, "NvDsInferSetSourceResolution"):
+                set_res = lib.NvDsInferSetSourceResolution
+                set_res.restype = None
+                set_res.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int]
+                self._pose_set_source_res_fn = set_res
+            if hasattr(lib, "NvDsInferGetStageLatency") and hasattr(lib, "NvDsInferGetStageName"):
+                latency = lib.NvDsInferGetStageLatency
+                latency.restype = ctypes.c_int
+                latency.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.POINTER(_StageLatency)]
+                name = lib.NvDsInferGetStageName
+                name.restype = ctypes.c_char_p
+                name.argtypes = [ctypes.c_int]
+                lib.NvDsInferGetStageCount.restype = ctypes.c_int
+                self._stage_names = [name(i).decode() for i in range(lib.NvDsInferGetStageCount())]
+                self._stage_latency_fn = latency
+            if hasattr(lib, "NvDsInferGetParserStats"):
+                stats = lib.NvDsInferGetParserStats
+                stats.restype = None
+                stats.argtypes = [ctypes.POINTER(_ParserStats)]
+                self._parser_stats_fn = stats
+            if hasattr(lib, "NvDsInferGetMemoryStats"):
+                memory = lib.NvDsInferGetMemoryStats
+                memory.restype = None
+                memory.argtypes = [ctypes.POINTER(_MemoryStats)]
+                self._memory_stats_fn = memory
+            if hasattr(lib, "NvDsInferGetInferInterval") and hasattr(lib, "NvDsInferGetMotionState"):
+                interval = lib.NvDsInferGetInferInterval
+                interval.restype = ctypes.c_int
+                interval.argtypes = []
+                motion = lib.NvDsInferGetMotionState
+                motion.restype = ctypes.c_int
+                motion.argtypes = [ctypes.c_int, ctypes.POINTER(_MotionState)]
+                self._infer_interval_fn = interval
+                self._motion_state_fn = motion
+            if hasattr(lib, "NvDsInferTagFrameTiming") and hasattr(lib, "NvDsInferGetFrameTiming"):
+                tag = lib.NvDsInferTagFrameTiming
+                tag.restype = ctypes.c_int
+                tag.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.c_int64]
+                timing = lib.NvDsInferGetFrameTiming
+                timing.restype = ctypes.c_int
+                timing.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.POINTER(_FrameTiming)]
+                self._tag_timing_fn = tag
+                self._get_timing_fn = timing
+            if hasattr(lib, "NvDsInferYoloRefitEngine"):
+                refit = lib.NvDsInferYoloRefitEngine
+                refit.restype = ctypes.c_int
+                refit.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+                self._refit_fn = refit
+            if hasattr(lib, "NvDsInferYoloEngineSwapPoll"):
+                swap = lib.NvDsInferYoloEngineSwapPoll
+                swap.restype = ctypes.c_int
+                swap.argtypes = [ctypes.c_char_p, ctypes.c_int]
+                self._engine_swap_fn = swap
             print(f"[{ts()}] [POSE] cache hook ready: {lib_path}")
         except Exception as exc:
             print(f"[{ts()}] [POSE] cache hook failed: {exc}")
 
+    def parser_latency(self, window_s: int = 5) -> dict[str, dict[str, float]]:
+        """Rolling per-stage latency of the custom lib (parse, nms, cache, ...) over the last window_s seconds."""
+        if self._stage_latency_fn is None:
+            return {}
+        out: dict[str, dict[str, float]] = {}
+        lat = _StageLatency()
+        for i, name in enumerate(self._stage_names):
+            if self._stage_latency_fn(i, window_s, ctypes.byref(lat)) and lat.count:
+                out[name] = {
+                    "count": float(lat.count),
+                    "mean_us": lat.mean_us,
+                    "p50_us": lat.p50_us,
+                    "p90_us": lat.p90_us,
+                    "p99_us": lat.p99_us,
+                    "max_us": lat.max_us,
+                }
+        return out
+
+    def _capture_base(self) -> int:
+        """Monotonic time of running time 0, or 0 when the pipeline clock is not CLOCK_MONOTONIC."""
+        if self._capture_base_ns is None:
+            base = 0
+            try:
+                clock = self.pipeline.get_pipeline_clock() if self.pipeline else None
+                if (
+                    isinstance(clock, Gst.SystemClock)
+                    and clock.get_property("clock-type") == Gst.ClockType.MONOTONIC
+                ):
+                    base = int(self.pipeline.get_base_time())
+            except Exception:
+                base = 0
+            self._capture_base_ns = base
+        return self._capture_base_ns
+
+    def _tag_frame_timing(self, buf) -> None:
+        """Hand the lib the PTS and capture time of every frame nvinfer just parsed.
+
+        Live sources stamp buffers with the running time at capture, so base time + PTS is the capture time on
+        the pipeline clock; without a monotonic system clock only the PTS is tagged.
+        """
+        tag = self._tag_timing_fn
+        if tag is None:
+            return
+        try:
+            batch = pyds.gst_buffer_get_nvds_batch_meta(hash(buf))
+        except Exception:
+            return
+        if not batch:
+            return
+        base = self._capture_base()
+        l_frame = batch.frame_meta_list
+        while l_frame:
+            try:
+                fmeta = pyds.NvDsFrameMeta.cast(l_frame.data)
+            except StopIteration:
+                break
+            pts = int(getattr(fmeta, "buf_pts", 0) or 0)
+            capture = base + pts if base and pts else 0
+            tag(int(getattr(fmeta, "batch_id", 0)), pts, capture)
+            try:
+                l_frame = l_frame.next
+            except StopIteration:
+                break
+
+    def frame_timing(self, source_id: int, frame_num: int) -> dict[str, int] | None:
+        """PTS, capture and parse times (monotonic ns) of a recently parsed frame, None when unknown."""
+        if self._get_timing_fn is None:
+            return None
+        raw = _FrameTiming()
+        if not self._get_timing_fn(source_id, frame_num, ctypes.byref(raw)):
+            return None
+        return {name: int(getattr(raw, name)) for name, _ in _FrameTiming._fields_ if name != "reserved"}
+
+    def parser_stats(self) -> dict[str, int]:
+        """Totals of the custom lib's parser counters since load (empty when the lib does not export them)."""
+        if self._parser_stats_fn is None:
+            return {}
+        raw = _ParserStats()
+        self._parser_stats_fn(ctypes.byref(raw))
+        return {name: int(getattr(raw, name)) for name, _ in _ParserStats._fields_}
+
+    def memory_stats(self) -> dict:
+        """The parser lib's memory accounts in bytes (empty when the lib does not export them).
+
+        current/peak map component -> kind -> bytes; total_peak and budget map kind -> bytes (budget 0 = none).
+        """
+        if self._memory_stats_fn is None:
+            return {}
+        raw = _MemoryStats()
+        self._memory_stats_fn(ctypes.byref(raw))
+
+        def per_component(table) -> dict[str, dict[str, int]]:
+            return {c: {k: int(table[i][j]) for j, k in enumerate(_MEM_KINDS)} for i, c in enumerate(_MEM_COMPONENTS)}
+
+        return {
+            "current": per_component(raw.current),
+            "peak": per_component(raw.peak),
+            "total_peak": {k: int(raw.total_peak[j]) for j, k in enumerate(_MEM_KINDS)},
+            "budget": {k: int(raw.budget[j]) for j, k in enumerate(_MEM_KINDS)},
+            "refused": int(raw.refused),
+        }
+
+    def _poll_parser_stats(self) -> None:
+        """Once a second: warn when the pose/OBB rings dropped frames, the parsers are still allocating or
+        SQUEAKVIEW_MEM_BUDGET turned allocations down."""
+        now = time.monotonic()
+        if self._parser_stats_fn is None or now - self._parser_stats_polled < 1.0:
+            return
+        self._parser_stats_polled = now
+        memory = self.memory_stats()
+        if memory and memory["refused"] > self._memory_refused:
+            refused, self._memory_refused = memory["refused"] - self._memory_refused, memory["refused"]
+            peak = ", ".join(f"{k} {v >> 20} MiB" for k, v in memory["total_peak"].items())
+            print(f"[{ts()}] [POSE] WARN: memory budget refused {refused} allocations (peak {peak})")
+        stats = self.parser_stats()
+        last, self._parser_stats_last = self._parser_stats_last, stats
+        if not last:
+            return
+        dropped = stats["cache_overwrites"] - last["cache_overwrites"]
+        if dropped > 0:
+            print(f"[{ts()}] [POSE] WARN: {dropped} parser frames overwritten before they were read")
+        frames = stats["frames_parsed"] - last["frames_parsed"]
+        grown = stats["allocations"] - last["allocations"]
+        if grown > 0 and frames > 0 and stats["frames_parsed"] > 100:
+            print(f"[{ts()}] [POSE] NOTE: parser scratch grew {grown} times over the last {frames} frames")
+
+    def motion_state(self, source_id: int) -> dict[str, float] | None:
+        """Motion gate view of one source (None while the gate is off or the source has not been parsed yet)."""
+        if self._motion_state_fn is None:
+            return None
+        raw = _MotionState()
+        if not self._motion_state_fn(source_id, ctypes.byref(raw)):
+            return None
+        return {name: getattr(raw, name) for name, _ in _MotionState._fields_}
+
+    def _poll_infer_interval(self) -> None:
+        """Once a second: apply the motion gate's recommended interval to nvinfer when it changed.
+
+        nvinfer only runs the parser on the frames it infers, so the gate can only drop back to interval 0 on the
+        next inferred frame; the idle interval bounds how long a burst of activity goes unseen.
+        """
+        now = time.monotonic()
+        if self._infer_interval_fn is None or now - self._infer_interval_polled < 1.0:
+            return
+        self._infer_interval_polled = now
+        interval = int(self._infer_interval_fn())
+        if interval == self._infer_interval:
+            return
+        pgie = self.pipeline.get_by_name("pgie") if getattr(self, "pipeline", None) else None
+        if pgie is None:
+            return
+        pgie.set_property("interval", interval)
+        print(f"[{ts()}] [MOTION] nvinfer interval {self._infer_interval} -> {interval}", flush=True)
+        self._infer_interval = interval
+
+    def refit_weights(self, onnx_path: str) -> bool:
+        """Swap the engine's weights for those of onnx_path (same architecture) without restarting.
+
+        The refit runs from a one-shot probe on the nvinfer sink pad, so it happens on the streaming thread
+        between two frames and no new inference starts while the weights change. Returns False when the lib
+        cannot refit or the pipeline has no nvinfer element; the outcome of the refit itself is logged.
+        """
+        pgie = self.pipeline.get_by_name("pgie") if getattr(self, "pipeline", None) else None
+        pad = pgie.get_static_pad("sink") if pgie is not None else None
+        if self._refit_fn is None or pad is None:
+            return False
+        path = str(Path(onnx_path).expanduser())
+
+        def _refit(_pad, _info):
+            ok = self._refit_fn(None, path.encode())
+            print(f"[{ts()}] [REFIT] {'weights swapped from' if ok else 'refit failed for'} {path}", flush=True)
+            return Gst.PadProbeReturn.REMOVE
+
+        pad.add_probe(Gst.PadProbeType.BUFFER, _refit)
+        print(f"[{ts()}] [REFIT] refit from {path} queued for the next frame", flush=True)
+        return True
+
+    def _poll_refit_request(self):
+        try:
+            text = self.refit_ctrl_path.read_text().strip()
+        except Exception:
+            return True
+        try:
+            self.refit_ctrl_path.unlink()
+        except Exception:
+            pass
+        if text and not self.refit_weights(text):
+            print(f"[{ts()}] [REFIT] ignored {text}: the custom lib cannot refit (YOLO_REFIT=1, TensorRT >= 10)")
+        return True
+
+    def _poll_engine_swap(self):
+        """Point nvinfer at the engine a YOLO_HOT_SWAP background build finished.
+
+        Setting model-engine-file on a running nvinfer loads the new engine next to the old one and switches
+        between two batches, so capture never stops. The lib validated the plan against the fallback's inputs
+        and outputs before reporting it.
+        """
+        if self._engine_swap_fn is None:
+            return True
+        buf = ctypes.create_string_buffer(4096)
+        state = self._engine_swap_fn(buf, len(buf))
+        if state == 0:
+            return True
+        path = buf.value.decode(errors="replace")
+        if state < 0:
+            print(f"[{ts()}] [SWAP] background build of {path} failed, staying on the fallback engine", flush=True)
+            return True
+        pgie = self.pipeline.get_by_name("pgie") if getattr(self, "pipeline", None) else None
+        if pgie is None:
+            print(f"[{ts()}] [SWAP] {path} is ready but the pipeline has no nvinfer element", flush=True)
+            return True
+        pgie.set_property("model-engine-file", path)
+        print(f"[{ts()}] [SWAP] switching nvinfer to {path}", flush=True)
+        return True
+
+    def _push_pose_source_resolution(self, frame_meta) -> None:
+        """Tell the parser the real frame size of this batch slot so it can unletterbox in C++."""
+        set_res = self._pose_set_source_res_fn
+        if set_res is None:
+            return
+        slot = int(getattr(frame_meta, "batch_id", 0))
+        res = (int(getattr(frame_meta, "source_frame_width", 0)), int(getattr(frame_meta, "source_frame_height", 0)))
+        if res[0] <= 0 or res[1] <= 0 or self._pose_source_res.get(slot) == res:
+            return
+        set_res(slot, res[0], res[1])
+        self._pose_source_res[slot] = res
+
     def _decode_pose_tensor(self, frame_meta) -> list[dict] | None:
         if not self.pose_mode:
             return None
@@ -616,25 +1184,111 @@ class App:
         if fn is None:
             return []
 
-        data_ptr = ctypes.POINTER(ctypes.c_float)()
-        total = ctypes.c_int()
-        kpts = ctypes.c_int()
-        seq = fn(ctypes.byref(data_ptr), ctypes.byref(total), ctypes.byref(kpts))
-        total_val = int(total.value)
-
-        if seq == 0 or total_val <= 0 or not data_ptr:
-            self._pose_cache_seq = seq
-            self._pose_cache_last = []
-            return []
+        self._push_pose_source_resolution(frame_meta)
+        result_acquire = self._result_acquire_fn
+        if result_acquire is not None:
+            # The versioned result record (result_record.h): one layout whatever SQUEAKVIEW_POSE_FORMAT is.
+            cache_key = int(getattr(frame_meta, "batch_id", -1))
+            cached = self._pose_cache_by_slot.get(cache_key)
+            frame = _ResultFrame()
+            if not result_acquire(_RESULT_KIND_POSE, cache_key, ctypes.byref(frame)):
+                return self._stale_pose(cached)
+            try:
+                seq = int(frame.seq)
+                if cached is not None and seq == cached[0]:
+                    return self._stale_pose(cached)
+                header = frame.record.contents
+                if header.magic != _RESULT_MAGIC or header.count <= 0:
+                    self._pose_cache_by_slot[cache_key] = (seq, [])
+                    return []
+                flags = _POSE_FRAME_SOURCE_COORDS if header.flags & _RESULT_SOURCE_COORDS else 0
+                if header.fields >> _RESULT_TRACK_IDS & 1:
+                    flags |= _POSE_FRAME_TRACK_IDS
+                rows = _result_pose_rows(header)
+                kpt_count = int(header.kpts)
+            finally:
+                self._result_release_fn(ctypes.byref(frame))
+            detections = self._pose_rows_to_detections(rows, kpt_count, frame_meta, flags)
+            self._pose_cache_by_slot[cache_key] = (seq, detections)
+            return detections
+
+        view_acquire = self._pose_view_acquire_fn
+        if view_acquire is not None:
+            # Pin the newest ring slot for this batch slot and decode straight out of it: no copy and no
+            # per-value ctypes access, the slot is only unpinned once the detections are built.
+            cache_key = int(getattr(frame_meta, "batch_id", -1))
+            cached = self._pose_cache_by_slot.get(cache_key)
+            view = _PoseView()
+            if not view_acquire(cache_key, ctypes.byref(view)):
+                return self._stale_pose(cached)
+            try:
+                seq = int(view.seq)
+                if cached is not None and seq == cached[0]:
+                    return self._stale_pose(cached)
+                rows_n, width = int(view.shape[0]), int(view.shape[1])
+                if rows_n <= 0 or not view.data:
+                    self._pose_cache_by_slot[cache_key] = (seq, [])
+                    return []
+                rows = np.ctypeslib.as_array(view.data, shape=(rows_n, width))
+                if int(view.flags) & _POSE_FRAME_COMPACT:
+                    rows = _unpack_compact_pose(rows, int(view.kpts), bool(int(view.flags) & _POSE_FRAME_TRACK_IDS))
+                detections = self._pose_rows_to_detections(rows, int(view.kpts), frame_meta, int(view.flags))
+            finally:
+                self._pose_view_release_fn(ctypes.byref(view))
+            self._pose_cache_by_slot[cache_key] = (seq, detections)
+            return detections
+
+        flags = 0
+        acquire = self._pose_acquire_fn
+        if acquire is not None:
+            # Pin the newest ring slot for this frame's batch slot so the parser cannot recycle it while we copy it out.
+            cache_key = int(getattr(frame_meta, "batch_id", -1))
+            cached = self._pose_cache_by_slot.get(cache_key)
+            frame = _PoseFrame()
+            if not acquire(cache_key, ctypes.byref(frame)):
+                return self._stale_pose(cached)
+            try:
+                seq = int(frame.seq)
+                kpts_val = int(frame.kpts)
+                total_val = int(frame.count) * int(frame.stride)
+                flags = int(frame.flags)
+                if cached is not None and seq == cached[0]:
+                    return self._stale_pose(cached)
+                if total_val <= 0 or not frame.data:
+                    self._pose_cache_by_slot[cache_key] = (seq, [])
+                    return []
+                arr = np.array(np.ctypeslib.as_array(frame.data, shape=(total_val,)), copy=True)
+            finally:
+                self._pose_release_fn(ctypes.byref(frame))
+            if flags & _POSE_FRAME_COMPACT:
+                kpt_count = max(0, kpts_val)
+                words = (_POSE_COMPACT_HEADER + 5 * kpt_count + 3) // 4
+                rows = _unpack_compact_pose(arr[: total_val - total_val % words].reshape(-1, words), kpt_count,
+                                            bool(flags & _POSE_FRAME_TRACK_IDS))
+                detections = self._pose_rows_to_detections(rows, kpt_count, frame_meta, flags)
+                self._pose_cache_by_slot[cache_key] = (int(seq), detections)
+                return detections
+        else:
+            # NvDsInferGetPoseCache only returns plain float rows (no compact records, no track ids).
+            cache_key = -1
+            cached = self._pose_cache_by_slot.get(cache_key)
+            data_ptr = ctypes.POINTER(ctypes.c_float)()
+            total = ctypes.c_int()
+            kpts = ctypes.c_int()
+            seq = fn(ctypes.byref(data_ptr), ctypes.byref(total), ctypes.byref(kpts))
+            total_val = int(total.value)
+            kpts_val = int(kpts.value)
+
+            if seq == 0 or total_val <= 0 or not data_ptr:
+                self._pose_cache_by_slot[cache_key] = (int(seq), [])
+                return []
 
-        if seq == self._pose_cache_seq and self._pose_cache_last is not None:
-            return self._pose_cache_last
+            if cached is not None and seq == cached[0]:
+                return self._stale_pose(cached)
+            arr = np.array(np.ctypeslib.as_array(data_ptr, shape=(total_val,)), copy=True)
 
-        kpt_count = max(0, int(kpts.value))
-        stride = 5 + 3 * kpt_count
-        if stride <= 5:
-            print(f"[{ts()}] [POSE] cache stride invalid: stride={stride}")
-            return []
+        kpt_count = max(0, kpts_val)
+        stride = 5 + 3 * kpt_count + (1 if flags & _POSE_FRAME_TRACK_IDS else 0)
         remainder = total_val % stride
         if remainder != 0:
             print(f"[{ts()}] [POSE] cache size mismatch total={total_val} stride={stride}")
@@ -642,15 +1296,54 @@ class App:
             if total_val <= 0:
                 return []
 
-        arr = np.ctypeslib.as_array(data_ptr, shape=(total_val,))
-        arr = np.array(arr, copy=True).reshape(-1, stride)
+        detections = self._pose_rows_to_detections(arr[:total_val].reshape(-1, stride), kpt_count, frame_meta, flags)
+        self._pose_cache_by_slot[cache_key] = (int(seq), detections)
+        return detections
+
+    def _object_keypoints(self, ometa, x: float, y: float, w: float, h: float) -> list[float] | None:
+        """Keypoints the parser attached to this object's mask payload, flat (x, y, score) in frame pixels, or None.
+
+        The payload is 3 x kpts floats, (u, v, score) with u, v relative to the box (attach_keypoints in
+        yolo_pose_parser.cpp), so the keypoints follow the box through nvinfer's scaling and the tracker.
+        """
+        mask = getattr(ometa, "mask_params", None)
+        if mask is None or int(getattr(mask, "width", 0)) != 3:
+            return None
+        kpt_count = int(getattr(mask, "height", 0))
+        if kpt_count <= 0 or int(getattr(mask, "size", 0)) < 12 * kpt_count:
+            return None
+        try:
+            kps = np.array(mask.get_mask_array(), dtype=np.float64)[: 3 * kpt_count].reshape(kpt_count, 3)
+        except Exception:
+            return None
+        kps[:, 0] = x + kps[:, 0] * w
+        kps[:, 1] = y + kps[:, 1] * h
+        self.pose_kpt_count = kpt_count
+        self.pose_kpt_dims = 3
+        return kps.reshape(-1).tolist()
+
+    @staticmethod
+    def _stale_pose(cached: tuple[int, list[dict]] | None) -> list[dict]:
+        """Detections of a pose frame already returned once (nvinfer skipped this frame), marked stale=True."""
+        return [dict(d, stale=True) for d in cached[1]] if cached else []
+
+    def _pose_rows_to_detections(self, rows: np.ndarray, kpt_count: int, frame_meta, flags: int) -> list[dict]:
+        """[x1,y1,x2,y2,conf, (x,y,score)*kpts (, track id)] rows -> detection dicts in frame pixels, best first.
+
+        rows may be a view of the parser's ring slot: it is only read, every result is a new array.
+        """
+        kpt_count = max(0, kpt_count)
+        stride = 5 + 3 * kpt_count
+        track_ids = bool(flags & _POSE_FRAME_TRACK_IDS)
+        if stride <= 5 or rows.ndim != 2 or rows.shape[1] < stride + (1 if track_ids else 0):
+            print(f"[{ts()}] [POSE] cache stride invalid: stride={stride}")
+            return []
 
-        detections: list[dict] = []
         self.pose_kpt_count = kpt_count
         self.pose_kpt_dims = 3 if kpt_count > 0 else 0
-        if arr.size and not hasattr(self, "_pose_debug_raw_printed"):
+        if rows.size and not hasattr(self, "_pose_debug_raw_printed"):
             try:
-                rows_to_show = arr[: min(3, arr.shape[0]), : min(stride, arr.shape[1])]
+                rows_to_show = rows[: min(3, rows.shape[0]), :stride]
                 print(f"[{ts()}] [POSE] raw sample rows:\n{rows_to_show}")
             except Exception as debug_exc:
                 print(f"[{ts()}] [POSE] raw sample dump err: {debug_exc}")
@@ -668,44 +1361,33 @@ class App:
             gain = 1.0
         pad_x = 0.5 * (net_w - frame_w * gain)
         pad_y = 0.5 * (net_h - frame_h * gain)
+        if flags & _POSE_FRAME_SOURCE_COORDS:
+            # The parser already unletterboxed with the resolution we pushed for this slot.
+            gain, pad_x, pad_y = 1.0, 0.0, 0.0
+
+        conf = rows[:, 4]
+        keep = np.flatnonzero(conf > 0)
+        # Stable descending order, the same tie order as sorting the dicts by conf with reverse=True.
+        keep = keep[np.argsort(-conf[keep], kind="stable")]
+        if keep.size == 0:
+            return []
 
-        for chunk in arr:
-            if chunk.size < stride:
-                continue
-            x1, y1, x2, y2, conf = chunk[:5]
-            if conf <= 0:
-                continue
-            # undo letterbox
-            x1 = (x1 - pad_x) / gain
-            y1 = (y1 - pad_y) / gain
-            x2 = (x2 - pad_x) / gain
-            y2 = (y2 - pad_y) / gain
-            x1 = float(np.clip(x1, 0.0, frame_w - 1.0))
-            y1 = float(np.clip(y1, 0.0, frame_h - 1.0))
-            x2 = float(np.clip(x2, 0.0, frame_w - 1.0))
-            y2 = float(np.clip(y2, 0.0, frame_h - 1.0))
-
-            kp_vals = chunk[5 : 5 + 3 * kpt_count]
-            if kp_vals.size < 3 * kpt_count:
-                continue
-            kpts_flat: list[float] = []
-            for idx in range(kpt_count):
-                kx = (kp_vals[3 * idx + 0] - pad_x) / gain
-                ky = (kp_vals[3 * idx + 1] - pad_y) / gain
-                ks = float(kp_vals[3 * idx + 2])
-                kx = float(np.clip(kx, 0.0, frame_w - 1.0))
-                ky = float(np.clip(ky, 0.0, frame_h - 1.0))
-                kpts_flat.extend([kx, ky, ks])
-
-            detections.append({
-                "bbox": (x1, y1, x2, y2),
-                "conf": float(conf),
-                "kpts": kpts_flat,
-            })
-
-        detections.sort(key=lambda d: d["conf"], reverse=True)
-        self._pose_cache_seq = int(seq)
-        self._pose_cache_last = detections
+        # Undo the letterbox for boxes and keypoints at once; x columns and y columns alternate in both.
+        boxes = (rows[keep, 0:4].astype(np.float64) - (pad_x, pad_y, pad_x, pad_y)) / gain
+        boxes[:, 0::2] = np.clip(boxes[:, 0::2], 0.0, frame_w - 1.0)
+        boxes[:, 1::2] = np.clip(boxes[:, 1::2], 0.0, frame_h - 1.0)
+        kps = rows[keep, 5:stride].astype(np.float64).reshape(-1, kpt_count, 3)
+        kps[:, :, 0] = np.clip((kps[:, :, 0] - pad_x) / gain, 0.0, frame_w - 1.0)
+        kps[:, :, 1] = np.clip((kps[:, :, 1] - pad_y) / gain, 0.0, frame_h - 1.0)
+
+        detections = [
+            {"bbox": tuple(b), "conf": c, "kpts": k}
+            for b, c, k in zip(boxes.tolist(), conf[keep].astype(np.float64).tolist(),
+                               kps.reshape(keep.size, -1).tolist())
+        ]
+        if track_ids:
+            for det, tid in zip(detections, rows[keep, stride].astype(np.int64).tolist()):
+                det["track_id"] = tid
         if detections and not hasattr(self, "_pose_debug_cache_print"):
             first = detections[0]
             kp0 = first["kpts"][0] if first["kpts"] else 0.0
@@ -788,7 +1470,12 @@ class App:
                 ts_us = int(pts_value / 1_000) if pts_value else -1
                 stream_id = int(getattr(fmeta, "pad_index", 0))
 
-                pose_detections = self._decode_pose_tensor(fmeta) if self.pose_mode else None
+                pose_detections = None
+                if self.pose_mode:
+                    if self._pose_kpts_in_meta:
+                        self._push_pose_source_resolution(fmeta)
+                    else:
+                        pose_detections = self._decode_pose_tensor(fmeta)
                 # If pose count was unknown at init, rebuild CSV header before first row
                 if (
                     self.pose_mode
@@ -840,12 +1527,14 @@ class App:
                         ]
                         if self.pose_mode:
                             bbox = (x, y, x + w, y + h)
-                            pose_entry = self._match_pose_to_bbox(bbox, conf, pose_detections or [], used_pose)
-                            expected = self.pose_kpt_count * self.pose_kpt_dims
-                            if pose_entry:
-                                pose_vals = pose_entry.get("kpts", [])
+                            pose_entry = None
+                            pose_vals = self._object_keypoints(ometa, x, y, w, h)
+                            if pose_vals is not None:
+                                self._pose_kpts_in_meta = True
                             else:
-                                pose_vals = None
+                                pose_entry = self._match_pose_to_bbox(bbox, conf, pose_detections or [], used_pose)
+                                pose_vals = pose_entry.get("kpts", []) if pose_entry else None
+                            expected = self.pose_kpt_count * self.pose_kpt_dims
                             if pose_vals and len(pose_vals) >= expected:
                                 for idx in range(self.pose_kpt_count):
                                     base = idx * self.pose_kpt_dims
@@ -877,6 +1566,15 @@ class App:
                 except StopIteration:
                     break
 
+                # Frames nvinfer skipped under the motion gate carry no objects: keep drawing the last poses.
+                if self.pose_mode and obj_count == 0 and pose_detections is None:
+                    pose_detections = self._decode_pose_tensor(fmeta)
+                if self.pose_mode and obj_count == 0 and pose_detections and pose_detections[0].get("stale"):
+                    for det in pose_detections:
+                        x1, y1, x2, y2 = det["bbox"]
+                        frame_pose_draw.append({"rect": (x1, y1, x2 - x1, y2 - y1), "pose_bbox": det["bbox"],
+                                                "kpts": det.get("kpts", [])})
+
                 if self.pose_mode and frame_pose_draw:
                     display_meta = None
                     try: